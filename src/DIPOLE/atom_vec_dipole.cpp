@@ -64,7 +64,7 @@ void AtomVecDipole::grow(int n)
   image = memory->grow(atom->image,nmax,"atom:image");
   x = memory->grow(atom->x,nmax,3,"atom:x");
   v = memory->grow(atom->v,nmax,3,"atom:v");
-  f = memory->grow(atom->f,nmax*comm->nthreads,3,"atom:f");
+  f = memory->grow(atom->f,nmax*nthreads_f(),3,"atom:f");
 
   q = memory->grow(atom->q,nmax,"atom:q");
   mu = memory->grow(atom->mu,nmax,4,"atom:mu");
@@ -901,7 +901,7 @@ bigint AtomVecDipole::memory_usage()
   if (atom->memcheck("image")) bytes += memory->usage(image,nmax);
   if (atom->memcheck("x")) bytes += memory->usage(x,nmax,3);
   if (atom->memcheck("v")) bytes += memory->usage(v,nmax,3);
-  if (atom->memcheck("f")) bytes += memory->usage(f,nmax*comm->nthreads,3);
+  if (atom->memcheck("f")) bytes += memory->usage(f,nmax*nthreads_f(),3);
 
   if (atom->memcheck("q")) bytes += memory->usage(q,nmax);
   if (atom->memcheck("mu")) bytes += memory->usage(mu,nmax,4);
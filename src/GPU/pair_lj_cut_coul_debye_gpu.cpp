@@ -71,6 +71,7 @@ PairLJCutCoulDebyeGPU::PairLJCutCoulDebyeGPU(LAMMPS *lmp) :
   PairLJCutCoulDebye(lmp), gpu_mode(GPU_FORCE)
 {
   respa_enable = 0;
+  overlap_enable = 0;
   reinitflag = 0;
   cpu_time = 0.0;
   GPU_EXTRA::gpu_ready(lmp->modify, lmp->error); 
@@ -88,6 +88,7 @@ void Ewald::init()
   // error check
   
   triclinic_check();
+  mixed_check();
   if (domain->dimension == 2)
     error->all(FLERR,"Cannot use Ewald with 2d simulation");
 
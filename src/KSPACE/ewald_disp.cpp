@@ -93,6 +93,7 @@ void EwaldDisp::init()
   }
 
   triclinic_check();
+  mixed_check();
   if (domain->dimension == 2)
     error->all(FLERR,"Cannot use EwaldDisp with 2d simulation");
   if (slabflag == 0 && domain->nonperiodic > 0)
@@ -34,6 +34,11 @@
 #define MIN(A,B) ((A) < (B) ? (A) : (B))
 #define MAX(A,B) ((A) > (B) ? (A) : (B))
 
+static void fft_3d_targets(FFT_DATA **, FFT_DATA **, int, int,
+                           struct fft_plan_3d *);
+static int fft_3d_remap(FFT_DATA **, FFT_DATA **, int,
+                        struct remap_plan_3d *, struct fft_plan_3d *);
+
 /* ----------------------------------------------------------------------
    Data layout for 3d FFTs:
 
@@ -62,13 +67,39 @@
                   will be placed (can be same as in)
    flag         1 for forward FFT, -1 for inverse FFT
    plan         plan returned by previous call to fft_3d_create_plan
+
+   return 1 if remap buffers could not be allocated, else 0
 ------------------------------------------------------------------------- */
 
-void fft_3d(FFT_DATA *in, FFT_DATA *out, int flag, struct fft_plan_3d *plan)
+int fft_3d(FFT_DATA *in, FFT_DATA *out, int flag, struct fft_plan_3d *plan)
 {
-  int i,total,length,offset,num;
+  return fft_3d_batch(&in,&out,1,flag,plan);
+}
+
+/* ----------------------------------------------------------------------
+   Perform N 3d FFTs with the same plan at once
+
+   Arguments:
+   in           N starting addresses of input data on this proc
+   out          N starting addresses of where output data for this proc
+                  will be placed (each can be same as its in)
+   n            # of FFTs
+   flag         1 for forward FFT, -1 for inverse FFT
+   plan         plan returned by previous call to fft_3d_create_plan
+
+   the 1d FFTs are done for each field in turn, but each remap moves
+     all N fields with a single communication phase
+   for N = 1 this is the same as fft_3d()
+   return 1 if copy or remap buffers could not be allocated, else 0
+------------------------------------------------------------------------- */
+
+int fft_3d_batch(FFT_DATA **in, FFT_DATA **out, int n, int flag,
+                 struct fft_plan_3d *plan)
+{
+  int i,total,length,offset,num,ifield;
   FFT_SCALAR norm, *out_ptr;
-  FFT_DATA *data,*copy;
+  FFT_DATA *data;
+  FFT_DATA *datas[FFT_MAXBATCH],*copies[FFT_MAXBATCH];
 
   // system specific constants
 
@@ -91,243 +122,293 @@ void fft_3d(FFT_DATA *in, FFT_DATA *out, int flag, struct fft_plan_3d *plan)
   // nothing to do for other FFTs.
 #endif
 
+  // extra fields beyond the first need their own copy buffer
+
+  if (n > 1 && plan->copy_size && n > plan->nbatch) {
+    free(plan->batchcopy);
+    plan->batchcopy =
+      (FFT_DATA *) malloc((n-1)*plan->copy_size*sizeof(FFT_DATA));
+    if (plan->batchcopy == NULL) {
+      plan->nbatch = 0;
+      return 1;
+    }
+    plan->nbatch = n;
+  }
+
   // pre-remap to prepare for 1st FFTs if needed
   // copy = loc for remap result
 
   if (plan->pre_plan) {
-    if (plan->pre_target == 0) copy = out;
-    else copy = plan->copy;
-    remap_3d((FFT_SCALAR *) in, (FFT_SCALAR *) copy, (FFT_SCALAR *) plan->scratch,
-             plan->pre_plan);
-    data = copy;
+    fft_3d_targets(out,copies,n,plan->pre_target,plan);
+    if (fft_3d_remap(in,copies,n,plan->pre_plan,plan)) return 1;
+    for (ifield = 0; ifield < n; ifield++) datas[ifield] = copies[ifield];
   }
   else
-    data = in;
+    for (ifield = 0; ifield < n; ifield++) datas[ifield] = in[ifield];
 
   // 1d FFTs along fast axis
 
   total = plan->total1;
   length = plan->length1;
 
+  for (ifield = 0; ifield < n; ifield++) {
+    data = datas[ifield];
 #if defined(FFT_SGI)
-  for (offset = 0; offset < total; offset += length)
-    FFT_1D(flag,length,&data[offset],1,plan->coeff1);
+    for (offset = 0; offset < total; offset += length)
+      FFT_1D(flag,length,&data[offset],1,plan->coeff1);
 #elif defined(FFT_SCSL)
-  for (offset = 0; offset < total; offset += length)
-    FFT_1D(flag,length,scalef,&data[offset],&data[offset],plan->coeff1,
-           plan->work1,&isys);
+    for (offset = 0; offset < total; offset += length)
+      FFT_1D(flag,length,scalef,&data[offset],&data[offset],plan->coeff1,
+             plan->work1,&isys);
 #elif defined(FFT_ACML)
-  num=total/length;
-  FFT_1D(&flag,&num,&length,data,plan->coeff1,&info);
+    num=total/length;
+    FFT_1D(&flag,&num,&length,data,plan->coeff1,&info);
 #elif defined(FFT_INTEL)
-  for (offset = 0; offset < total; offset += length)
-    FFT_1D(&data[offset],&length,&flag,plan->coeff1);
+    for (offset = 0; offset < total; offset += length)
+      FFT_1D(&data[offset],&length,&flag,plan->coeff1);
 #elif defined(FFT_MKL)
-  if (flag == -1)
-    DftiComputeForward(plan->handle_fast,data);
-  else
-    DftiComputeBackward(plan->handle_fast,data);
+    if (flag == -1)
+      DftiComputeForward(plan->handle_fast,data);
+    else
+      DftiComputeBackward(plan->handle_fast,data);
 #elif defined(FFT_DEC)
-  if (flag == -1)
-    for (offset = 0; offset < total; offset += length)
-      FFT_1D(&c,&c,&f,&data[offset],&data[offset],&length,&one);
-  else
-    for (offset = 0; offset < total; offset += length)
-      FFT_1D(&c,&c,&b,&data[offset],&data[offset],&length,&one);
+    if (flag == -1)
+      for (offset = 0; offset < total; offset += length)
+        FFT_1D(&c,&c,&f,&data[offset],&data[offset],&length,&one);
+    else
+      for (offset = 0; offset < total; offset += length)
+        FFT_1D(&c,&c,&b,&data[offset],&data[offset],&length,&one);
 #elif defined(FFT_T3E)
-  for (offset = 0; offset < total; offset += length)
-    FFT_1D(&flag,&length,&scalef,&data[offset],&data[offset],plan->coeff1,
-           plan->work1,&isys);
+    for (offset = 0; offset < total; offset += length)
+      FFT_1D(&flag,&length,&scalef,&data[offset],&data[offset],plan->coeff1,
+             plan->work1,&isys);
 #elif defined(FFT_FFTW2)
-  if (flag == -1)
-    fftw(plan->plan_fast_forward,total/length,data,1,length,NULL,0,0);
-  else
-    fftw(plan->plan_fast_backward,total/length,data,1,length,NULL,0,0);
+    if (flag == -1)
+      fftw(plan->plan_fast_forward,total/length,data,1,length,NULL,0,0);
+    else
+      fftw(plan->plan_fast_backward,total/length,data,1,length,NULL,0,0);
 #elif defined(FFT_FFTW3)
-  if (flag == -1)
-    theplan=plan->plan_fast_forward;
-  else
-    theplan=plan->plan_fast_backward;
-  FFTW_API(execute_dft)(theplan,data,data);
+    if (flag == -1)
+      theplan=plan->plan_fast_forward;
+    else
+      theplan=plan->plan_fast_backward;
+    FFTW_API(execute_dft)(theplan,data,data);
 #else
-  if (flag == -1)
-    for (offset = 0; offset < total; offset += length)
-      kiss_fft(plan->cfg_fast_forward,&data[offset],&data[offset]);
-  else
-    for (offset = 0; offset < total; offset += length)
-      kiss_fft(plan->cfg_fast_backward,&data[offset],&data[offset]);
+    if (flag == -1)
+      for (offset = 0; offset < total; offset += length)
+        kiss_fft(plan->cfg_fast_forward,&data[offset],&data[offset]);
+    else
+      for (offset = 0; offset < total; offset += length)
+        kiss_fft(plan->cfg_fast_backward,&data[offset],&data[offset]);
 #endif
+  }
 
   // 1st mid-remap to prepare for 2nd FFTs
   // copy = loc for remap result
 
-  if (plan->mid1_target == 0) copy = out;
-  else copy = plan->copy;
-  remap_3d((FFT_SCALAR *) data, (FFT_SCALAR *) copy, (FFT_SCALAR *) plan->scratch,
-           plan->mid1_plan);
-  data = copy;
+  fft_3d_targets(out,copies,n,plan->mid1_target,plan);
+  if (fft_3d_remap(datas,copies,n,plan->mid1_plan,plan)) return 1;
+  for (ifield = 0; ifield < n; ifield++) datas[ifield] = copies[ifield];
 
   // 1d FFTs along mid axis
 
   total = plan->total2;
   length = plan->length2;
 
+  for (ifield = 0; ifield < n; ifield++) {
+    data = datas[ifield];
 #if defined(FFT_SGI)
-  for (offset = 0; offset < total; offset += length)
-    FFT_1D(flag,length,&data[offset],1,plan->coeff2);
+    for (offset = 0; offset < total; offset += length)
+      FFT_1D(flag,length,&data[offset],1,plan->coeff2);
 #elif defined(FFT_SCSL)
-  for (offset = 0; offset < total; offset += length)
-    FFT_1D(flag,length,scalef,&data[offset],&data[offset],plan->coeff2,
-           plan->work2,&isys);
+    for (offset = 0; offset < total; offset += length)
+      FFT_1D(flag,length,scalef,&data[offset],&data[offset],plan->coeff2,
+             plan->work2,&isys);
 #elif defined(FFT_ACML)
-  num=total/length;
-  FFT_1D(&flag,&num,&length,data,plan->coeff2,&info);
+    num=total/length;
+    FFT_1D(&flag,&num,&length,data,plan->coeff2,&info);
 #elif defined(FFT_INTEL)
-  for (offset = 0; offset < total; offset += length)
-    FFT_1D(&data[offset],&length,&flag,plan->coeff2);
+    for (offset = 0; offset < total; offset += length)
+      FFT_1D(&data[offset],&length,&flag,plan->coeff2);
 #elif defined(FFT_MKL)
-  if (flag == -1)
-    DftiComputeForward(plan->handle_mid,data);
-  else
-    DftiComputeBackward(plan->handle_mid,data);
+    if (flag == -1)
+      DftiComputeForward(plan->handle_mid,data);
+    else
+      DftiComputeBackward(plan->handle_mid,data);
 #elif defined(FFT_DEC)
-  if (flag == -1)
-    for (offset = 0; offset < total; offset += length)
-      FFT_1D(&c,&c,&f,&data[offset],&data[offset],&length,&one);
-  else
-    for (offset = 0; offset < total; offset += length)
-      FFT_1D(&c,&c,&b,&data[offset],&data[offset],&length,&one);
+    if (flag == -1)
+      for (offset = 0; offset < total; offset += length)
+        FFT_1D(&c,&c,&f,&data[offset],&data[offset],&length,&one);
+    else
+      for (offset = 0; offset < total; offset += length)
+        FFT_1D(&c,&c,&b,&data[offset],&data[offset],&length,&one);
 #elif defined(FFT_T3E)
-  for (offset = 0; offset < total; offset += length)
-    FFT_1D(&flag,&length,&scalef,&data[offset],&data[offset],plan->coeff2,
-           plan->work2,&isys);
+    for (offset = 0; offset < total; offset += length)
+      FFT_1D(&flag,&length,&scalef,&data[offset],&data[offset],plan->coeff2,
+             plan->work2,&isys);
 #elif defined(FFT_FFTW2)
-  if (flag == -1)
-    fftw(plan->plan_mid_forward,total/length,data,1,length,NULL,0,0);
-  else
-    fftw(plan->plan_mid_backward,total/length,data,1,length,NULL,0,0);
+    if (flag == -1)
+      fftw(plan->plan_mid_forward,total/length,data,1,length,NULL,0,0);
+    else
+      fftw(plan->plan_mid_backward,total/length,data,1,length,NULL,0,0);
 #elif defined(FFT_FFTW3)
-  if (flag == -1)
-    theplan=plan->plan_mid_forward;
-  else
-    theplan=plan->plan_mid_backward;
-  FFTW_API(execute_dft)(theplan,data,data);
+    if (flag == -1)
+      theplan=plan->plan_mid_forward;
+    else
+      theplan=plan->plan_mid_backward;
+    FFTW_API(execute_dft)(theplan,data,data);
 #else
-  if (flag == -1)
-    for (offset = 0; offset < total; offset += length)
-      kiss_fft(plan->cfg_mid_forward,&data[offset],&data[offset]);
-  else
-    for (offset = 0; offset < total; offset += length)
-      kiss_fft(plan->cfg_mid_backward,&data[offset],&data[offset]);
+    if (flag == -1)
+      for (offset = 0; offset < total; offset += length)
+        kiss_fft(plan->cfg_mid_forward,&data[offset],&data[offset]);
+    else
+      for (offset = 0; offset < total; offset += length)
+        kiss_fft(plan->cfg_mid_backward,&data[offset],&data[offset]);
 #endif
+  }
 
   // 2nd mid-remap to prepare for 3rd FFTs
   // copy = loc for remap result
 
-  if (plan->mid2_target == 0) copy = out;
-  else copy = plan->copy;
-  remap_3d((FFT_SCALAR *) data, (FFT_SCALAR *) copy, (FFT_SCALAR *) plan->scratch,
-           plan->mid2_plan);
-  data = copy;
+  fft_3d_targets(out,copies,n,plan->mid2_target,plan);
+  if (fft_3d_remap(datas,copies,n,plan->mid2_plan,plan)) return 1;
+  for (ifield = 0; ifield < n; ifield++) datas[ifield] = copies[ifield];
 
   // 1d FFTs along slow axis
 
   total = plan->total3;
   length = plan->length3;
 
+  for (ifield = 0; ifield < n; ifield++) {
+    data = datas[ifield];
 #if defined(FFT_SGI)
-  for (offset = 0; offset < total; offset += length)
-    FFT_1D(flag,length,&data[offset],1,plan->coeff3);
+    for (offset = 0; offset < total; offset += length)
+      FFT_1D(flag,length,&data[offset],1,plan->coeff3);
 #elif defined(FFT_SCSL)
-  for (offset = 0; offset < total; offset += length)
-    FFT_1D(flag,length,scalef,&data[offset],&data[offset],plan->coeff3,
-           plan->work3,&isys);
+    for (offset = 0; offset < total; offset += length)
+      FFT_1D(flag,length,scalef,&data[offset],&data[offset],plan->coeff3,
+             plan->work3,&isys);
 #elif defined(FFT_ACML)
-  num=total/length;
-  FFT_1D(&flag,&num,&length,data,plan->coeff3,&info);
+    num=total/length;
+    FFT_1D(&flag,&num,&length,data,plan->coeff3,&info);
 #elif defined(FFT_INTEL)
-  for (offset = 0; offset < total; offset += length)
-    FFT_1D(&data[offset],&length,&flag,plan->coeff3);
+    for (offset = 0; offset < total; offset += length)
+      FFT_1D(&data[offset],&length,&flag,plan->coeff3);
 #elif defined(FFT_MKL)
-  if (flag == -1)
-    DftiComputeForward(plan->handle_slow,data);
-  else
-    DftiComputeBackward(plan->handle_slow,data);
+    if (flag == -1)
+      DftiComputeForward(plan->handle_slow,data);
+    else
+      DftiComputeBackward(plan->handle_slow,data);
 #elif defined(FFT_DEC)
-  if (flag == -1)
-    for (offset = 0; offset < total; offset += length)
-      FFT_1D(&c,&c,&f,&data[offset],&data[offset],&length,&one);
-  else
-    for (offset = 0; offset < total; offset += length)
-      FFT_1D(&c,&c,&b,&data[offset],&data[offset],&length,&one);
+    if (flag == -1)
+      for (offset = 0; offset < total; offset += length)
+        FFT_1D(&c,&c,&f,&data[offset],&data[offset],&length,&one);
+    else
+      for (offset = 0; offset < total; offset += length)
+        FFT_1D(&c,&c,&b,&data[offset],&data[offset],&length,&one);
 #elif defined(FFT_T3E)
-  for (offset = 0; offset < total; offset += length)
-    FFT_1D(&flag,&length,&scalef,&data[offset],&data[offset],plan->coeff3,
-           plan->work3,&isys);
+    for (offset = 0; offset < total; offset += length)
+      FFT_1D(&flag,&length,&scalef,&data[offset],&data[offset],plan->coeff3,
+             plan->work3,&isys);
 #elif defined(FFT_FFTW2)
-  if (flag == -1)
-    fftw(plan->plan_slow_forward,total/length,data,1,length,NULL,0,0);
-  else
-    fftw(plan->plan_slow_backward,total/length,data,1,length,NULL,0,0);
+    if (flag == -1)
+      fftw(plan->plan_slow_forward,total/length,data,1,length,NULL,0,0);
+    else
+      fftw(plan->plan_slow_backward,total/length,data,1,length,NULL,0,0);
 #elif defined(FFT_FFTW3)
-  if (flag == -1)
-    theplan=plan->plan_slow_forward;
-  else
-    theplan=plan->plan_slow_backward;
-  FFTW_API(execute_dft)(theplan,data,data);
+    if (flag == -1)
+      theplan=plan->plan_slow_forward;
+    else
+      theplan=plan->plan_slow_backward;
+    FFTW_API(execute_dft)(theplan,data,data);
 #else
-  if (flag == -1)
-    for (offset = 0; offset < total; offset += length)
-      kiss_fft(plan->cfg_slow_forward,&data[offset],&data[offset]);
-  else
-    for (offset = 0; offset < total; offset += length)
-      kiss_fft(plan->cfg_slow_backward,&data[offset],&data[offset]);
+    if (flag == -1)
+      for (offset = 0; offset < total; offset += length)
+        kiss_fft(plan->cfg_slow_forward,&data[offset],&data[offset]);
+    else
+      for (offset = 0; offset < total; offset += length)
+        kiss_fft(plan->cfg_slow_backward,&data[offset],&data[offset]);
 #endif
+  }
 
   // post-remap to put data in output format if needed
   // destination is always out
 
   if (plan->post_plan)
-    remap_3d((FFT_SCALAR *) data, (FFT_SCALAR *) out, (FFT_SCALAR *) plan->scratch,
-             plan->post_plan);
+    if (fft_3d_remap(datas,out,n,plan->post_plan,plan)) return 1;
 
   // scaling if required
+
+  for (ifield = 0; ifield < n; ifield++) {
+    data = out[ifield];
 #if !defined(FFT_T3E) && !defined(FFT_ACML)
-  if (flag == 1 && plan->scaled) {
-    norm = plan->norm;
-    num = plan->normnum;
-    out_ptr = (FFT_SCALAR *)out;
-    for (i = 0; i < num; i++) {
+    if (flag == 1 && plan->scaled) {
+      norm = plan->norm;
+      num = plan->normnum;
+      out_ptr = (FFT_SCALAR *)data;
+      for (i = 0; i < num; i++) {
 #if defined(FFT_FFTW3)
-      *(out_ptr++) *= norm;
-      *(out_ptr++) *= norm;
+        *(out_ptr++) *= norm;
+        *(out_ptr++) *= norm;
 #elif defined(FFT_MKL)
-      out[i] *= norm;
+        data[i] *= norm;
 #else
-      out[i].re *= norm;
-      out[i].im *= norm;
+        data[i].re *= norm;
+        data[i].im *= norm;
 #endif
+      }
     }
-  }
 #endif
 
 #ifdef FFT_T3E
-  if (flag == 1 && plan->scaled) {
+    if (flag == 1 && plan->scaled) {
+      norm = plan->norm;
+      num = plan->normnum;
+      for (i = 0; i < num; i++) data[i] *= (norm,norm);
+    }
+#endif
+
+#ifdef FFT_ACML
     norm = plan->norm;
     num = plan->normnum;
-    for (i = 0; i < num; i++) out[i] *= (norm,norm);
-  }
+    for (i = 0; i < num; i++) {
+      data[i].re *= norm;
+      data[i].im *= norm;
+    }
 #endif
+  }
 
-#ifdef FFT_ACML
-  norm = plan->norm;
-  num = plan->normnum;
-  for (i = 0; i < num; i++) {
-    out[i].re *= norm;
-    out[i].im *= norm;
+  return 0;
+}
+
+/* ----------------------------------------------------------------------
+   set destination of a remap for each of N fields
+   target = 0 for out, else the plan copy buffer for that field
+------------------------------------------------------------------------- */
+
+static void fft_3d_targets(FFT_DATA **out, FFT_DATA **copies, int n,
+                           int target, struct fft_plan_3d *plan)
+{
+  for (int ifield = 0; ifield < n; ifield++) {
+    if (target == 0) copies[ifield] = out[ifield];
+    else if (ifield == 0) copies[ifield] = plan->copy;
+    else copies[ifield] = &plan->batchcopy[(ifield-1)*plan->copy_size];
   }
-#endif
+}
+
+/* ----------------------------------------------------------------------
+   remap N fields, a single field uses the plan scratch buffer
+   return 1 if remap buffers could not be allocated, else 0
+------------------------------------------------------------------------- */
 
+static int fft_3d_remap(FFT_DATA **in, FFT_DATA **out, int n,
+                        struct remap_plan_3d *remap_plan,
+                        struct fft_plan_3d *plan)
+{
+  if (n == 1)
+    return remap_3d((FFT_SCALAR *) in[0],(FFT_SCALAR *) out[0],
+                    (FFT_SCALAR *) plan->scratch,remap_plan);
+  return remap_3d_batch((FFT_SCALAR **) in,(FFT_SCALAR **) out,n,remap_plan);
 }
 
 /* ----------------------------------------------------------------------
@@ -586,6 +667,10 @@ struct fft_plan_3d *fft_3d_create_plan(
 
   *nbuf = copy_size + scratch_size;
 
+  plan->copy_size = copy_size;
+  plan->nbatch = 0;
+  plan->batchcopy = NULL;
+
   if (copy_size) {
     plan->copy = (FFT_DATA *) malloc(copy_size*sizeof(FFT_DATA));
     if (plan->copy == NULL) return NULL;
@@ -940,6 +1025,7 @@ void fft_3d_destroy_plan(struct fft_plan_3d *plan)
 
   if (plan->copy) free(plan->copy);
   if (plan->scratch) free(plan->scratch);
+  if (plan->batchcopy) free(plan->batchcopy);
 
 #if defined(FFT_SGI)
   free(plan->coeff1);
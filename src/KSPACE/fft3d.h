@@ -240,6 +240,10 @@ typedef struct kiss_fft_state* kiss_fft_cfg;
 
 // -------------------------------------------------------------------------
 
+// max # of fields transformed together by fft_3d_batch()
+
+#define FFT_MAXBATCH 8
+
 // details of how to do a 3d FFT
 
 struct fft_plan_3d {
@@ -249,6 +253,9 @@ struct fft_plan_3d {
   struct remap_plan_3d *post_plan;      // remap from 3rd FFTs -> output
   FFT_DATA *copy;                   // memory for remap results (if needed)
   FFT_DATA *scratch;                // scratch space for remaps
+  int copy_size;                    // size of copy buffer
+  int nbatch;                       // # of fields batchcopy is sized for
+  FFT_DATA *batchcopy;              // copy buffers for extra batched fields
   int total1,total2,total3;         // # of 1st,2nd,3rd FFTs (times length)
   int length1,length2,length3;      // length of 1st,2nd,3rd FFTs
   int pre_target;                   // where to put remap results
@@ -315,7 +322,8 @@ struct fft_plan_3d {
 // function prototypes
 
 extern "C" { 
-  void fft_3d(FFT_DATA *, FFT_DATA *, int, struct fft_plan_3d *);
+  int fft_3d(FFT_DATA *, FFT_DATA *, int, struct fft_plan_3d *);
+  int fft_3d_batch(FFT_DATA **, FFT_DATA **, int, int, struct fft_plan_3d *);
   struct fft_plan_3d *fft_3d_create_plan(MPI_Comm, int, int, int,
                                          int, int, int, int, int, 
                                          int, int, int, int, int, int, int,
@@ -44,7 +44,19 @@ FFT3d::~FFT3d()
 
 void FFT3d::compute(FFT_SCALAR *in, FFT_SCALAR *out, int flag)
 {
-  fft_3d((FFT_DATA *) in,(FFT_DATA *) out,flag,plan);
+  if (fft_3d((FFT_DATA *) in,(FFT_DATA *) out,flag,plan))
+    error->one(FLERR,"Could not allocate 3d FFT remap buffers");
+}
+
+/* ----------------------------------------------------------------------
+   perform N FFTs at once, sharing the communication of each remap
+------------------------------------------------------------------------- */
+
+void FFT3d::compute_batch(FFT_SCALAR **in, FFT_SCALAR **out, int n, int flag)
+{
+  if (n > FFT_MAXBATCH) error->one(FLERR,"Too many fields for batched 3d FFT");
+  if (fft_3d_batch((FFT_DATA **) in,(FFT_DATA **) out,n,flag,plan))
+    error->one(FLERR,"Could not allocate 3d FFT remap buffers");
 }
 
 /* ---------------------------------------------------------------------- */
@@ -25,6 +25,7 @@ class FFT3d : protected Pointers {
         int,int,int,int,int,int,int,int,int *,int);
   ~FFT3d();
   void compute(FFT_SCALAR *, FFT_SCALAR *, int);
+  void compute_batch(FFT_SCALAR **, FFT_SCALAR **, int, int);
   void timing1d(FFT_SCALAR *, int, int);
 
  private:
@@ -43,4 +44,15 @@ The FFT setup for the PPPM solver failed, typically due
 to lack of memory.  This is an unusual error.  Check the
 size of the FFT grid you are requesting.
 
+E: Could not allocate 3d FFT remap buffers
+
+The buffers or the collective communication setup for the data remaps
+of a 3d FFT could not be allocated, typically due to lack of memory.
+Check the size of the FFT grid you are requesting.
+
+E: Too many fields for batched 3d FFT
+
+More fields were passed to a batched FFT than it supports.  This
+is an internal error.
+
 */
@@ -67,6 +67,8 @@ GridComm::GridComm(LAMMPS *lmp, MPI_Comm gcomm, int forward, int reverse,
   nswap = 0;
   swap = NULL;
   buf1 = buf2 = NULL;
+  single = 0;
+  fbuf1 = fbuf2 = NULL;
 }
 
 /* ---------------------------------------------------------------------- */
@@ -116,6 +118,8 @@ GridComm::GridComm(LAMMPS *lmp, MPI_Comm gcomm, int forward, int reverse,
   nswap = 0;
   swap = NULL;
   buf1 = buf2 = NULL;
+  single = 0;
+  fbuf1 = fbuf2 = NULL;
 }
 
 /* ---------------------------------------------------------------------- */
@@ -130,6 +134,8 @@ GridComm::~GridComm()
 
   memory->destroy(buf1);
   memory->destroy(buf2);
+  memory->destroy(fbuf1);
+  memory->destroy(fbuf2);
 }
 
 /* ----------------------------------------------------------------------
@@ -481,6 +487,14 @@ void GridComm::setup()
   nbuf *= MAX(nforward,nreverse);
   memory->create(buf1,nbuf,"Commgrid:buf1");
   memory->create(buf2,nbuf,"Commgrid:buf2");
+
+  // single precision buffers, not needed if FFT_SCALAR is already float
+
+  if (sizeof(FFT_SCALAR) == sizeof(float)) single = 0;
+  if (single) {
+    memory->create(fbuf1,nbuf,"Commgrid:fbuf1");
+    memory->create(fbuf2,nbuf,"Commgrid:fbuf2");
+  }
 }
 
 /* ----------------------------------------------------------------------
@@ -495,13 +509,9 @@ void GridComm::forward_comm(KSpace *kspace, int which)
     else
       kspace->pack_forward(which,buf1,swap[m].npack,swap[m].packlist);
 
-    if (swap[m].sendproc != me) {
-      MPI_Irecv(buf2,nforward*swap[m].nunpack,MPI_FFT_SCALAR,
-                swap[m].recvproc,0,gridcomm,&request);
-      MPI_Send(buf1,nforward*swap[m].npack,MPI_FFT_SCALAR,
-               swap[m].sendproc,0,gridcomm);
-      MPI_Wait(&request,MPI_STATUS_IGNORE);
-    }
+    if (swap[m].sendproc != me)
+      exchange(nforward*swap[m].npack,swap[m].sendproc,
+               nforward*swap[m].nunpack,swap[m].recvproc);
     
     kspace->unpack_forward(which,buf2,swap[m].nunpack,swap[m].unpacklist);
   }
@@ -520,18 +530,37 @@ void GridComm::reverse_comm(KSpace *kspace, int which)
     else
       kspace->pack_reverse(which,buf1,swap[m].nunpack,swap[m].unpacklist);
 
-    if (swap[m].recvproc != me) {
-      MPI_Irecv(buf2,nreverse*swap[m].npack,MPI_FFT_SCALAR,
-                swap[m].sendproc,0,gridcomm,&request);
-      MPI_Send(buf1,nreverse*swap[m].nunpack,MPI_FFT_SCALAR,
-               swap[m].recvproc,0,gridcomm);
-      MPI_Wait(&request,MPI_STATUS_IGNORE);
-    }
+    if (swap[m].recvproc != me)
+      exchange(nreverse*swap[m].nunpack,swap[m].recvproc,
+               nreverse*swap[m].npack,swap[m].sendproc);
     
     kspace->unpack_reverse(which,buf2,swap[m].npack,swap[m].packlist);
   }
 }
 
+/* ----------------------------------------------------------------------
+   send Nsend values in buf1 to Sendproc, recv Nrecv values into buf2
+   if single is set, values are rounded to single precision for the message,
+     which halves the message size, then converted back to FFT_SCALAR
+------------------------------------------------------------------------- */
+
+void GridComm::exchange(int nsend, int sendproc, int nrecv, int recvproc)
+{
+  if (!single) {
+    MPI_Irecv(buf2,nrecv,MPI_FFT_SCALAR,recvproc,0,gridcomm,&request);
+    MPI_Send(buf1,nsend,MPI_FFT_SCALAR,sendproc,0,gridcomm);
+    MPI_Wait(&request,MPI_STATUS_IGNORE);
+    return;
+  }
+
+  int i;
+  for (i = 0; i < nsend; i++) fbuf1[i] = buf1[i];
+  MPI_Irecv(fbuf2,nrecv,MPI_FLOAT,recvproc,0,gridcomm,&request);
+  MPI_Send(fbuf1,nsend,MPI_FLOAT,sendproc,0,gridcomm);
+  MPI_Wait(&request,MPI_STATUS_IGNORE);
+  for (i = 0; i < nrecv; i++) buf2[i] = fbuf2[i];
+}
+
 /* ----------------------------------------------------------------------
    create 1d list of offsets into 3d array section (xlo:xhi,ylo:yhi,zlo:zhi)
    assume 3d array is allocated as (outxlo_max:outxhi_max,outylo_max:outyhi_max,
@@ -564,5 +593,6 @@ int GridComm::indices(int *&list,
 double GridComm::memory_usage()
 {
   double bytes = 2*nbuf * sizeof(double);
+  if (single) bytes += 2*nbuf * sizeof(float);
   return bytes;
 }
@@ -28,6 +28,8 @@ namespace LAMMPS_NS {
 
 class GridComm : protected Pointers {
  public:
+  int single;          // 1 if ghost values are sent in single precision
+
   GridComm(class LAMMPS *, MPI_Comm, int, int,
            int, int, int, int, int, int,
            int, int, int, int, int, int,
@@ -65,6 +67,7 @@ class GridComm : protected Pointers {
 
   int nbuf;
   FFT_SCALAR *buf1,*buf2;
+  float *fbuf1,*fbuf2;      // single precision copies of buf1,buf2
 
   struct Swap {
     int sendproc;       // proc to send to for forward comm
@@ -78,6 +81,7 @@ class GridComm : protected Pointers {
   int nswap;
   Swap *swap;
 
+  void exchange(int, int, int, int);
   int indices(int *&, int, int, int, int, int, int);
 };
 
@@ -145,6 +145,7 @@ void MSM::init()
   // error check
 
   triclinic_check();
+  mixed_check();
   if (domain->dimension == 2)
     error->all(FLERR,"Cannot (yet) use MSM with 2d simulation");
   if (comm->style != 0) 
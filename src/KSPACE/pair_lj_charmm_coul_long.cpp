@@ -48,6 +48,7 @@ using namespace LAMMPS_NS;
 PairLJCharmmCoulLong::PairLJCharmmCoulLong(LAMMPS *lmp) : Pair(lmp)
 {
   respa_enable = 1;
+  overlap_enable = 1;
   ewaldflag = pppmflag = 1;
   ftable = NULL;
   implicit = 0;
@@ -42,6 +42,7 @@ PairLJCharmmCoulMSM::PairLJCharmmCoulMSM(LAMMPS *lmp) :
 {
   ewaldflag = pppmflag = 0;
   msmflag = 1;
+  overlap_enable = 0;
   nmax = 0;
   ftmp = NULL;
 }
@@ -53,6 +53,7 @@ PairLJCutTIP4PLong::PairLJCutTIP4PLong(LAMMPS *lmp) :
 {
   tip4pflag = 1;
   ewaldflag = pppmflag = 1;  // for clarity, though inherited from parent class
+  overlap_enable = 0;        // M-site positions require ghost coords
 
   single_enable = 0;
   respa_enable = 0;
@@ -23,6 +23,7 @@
 #include "stdio.h"
 #include "stdlib.h"
 #include "math.h"
+#include "float.h"
 #include "pppm.h"
 #include "atom.h"
 #include "comm.h"
@@ -35,6 +36,7 @@
 #include "domain.h"
 #include "fft3d_wrap.h"
 #include "remap_wrap.h"
+#include "timer.h"
 #include "memory.h"
 #include "error.h"
 
@@ -70,6 +72,9 @@ PPPM::PPPM(LAMMPS *lmp, int narg, char **arg) : KSpace(lmp, narg, arg)
  
   pppmflag = 1;
   group_group_enable = 1;
+  mixed_support = 1;
+
+  t_map = t_rho = t_gridcomm = t_remap = t_poisson = t_field = -1;
 
   accuracy_relative = fabs(force->numeric(FLERR,arg[0]));
 
@@ -88,6 +93,7 @@ PPPM::PPPM(LAMMPS *lmp, int narg, char **arg) : KSpace(lmp, narg, arg)
   v0_brick = v1_brick = v2_brick = v3_brick = v4_brick = v5_brick = NULL;
   greensfn = NULL;
   work1 = work2 = NULL;
+  work3 = work4 = NULL;
   vg = NULL;
   fkx = fky = fkz = NULL;
 
@@ -174,6 +180,7 @@ void PPPM::init()
   // error check
 
   triclinic_check();
+  mixed_check();
   if (domain->triclinic && differentiation_flag == 1)
     error->all(FLERR,"Cannot (yet) use PPPM with triclinic box "
                "and kspace_modify diff ad");
@@ -332,6 +339,8 @@ void PPPM::init()
 #else
     const char fft_prec[] = "double";
 #endif
+    const char *comm_prec = fft_prec;
+    if (mixed_flag) comm_prec = "single";
 
     if (screen) {
       fprintf(screen,"  G vector (1/distance) = %g\n",g_ewald);
@@ -342,6 +351,7 @@ void PPPM::init()
       fprintf(screen,"  estimated relative force accuracy = %g\n",
               estimated_accuracy/two_charge_force);
       fprintf(screen,"  using %s precision FFTs\n",fft_prec);
+      fprintf(screen,"  using %s precision grid communication\n",comm_prec);
       fprintf(screen,"  3d grid and FFT values/proc = %d %d\n",
               ngrid_max,nfft_both_max);
     }
@@ -354,6 +364,7 @@ void PPPM::init()
       fprintf(logfile,"  estimated relative force accuracy = %g\n",
               estimated_accuracy/two_charge_force);
       fprintf(logfile,"  using %s precision FFTs\n",fft_prec);
+      fprintf(logfile,"  using %s precision grid communication\n",comm_prec);
       fprintf(logfile,"  3d grid and FFT values/proc = %d %d\n",
               ngrid_max,nfft_both_max);
     }
@@ -366,12 +377,31 @@ void PPPM::init()
   cg->ghost_notify();
   cg->setup();
 
+  // warn if single precision grid comm is a significant part of error
+
+  if (mixed_flag && me == 0) {
+    double df_mixed = compute_df_mixed();
+    if (df_mixed > 0.1*accuracy)
+      error->warning(FLERR,"PPPM single precision grid communication "
+                     "error is a significant part of requested accuracy");
+  }
+
   // pre-compute Green's function denomiator expansion
   // pre-compute 1d charge distribution coefficients
 
   compute_gf_denom();
   if (differentiation_flag == 1) compute_sf_precoeff();
   compute_rho_coeff();
+
+  // register a detailed timer for each stage of compute()
+
+  int parent = timer->add(force->kspace_style,timer->add("Kspace"));
+  t_map = timer->add("particle_map",parent);
+  t_rho = timer->add("make_rho",parent);
+  t_gridcomm = timer->add("grid comm",parent);
+  t_remap = timer->add("brick2fft",parent);
+  t_poisson = timer->add("poisson",parent);
+  t_field = timer->add("fieldforce",parent);
 }
 
 /* ----------------------------------------------------------------------
@@ -626,28 +656,40 @@ void PPPM::compute(int eflag, int vflag)
   // find grid points for all my particles
   // map my particle charge onto my local 3d density grid
 
+  timer->sub_start(t_map);
   particle_map();
+  timer->sub_stop(t_map);
+  timer->sub_start(t_rho);
   make_rho();
+  timer->sub_stop(t_rho);
 
   // all procs communicate density values from their ghost cells
   //   to fully sum contribution in their 3d bricks
   // remap from 3d decomposition to FFT decomposition
 
+  timer->sub_start(t_gridcomm);
   cg->reverse_comm(this,REVERSE_RHO);
+  timer->sub_stop(t_gridcomm);
+  timer->sub_start(t_remap);
   brick2fft();
+  timer->sub_stop(t_remap);
 
   // compute potential gradient on my FFT grid and
   //   portion of e_long on this proc's FFT grid
   // return gradients (electric fields) in 3d brick decomposition
   // also performs per-atom calculations via poisson_peratom()
 
+  timer->sub_start(t_poisson);
   poisson();
+  timer->sub_stop(t_poisson);
 
   // all procs communicate E-field values
   // to fill ghost cells surrounding their 3d bricks
 
+  timer->sub_start(t_gridcomm);
   if (differentiation_flag == 1) cg->forward_comm(this,FORWARD_AD);
   else cg->forward_comm(this,FORWARD_IK);
+  timer->sub_stop(t_gridcomm);
 
   // extra per-atom energy/virial communication
 
@@ -660,7 +702,9 @@ void PPPM::compute(int eflag, int vflag)
 
   // calculate the force on my particles
 
+  timer->sub_start(t_field);
   fieldforce();
+  timer->sub_stop(t_field);
 
   // extra per-atom energy/virial communication
 
@@ -748,6 +792,11 @@ void PPPM::allocate()
   memory->create(work2,2*nfft_both,"pppm:work2");
   memory->create(vg,nfft_both,6,"pppm:vg");
 
+  if (fftbatch_flag && differentiation_flag == 0 && triclinic == 0) {
+    memory->create(work3,2*nfft_both,"pppm:work3");
+    memory->create(work4,2*nfft_both,"pppm:work4");
+  }
+
   if (triclinic == 0) {
     memory->create1d_offset(fkx,nxlo_fft,nxhi_fft,"pppm:fkx");
     memory->create1d_offset(fky,nylo_fft,nyhi_fft,"pppm:fky");
@@ -826,6 +875,10 @@ void PPPM::allocate()
                       nxlo_out,nxhi_out,nylo_out,nyhi_out,nzlo_out,nzhi_out,
                       procneigh[0][0],procneigh[0][1],procneigh[1][0],
                       procneigh[1][1],procneigh[2][0],procneigh[2][1]);
+
+  // optionally send ghost grid values in single precision
+
+  cg->single = mixed_flag;
 }
 
 /* ----------------------------------------------------------------------
@@ -854,6 +907,9 @@ void PPPM::deallocate()
   memory->destroy(greensfn);
   memory->destroy(work1);
   memory->destroy(work2);
+  memory->destroy(work3);
+  memory->destroy(work4);
+  work3 = work4 = NULL;
   memory->destroy(vg);
 
   if (triclinic == 0) {
@@ -923,6 +979,8 @@ void PPPM::allocate_peratom()
                    nxlo_out,nxhi_out,nylo_out,nyhi_out,nzlo_out,nzhi_out,
                    procneigh[0][0],procneigh[0][1],procneigh[1][0],
                    procneigh[1][1],procneigh[2][0],procneigh[2][1]);
+
+  cg_peratom->single = mixed_flag;
 }
 
 /* ----------------------------------------------------------------------
@@ -1319,12 +1377,32 @@ double PPPM::final_accuracy()
   double q2_over_sqrt = q2 / sqrt(natoms*cutoff*xprd*yprd*zprd);
   double df_rspace = 2.0 * q2_over_sqrt * exp(-g_ewald*g_ewald*cutoff*cutoff);
   double df_table = estimate_table_accuracy(q2_over_sqrt,df_rspace);
+  double df_mixed = compute_df_mixed();
   double estimated_accuracy = sqrt(df_kspace*df_kspace + df_rspace*df_rspace +
-                                   df_table*df_table);
+                                   df_table*df_table + df_mixed*df_mixed);
 
   return estimated_accuracy;
 }
 
+/* ----------------------------------------------------------------------
+   estimate force error from sending ghost grid values in single precision
+   rho and E-field ghost values are each rounded once per timestep
+   each rounding has a relative error of at most half the float epsilon
+   scaled by a typical K-space force between two average charges
+     at a distance of 1/g_ewald
+   return 0.0 if grid comm is done in full precision
+------------------------------------------------------------------------- */
+
+double PPPM::compute_df_mixed()
+{
+  if (!mixed_flag || sizeof(FFT_SCALAR) == sizeof(float)) return 0.0;
+
+  bigint natoms = atom->natoms;
+  if (natoms == 0) return 0.0;
+  double fkspace = q2/natoms * g_ewald*g_ewald;
+  return sqrt(2.0) * 0.5*FLT_EPSILON * fkspace;
+}
+
 /* ----------------------------------------------------------------------
    set local subset of PPPM/FFT grid that I own
    n xyz lo/hi in = 3d brick that I own (inclusive)
@@ -2053,6 +2131,13 @@ void PPPM::poisson_ik()
     return;
   }
 
+  // all 3 gradients at once, sharing the communication of each remap
+
+  if (work3) {
+    poisson_ik_batch();
+    return;
+  }
+
   // compute gradients of V(r) in each of 3 dims by transformimg -ik*V(k)
   // FFT leaves data in 3d brick decomposition
   // copy it into inner portion of vdx,vdy,vdz arrays
@@ -2121,6 +2206,42 @@ void PPPM::poisson_ik()
       }
 }
 
+/* ----------------------------------------------------------------------
+   gradients of V(r) for ik with the 3 backward FFTs batched together
+   each remap of the FFT then exchanges x,y,z data in one message per proc
+------------------------------------------------------------------------- */
+
+void PPPM::poisson_ik_batch()
+{
+  int i,j,k,n;
+
+  n = 0;
+  for (k = nzlo_fft; k <= nzhi_fft; k++)
+    for (j = nylo_fft; j <= nyhi_fft; j++)
+      for (i = nxlo_fft; i <= nxhi_fft; i++) {
+        work2[n] = fkx[i]*work1[n+1];
+        work2[n+1] = -fkx[i]*work1[n];
+        work3[n] = fky[j]*work1[n+1];
+        work3[n+1] = -fky[j]*work1[n];
+        work4[n] = fkz[k]*work1[n+1];
+        work4[n+1] = -fkz[k]*work1[n];
+        n += 2;
+      }
+
+  FFT_SCALAR *fields[3] = {work2,work3,work4};
+  fft2->compute_batch(fields,fields,3,-1);
+
+  n = 0;
+  for (k = nzlo_in; k <= nzhi_in; k++)
+    for (j = nylo_in; j <= nyhi_in; j++)
+      for (i = nxlo_in; i <= nxhi_in; i++) {
+        vdx_brick[k][j][i] = work2[n];
+        vdy_brick[k][j][i] = work3[n];
+        vdz_brick[k][j][i] = work4[n];
+        n += 2;
+      }
+}
+
 /* ----------------------------------------------------------------------
    FFT-based Poisson solver for ik for a triclinic system
 ------------------------------------------------------------------------- */
@@ -3055,6 +3176,7 @@ double PPPM::memory_usage()
   bytes += 6 * nfft_both * sizeof(double);
   bytes += nfft_both * sizeof(double);
   bytes += nfft_both*5 * sizeof(FFT_SCALAR);
+  if (work3) bytes += 4 * nfft_both * sizeof(FFT_SCALAR);
 
   if (peratom_allocate_flag)
     bytes += 6 * nbrick * sizeof(FFT_SCALAR);
@@ -59,6 +59,7 @@ class PPPM : public KSpace {
   double h_x,h_y,h_z;
   double shift,shiftone;
   int peratom_allocate_flag;
+  int t_map,t_rho,t_gridcomm,t_remap,t_poisson,t_field;  // stage timers
 
   int nxlo_in,nylo_in,nzlo_in,nxhi_in,nyhi_in,nzhi_in;
   int nxlo_out,nylo_out,nzlo_out,nxhi_out,nyhi_out,nzhi_out;
@@ -77,6 +78,7 @@ class PPPM : public KSpace {
   double *fkx,*fky,*fkz;
   FFT_SCALAR *density_fft;
   FFT_SCALAR *work1,*work2;
+  FFT_SCALAR *work3,*work4;    // extra fields for batched ik FFTs
 
   double *gf_b;
   FFT_SCALAR **rho1d,**rho_coeff,**drho1d,**drho_coeff;
@@ -118,6 +120,7 @@ class PPPM : public KSpace {
   virtual void deallocate_peratom();
   int factorable(int);
   double compute_df_kspace();
+  double compute_df_mixed();
   double estimate_ik_error(double, double, bigint);
   virtual double compute_qopt();
   virtual void compute_gf_denom();
@@ -160,6 +163,7 @@ class PPPM : public KSpace {
   void setup_triclinic();
   void compute_gf_ik_triclinic();
   void poisson_ik_triclinic();
+  void poisson_ik_batch();
   void poisson_groups_triclinic();
 
   // group-group interactions
@@ -332,4 +336,10 @@ E: Cannot (yet) use kspace_modify diff ad with compute group/group
 
 This option is not yet supported.
 
+W: PPPM single precision grid communication error is a significant part of requested accuracy
+
+The estimated force error from sending ghost grid values in single
+precision, as requested by kspace_modify mixed yes, is more than 10%
+of the requested accuracy.  Consider turning this option off.
+
 */
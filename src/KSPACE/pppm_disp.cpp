@@ -210,6 +210,7 @@ void PPPMDisp::init()
   }
 
   triclinic_check();
+  mixed_check();
   if (domain->dimension == 2)
     error->all(FLERR,"Cannot use PPPMDisp with 2d simulation");
   if (comm->style != 0) 
@@ -22,6 +22,17 @@
 #define MIN(A,B) ((A) < (B) ? (A) : (B))
 #define MAX(A,B) ((A) > (B) ? (A) : (B))
 
+// MPI-3 libraries provide a nonblocking all-to-all, which lets the
+// self data of a collective remap be copied while the exchange is in flight
+
+#if defined(MPI_VERSION) && (MPI_VERSION >= 3)
+#define REMAP_IALLTOALLV
+#endif
+
+static int remap_3d_collective(FFT_SCALAR **, FFT_SCALAR **, int,
+                               struct remap_plan_3d *);
+static int remap_3d_collective_setup(struct remap_plan_3d *, int);
+
 /* ----------------------------------------------------------------------
    Data layout for 3d remaps:
 
@@ -57,10 +68,12 @@
                 if memory=1 was used in call to remap_3d_create_plan
                   then buf is not used, can just be a dummy pointer
    plan         plan returned by previous call to remap_3d_create_plan
+
+   return 1 if buffers for a collective remap could not be allocated, else 0
 ------------------------------------------------------------------------- */
 
-void remap_3d(FFT_SCALAR *in, FFT_SCALAR *out, FFT_SCALAR *buf,
-              struct remap_plan_3d *plan)
+int remap_3d(FFT_SCALAR *in, FFT_SCALAR *out, FFT_SCALAR *buf,
+             struct remap_plan_3d *plan)
 {
   // use point-to-point communication
 
@@ -111,96 +124,284 @@ void remap_3d(FFT_SCALAR *in, FFT_SCALAR *out, FFT_SCALAR *buf,
 
   // use All2Allv collective for remap communication
 
-  } else { 
-    if (plan->commringlen > 0) {
-      int isend,irecv;
-
-      // create send and recv buffers for alltoallv collective
-
-      int sendBufferSize = 0;
-      int recvBufferSize = 0;
-      for (int i=0;i<plan->nsend;i++)
-        sendBufferSize += plan->send_size[i];
-      for (int i=0;i<plan->nrecv;i++)
-        recvBufferSize += plan->recv_size[i];
-
-      FFT_SCALAR *packedSendBuffer 
-        = (FFT_SCALAR *) malloc(sizeof(FFT_SCALAR) * sendBufferSize);
-      FFT_SCALAR *packedRecvBuffer 
-        = (FFT_SCALAR *) malloc(sizeof(FFT_SCALAR) * recvBufferSize);
-
-      int *sendcnts = (int *) malloc(sizeof(int) * plan->commringlen);
-      int *rcvcnts = (int *) malloc(sizeof(int) * plan->commringlen);
-      int *sdispls = (int *) malloc(sizeof(int) * plan->commringlen);
-      int *rdispls = (int *) malloc(sizeof(int) * plan->commringlen);
-      int *nrecvmap = (int *) malloc(sizeof(int) * plan->commringlen);
-
-      // create and populate send data, count and displacement buffers
-
-      int currentSendBufferOffset = 0;
-      for (isend = 0; isend < plan->commringlen; isend++) {
-        sendcnts[isend] = 0;
-        sdispls[isend] = 0;
-        int foundentry = 0;
-        for (int i=0;(i<plan->nsend && !foundentry); i++) {
-          if (plan->send_proc[i] == plan->commringlist[isend]) {
-            foundentry = 1;
-            sendcnts[isend] = plan->send_size[i];
-            sdispls[isend] = currentSendBufferOffset;
-            plan->pack(&in[plan->send_offset[i]],
-                       &packedSendBuffer[currentSendBufferOffset],
-                       &plan->packplan[i]);
-            currentSendBufferOffset += plan->send_size[i];
-          }
-        }
-      }
+  } else {
+    if (plan->commringlen > 0) return remap_3d_collective(&in,&out,1,plan);
+  }
 
-      // create and populate recv count and displacement buffers
-
-      int currentRecvBufferOffset = 0;
-      for (irecv = 0; irecv < plan->commringlen; irecv++) {
-        rcvcnts[irecv] = 0;
-        rdispls[irecv] = 0;
-        nrecvmap[irecv] = -1;
-        int foundentry = 0;
-        for (int i=0;(i<plan->nrecv && !foundentry); i++) {
-          if (plan->recv_proc[i] == plan->commringlist[irecv]) {
-            foundentry = 1;
-            rcvcnts[irecv] = plan->recv_size[i];
-            rdispls[irecv] = currentRecvBufferOffset;
-            currentRecvBufferOffset += plan->recv_size[i];
-            nrecvmap[irecv] = i;
-          }
-        }
-      }
+  return 0;
+}
 
-      MPI_Alltoallv(packedSendBuffer, sendcnts, sdispls,
-                    MPI_FFT_SCALAR, packedRecvBuffer, rcvcnts,
-                    rdispls, MPI_FFT_SCALAR, plan->comm);
+/* ----------------------------------------------------------------------
+   Perform 3d remap of N fields with the same layout at once
 
-      // unpack the data from the recv buffer into out
+   Arguments:
+   in           N starting addresses of input data on this proc
+   out          N starting addresses of where output data will be placed
+                  (can be same as in)
+   n            # of fields
+   plan         plan returned by previous call to remap_3d_create_plan
 
-      currentRecvBufferOffset = 0;
-      for (irecv = 0; irecv < plan->commringlen; irecv++) {
-        if (nrecvmap[irecv] > -1) {
-          plan->unpack(&packedRecvBuffer[currentRecvBufferOffset],
-                       &out[plan->recv_offset[nrecvmap[irecv]]],
-                       &plan->unpackplan[nrecvmap[irecv]]);
-          currentRecvBufferOffset += plan->recv_size[nrecvmap[irecv]];
-        }
-      }
+   all fields share one message (or one collective) per proc pair,
+     so the number of messages is the same as for a single remap
+   buffers are allocated internally and grown as needed
+   return 1 if buffers could not be allocated, else 0
+------------------------------------------------------------------------- */
 
-      // free temporary data structures
+int remap_3d_batch(FFT_SCALAR **in, FFT_SCALAR **out, int n,
+                   struct remap_plan_3d *plan)
+{
+  int i,k,isend,irecv,nrecvall,size;
+  FFT_SCALAR *sendbuf,*scratch;
+
+  // use All2Allv collective for remap communication
+
+  if (plan->usecollective) {
+    if (plan->commringlen > 0) return remap_3d_collective(in,out,n,plan);
+    return 0;
+  }
+
+  // grow batch buffers if needed
+  // scratch holds N consecutive blocks per recv, one per field
+
+  if (n > plan->nbatch) {
+    free(plan->batchsendbuf);
+    free(plan->batchscratch);
+    plan->batchsendbuf = plan->batchscratch = NULL;
+
+    size = 0;
+    for (isend = 0; isend < plan->nsend; isend++)
+      size = MAX(size,plan->send_size[isend]);
+    if (size)
+      plan->batchsendbuf = (FFT_SCALAR *) malloc(n*size*sizeof(FFT_SCALAR));
+
+    nrecvall = plan->nrecv + plan->self;
+    size = 0;
+    if (nrecvall)
+      size = plan->recv_bufloc[nrecvall-1] + plan->recv_size[nrecvall-1];
+    if (size)
+      plan->batchscratch = (FFT_SCALAR *) malloc(n*size*sizeof(FFT_SCALAR));
+
+    if ((plan->nsend && plan->batchsendbuf == NULL) ||
+        (size && plan->batchscratch == NULL)) {
+      plan->nbatch = 0;
+      return 1;
+    }
+    plan->nbatch = n;
+  }
 
-      free(sendcnts);
-      free(rcvcnts);
-      free(sdispls);
-      free(rdispls);
-      free(nrecvmap);
-      free(packedSendBuffer);
-      free(packedRecvBuffer);
+  sendbuf = plan->batchsendbuf;
+  scratch = plan->batchscratch;
+
+  // post all recvs into scratch space
+
+  for (irecv = 0; irecv < plan->nrecv; irecv++)
+    MPI_Irecv(&scratch[n*plan->recv_bufloc[irecv]],n*plan->recv_size[irecv],
+              MPI_FFT_SCALAR,plan->recv_proc[irecv],0,
+              plan->comm,&plan->request[irecv]);
+
+  // send all messages to other procs
+
+  for (isend = 0; isend < plan->nsend; isend++) {
+    for (k = 0; k < n; k++)
+      plan->pack(&in[k][plan->send_offset[isend]],
+                 &sendbuf[k*plan->send_size[isend]],&plan->packplan[isend]);
+    MPI_Send(sendbuf,n*plan->send_size[isend],MPI_FFT_SCALAR,
+             plan->send_proc[isend],0,plan->comm);
+  }
+
+  // copy in -> scratch -> out for self data
+
+  if (plan->self) {
+    isend = plan->nsend;
+    irecv = plan->nrecv;
+    for (k = 0; k < n; k++) {
+      scratch = &plan->batchscratch[n*plan->recv_bufloc[irecv] +
+                                    k*plan->recv_size[irecv]];
+      plan->pack(&in[k][plan->send_offset[isend]],scratch,
+                 &plan->packplan[isend]);
+      plan->unpack(scratch,&out[k][plan->recv_offset[irecv]],
+                   &plan->unpackplan[irecv]);
     }
+    scratch = plan->batchscratch;
   }
+
+  // unpack all messages from scratch -> out
+
+  for (i = 0; i < plan->nrecv; i++) {
+    MPI_Waitany(plan->nrecv,plan->request,&irecv,MPI_STATUS_IGNORE);
+    for (k = 0; k < n; k++)
+      plan->unpack(&scratch[n*plan->recv_bufloc[irecv] +
+                            k*plan->recv_size[irecv]],
+                   &out[k][plan->recv_offset[irecv]],
+                   &plan->unpackplan[irecv]);
+  }
+
+  return 0;
+}
+
+/* ----------------------------------------------------------------------
+   remap N fields via one MPI_Alltoallv on the plan communicator
+   each commring entry holds N consecutive blocks, one per field
+   with MPI-3, the self block is not part of the exchange but is copied
+     locally while a nonblocking MPI_Ialltoallv is in progress
+   return 1 if the alltoallv setup could not be allocated, else 0
+------------------------------------------------------------------------- */
+
+static int remap_3d_collective(FFT_SCALAR **in, FFT_SCALAR **out, int n,
+                               struct remap_plan_3d *plan)
+{
+  int i,j,k,jself;
+  FFT_SCALAR *selfbuf;
+
+  if (plan->ncollective != n)
+    if (remap_3d_collective_setup(plan,n)) return 1;
+
+  FFT_SCALAR *sendbuf = plan->packedsendbuf;
+  FFT_SCALAR *recvbuf = plan->packedrecvbuf;
+
+  // pack data for other procs into send buffer
+
+  for (j = 0; j < plan->commringlen; j++) {
+    i = plan->nsendmap[j];
+    if (i < 0) continue;
+#ifdef REMAP_IALLTOALLV
+    if (i == plan->selfsend) continue;
+#endif
+    for (k = 0; k < n; k++)
+      plan->pack(&in[k][plan->send_offset[i]],
+                 &sendbuf[plan->sdispls[j] + k*plan->send_size[i]],
+                 &plan->packplan[i]);
+  }
+
+#ifdef REMAP_IALLTOALLV
+  MPI_Request request;
+  MPI_Ialltoallv(sendbuf,plan->sendcnts,plan->sdispls,MPI_FFT_SCALAR,
+                 recvbuf,plan->rcvcnts,plan->rdispls,MPI_FFT_SCALAR,
+                 plan->comm,&request);
+
+  // copy in -> recv buffer -> out for self data while exchange proceeds
+  // all other data has already been packed, so in can be overwritten
+
+  if (plan->selfsend >= 0) {
+    jself = 0;
+    for (j = 0; j < plan->commringlen; j++)
+      if (plan->nrecvmap[j] == plan->selfrecv) jself = j;
+    i = plan->selfrecv;
+    for (k = 0; k < n; k++) {
+      selfbuf = &recvbuf[plan->rdispls[jself] + k*plan->recv_size[i]];
+      plan->pack(&in[k][plan->send_offset[plan->selfsend]],selfbuf,
+                 &plan->packplan[plan->selfsend]);
+      plan->unpack(selfbuf,&out[k][plan->recv_offset[i]],
+                   &plan->unpackplan[i]);
+    }
+  }
+
+  MPI_Wait(&request,MPI_STATUS_IGNORE);
+#else
+  MPI_Alltoallv(sendbuf,plan->sendcnts,plan->sdispls,MPI_FFT_SCALAR,
+                recvbuf,plan->rcvcnts,plan->rdispls,MPI_FFT_SCALAR,
+                plan->comm);
+#endif
+
+  // unpack the data from the recv buffer into out
+
+  for (j = 0; j < plan->commringlen; j++) {
+    i = plan->nrecvmap[j];
+    if (i < 0) continue;
+#ifdef REMAP_IALLTOALLV
+    if (i == plan->selfrecv) continue;
+#endif
+    for (k = 0; k < n; k++)
+      plan->unpack(&recvbuf[plan->rdispls[j] + k*plan->recv_size[i]],
+                   &out[k][plan->recv_offset[i]],&plan->unpackplan[i]);
+  }
+
+  return 0;
+}
+
+/* ----------------------------------------------------------------------
+   create alltoallv counts, displacements and buffers for N fields
+   they depend only on the plan, so are reused until N changes
+   return 1 if buffers could not be allocated, else 0
+   on failure the plan is marked as not set up, so no stale setup is used
+------------------------------------------------------------------------- */
+
+static int remap_3d_collective_setup(struct remap_plan_3d *plan, int n)
+{
+  int i,j,len;
+
+  len = plan->commringlen;
+  plan->ncollective = 0;
+
+  if (plan->sendcnts == NULL) {
+    plan->sendcnts = (int *) malloc(len*sizeof(int));
+    plan->rcvcnts = (int *) malloc(len*sizeof(int));
+    plan->sdispls = (int *) malloc(len*sizeof(int));
+    plan->rdispls = (int *) malloc(len*sizeof(int));
+    plan->nsendmap = (int *) malloc(len*sizeof(int));
+    plan->nrecvmap = (int *) malloc(len*sizeof(int));
+    if (plan->sendcnts == NULL || plan->rcvcnts == NULL ||
+        plan->sdispls == NULL || plan->rdispls == NULL ||
+        plan->nsendmap == NULL || plan->nrecvmap == NULL) {
+      free(plan->sendcnts);
+      free(plan->rcvcnts);
+      free(plan->sdispls);
+      free(plan->rdispls);
+      free(plan->nsendmap);
+      free(plan->nrecvmap);
+      plan->sendcnts = plan->rcvcnts = plan->sdispls = plan->rdispls = NULL;
+      plan->nsendmap = plan->nrecvmap = NULL;
+      return 1;
+    }
+  }
+
+  // send and recv blocks are stored in commring order
+  // with MPI-3, counts for self are zero, but space is still reserved
+
+  int sendtotal = 0;
+  int recvtotal = 0;
+
+  for (j = 0; j < len; j++) {
+    plan->sendcnts[j] = plan->sdispls[j] = 0;
+    plan->nsendmap[j] = -1;
+    for (i = 0; i < plan->nsend; i++)
+      if (plan->send_proc[i] == plan->commringlist[j]) {
+        plan->nsendmap[j] = i;
+        plan->sendcnts[j] = n*plan->send_size[i];
+        plan->sdispls[j] = sendtotal;
+        sendtotal += n*plan->send_size[i];
+        break;
+      }
+
+    plan->rcvcnts[j] = plan->rdispls[j] = 0;
+    plan->nrecvmap[j] = -1;
+    for (i = 0; i < plan->nrecv; i++)
+      if (plan->recv_proc[i] == plan->commringlist[j]) {
+        plan->nrecvmap[j] = i;
+        plan->rcvcnts[j] = n*plan->recv_size[i];
+        plan->rdispls[j] = recvtotal;
+        recvtotal += n*plan->recv_size[i];
+        break;
+      }
+
+#ifdef REMAP_IALLTOALLV
+    if (plan->nsendmap[j] >= 0 && plan->nsendmap[j] == plan->selfsend)
+      plan->sendcnts[j] = 0;
+    if (plan->nrecvmap[j] >= 0 && plan->nrecvmap[j] == plan->selfrecv)
+      plan->rcvcnts[j] = 0;
+#endif
+  }
+
+  free(plan->packedsendbuf);
+  free(plan->packedrecvbuf);
+  plan->packedsendbuf = (FFT_SCALAR *) malloc(MAX(sendtotal,1) *
+                                              sizeof(FFT_SCALAR));
+  plan->packedrecvbuf = (FFT_SCALAR *) malloc(MAX(recvtotal,1) *
+                                              sizeof(FFT_SCALAR));
+  if (plan->packedsendbuf == NULL || plan->packedrecvbuf == NULL) return 1;
+
+  plan->ncollective = n;
+  return 0;
 }
 
 /* ----------------------------------------------------------------------
@@ -253,6 +454,15 @@ struct remap_plan_3d *remap_3d_create_plan(
   plan = (struct remap_plan_3d *) malloc(sizeof(struct remap_plan_3d));
   if (plan == NULL) return NULL;
   plan->usecollective = usecollective;
+  plan->commringlen = 0;
+  plan->commringlist = NULL;
+  plan->selfsend = plan->selfrecv = -1;
+  plan->ncollective = plan->nbatch = 0;
+  plan->sendcnts = plan->rcvcnts = NULL;
+  plan->sdispls = plan->rdispls = NULL;
+  plan->nsendmap = plan->nrecvmap = NULL;
+  plan->packedsendbuf = plan->packedrecvbuf = NULL;
+  plan->batchsendbuf = plan->batchscratch = NULL;
 
   // store parameters in local data structs
 
@@ -342,6 +552,7 @@ struct remap_plan_3d *remap_3d_create_plan(
   // plan->nsend = # of sends not including self
 
   if (nsend && plan->send_proc[nsend-1] == me) {
+    plan->selfsend = nsend-1;
     if (plan->usecollective) // for collectives include self in nsend list
       plan->nsend = nsend;
     else
@@ -559,6 +770,7 @@ struct remap_plan_3d *remap_3d_create_plan(
   // for collectives include self in the nsend list
 
   if (nrecv && plan->recv_proc[nrecv-1] == me) {
+    plan->selfrecv = nrecv-1;
     if (plan->usecollective) plan->nrecv = nrecv;
     else plan->nrecv = nrecv - 1;
   } else plan->nrecv = nrecv;
@@ -646,6 +858,19 @@ void remap_3d_destroy_plan(struct remap_plan_3d *plan)
       free(plan->commringlist);
   }
 
+  // free cached collective and batch buffers
+
+  free(plan->sendcnts);
+  free(plan->rcvcnts);
+  free(plan->sdispls);
+  free(plan->rdispls);
+  free(plan->nsendmap);
+  free(plan->nrecvmap);
+  free(plan->packedsendbuf);
+  free(plan->packedrecvbuf);
+  free(plan->batchsendbuf);
+  free(plan->batchscratch);
+
   // free internal arrays
 
   if (plan->nsend || plan->self) {
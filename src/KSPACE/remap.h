@@ -48,6 +48,16 @@ struct remap_plan_3d {
   int usecollective;                // use collective or point-to-point MPI
   int commringlen;                  // length of commringlist
   int *commringlist;                // ranks on communication ring of this plan
+  int selfsend,selfrecv;            // index of self in send/recv lists, or -1
+  int ncollective;                  // # of fields collective bufs are sized for
+  int *sendcnts,*rcvcnts;           // alltoallv counts per commring entry
+  int *sdispls,*rdispls;            // alltoallv displacements
+  int *nsendmap,*nrecvmap;          // send/recv index for each commring entry
+  FFT_SCALAR *packedsendbuf;        // alltoallv send buffer
+  FFT_SCALAR *packedrecvbuf;        // alltoallv recv buffer
+  int nbatch;                       // # of fields batch bufs are sized for
+  FFT_SCALAR *batchsendbuf;         // send buffer for batched remaps
+  FFT_SCALAR *batchscratch;         // recv buffer for batched remaps
 };
 
 // collision between 2 regions
@@ -60,7 +70,9 @@ struct extent_3d {
 
 // function prototypes
 
-void remap_3d(FFT_SCALAR *, FFT_SCALAR *, FFT_SCALAR *, struct remap_plan_3d *);
+int remap_3d(FFT_SCALAR *, FFT_SCALAR *, FFT_SCALAR *, struct remap_plan_3d *);
+int remap_3d_batch(FFT_SCALAR **, FFT_SCALAR **, int,
+                   struct remap_plan_3d *);
 struct remap_plan_3d *remap_3d_create_plan(MPI_Comm,
                                            int, int, int, int, int, int,
                                            int, int, int, int, int, int,
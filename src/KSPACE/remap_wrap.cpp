@@ -45,5 +45,6 @@ Remap::~Remap()
 
 void Remap::perform(FFT_SCALAR *in, FFT_SCALAR *out, FFT_SCALAR *buf)
 {
-  remap_3d(in,out,buf,plan);
+  if (remap_3d(in,out,buf,plan))
+    error->one(FLERR,"Could not allocate 3d remap buffers");
 }
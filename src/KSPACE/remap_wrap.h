@@ -40,4 +40,9 @@ E: Could not create 3d remap plan
 
 The FFT setup in pppm failed.
 
+E: Could not allocate 3d remap buffers
+
+The buffers for a collective remap could not be allocated, typically
+due to lack of memory.
+
 */
@@ -45,6 +45,8 @@ using namespace MathConst;
 
 enum{ATOM,MOLECULE};
 
+static int compare_index(const void *, const void *);
+
 /* ---------------------------------------------------------------------- */
 
 FixGCMC::FixGCMC(LAMMPS *lmp, int narg, char **arg) :
@@ -196,6 +198,10 @@ FixGCMC::FixGCMC(LAMMPS *lmp, int narg, char **arg) :
 
   gcmc_nmax = 0;
   local_gas_list = NULL;
+
+  nbinx = nbiny = nbinz = 1;
+  maxbin = maxbinatom = maxneigh = 0;
+  binhead = binnext = neighs = NULL;
 }
 
 /* ----------------------------------------------------------------------
@@ -222,6 +228,7 @@ void FixGCMC::options(int narg, char **arg)
   fugacity_coeff = 1.0;
   shakeflag = 0;
   idshake = NULL;
+  binflag = 1;
   
   int iarg = 0;
   while (iarg < narg) {
@@ -261,6 +268,12 @@ void FixGCMC::options(int narg, char **arg)
       if (iarg+2 > narg) error->all(FLERR,"Illegal fix gcmc command");
       fugacity_coeff = force->numeric(FLERR,arg[iarg+1]);
       iarg += 2;
+    } else if (strcmp(arg[iarg],"bins") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal fix gcmc command");
+      if (strcmp(arg[iarg+1],"yes") == 0) binflag = 1;
+      else if (strcmp(arg[iarg+1],"no") == 0) binflag = 0;
+      else error->all(FLERR,"Illegal fix gcmc command");
+      iarg += 2;
     } else error->all(FLERR,"Illegal fix gcmc command");
   }
 }
@@ -290,6 +303,10 @@ FixGCMC::~FixGCMC()
   delete [] idshake;
   memory->destroy(coords);
   memory->destroy(imageflags);
+
+  memory->destroy(binhead);
+  memory->destroy(binnext);
+  memory->destroy(neighs);
 }
 
 /* ---------------------------------------------------------------------- */
@@ -965,6 +982,8 @@ void FixGCMC::attempt_molecule_insertion()
 
 double FixGCMC::energy(int i, int itype, tagint imolecule, double *coord)
 {
+  if (binflag) return energy_binned(i,itype,imolecule,coord);
+
   double delx,dely,delz,rsq;
 
   double **x = atom->x;
@@ -999,6 +1018,145 @@ double FixGCMC::energy(int i, int itype, tagint imolecule, double *coord)
   return total_energy;
 }
 
+/* ----------------------------------------------------------------------
+   same as energy(), but only visit atoms in the bins around coord
+   interacting atoms are summed in order of their index,
+     so the result is bitwise identical to looping over all atoms
+------------------------------------------------------------------------- */
+
+double FixGCMC::energy_binned(int i, int itype, tagint imolecule,
+                              double *coord)
+{
+  int j,m,n,ix,iy,iz,jx,jy,jz,jtype;
+  double delx,dely,delz,rsq;
+
+  double **x = atom->x;
+  int *type = atom->type;
+  tagint *molecule = atom->molecule;
+  pair = force->pair;
+  cutsq = force->pair->cutsq;
+
+  ix = static_cast<int> ((coord[0]-binlo[0])*bininv[0]);
+  iy = static_cast<int> ((coord[1]-binlo[1])*bininv[1]);
+  iz = static_cast<int> ((coord[2]-binlo[2])*bininv[2]);
+  ix = MAX(0,MIN(ix,nbinx-1));
+  iy = MAX(0,MIN(iy,nbiny-1));
+  iz = MAX(0,MIN(iz,nbinz-1));
+
+  // gather atoms within cutoff from the 27 surrounding bins
+
+  n = 0;
+  for (jz = MAX(iz-1,0); jz <= MIN(iz+1,nbinz-1); jz++)
+    for (jy = MAX(iy-1,0); jy <= MIN(iy+1,nbiny-1); jy++)
+      for (jx = MAX(ix-1,0); jx <= MIN(ix+1,nbinx-1); jx++)
+        for (j = binhead[(jz*nbiny + jy)*nbinx + jx]; j >= 0;
+             j = binnext[j]) {
+          if (i == j) continue;
+          if (mode == MOLECULE)
+            if (imolecule == molecule[j]) continue;
+
+          delx = coord[0] - x[j][0];
+          dely = coord[1] - x[j][1];
+          delz = coord[2] - x[j][2];
+          rsq = delx*delx + dely*dely + delz*delz;
+          if (rsq < cutsq[itype][type[j]]) {
+            if (n == maxneigh) {
+              maxneigh += 256;
+              memory->grow(neighs,maxneigh,"gcmc:neighs");
+            }
+            neighs[n++] = j;
+          }
+        }
+
+  if (n > 1) qsort(neighs,n,sizeof(int),compare_index);
+
+  double fpair = 0.0;
+  double factor_coul = 1.0;
+  double factor_lj = 1.0;
+
+  double total_energy = 0.0;
+  for (m = 0; m < n; m++) {
+    j = neighs[m];
+    delx = coord[0] - x[j][0];
+    dely = coord[1] - x[j][1];
+    delz = coord[2] - x[j][2];
+    rsq = delx*delx + dely*dely + delz*delz;
+    jtype = type[j];
+    total_energy +=
+      pair->single(i,j,itype,jtype,rsq,factor_coul,factor_lj,fpair);
+  }
+
+  return total_energy;
+}
+
+/* ----------------------------------------------------------------------
+   bin owned and ghost atoms for energy_binned()
+   bins are at least as large as the pair cutoff
+   atoms in each bin are linked in increasing index order
+------------------------------------------------------------------------- */
+
+void FixGCMC::bin_atoms()
+{
+  int i,ix,iy,iz,ibin,nbins;
+  double lo[3],hi[3],len;
+
+  double **x = atom->x;
+  int nall = atom->nlocal + atom->nghost;
+  double cut = force->pair->cutforce;
+
+  lo[0] = lo[1] = lo[2] = 0.0;
+  hi[0] = hi[1] = hi[2] = 0.0;
+  if (nall) {
+    lo[0] = hi[0] = x[0][0];
+    lo[1] = hi[1] = x[0][1];
+    lo[2] = hi[2] = x[0][2];
+  }
+  for (i = 1; i < nall; i++) {
+    lo[0] = MIN(lo[0],x[i][0]);
+    lo[1] = MIN(lo[1],x[i][1]);
+    lo[2] = MIN(lo[2],x[i][2]);
+    hi[0] = MAX(hi[0],x[i][0]);
+    hi[1] = MAX(hi[1],x[i][1]);
+    hi[2] = MAX(hi[2],x[i][2]);
+  }
+
+  int *nbin[3] = {&nbinx,&nbiny,&nbinz};
+  for (int dim = 0; dim < 3; dim++) {
+    len = hi[dim] - lo[dim];
+    *nbin[dim] = 1;
+    if (cut > 0.0 && len > cut) *nbin[dim] = static_cast<int> (len/cut);
+    binlo[dim] = lo[dim];
+    bininv[dim] = 0.0;
+    if (len > 0.0) bininv[dim] = *nbin[dim]/len;
+  }
+
+  nbins = nbinx*nbiny*nbinz;
+  if (nbins > maxbin) {
+    maxbin = nbins;
+    memory->destroy(binhead);
+    memory->create(binhead,maxbin,"gcmc:binhead");
+  }
+  if (nall > maxbinatom) {
+    maxbinatom = atom->nmax;
+    memory->destroy(binnext);
+    memory->create(binnext,maxbinatom,"gcmc:binnext");
+  }
+
+  for (ibin = 0; ibin < nbins; ibin++) binhead[ibin] = -1;
+
+  for (i = nall-1; i >= 0; i--) {
+    ix = static_cast<int> ((x[i][0]-binlo[0])*bininv[0]);
+    iy = static_cast<int> ((x[i][1]-binlo[1])*bininv[1]);
+    iz = static_cast<int> ((x[i][2]-binlo[2])*bininv[2]);
+    ix = MIN(ix,nbinx-1);
+    iy = MIN(iy,nbiny-1);
+    iz = MIN(iz,nbinz-1);
+    ibin = (iz*nbiny + iy)*nbinx + ix;
+    binnext[i] = binhead[ibin];
+    binhead[ibin] = i;
+  }
+}
+
 /* ----------------------------------------------------------------------
 ------------------------------------------------------------------------- */
 
@@ -1122,6 +1280,10 @@ void FixGCMC::update_gas_atoms_list()
   MPI_Allreduce(&ngas_local,&ngas,1,MPI_INT,MPI_SUM,world);
   MPI_Scan(&ngas_local,&ngas_before,1,MPI_INT,MPI_SUM,world);
   ngas_before -= ngas_local;
+
+  // list is updated whenever atoms change, so also rebin them
+
+  if (binflag) bin_atoms();
 }
 
 /* ----------------------------------------------------------------------
@@ -1148,6 +1310,7 @@ double FixGCMC::compute_vector(int n)
 double FixGCMC::memory_usage()
 {
   double bytes = gcmc_nmax * sizeof(int);
+  bytes += (maxbin + maxbinatom + maxneigh) * sizeof(int);
   return bytes;
 }
 
@@ -1187,3 +1350,16 @@ void FixGCMC::restart(char *buf)
 
   next_reneighbor = static_cast<int> (list[n++]);
 }
+
+/* ----------------------------------------------------------------------
+   comparison function invoked by qsort() to sort atom indices
+------------------------------------------------------------------------- */
+
+int compare_index(const void *iptr, const void *jptr)
+{
+  int i = *((int *) iptr);
+  int j = *((int *) jptr);
+  if (i < j) return -1;
+  if (i > j) return 1;
+  return 0;
+}
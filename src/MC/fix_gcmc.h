@@ -40,11 +40,13 @@ class FixGCMC : public Fix {
   void attempt_molecule_deletion();
   void attempt_molecule_insertion();
   double energy(int, int, tagint, double *);
+  double energy_binned(int, int, tagint, double *);
   int pick_random_gas_atom();
   tagint pick_random_gas_molecule();
   double molecule_energy(tagint);
   void get_rotation_matrix(double, double *);
   void update_gas_atoms_list();
+  void bin_atoms();
   double compute_vector(int);
   double memory_usage();
   void write_restart(FILE *);
@@ -96,6 +98,16 @@ class FixGCMC : public Fix {
 
   class Pair *pair;
 
+  int binflag;              // 1 if energy() only visits nearby bins
+  int nbinx,nbiny,nbinz;    // # of bins in each dim
+  int maxbin,maxbinatom;    // allocated size of binhead, binnext
+  int *binhead;             // 1st atom in each bin, -1 if empty
+  int *binnext;             // next atom in same bin, -1 at end
+  double binlo[3];          // lower corner of bin grid
+  double bininv[3];         // inverse bin size in each dim
+  int maxneigh;             // allocated size of neighs
+  int *neighs;              // atoms within cutoff of trial position
+
   class RanPark *random_equal;
   class RanPark *random_unequal;
   
@@ -34,15 +34,9 @@
 #include "error.h"
 #include <stdlib.h>
 
-#if defined(_OPENMP)
-#include <omp.h>
-#endif
-
 using namespace LAMMPS_NS;
 
 #define MAX_TEXT_HEADER_SIZE 4096
-#define DUMP_BUF_CHUNK_SIZE 16384
-#define DUMP_BUF_INCREMENT_SIZE 4096
 
 enum{ID,MOL,TYPE,ELEMENT,MASS,
      X,Y,Z,XS,YS,ZS,XSTRI,YSTRI,ZSTRI,XU,YU,ZU,XUTRI,YUTRI,ZUTRI,
@@ -253,6 +247,7 @@ void DumpCustomMPIIO::init_style()
     strcpy(vformat[i],ptr);
     vformat[i] = strcat(vformat[i]," ");
   }
+  setup_conversions();
 
   // setup boundary string
 
@@ -530,16 +525,9 @@ void DumpCustomMPIIO::write_string(int n, double *mybuf)
 {
   if (performEstimate) {
 
-#if defined(_OPENMP)
-    int nthreads = omp_get_max_threads();
-    if (nthreads > 1)
-      nsme = convert_string_omp(n,mybuf);
-    else
-      nsme = convert_string(n,mybuf);
-#else
+    // convert_string() is multithreaded with OpenMP
 
     nsme = convert_string(n,mybuf);
-#endif
     bigint incPrefix = 0;
     bigint bigintNsme = (bigint) nsme;
     MPI_Scan(&bigintNsme,&incPrefix,1,MPI_LMP_BIGINT,MPI_SUM,world);
@@ -552,106 +540,3 @@ void DumpCustomMPIIO::write_string(int n, double *mybuf)
       MPI_File_sync(mpifh);
   }
 }
-
-#if defined(_OPENMP)
-
-/* ----------------------------------------------------------------------
-   multithreaded version - convert mybuf of doubles to one big formatted string in sbuf
-   return -1 if strlen exceeds an int, since used as arg in MPI calls in Dump
-------------------------------------------------------------------------- */
-
-int DumpCustomMPIIO::convert_string_omp(int n, double *mybuf)
-{
-  char **mpifh_buffer_line_per_thread;
-  int mpifhStringCount;
-  int *mpifhStringCountPerThread, *bufOffset, *bufRange, *bufLength;
-
-  mpifhStringCount = 0;
-
-  int nthreads = omp_get_max_threads();
-  if (nthreads > n) { // call serial version
-    convert_string(n,mybuf);
-
-  }
-  else {
-    memory->create(mpifhStringCountPerThread,nthreads,"dump:mpifhStringCountPerThread");
-    mpifh_buffer_line_per_thread = (char **) malloc(nthreads*sizeof(char*));
-    memory->create(bufOffset,nthreads,"dump:bufOffset");
-    memory->create(bufRange,nthreads,"dump:bufRange");
-    memory->create(bufLength,nthreads,"dump:bufLength");
-
-    int i=0;
-    for (i=0;i<(nthreads-1);i++) {
-      mpifhStringCountPerThread[i] = 0;
-      bufOffset[i] = (int) (i*(int)(floor((double)n/(double)nthreads))*size_one);
-      bufRange[i] = (int)(floor((double)n/(double)nthreads));
-      bufLength[i] = DUMP_BUF_CHUNK_SIZE;
-      mpifh_buffer_line_per_thread[i] = (char *) malloc(DUMP_BUF_CHUNK_SIZE * sizeof(char));
-      mpifh_buffer_line_per_thread[i][0] = '\0';
-    }
-    mpifhStringCountPerThread[i] = 0;
-    bufOffset[i] = (int) (i*(int)(floor((double)n/(double)nthreads))*size_one);
-    bufRange[i] =  n-(i*(int)(floor((double)n/(double)nthreads)));
-    bufLength[i] = DUMP_BUF_CHUNK_SIZE;
-    mpifh_buffer_line_per_thread[i] = (char *) malloc(DUMP_BUF_CHUNK_SIZE * sizeof(char));
-    mpifh_buffer_line_per_thread[i][0] = '\0';
-
-#pragma omp parallel default(none) shared(bufOffset, bufRange, bufLength, mpifhStringCountPerThread, mpifh_buffer_line_per_thread, mybuf)
-    {
-      int tid = omp_get_thread_num();
-      int m=0;
-
-      for (int i = 0; i < bufRange[tid]; i++) {
-
-        if ((bufLength[tid] - mpifhStringCountPerThread[tid]) < DUMP_BUF_INCREMENT_SIZE) {
-          mpifh_buffer_line_per_thread[tid] = (char *) realloc(mpifh_buffer_line_per_thread[tid],(mpifhStringCountPerThread[tid]+DUMP_BUF_CHUNK_SIZE) * sizeof(char));
-          bufLength[tid] = (mpifhStringCountPerThread[tid]+DUMP_BUF_CHUNK_SIZE) * sizeof(char);
-        }
-        for (int j = 0; j < size_one; j++) {
-
-          if (vtype[j] == INT)
-            mpifhStringCountPerThread[tid] += sprintf(&(mpifh_buffer_line_per_thread[tid][mpifhStringCountPerThread[tid]]),vformat[j],static_cast<int> (mybuf[bufOffset[tid]+m]));
-          else if (vtype[j] == DOUBLE)
-            mpifhStringCountPerThread[tid] += sprintf(&(mpifh_buffer_line_per_thread[tid][mpifhStringCountPerThread[tid]]),vformat[j],mybuf[bufOffset[tid]+m]);
-          else if (vtype[j] == STRING)
-            mpifhStringCountPerThread[tid] += sprintf(&(mpifh_buffer_line_per_thread[tid][mpifhStringCountPerThread[tid]]),vformat[j],typenames[(int) mybuf[bufOffset[tid]+m]]);
-          m ++;
-        }
-        mpifhStringCountPerThread[tid] += sprintf(&(mpifh_buffer_line_per_thread[tid][mpifhStringCountPerThread[tid]]),"\n");
-
-      }
-    }
-
-#pragma omp barrier
-    mpifhStringCount = 0;
-    for (i=0;i<nthreads;i++) {
-      mpifhStringCount += mpifhStringCountPerThread[i];
-    }
-
-    memory->destroy(bufOffset);
-    memory->destroy(bufRange);
-    memory->destroy(bufLength);
-
-    if (mpifhStringCount > 0) {
-      if (mpifhStringCount > maxsbuf) {
-        if (mpifhStringCount > MAXSMALLINT) return -1;
-        maxsbuf = mpifhStringCount;
-        memory->grow(sbuf,maxsbuf,"dump:sbuf");
-      }
-      sbuf[0] = '\0';
-    }
-
-
-    for (int i=0;i<nthreads;i++) {
-      strcat(sbuf,mpifh_buffer_line_per_thread[i]);
-      free(mpifh_buffer_line_per_thread[i]);
-    }
-
-    memory->destroy(mpifhStringCountPerThread);
-    free(mpifh_buffer_line_per_thread);
-
-  }
-
-  return mpifhStringCount;
-}
-#endif
@@ -39,10 +39,6 @@ class DumpCustomMPIIO : public DumpCustom {
   int performEstimate; // switch for write_data and write_header methods to use for gathering data and detemining filesize for preallocation vs actually writing the data
   char *filecurrent;  // name of file for this round (with % and * replaced)
 
-#if defined(_OPENMP)
-  int convert_string_omp(int, double *);  // multithreaded version of convert_string
-#endif
-
   virtual void openfile();
   virtual void write_header(bigint);
   virtual void write();
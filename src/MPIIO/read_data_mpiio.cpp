@@ -0,0 +1,218 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#include "mpi.h"
+#include "string.h"
+#include "stdio.h"
+#include "read_data_mpiio.h"
+#include "memory.h"
+#include "error.h"
+
+using namespace LAMMPS_NS;
+
+#define WINDOW 4194304          // bytes of file each proc reads per pass
+#define DELTA 1048576
+
+/* ---------------------------------------------------------------------- */
+
+ReadDataMPIIO::ReadDataMPIIO(LAMMPS *lmp) : Pointers(lmp)
+{
+  mpiio_exists = 1;
+  MPI_Comm_size(world,&nprocs);
+  MPI_Comm_rank(world,&me);
+  window = NULL;
+  maxwindow = 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+ReadDataMPIIO::~ReadDataMPIIO()
+{
+  memory->sfree(window);
+}
+
+/* ----------------------------------------------------------------------
+   calls MPI_File_open in read-only mode and stores size of file
+------------------------------------------------------------------------- */
+
+void ReadDataMPIIO::openForRead(char *filename)
+{
+  int err = MPI_File_open(world,filename,MPI_MODE_RDONLY,
+                          MPI_INFO_NULL,&mpifh);
+  if (err != MPI_SUCCESS) {
+    char str[MPI_MAX_ERROR_STRING+128];
+    char mpiErrorString[MPI_MAX_ERROR_STRING];
+    int mpiErrorStringLength;
+    MPI_Error_string(err,mpiErrorString,&mpiErrorStringLength);
+    sprintf(str,"Cannot open data file for reading - MPI error: %s",
+            mpiErrorString);
+    error->one(FLERR,str);
+  }
+
+  MPI_File_get_size(mpifh,&filesize);
+}
+
+/* ----------------------------------------------------------------------
+   read Nlines lines of text starting at file byte Offset
+   done in passes, each pass every proc reads a disjoint WINDOW of bytes
+     via collective MPI-IO, plus a few extra bytes to resync on line bounds
+   a line belongs to the proc whose window contains its first byte
+   MPI_Scan of per-proc line counts determines which lines are in section
+   if keep = 1, append my lines to Lines, grown as needed to Maxlines bytes
+   each stored line is terminated by a newline
+   return nmine = # of lines of section owned by this proc
+   return value = file byte offset immediately after last line of section
+------------------------------------------------------------------------- */
+
+bigint ReadDataMPIIO::read_lines(bigint offset, bigint nlines, int maxline,
+                                 int keep, int &nmine, char *&lines,
+                                 bigint &maxlines)
+{
+  int i,len,nbytes,ifirst,ilast,nkeep,m;
+  bigint ncount,scan,first,total,remain,lastend,sectionend,all;
+  MPI_Offset lo,hi,rlo,rhi;
+  char *ptr;
+
+  if (maxwindow < WINDOW + maxline + 1) {
+    maxwindow = WINDOW + maxline + 1;
+    memory->sfree(window);
+    window = (char *) memory->smalloc(maxwindow,"read_data:window");
+  }
+
+  nmine = 0;
+  bigint nbuf = 0;
+  bigint nread = 0;
+  bigint start = offset;
+  bigint stop = offset;
+
+  while (nread < nlines) {
+    if (start >= filesize) error->all(FLERR,"Unexpected end of data file");
+
+    // my lines start in [lo,hi)
+    // read 1 byte before lo to detect if a line starts at lo
+    // read maxline bytes beyond hi to complete last line starting before hi
+
+    lo = start + (MPI_Offset) me * WINDOW;
+    hi = lo + WINDOW;
+    if (lo > filesize) lo = filesize;
+    if (hi > filesize) hi = filesize;
+    rlo = lo;
+    if (lo > start) rlo = lo - 1;
+    rhi = hi + maxline;
+    if (rhi > filesize) rhi = filesize;
+    nbytes = rhi - rlo;
+
+    int err = MPI_File_read_at_all(mpifh,rlo,window,nbytes,
+                                   MPI_CHAR,MPI_STATUS_IGNORE);
+    if (err != MPI_SUCCESS) {
+      char str[MPI_MAX_ERROR_STRING+128];
+      char mpiErrorString[MPI_MAX_ERROR_STRING];
+      int mpiErrorStringLength;
+      MPI_Error_string(err,mpiErrorString,&mpiErrorStringLength);
+      sprintf(str,"Cannot read from data file - MPI error: %s",
+              mpiErrorString);
+      error->one(FLERR,str);
+    }
+
+    // ifirst = 1st line start in my window, ilast = end of my range
+    // line starts at start of section or after a newline
+
+    ifirst = lo - rlo;
+    ilast = hi - rlo;
+    if (lo != start)
+      while (ifirst < ilast && window[ifirst-1] != '\n') ifirst++;
+
+    // count lines starting in my range
+
+    ncount = 0;
+    for (i = ifirst; i < ilast; i += len) {
+      ptr = (char *) memchr(&window[i],'\n',nbytes-i);
+      if (ptr) len = ptr - &window[i] + 1;
+      else if (rhi == filesize) len = nbytes - i;
+      else len = maxline;
+      if (len >= maxline)
+        error->one(FLERR,"Data file line too long for read_data mpiio");
+      ncount++;
+    }
+
+    // first = index of my 1st line in this pass
+    // nkeep = # of my lines that are in section
+
+    MPI_Scan(&ncount,&scan,1,MPI_LMP_BIGINT,MPI_SUM,world);
+    MPI_Allreduce(&ncount,&total,1,MPI_LMP_BIGINT,MPI_SUM,world);
+    first = scan - ncount;
+    remain = nlines - nread;
+    nkeep = 0;
+    if (first < remain) nkeep = MIN(ncount,remain-first);
+
+    // store my lines in section
+    // lastend = file offset after my last line
+    // sectionend = file offset after last line of section, if I own it
+
+    lastend = sectionend = 0;
+    m = 0;
+    for (i = ifirst; i < ilast; i += len) {
+      ptr = (char *) memchr(&window[i],'\n',nbytes-i);
+      if (ptr) len = ptr - &window[i] + 1;
+      else len = nbytes - i;
+      lastend = rlo + i + len;
+      if (m < nkeep) {
+        if (keep) {
+          if (nbuf + len + 2 > maxlines) {
+            maxlines = nbuf + len + 2 + DELTA;
+            lines = (char *)
+              memory->srealloc(lines,maxlines,"read_data:lines");
+          }
+          memcpy(&lines[nbuf],&window[i],len);
+          nbuf += len;
+          if (lines[nbuf-1] != '\n') lines[nbuf++] = '\n';
+          lines[nbuf] = '\0';
+        }
+        if (first+m == remain-1) sectionend = lastend;
+      }
+      m++;
+    }
+    nmine += nkeep;
+
+    // if section is done, stop = offset after its last line
+    // else next pass starts after last line of this pass
+
+    if (total >= remain) {
+      MPI_Allreduce(&sectionend,&stop,1,MPI_LMP_BIGINT,MPI_MAX,world);
+      nread = nlines;
+    } else {
+      MPI_Allreduce(&lastend,&all,1,MPI_LMP_BIGINT,MPI_MAX,world);
+      start = all;
+      nread += total;
+    }
+  }
+
+  return stop;
+}
+
+/* ----------------------------------------------------------------------
+   calls MPI_File_close
+------------------------------------------------------------------------- */
+
+void ReadDataMPIIO::close()
+{
+  int err = MPI_File_close(&mpifh);
+  if (err != MPI_SUCCESS) {
+    char str[MPI_MAX_ERROR_STRING+128];
+    char mpiErrorString[MPI_MAX_ERROR_STRING];
+    int mpiErrorStringLength;
+    MPI_Error_string(err,mpiErrorString,&mpiErrorStringLength);
+    sprintf(str,"Cannot close data file - MPI error: %s",mpiErrorString);
+    error->one(FLERR,str);
+  }
+}
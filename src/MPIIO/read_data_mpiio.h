@@ -0,0 +1,70 @@
+/* -*- c++ -*- ----------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#ifndef LMP_READ_DATA_MPIIO_H
+#define LMP_READ_DATA_MPIIO_H
+
+#include "pointers.h"
+
+namespace LAMMPS_NS {
+
+class ReadDataMPIIO : protected Pointers {
+ private:
+  MPI_File mpifh;
+  MPI_Offset filesize;
+  int nprocs,me;
+  char *window;                 // bytes of file read by this proc
+  int maxwindow;
+
+ public:
+  int mpiio_exists;
+
+  ReadDataMPIIO(class LAMMPS *);
+  ~ReadDataMPIIO();
+  void openForRead(char *);
+  bigint read_lines(bigint, bigint, int, int, int &, char *&, bigint &);
+  void close();
+};
+
+}
+
+#endif
+
+/* ERROR/WARNING messages:
+
+E: Cannot open data file for reading - MPI error: %s
+
+This error was generated by MPI when opening a data file for reading
+with the read_data mpiio option.
+
+E: Cannot read from data file - MPI error: %s
+
+This error was generated by MPI when reading a data file with the
+read_data mpiio option.
+
+E: Cannot close data file - MPI error: %s
+
+This error was generated by MPI when closing a data file read with the
+read_data mpiio option.
+
+E: Unexpected end of data file
+
+LAMMPS hit the end of the data file while attempting to read a
+section.  Something is wrong with the format of the data file.
+
+E: Data file line too long for read_data mpiio
+
+A line of a data file section is longer than the maximum line length
+LAMMPS allows for data files.
+
+*/
@@ -173,6 +173,54 @@ void RestartMPIIO::read(MPI_Offset chunkOffset, bigint chunkSize, double *buf)
   }
 }
 
+/* ----------------------------------------------------------------------
+   read N non-contiguous chunks into buf via a single collective MPI-IO call
+   offsets = byte offset of each chunk relative to headerOffset, ascending
+   sizes = # of doubles in each chunk, chunks are stored consecutively in buf
+   an hindexed file view lets MPI_File_read_all aggregate the requests
+------------------------------------------------------------------------- */
+
+void RestartMPIIO::read_chunks(MPI_Offset headerOffset, int n,
+                               MPI_Offset *offsets, int *sizes, double *buf)
+{
+  bigint total = 0;
+  for (int i = 0; i < n; i++) total += sizes[i];
+  if (total > INT_MAX)
+    error->one(FLERR,"Too much restart data for one proc to read via MPI-IO");
+
+  MPI_Aint *displs = new MPI_Aint[n+1];
+  int *blocklens = new int[n+1];
+  for (int i = 0; i < n; i++) {
+    displs[i] = (MPI_Aint) offsets[i];
+    blocklens[i] = sizes[i];
+  }
+
+  MPI_Datatype filetype;
+  MPI_Type_create_hindexed(n,blocklens,displs,MPI_DOUBLE,&filetype);
+  MPI_Type_commit(&filetype);
+
+  int err = MPI_File_set_view(mpifh,headerOffset,MPI_DOUBLE,filetype,
+                              (char *) "native",MPI_INFO_NULL);
+  if (err == MPI_SUCCESS)
+    err = MPI_File_read_all(mpifh,buf,(int) total,MPI_DOUBLE,
+                            MPI_STATUS_IGNORE);
+  if (err != MPI_SUCCESS) {
+    char str[MPI_MAX_ERROR_STRING+128];
+    char mpiErrorString[MPI_MAX_ERROR_STRING];
+    int mpiErrorStringLength;
+    MPI_Error_string(err, mpiErrorString, &mpiErrorStringLength);
+    sprintf(str,"Cannot read from restart file - MPI error: %s",
+            mpiErrorString);
+    error->one(FLERR,str);
+  }
+
+  MPI_File_set_view(mpifh,0,MPI_BYTE,MPI_BYTE,(char *) "native",
+                    MPI_INFO_NULL);
+  MPI_Type_free(&filetype);
+  delete [] displs;
+  delete [] blocklens;
+}
+
 /* ----------------------------------------------------------------------
    calls MPI_File_close
 ------------------------------------------------------------------------- */
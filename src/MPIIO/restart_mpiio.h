@@ -32,6 +32,7 @@ class RestartMPIIO  : protected Pointers {
   void openForWrite(char *);
   void write(MPI_Offset, int, double *);
   void read(MPI_Offset, bigint, double *);
+  void read_chunks(MPI_Offset, int, MPI_Offset *, int *, double *);
   void close();
 };
 
@@ -66,6 +67,12 @@ E: Cannot read from restart file - MPI error: %s
 This error was generated by MPI when reading/writing an MPI-IO restart
 file.
 
+E: Too much restart data for one proc to read via MPI-IO
+
+The chunks of an MPI-IO restart file that overlap this proc's
+sub-domain hold more than 2^31 values.  Read the file on more
+processors.
+
 E: Cannot close restart file - MPI error: %s
 
 This error was generated by MPI when reading/writing an MPI-IO restart
@@ -83,7 +83,7 @@ void AtomVecPeri::grow(int n)
   image = memory->grow(atom->image,nmax,"atom:image");
   x = memory->grow(atom->x,nmax,3,"atom:x");
   v = memory->grow(atom->v,nmax,3,"atom:v");
-  f = memory->grow(atom->f,nmax*comm->nthreads,3,"atom:f");
+  f = memory->grow(atom->f,nmax*nthreads_f(),3,"atom:f");
 
   vfrac = memory->grow(atom->vfrac,nmax,"atom:vfrac");
   rmass = memory->grow(atom->rmass,nmax,"atom:rmass");
@@ -948,7 +948,7 @@ bigint AtomVecPeri::memory_usage()
   if (atom->memcheck("image")) bytes += memory->usage(image,nmax);
   if (atom->memcheck("x")) bytes += memory->usage(x,nmax,3);
   if (atom->memcheck("v")) bytes += memory->usage(v,nmax,3);
-  if (atom->memcheck("f")) bytes += memory->usage(f,nmax*comm->nthreads,3);
+  if (atom->memcheck("f")) bytes += memory->usage(f,nmax*nthreads_f(),3);
 
   if (atom->memcheck("vfrac")) bytes += memory->usage(vfrac,nmax);
   if (atom->memcheck("rmass")) bytes += memory->usage(rmass,nmax);
@@ -41,10 +41,6 @@ using namespace LAMMPS_NS;
 using namespace FixConst;
 using namespace MathConst;
 
-// allocate space for static class variable
-
-FixRigidSmall *FixRigidSmall::frsptr;
-
 #define MAXLINE 256
 #define CHUNK 1024
 #define ATTRIBUTE_PERBODY 11
@@ -1379,7 +1375,6 @@ void FixRigidSmall::set_v()
 void FixRigidSmall::create_bodies()
 {
   int i,m,n;
-  double unwrap[3];
 
   // error check on image flags of atoms in rigid bodies
 
@@ -1405,139 +1400,53 @@ void FixRigidSmall::create_bodies()
   if (flagall) error->all(FLERR,"Fix rigid/small atom has non-zero image flag "
                           "in a non-periodic dimension");
 
-  // allocate buffer for passing messages around ring of procs
-  // percount = max number of values to put in buffer for each of ncount
+  // send each atom in a rigid body to rendezvous proc = body ID % P
+  // datum = owning proc, local index, atom ID, body ID, unwrapped coords
 
   int ncount = 0;
   for (i = 0; i < nlocal; i++)
     if (mask[i] & groupbit) ncount++;
 
-  int percount = 5;
-  double *buf;
-  memory->create(buf,ncount*percount,"rigid/small:buf");
-
-  // create map hash for storing unique molecule IDs of my atoms
-  // key = molecule ID
-  // value = index into per-body data structure
-  // n = # of entries in hash
-
-  hash = new std::map<tagint,int>();
-  hash->clear();
-
-  // setup hash
-  // key = body ID
-  // value = index into N-length data structure
-  // n = count of unique bodies my atoms are part of
+  int *proclist;
+  memory->create(proclist,ncount,"rigid/small:proclist");
+  InRvous *inbuf = (InRvous *)
+    memory->smalloc((bigint) ncount*sizeof(InRvous),"rigid/small:inbuf");
 
+  tagint *tag = atom->tag;
   tagint *molecule = atom->molecule;
-
-  n = 0;
-  for (i = 0; i < nlocal; i++) {
-    if (!(mask[i] & groupbit)) continue;
-    if (hash->find(molecule[i]) == hash->end()) (*hash)[molecule[i]] = n++;
-  }
-
-  // bbox = bounding box of each rigid body my atoms are part of
-
-  memory->create(bbox,n,6,"rigid/small:bbox");
-
-  for (i = 0; i < n; i++) {
-    bbox[i][0] = bbox[i][2] = bbox[i][4] = BIG;
-    bbox[i][1] = bbox[i][3] = bbox[i][5] = -BIG;
-  }
-
-  // pack my atoms into buffer as molecule ID, unwrapped coords
-
   double **x = atom->x;
+  int me = comm->me;
+  int nprocs = comm->nprocs;
 
   m = 0;
   for (i = 0; i < nlocal; i++) {
     if (!(mask[i] & groupbit)) continue;
-    domain->unmap(x[i],image[i],unwrap);
-    buf[m++] = molecule[i];
-    buf[m++] = unwrap[0];
-    buf[m++] = unwrap[1];
-    buf[m++] = unwrap[2];
+    proclist[m] = molecule[i] % nprocs;
+    inbuf[m].me = me;
+    inbuf[m].ilocal = i;
+    inbuf[m].atomID = tag[i];
+    inbuf[m].bodyID = molecule[i];
+    domain->unmap(x[i],image[i],inbuf[m].x);
+    m++;
   }
 
-  // pass buffer around ring of procs
-  // func = update bbox with atom coords from every proc
-  // when done, have full bbox for every rigid body my atoms are part of
-
-  frsptr = this;
-  comm->ring(m,sizeof(double),buf,1,ring_bbox,NULL);
-
-  // ctr = center pt of each rigid body my atoms are part of
+  // rendezvous procs assign each body an owning atom and compute rsqfar
+  // outbuf = bodytag for each of my atoms in a rigid body
 
-  memory->create(ctr,n,6,"rigid/small:bbox");
-
-  for (i = 0; i < n; i++) {
-    ctr[i][0] = 0.5 * (bbox[i][0] + bbox[i][1]);
-    ctr[i][1] = 0.5 * (bbox[i][2] + bbox[i][3]);
-    ctr[i][2] = 0.5 * (bbox[i][4] + bbox[i][5]);
-  }
-
-  // idclose = ID of atom in body closest to center pt (smaller ID if tied)
-  // rsqclose = distance squared from idclose to center pt
-
-  memory->create(idclose,n,"rigid/small:idclose");
-  memory->create(rsqclose,n,"rigid/small:rsqclose");
-
-  for (i = 0; i < n; i++) rsqclose[i] = BIG;
-
-  // pack my atoms into buffer as molecule ID, atom ID, unwrapped coords
-
-  tagint *tag = atom->tag;
-
-  m = 0;
-  for (i = 0; i < nlocal; i++) {
-    if (!(mask[i] & groupbit)) continue;
-    domain->unmap(x[i],image[i],unwrap);
-    buf[m++] = molecule[i];
-    buf[m++] = ubuf(tag[i]).d;
-    buf[m++] = unwrap[0];
-    buf[m++] = unwrap[1];
-    buf[m++] = unwrap[2];
-  }
-
-  // pass buffer around ring of procs
-  // func = update idclose,rsqclose with atom IDs from every proc
-  // when done, have idclose for every rigid body my atoms are part of
-
-  frsptr = this;
-  comm->ring(m,sizeof(double),buf,2,ring_nearest,NULL);
-
-  // set bodytag of all owned atoms, based on idclose
-  // find max value of rsqclose across all procs
-
-  double rsqmax = 0.0;
-  for (i = 0; i < nlocal; i++) {
-    bodytag[i] = 0;
-    if (!(mask[i] & groupbit)) continue;
-    m = hash->find(molecule[i])->second;
-    bodytag[i] = idclose[m];
-    rsqmax = MAX(rsqmax,rsqclose[m]);
-  }
+  rsqfar = 0.0;
 
-  // pack my atoms into buffer as bodytag of owning atom, unwrapped coords
+  char *buf;
+  n = comm->rendezvous(ncount,proclist,(char *) inbuf,sizeof(InRvous),
+                       rendezvous_body,buf,sizeof(OutRvous),(void *) this);
+  OutRvous *outbuf = (OutRvous *) buf;
 
-  m = 0;
-  for (i = 0; i < nlocal; i++) {
-    if (!(mask[i] & groupbit)) continue;
-    domain->unmap(x[i],image[i],unwrap);
-    buf[m++] = ubuf(bodytag[i]).d;
-    buf[m++] = unwrap[0];
-    buf[m++] = unwrap[1];
-    buf[m++] = unwrap[2];
-  }
+  memory->destroy(proclist);
+  memory->sfree(inbuf);
 
-  // pass buffer around ring of procs
-  // func = update rsqfar for atoms belonging to bodies I own
-  // when done, have rsqfar for all atoms in bodies I own
+  for (i = 0; i < nlocal; i++) bodytag[i] = 0;
+  for (m = 0; m < n; m++) bodytag[outbuf[m].ilocal] = outbuf[m].atomID;
 
-  rsqfar = 0.0;
-  frsptr = this;
-  comm->ring(m,sizeof(double),buf,3,ring_farthest,NULL);
+  memory->sfree(outbuf);
 
   // find maxextent of rsqfar across all procs
   // if defined, include molecule->maxextent
@@ -1548,122 +1457,117 @@ void FixRigidSmall::create_bodies()
     for (int i = 0; i < nmol; i++)
       maxextent = MAX(maxextent,onemols[i]->maxextent);
   }
-
-  // clean up
-
-  delete hash;
-  memory->destroy(buf);
-  memory->destroy(bbox);
-  memory->destroy(ctr);
-  memory->destroy(idclose);
-  memory->destroy(rsqclose);
 }
 
 /* ----------------------------------------------------------------------
-   process rigid body atoms from another proc
-   update bounding box for rigid bodies my atoms are part of
+   callback from comm->rendezvous() in create_bodies()
+   inbuf = list of N atoms from all procs, all bodies on this proc are complete
+   for each body: bbox center, owning atom = atom closest to center
+     (smaller ID if tied), rsqfar = max dist from owning atom to body atoms
+   return bodytag to proc owning each atom
 ------------------------------------------------------------------------- */
 
-void FixRigidSmall::ring_bbox(int n, char *cbuf)
+int FixRigidSmall::rendezvous_body(int n, char *inbuf,
+                                   int *&procs, char *&outbuf, void *ptr)
 {
-  std::map<tagint,int> *hash = frsptr->hash;
-  double **bbox = frsptr->bbox;
+  int i,m;
+  double delx,dely,delz,rsq;
 
-  double *buf = (double *) cbuf;
-  int ndatums = n/4;
+  FixRigidSmall *frsptr = (FixRigidSmall *) ptr;
+  Memory *memory = frsptr->memory;
 
-  int j,imol;
-  double *x;
+  InRvous *in = (InRvous *) inbuf;
 
-  int m = 0;
-  for (int i = 0; i < ndatums; i++, m += 4) {
-    imol = static_cast<int> (buf[m]);
-    if (hash->find(imol) != hash->end()) {
-      j = hash->find(imol)->second;
-      x = &buf[m+1];
-      bbox[j][0] = MIN(bbox[j][0],x[0]);
-      bbox[j][1] = MAX(bbox[j][1],x[0]);
-      bbox[j][2] = MIN(bbox[j][2],x[1]);
-      bbox[j][3] = MAX(bbox[j][3],x[1]);
-      bbox[j][4] = MIN(bbox[j][4],x[2]);
-      bbox[j][5] = MAX(bbox[j][5],x[2]);
-    }
-  }
-}
+  // hash = unique body IDs in my list of atoms
+  // value = index into per-body data structures
 
-/* ----------------------------------------------------------------------
-   process rigid body atoms from another proc
-   update nearest atom to body center for rigid bodies my atoms are part of
-------------------------------------------------------------------------- */
+  std::map<tagint,int> hash;
+  std::map<tagint,int>::iterator pos;
 
-void FixRigidSmall::ring_nearest(int n, char *cbuf)
-{
-  std::map<tagint,int> *hash = frsptr->hash;
-  double **ctr = frsptr->ctr;
-  tagint *idclose = frsptr->idclose;
-  double *rsqclose = frsptr->rsqclose;
+  int nbody = 0;
+  for (i = 0; i < n; i++)
+    if (hash.find(in[i].bodyID) == hash.end()) hash[in[i].bodyID] = nbody++;
 
-  double *buf = (double *) cbuf;
-  int ndatums = n/5;
+  // bbox = bounding box of each rigid body
+
+  double **bbox;
+  memory->create(bbox,nbody,6,"rigid/small:bbox");
+
+  for (m = 0; m < nbody; m++) {
+    bbox[m][0] = bbox[m][2] = bbox[m][4] = BIG;
+    bbox[m][1] = bbox[m][3] = bbox[m][5] = -BIG;
+  }
 
-  int j,imol;
-  tagint tag;
-  double delx,dely,delz,rsq;
   double *x;
+  for (i = 0; i < n; i++) {
+    m = hash.find(in[i].bodyID)->second;
+    x = in[i].x;
+    bbox[m][0] = MIN(bbox[m][0],x[0]);
+    bbox[m][1] = MAX(bbox[m][1],x[0]);
+    bbox[m][2] = MIN(bbox[m][2],x[1]);
+    bbox[m][3] = MAX(bbox[m][3],x[1]);
+    bbox[m][4] = MIN(bbox[m][4],x[2]);
+    bbox[m][5] = MAX(bbox[m][5],x[2]);
+  }
 
-  int m = 0;
-  for (int i = 0; i < ndatums; i++, m += 5) {
-    imol = static_cast<int> (buf[m]);
-    if (hash->find(imol) != hash->end()) {
-      j = hash->find(imol)->second;
-      tag = (tagint) ubuf(buf[m+1]).i;
-      x = &buf[m+2];
-      delx = x[0] - ctr[j][0];
-      dely = x[1] - ctr[j][1];
-      delz = x[2] - ctr[j][2];
-      rsq = delx*delx + dely*dely + delz*delz;
-      if (rsq <= rsqclose[j]) {
-        if (rsq == rsqclose[j] && tag > idclose[j]) continue;
-        idclose[j] = tag;
-        rsqclose[j] = rsq;
-      }
+  // iclose = index of atom in body closest to center pt (smaller ID if tied)
+  // rsqclose = distance squared from iclose to center pt
+
+  int *iclose;
+  double *rsqclose;
+  memory->create(iclose,nbody,"rigid/small:iclose");
+  memory->create(rsqclose,nbody,"rigid/small:rsqclose");
+
+  for (m = 0; m < nbody; m++) rsqclose[m] = BIG;
+
+  for (i = 0; i < n; i++) {
+    m = hash.find(in[i].bodyID)->second;
+    x = in[i].x;
+    delx = x[0] - 0.5*(bbox[m][0] + bbox[m][1]);
+    dely = x[1] - 0.5*(bbox[m][2] + bbox[m][3]);
+    delz = x[2] - 0.5*(bbox[m][4] + bbox[m][5]);
+    rsq = delx*delx + dely*dely + delz*delz;
+    if (rsq <= rsqclose[m]) {
+      if (rsq == rsqclose[m] && in[i].atomID > in[iclose[m]].atomID) continue;
+      iclose[m] = i;
+      rsqclose[m] = rsq;
     }
   }
-}
-
-/* ----------------------------------------------------------------------
-   process rigid body atoms from another proc
-   update rsqfar = distance from owning atom to other atom
-------------------------------------------------------------------------- */
 
-void FixRigidSmall::ring_farthest(int n, char *cbuf)
-{
-  double **x = frsptr->atom->x;
-  imageint *image = frsptr->atom->image;
-  int nlocal = frsptr->atom->nlocal;
+  // set bodytag of all atoms and rsqfar from owning atom to each atom
 
-  double *buf = (double *) cbuf;
-  int ndatums = n/4;
+  memory->create(procs,n,"rigid/small:procs");
+  OutRvous *out = (OutRvous *)
+    memory->smalloc((bigint) n*sizeof(OutRvous),"rigid/small:outbuf");
 
-  int iowner;
-  tagint tag;
-  double delx,dely,delz,rsq;
-  double *xx;
-  double unwrap[3];
+  double rsqfar = frsptr->rsqfar;
+  double *xown;
 
-  int m = 0;
-  for (int i = 0; i < ndatums; i++, m += 4) {
-    tag = (tagint) ubuf(buf[m]).i;
-    iowner = frsptr->atom->map(tag);
-    if (iowner < 0 || iowner >= nlocal) continue;
-    frsptr->domain->unmap(x[iowner],image[iowner],unwrap);
-    xx = &buf[m+1];
-    delx = xx[0] - unwrap[0];
-    dely = xx[1] - unwrap[1];
-    delz = xx[2] - unwrap[2];
+  for (i = 0; i < n; i++) {
+    m = hash.find(in[i].bodyID)->second;
+    x = in[i].x;
+    xown = in[iclose[m]].x;
+    delx = x[0] - xown[0];
+    dely = x[1] - xown[1];
+    delz = x[2] - xown[2];
     rsq = delx*delx + dely*dely + delz*delz;
-    frsptr->rsqfar = MAX(frsptr->rsqfar,rsq);
+    rsqfar = MAX(rsqfar,rsq);
+
+    procs[i] = in[i].me;
+    out[i].ilocal = in[i].ilocal;
+    out[i].atomID = in[iclose[m]].atomID;
   }
+
+  frsptr->rsqfar = rsqfar;
+
+  // clean up
+
+  memory->destroy(bbox);
+  memory->destroy(iclose);
+  memory->destroy(rsqclose);
+
+  outbuf = (char *) out;
+  return n;
 }
 
 /* ----------------------------------------------------------------------
@@ -29,10 +29,6 @@ namespace LAMMPS_NS {
 
 class FixRigidSmall : public Fix {
  public:
-  // static variable for ring communication callback to access class data
-
-  static FixRigidSmall *frsptr;
-
   FixRigidSmall(class LAMMPS *, int, char **);
   virtual ~FixRigidSmall();
   virtual int setmask();
@@ -173,13 +169,21 @@ class FixRigidSmall : public Fix {
   class Molecule **onemols;
   int nmol;
 
-  // class data used by ring communication callbacks
+  std::map<tagint,int> *hash;     // mol ID -> local body, used by readfile()
+
+  // rendezvous datums for create_bodies()
+
+  struct InRvous {
+    int me,ilocal;
+    tagint atomID,bodyID;
+    double x[3];
+  };
+
+  struct OutRvous {
+    int ilocal;
+    tagint atomID;
+  };
 
-  std::map<tagint,int> *hash;
-  double **bbox;
-  double **ctr;
-  tagint *idclose;
-  double *rsqclose;
   double rsqfar;
 
   void set_xv();
@@ -191,11 +195,9 @@ class FixRigidSmall : public Fix {
   void grow_body();
   void reset_atom2body();
 
-  // callback functions for ring communication
+  // callback function for rendezvous communication
 
-  static void ring_bbox(int, char *);
-  static void ring_nearest(int, char *);
-  static void ring_farthest(int, char *);
+  static int rendezvous_body(int, char *, int *&, char *&, void *);
 
   // debug
 
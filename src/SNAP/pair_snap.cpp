@@ -84,6 +84,8 @@ PairSNAP::PairSNAP(LAMMPS *lmp) : Pair(lmp)
   i_zarray_i =NULL;
 
   use_shared_arrays = 0;
+  use_adjoint = 0;
+  beta = NULL;
 
 #ifdef TIMING_INFO
   timers[0] = 0;
@@ -138,6 +140,7 @@ PairSNAP::~PairSNAP()
     for (int tid = 0; tid<nthreads; tid++)
       delete sna[tid];
     delete [] sna;
+    memory->destroy(beta);
 
   }
 
@@ -236,33 +239,40 @@ void PairSNAP::compute_regular(int eflag, int vflag)
       snaptr->copy_bi2bvec();
     }
 
+    double* coeffi = coeffelem[ielem];
+
+    // compute Yi for atom I, if forces use it
+
+    if (use_adjoint) compute_yi_atom(snaptr,coeffi,beta[0]);
+
     // for neighbors of I within cutoff:
-    // compute dUi/drj and dBi/drj
+    // compute dUi/drj and dBi/drj, or dEi/drj from Yi
     // Fij = dEi/dRj = -dEi/dRi => add to Fi, subtract from Fj
 
-    double* coeffi = coeffelem[ielem];
-
     for (int jj = 0; jj < ninside; jj++) {
       int j = snaptr->inside[jj];
       snaptr->compute_duidrj(snaptr->rij[jj],
 			     snaptr->wj[jj],snaptr->rcutij[jj]);
 
-      snaptr->compute_dbidrj();
-      snaptr->copy_dbi2dbvec();
-
-      fij[0] = 0.0;
-      fij[1] = 0.0;
-      fij[2] = 0.0;
-
-      for (int k = 1; k <= ncoeff; k++) {
-	double bgb;
-	if (gammaoneflag) 
-	  bgb = coeffi[k];
-	else bgb = coeffi[k]*
-	       gamma*pow(snaptr->bvec[k-1],gamma-1.0);
-	fij[0] += bgb*snaptr->dbvec[k-1][0];
-	fij[1] += bgb*snaptr->dbvec[k-1][1];
-	fij[2] += bgb*snaptr->dbvec[k-1][2];
+      if (use_adjoint) snaptr->compute_deidrj(fij);
+      else {
+	snaptr->compute_dbidrj();
+	snaptr->copy_dbi2dbvec();
+
+	fij[0] = 0.0;
+	fij[1] = 0.0;
+	fij[2] = 0.0;
+
+	for (int k = 1; k <= ncoeff; k++) {
+	  double bgb;
+	  if (gammaoneflag) 
+	    bgb = coeffi[k];
+	  else bgb = coeffi[k]*
+		 gamma*pow(snaptr->bvec[k-1],gamma-1.0);
+	  fij[0] += bgb*snaptr->dbvec[k-1][0];
+	  fij[1] += bgb*snaptr->dbvec[k-1][1];
+	  fij[2] += bgb*snaptr->dbvec[k-1][2];
+	}
       }
 
       f[i][0] += fij[0];
@@ -481,6 +491,13 @@ void PairSNAP::compute_optimized(int eflag, int vflag)
         if (iold != i) {
           set_sna_to_shared(tid,i_pairs[iijj][3]);
 	  ielem = map[type[i]];
+	  if (use_adjoint) {
+	    if (!gammaoneflag) {
+	      sna[tid]->compute_bi();
+	      sna[tid]->copy_bi2bvec();
+	    }
+	    compute_yi_atom(sna[tid],coeffelem[ielem],beta[tid]);
+	  }
 	}
         iold = i;
       } else {
@@ -542,6 +559,16 @@ void PairSNAP::compute_optimized(int eflag, int vflag)
 
           sna[tid]->compute_ui(ninside); //unitialised
           sna[tid]->compute_zi();
+
+          // compute Yi for atom I, if forces use it
+
+          if (use_adjoint) {
+            if (!gammaoneflag) {
+              sna[tid]->compute_bi();
+              sna[tid]->copy_bi2bvec();
+            }
+            compute_yi_atom(sna[tid],coeffelem[ielem],beta[tid]);
+          }
         }
       }
 
@@ -559,26 +586,29 @@ void PairSNAP::compute_optimized(int eflag, int vflag)
         sna[tid]->compute_duidrj(sna[tid]->rij[jj],
 				 sna[tid]->wj[jj],sna[tid]->rcutij[jj]);
 
-        sna[tid]->compute_dbidrj();
-        sna[tid]->copy_dbi2dbvec();
-	if (!gammaoneflag) {
-	  sna[tid]->compute_bi();
-	  sna[tid]->copy_bi2bvec();
-	}
-
-        fij[0] = 0.0;
-        fij[1] = 0.0;
-        fij[2] = 0.0;
+        if (use_adjoint) sna[tid]->compute_deidrj(fij);
+        else {
+          sna[tid]->compute_dbidrj();
+          sna[tid]->copy_dbi2dbvec();
+          if (!gammaoneflag) {
+            sna[tid]->compute_bi();
+            sna[tid]->copy_bi2bvec();
+          }
 
-        for (k = 1; k <= ncoeff; k++) {
-	  double bgb;
-	  if (gammaoneflag) 
-	    bgb = coeffi[k];
-	  else bgb = coeffi[k]*
-		 gamma*pow(sna[tid]->bvec[k-1],gamma-1.0);
-	  fij[0] += bgb*sna[tid]->dbvec[k-1][0];
-	  fij[1] += bgb*sna[tid]->dbvec[k-1][1];
-	  fij[2] += bgb*sna[tid]->dbvec[k-1][2];
+          fij[0] = 0.0;
+          fij[1] = 0.0;
+          fij[2] = 0.0;
+
+          for (k = 1; k <= ncoeff; k++) {
+            double bgb;
+            if (gammaoneflag) 
+              bgb = coeffi[k];
+            else bgb = coeffi[k]*
+                   gamma*pow(sna[tid]->bvec[k-1],gamma-1.0);
+            fij[0] += bgb*sna[tid]->dbvec[k-1][0];
+            fij[1] += bgb*sna[tid]->dbvec[k-1][1];
+            fij[2] += bgb*sna[tid]->dbvec[k-1][2];
+          }
         }
 
 #if defined(_OPENMP)
@@ -633,6 +663,24 @@ void PairSNAP::compute_optimized(int eflag, int vflag)
 
 }
 
+/* ----------------------------------------------------------------------
+   compute Yi of atom I from its Zi and beta_k = dEi/dBi_k
+   requires bvec of atom I if gamma != 1
+------------------------------------------------------------------------- */
+
+void PairSNAP::compute_yi_atom(SNA *snaptr, double *coeffi, double *betai)
+{
+  for (int k = 1; k <= ncoeff; k++) {
+    if (gammaoneflag)
+      betai[k-1] = coeffi[k];
+    else betai[k-1] = coeffi[k]*
+           gamma*pow(snaptr->bvec[k-1],gamma-1.0);
+  }
+  snaptr->compute_yi(betai);
+}
+
+/* ---------------------------------------------------------------------- */
+
 inline int PairSNAP::equal(double* x,double* y)
 {
   double dist2 =
@@ -1235,6 +1283,7 @@ void PairSNAP::settings(int narg, char **arg)
   use_shared_arrays=-1;
   do_load_balance = 0;
   use_optimized = 1;
+  use_adjoint = 0;
 
   // optional arguments
 
@@ -1255,6 +1304,10 @@ void PairSNAP::settings(int narg, char **arg)
       use_optimized=force->inumeric(FLERR,arg[++i]);
       continue;
     }
+    if (strcmp(arg[i],"adjoint")==0) {
+      use_adjoint=force->inumeric(FLERR,arg[++i]);
+      continue;
+    }
     if (strcmp(arg[i],"shared")==0) {
       use_shared_arrays=force->inumeric(FLERR,arg[++i]);
       continue;
@@ -1429,6 +1482,9 @@ void PairSNAP::coeff(int narg, char **arg)
       sna[tid]->grow_rij(nmax);
   }
 
+  memory->destroy(beta);
+  memory->create(beta,nthreads,ncoeff,"pair:beta");
+
   if (ncoeff != sna[0]->ncoeff) {
     printf("ncoeff = %d snancoeff = %d \n",ncoeff,sna[0]->ncoeff);
     error->all(FLERR,"Incorrect SNAP parameter file");
@@ -1735,6 +1791,7 @@ double PairSNAP::memory_usage()
   bytes += nmax*sizeof(int);
   bytes += (2*ncoeff+1)*sizeof(double);
   bytes += (ncoeff*3)*sizeof(double);
+  if (use_adjoint) bytes += nthreads*ncoeff*sizeof(double);
   bytes += sna[0]->memory_usage()*nthreads;
   return bytes;
 }
@@ -51,6 +51,7 @@ protected:
   void load_balance();
   void set_sna_to_shared(int snaid,int i);
   void build_per_atom_arrays();
+  void compute_yi_atom(class SNA *, double *, double *);
 
   int schedule_user;
   double schedule_time_guided;
@@ -72,6 +73,8 @@ protected:
 
   int use_optimized;
   int use_shared_arrays;
+  int use_adjoint;              // 1 if forces use Yi instead of dBi/dRj
+  double **beta;                // per-thread dEi/dBi
 
   int i_max;
   int i_neighmax;
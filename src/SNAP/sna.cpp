@@ -1031,6 +1031,172 @@ void SNA::compute_dbidrj()
 
 }
 
+/* ----------------------------------------------------------------------
+   compute Yi, the sum over bispectrum components k of beta_k times
+   the Zi elements that dBi_k/dRj contracts with dUi/dRj, so that
+   dEi/dRj = sum_k beta_k dBi_k/dRj = 2*sum_j Conj(dudr(j))*y(j)
+   beta is ordered like bvec, which is the order of idxj
+------------------------------------------------------------------------- */
+
+void SNA::compute_yi(double* beta)
+{
+  // for j = 0,...,twojmax
+  //   y(j,ma,mb) = 0
+  // for j1 = 0,...,twojmax
+  //   for j2 = 0,twojmax
+  //     for j = |j1-j2|,Min(twojmax,j1+j2),2
+  //        y(j,ma,mb) += beta(j1,j2,j)*z(j1,j2,j,ma,mb)
+  //        y(j1,ma1,mb1) += beta(j1,j2,j)*z(j,j2,j1,ma1,mb1)*(j+1)/(j1+1)
+  //        y(j2,ma2,mb2) += beta(j1,j2,j)*z(j1,j,j2,ma2,mb2)*(j+1)/(j2+1)
+
+  double** jjjzarray_r;
+  double** jjjzarray_i;
+
+  for(int j = 0; j <= twojmax; j++)
+    for(int mb = 0; 2*mb <= j; mb++)
+      for(int ma = 0; ma <= j; ma++) {
+        yarray_r[j][ma][mb] = 0.0;
+        yarray_i[j][ma][mb] = 0.0;
+      }
+
+  for(int JJ = 0; JJ < idxj_max; JJ++) {
+    const int j1 = idxj[JJ].j1;
+    const int j2 = idxj[JJ].j2;
+    const int j = idxj[JJ].j;
+    const double betaj = beta[JJ];
+
+    // y(j) += beta*z(j1,j2,j), use zarray j1/j2 symmetry
+
+    if (j1 >= j2) {
+      jjjzarray_r = zarray_r[j1][j2][j];
+      jjjzarray_i = zarray_i[j1][j2][j];
+    } else {
+      jjjzarray_r = zarray_r[j2][j1][j];
+      jjjzarray_i = zarray_i[j2][j1][j];
+    }
+
+    for(int mb = 0; 2*mb <= j; mb++)
+      for(int ma = 0; ma <= j; ma++) {
+        yarray_r[j][ma][mb] += betaj * jjjzarray_r[ma][mb];
+        yarray_i[j][ma][mb] += betaj * jjjzarray_i[ma][mb];
+      }
+
+    // y(j1) += beta*z(j,j2,j1)*(j+1)/(j1+1)
+
+    double j1fac = betaj*(j+1)/(j1+1.0);
+
+    if (j >= j2) {
+      jjjzarray_r = zarray_r[j][j2][j1];
+      jjjzarray_i = zarray_i[j][j2][j1];
+    } else {
+      jjjzarray_r = zarray_r[j2][j][j1];
+      jjjzarray_i = zarray_i[j2][j][j1];
+    }
+
+    for(int mb1 = 0; 2*mb1 <= j1; mb1++)
+      for(int ma1 = 0; ma1 <= j1; ma1++) {
+        yarray_r[j1][ma1][mb1] += j1fac * jjjzarray_r[ma1][mb1];
+        yarray_i[j1][ma1][mb1] += j1fac * jjjzarray_i[ma1][mb1];
+      }
+
+    // y(j2) += beta*z(j1,j,j2)*(j+1)/(j2+1)
+
+    double j2fac = betaj*(j+1)/(j2+1.0);
+
+    if (j1 >= j) {
+      jjjzarray_r = zarray_r[j1][j][j2];
+      jjjzarray_i = zarray_i[j1][j][j2];
+    } else {
+      jjjzarray_r = zarray_r[j][j1][j2];
+      jjjzarray_i = zarray_i[j][j1][j2];
+    }
+
+    for(int mb2 = 0; 2*mb2 <= j2; mb2++)
+      for(int ma2 = 0; ma2 <= j2; ma2++) {
+        yarray_r[j2][ma2][mb2] += j2fac * jjjzarray_r[ma2][mb2];
+        yarray_i[j2][ma2][mb2] += j2fac * jjjzarray_i[ma2][mb2];
+      }
+
+  } //end loop over j1 j2 j
+}
+
+/* ----------------------------------------------------------------------
+   compute dEi/dRj by contracting dUi/dRj with Yi
+   requires compute_yi() for atom I and compute_duidrj() for neighbor j
+------------------------------------------------------------------------- */
+
+void SNA::compute_deidrj(double* dedr)
+{
+  // dedr = 0
+  // for j = 0,...,twojmax
+  //   for mb = 0,...,jmid
+  //     for ma = 0,...,j
+  //       dedr += 2*Conj(dudr(j,ma,mb))*y(j,ma,mb)
+
+  double* dudr_r, *dudr_i;
+  double jjjmambyarray_r;
+  double jjjmambyarray_i;
+
+#ifdef TIMING_INFO
+  clock_gettime(CLOCK_REALTIME, &starttime);
+#endif
+
+  for(int k = 0; k < 3; k++)
+    dedr[k] = 0.0;
+
+  for(int j = 0; j <= twojmax; j++) {
+
+    for(int mb = 0; 2*mb < j; mb++)
+      for(int ma = 0; ma <= j; ma++) {
+
+        dudr_r = duarray_r[j][ma][mb];
+        dudr_i = duarray_i[j][ma][mb];
+        jjjmambyarray_r = yarray_r[j][ma][mb];
+        jjjmambyarray_i = yarray_i[j][ma][mb];
+        for(int k = 0; k < 3; k++)
+          dedr[k] +=
+            dudr_r[k] * jjjmambyarray_r +
+            dudr_i[k] * jjjmambyarray_i;
+
+      } //end loop over ma mb
+
+    // For j even, handle middle column
+
+    if (j%2 == 0) {
+      int mb = j/2;
+      for(int ma = 0; ma < mb; ma++) {
+        dudr_r = duarray_r[j][ma][mb];
+        dudr_i = duarray_i[j][ma][mb];
+        jjjmambyarray_r = yarray_r[j][ma][mb];
+        jjjmambyarray_i = yarray_i[j][ma][mb];
+        for(int k = 0; k < 3; k++)
+          dedr[k] +=
+            dudr_r[k] * jjjmambyarray_r +
+            dudr_i[k] * jjjmambyarray_i;
+      }
+      int ma = mb;
+      dudr_r = duarray_r[j][ma][mb];
+      dudr_i = duarray_i[j][ma][mb];
+      jjjmambyarray_r = yarray_r[j][ma][mb];
+      jjjmambyarray_i = yarray_i[j][ma][mb];
+      for(int k = 0; k < 3; k++)
+        dedr[k] +=
+          (dudr_r[k] * jjjmambyarray_r +
+           dudr_i[k] * jjjmambyarray_i)*0.5;
+    } // end if jeven
+
+  } //end loop over j
+
+  for(int k = 0; k < 3; k++)
+    dedr[k] *= 2.0;
+
+#ifdef TIMING_INFO
+  clock_gettime(CLOCK_REALTIME, &endtime);
+  timers[4] += (endtime.tv_sec - starttime.tv_sec + 1.0 *
+                (endtime.tv_nsec - starttime.tv_nsec) / 1000000000);
+#endif
+}
+
 /* ----------------------------------------------------------------------
    copy Bi derivatives into a vector
 ------------------------------------------------------------------------- */
@@ -1484,6 +1650,7 @@ double SNA::memory_usage()
   bytes += jdim * jdim * jdim * 3 * sizeof(double);
   bytes += ncoeff * sizeof(double);
   bytes += jdim * jdim * jdim * jdim * jdim * sizeof(complex<double>);
+  bytes += jdim * jdim * jdim * sizeof(complex<double>);
   return bytes;
 }
 
@@ -1512,6 +1679,11 @@ void SNA::create_twojmax_arrays()
   memory->create(uarray_i, jdim, jdim, jdim,
                  "sna:uarray");
 
+  memory->create(yarray_r, jdim, jdim, jdim,
+                 "sna:yarray");
+  memory->create(yarray_i, jdim, jdim, jdim,
+                 "sna:yarray");
+
   if(!use_shared_arrays) {
     memory->create(uarraytot_r, jdim, jdim, jdim,
                    "sna:uarraytot");
@@ -1541,6 +1713,9 @@ void SNA::destroy_twojmax_arrays()
   memory->destroy(uarray_r);
   memory->destroy(uarray_i);
 
+  memory->destroy(yarray_r);
+  memory->destroy(yarray_i);
+
   if(!use_shared_arrays) {
     memory->destroy(uarraytot_r);
     memory->destroy(zarray_r);
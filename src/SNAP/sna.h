@@ -56,6 +56,11 @@ public:
   void compute_dbidrj();
   void compute_dbidrj_nonsymm();
   void copy_dbi2dbvec();
+
+  // functions for derivatives of a linear combination of Bi
+
+  void compute_yi(double*);
+  void compute_deidrj(double*);
   double compute_sfac(double, double);
   double compute_dsfac(double, double);
 
@@ -101,6 +106,10 @@ private:
   double**** duarray_r, **** duarray_i;
   double**** dbarray;
 
+  // adjoint of Zi weighted by coefficients of Bi
+
+  double*** yarray_r, *** yarray_i;
+
   void create_twojmax_arrays();
   void destroy_twojmax_arrays();
   void init_clebsch_gordan();
@@ -221,6 +221,39 @@ int MPI_Irecv(void *buf, int count, MPI_Datatype datatype,
 
 /* ---------------------------------------------------------------------- */
 
+int MPI_Send_init(void *buf, int count, MPI_Datatype datatype,
+                  int dest, int tag, MPI_Comm comm, MPI_Request *request)
+{
+  printf("MPI Stub WARNING: Should not send message to self\n");
+  return 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+int MPI_Recv_init(void *buf, int count, MPI_Datatype datatype,
+                  int source, int tag, MPI_Comm comm, MPI_Request *request)
+{
+  printf("MPI Stub WARNING: Should not recv message from self\n");
+  return 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+int MPI_Startall(int count, MPI_Request *request)
+{
+  printf("MPI Stub WARNING: Should not start message to self\n");
+  return 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+int MPI_Request_free(MPI_Request *request)
+{
+  return 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
 int MPI_Wait(MPI_Request *request, MPI_Status *status)
 {
   printf("MPI Stub WARNING: Should not wait on message from self\n");
@@ -371,6 +404,21 @@ int MPI_Type_contiguous(int count, MPI_Datatype oldtype,
 
 /* ---------------------------------------------------------------------- */
 
+/* store size of indexed datatype in extra lists, same as contiguous */
+
+int MPI_Type_create_indexed_block(int count, int blocklength, int *displs,
+                                  MPI_Datatype oldtype, MPI_Datatype *newtype)
+{
+  if (nextra_datatype == MAXEXTRA_DATATYPE) return -1;
+  ptr_datatype[nextra_datatype] = newtype;
+  index_datatype[nextra_datatype] = -(nextra_datatype + 1);
+  size_datatype[nextra_datatype] = count * blocklength * stubtypesize(oldtype);
+  nextra_datatype++;
+  return 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
 /* set value of user datatype to internal negative index, 
    based on match of ptr */
 
@@ -52,6 +52,7 @@ class ComputePressureCuda : public ComputePressure {
   ~ComputePressureCuda() {}
   double compute_scalar();
   void compute_vector();
+  int size_reduce(int) {return 0;}   // virial is summed on GPU
 
   private:
   class Cuda *cuda;
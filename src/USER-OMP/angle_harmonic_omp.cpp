@@ -38,6 +38,7 @@ AngleHarmonicOMP::AngleHarmonicOMP(class LAMMPS *lmp)
   : AngleHarmonic(lmp), ThrOMP(lmp,THR_ANGLE)
 {
   suffix_flag |= Suffix::OMP;
+  thr_owner = 1;
 }
 
 /* ---------------------------------------------------------------------- */
@@ -91,7 +92,9 @@ void AngleHarmonicOMP::eval(int nfrom, int nto, ThrData * const thr)
   double rsq1,rsq2,r1,r2,c,s,a,a11,a12,a22;
 
   const dbl3_t * _noalias const x = (dbl3_t *) atom->x[0];
-  dbl3_t * _noalias const f = (dbl3_t *) thr->get_f()[0];
+  const bool owner = use_owner_thr();
+  dbl3_t * _noalias const f = owner ? (dbl3_t *) atom->f[0]
+    : (dbl3_t *) thr->get_f()[0];
   const int4_t * _noalias const anglelist = (int4_t *) neighbor->anglelist[0];
   const int nlocal = atom->nlocal;
   eangle = 0.0;
@@ -154,21 +157,33 @@ void AngleHarmonicOMP::eval(int nfrom, int nto, ThrData * const thr)
     // apply force to each of 3 atoms
 
     if (NEWTON_BOND || i1 < nlocal) {
-      f[i1].x += f1[0];
-      f[i1].y += f1[1];
-      f[i1].z += f1[2];
+      if (owner && !thr->owns(i1))
+        thr->add_f(i1,f1[0],f1[1],f1[2]);
+      else {
+        f[i1].x += f1[0];
+        f[i1].y += f1[1];
+        f[i1].z += f1[2];
+      }
     }
 
     if (NEWTON_BOND || i2 < nlocal) {
-      f[i2].x -= f1[0] + f3[0];
-      f[i2].y -= f1[1] + f3[1];
-      f[i2].z -= f1[2] + f3[2];
+      if (owner && !thr->owns(i2))
+        thr->add_f(i2,-(f1[0] + f3[0]),-(f1[1] + f3[1]),-(f1[2] + f3[2]));
+      else {
+        f[i2].x -= f1[0] + f3[0];
+        f[i2].y -= f1[1] + f3[1];
+        f[i2].z -= f1[2] + f3[2];
+      }
     }
 
     if (NEWTON_BOND || i3 < nlocal) {
-      f[i3].x += f3[0];
-      f[i3].y += f3[1];
-      f[i3].z += f3[2];
+      if (owner && !thr->owns(i3))
+        thr->add_f(i3,f3[0],f3[1],f3[2]);
+      else {
+        f[i3].x += f3[0];
+        f[i3].y += f3[1];
+        f[i3].z += f3[2];
+      }
     }
 
     if (EVFLAG) ev_tally_thr(this,i1,i2,i3,nlocal,NEWTON_BOND,eangle,f1,f3,
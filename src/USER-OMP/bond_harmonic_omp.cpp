@@ -33,6 +33,7 @@ BondHarmonicOMP::BondHarmonicOMP(class LAMMPS *lmp)
   : BondHarmonic(lmp), ThrOMP(lmp,THR_BOND)
 {
   suffix_flag |= Suffix::OMP;
+  thr_owner = 1;
 }
 
 /* ---------------------------------------------------------------------- */
@@ -84,7 +85,9 @@ void BondHarmonicOMP::eval(int nfrom, int nto, ThrData * const thr)
   double rsq,r,dr,rk;
 
   const dbl3_t * _noalias const x = (dbl3_t *) atom->x[0];
-  dbl3_t * _noalias const f = (dbl3_t *) thr->get_f()[0];
+  const bool owner = use_owner_thr();
+  dbl3_t * _noalias const f = owner ? (dbl3_t *) atom->f[0]
+    : (dbl3_t *) thr->get_f()[0];
   const int3_t * _noalias const bondlist = (int3_t *) neighbor->bondlist[0];
   const int nlocal = atom->nlocal;
   ebond = 0.0;
@@ -113,15 +116,23 @@ void BondHarmonicOMP::eval(int nfrom, int nto, ThrData * const thr)
     // apply force to each of 2 atoms
 
     if (NEWTON_BOND || i1 < nlocal) {
-      f[i1].x += delx*fbond;
-      f[i1].y += dely*fbond;
-      f[i1].z += delz*fbond;
+      if (owner && !thr->owns(i1))
+        thr->add_f(i1,delx*fbond,dely*fbond,delz*fbond);
+      else {
+        f[i1].x += delx*fbond;
+        f[i1].y += dely*fbond;
+        f[i1].z += delz*fbond;
+      }
     }
 
     if (NEWTON_BOND || i2 < nlocal) {
-      f[i2].x -= delx*fbond;
-      f[i2].y -= dely*fbond;
-      f[i2].z -= delz*fbond;
+      if (owner && !thr->owns(i2))
+        thr->add_f(i2,-delx*fbond,-dely*fbond,-delz*fbond);
+      else {
+        f[i2].x -= delx*fbond;
+        f[i2].y -= dely*fbond;
+        f[i2].z -= delz*fbond;
+      }
     }
 
     if (EVFLAG) ev_tally_thr(this,i1,i2,nlocal,NEWTON_BOND,
@@ -17,6 +17,7 @@
 ------------------------------------------------------------------------- */
 
 #include "atom.h"
+#include "atom_vec.h"
 #include "comm.h"
 #include "error.h"
 #include "force.h"
@@ -63,12 +64,21 @@ static int get_tid()
   return tid;
 }
 
+// true if an /omp style supports owner reduction of forces
+
+template <class T> static bool owner_thr(T *style)
+{
+  ThrOMP *thr = dynamic_cast<ThrOMP *>(style);
+  return thr && thr->get_owner_thr();
+}
+
 /* ---------------------------------------------------------------------- */
 
 FixOMP::FixOMP(LAMMPS *lmp, int narg, char **arg) 
   :  Fix(lmp, narg, arg),
      thr(NULL), last_omp_style(NULL), last_pair_hybrid(NULL),
-     _nthr(-1), _neighbor(true), _mixed(false), _reduced(true)
+     _nthr(-1), _neighbor(true), _mixed(false), _reduced(true),
+     _owner(false)
 {
   if (narg < 4) error->all(FLERR,"Illegal package omp command");
 
@@ -105,6 +115,12 @@ FixOMP::FixOMP(LAMMPS *lmp, int narg, char **arg)
       else if (strcmp(arg[iarg]+1,"no") == 0) _neighbor = false;
       else error->all(FLERR,"Illegal package omp command");
       iarg += 2;
+    } else if (strcmp(arg[iarg],"reduce") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal package omp command");
+      if (strcmp(arg[iarg+1],"dense") == 0) _owner = false;
+      else if (strcmp(arg[iarg+1],"owner") == 0) _owner = true;
+      else error->all(FLERR,"Illegal package omp command");
+      iarg += 2;
     }
 
     // undocumented options
@@ -123,12 +139,14 @@ FixOMP::FixOMP(LAMMPS *lmp, int narg, char **arg)
   if (comm->me == 0) {
     const char * const nmode = _neighbor ? "multi-threaded" : "serial";
     const char * const kmode = _mixed ? "mixed" : "double";
+    const char * const rmode = _owner ? "owner" : "dense";
 
     if (screen) {
       if (reset_thr)
 	fprintf(screen,"set %d OpenMP thread(s) per MPI task\n", nthreads);
       fprintf(screen,"using %s neighbor list subroutines\n", nmode);
       fprintf(screen,"prefer %s precision OpenMP force kernels\n", kmode);
+      fprintf(screen,"using %s reduction of per thread forces\n", rmode);
     }
     
     if (logfile) {
@@ -136,6 +154,7 @@ FixOMP::FixOMP(LAMMPS *lmp, int narg, char **arg)
 	fprintf(logfile,"set %d OpenMP thread(s) per MPI task\n", nthreads);
       fprintf(logfile,"using %s neighbor list subroutines\n", nmode);
       fprintf(logfile,"prefer %s precision OpenMP force kernels\n", kmode);
+      fprintf(logfile,"using %s reduction of per thread forces\n", rmode);
     }
   }
 
@@ -205,7 +224,13 @@ void FixOMP::init()
       && (strstr(update->integrate_style,"respa/omp") == NULL))
     error->all(FLERR,"Need to use respa/omp for r-RESPA with /omp styles");
 
+  // respa/omp sums the per thread force arrays directly
+
+  if (_owner && (strstr(update->integrate_style,"respa") != NULL))
+    error->all(FLERR,"Package omp reduce owner cannot be used with r-RESPA");
+
   int check_hybrid, kspace_split;
+  bool dense = !_owner;
   last_pair_hybrid = NULL;
   last_omp_style = NULL;
   const char *last_omp_name = NULL;
@@ -237,6 +262,7 @@ void FixOMP::init()
       last_force_name = (const char *) #name;				\
       last_omp_name = force->name ## _style;				\
       last_omp_style = (void *) force->name;				\
+      if (!owner_thr(force->name)) dense = true;			\
     }									\
   }
 
@@ -248,6 +274,7 @@ void FixOMP::init()
         last_force_name = (const char *) #name;		      \
         last_omp_name = style->keywords[i];		      \
         last_omp_style = style->styles[i];		      \
+        if (!owner_thr(style->styles[i])) dense = true;	      \
       }							      \
     }							      \
   }
@@ -281,6 +308,16 @@ void FixOMP::init()
 #undef CheckHybridForOMP
   set_neighbor_omp();
 
+  // per thread copies of the force array are only allocated
+  // if an active /omp style does not support owner reduction
+
+  for (int n = 0; n < _nthr; ++n) thr[n]->_fdense = dense;
+  const int fthread = dense ? 1 : 0;
+  if (atom->fthread != fthread) {
+    atom->fthread = fthread;
+    if (atom->nmax) atom->avec->grow(atom->nmax);
+  }
+
   // diagnostic output
   if (comm->me == 0) {
     if (last_omp_style) {
@@ -328,7 +365,11 @@ void FixOMP::set_neighbor_omp()
 // adjust size and clear out per thread accumulator arrays
 void FixOMP::pre_force(int)
 {
-  const int nall = atom->nlocal + atom->nghost;
+  const int nlocal = atom->nlocal;
+  const int nghost = atom->nghost;
+  const int nall = nlocal + nghost;
+  const int nthreads = comm->nthreads;
+  const bool owner = _owner;
 
   double **f = atom->f;
   double **torque = atom->torque;
@@ -342,6 +383,7 @@ void FixOMP::pre_force(int)
   {
     const int tid = get_tid();
     thr[tid]->check_tid(tid);
+    if (owner) thr[tid]->init_owner(nlocal,nghost,nthreads,memory);
     thr[tid]->init_force(nall,f,torque,erforce,de,drho);
   } // end of omp parallel region
 
@@ -30,6 +30,7 @@ PairLJCharmmCoulLongOMP::PairLJCharmmCoulLongOMP(LAMMPS *lmp) :
 {
   suffix_flag |= Suffix::OMP;
   respa_enable = 0;
+  overlap_enable = 0;
   cut_respa = NULL;
 }
 
@@ -37,7 +37,9 @@ PairLJCutCoulLongOMP::PairLJCutCoulLongOMP(LAMMPS *lmp) :
   PairLJCutCoulLong(lmp), ThrOMP(lmp, THR_PAIR)
 {
   suffix_flag |= Suffix::OMP;
+  thr_owner = 1;
   respa_enable = 0;
+  overlap_enable = 0;
   cut_respa = NULL;
 }
 
@@ -95,7 +97,9 @@ void PairLJCutCoulLongOMP::eval(int iifrom, int iito, ThrData * const thr)
   evdwl = ecoul = 0.0;
 
   const dbl3_t * _noalias const x = (dbl3_t *) atom->x[0];
-  dbl3_t * _noalias const f = (dbl3_t *) thr->get_f()[0];
+  const bool owner = use_owner_thr();
+  dbl3_t * _noalias const f = owner ? (dbl3_t *) atom->f[0]
+    : (dbl3_t *) thr->get_f()[0];
   const double * _noalias const q = atom->q;
   const int * _noalias const type = atom->type;
   const int nlocal = atom->nlocal;
@@ -175,9 +179,13 @@ void PairLJCutCoulLongOMP::eval(int iifrom, int iito, ThrData * const thr)
         fytmp += dely*fpair;
         fztmp += delz*fpair;
         if (NEWTON_PAIR || j < nlocal) {
-          f[j].x -= delx*fpair;
-          f[j].y -= dely*fpair;
-          f[j].z -= delz*fpair;
+          if (owner && !thr->owns(j))
+            thr->add_f(j,-delx*fpair,-dely*fpair,-delz*fpair);
+          else {
+            f[j].x -= delx*fpair;
+            f[j].y -= dely*fpair;
+            f[j].z -= delz*fpair;
+          }
         }
 
         if (EFLAG) {
@@ -202,9 +210,13 @@ void PairLJCutCoulLongOMP::eval(int iifrom, int iito, ThrData * const thr)
                                  evdwl,ecoul,fpair,delx,dely,delz,thr);
       }
     }
-    f[i].x += fxtmp;
-    f[i].y += fytmp;
-    f[i].z += fztmp;
+    if (owner && !thr->owns(i))
+      thr->add_f(i,fxtmp,fytmp,fztmp);
+    else {
+      f[i].x += fxtmp;
+      f[i].y += fytmp;
+      f[i].z += fztmp;
+    }
   }
 }
 
@@ -49,6 +49,7 @@ PPPMOMP::PPPMOMP(LAMMPS *lmp, int narg, char **arg) :
 {
   triclinic_support = 0;
   suffix_flag |= Suffix::OMP;
+  thr_owner = 1;
 }
 
 /* ----------------------------------------------------------------------
@@ -450,8 +451,11 @@ void PPPMOMP::fieldforce_ik()
     loop_setup_thr(ifrom,ito,tid,nlocal,nthreads);
 
     // get per thread data
+    // with owner reduction, atoms ifrom to ito are owned by this thread
+
     ThrData *thr = fix->get_thr(tid);
-    dbl3_t * _noalias const f = (dbl3_t *) thr->get_f()[0];
+    dbl3_t * _noalias const f = use_owner_thr() ? (dbl3_t *) atom->f[0]
+      : (dbl3_t *) thr->get_f()[0];
     FFT_SCALAR * const * const r1d = static_cast<FFT_SCALAR **>(thr->get_rho1d());
 
     for (i = ifrom; i < ito; ++i) {
@@ -534,8 +538,11 @@ void PPPMOMP::fieldforce_ad()
     loop_setup_thr(ifrom,ito,tid,nlocal,nthreads);
 
     // get per thread data
+    // with owner reduction, atoms ifrom to ito are owned by this thread
+
     ThrData *thr = fix->get_thr(tid);
-    dbl3_t * _noalias const f = (dbl3_t *) thr->get_f()[0];
+    dbl3_t * _noalias const f = use_owner_thr() ? (dbl3_t *) atom->f[0]
+      : (dbl3_t *) thr->get_f()[0];
     FFT_SCALAR * const * const r1d = static_cast<FFT_SCALAR **>(thr->get_rho1d());
     FFT_SCALAR * const * const d1d = static_cast<FFT_SCALAR **>(thr->get_drho1d());
 
@@ -25,15 +25,36 @@
 
 using namespace LAMMPS_NS;
 
+#define BUFDELTA 1024
+
 /* ---------------------------------------------------------------------- */
 
 ThrData::ThrData(int tid)
   : _f(0),_torque(0),_erforce(0),_de(0),_drho(0),_mu(0),_lambda(0),_rhoB(0),
-    _D_values(0),_rho(0),_fp(0),_rho1d(0),_drho1d(0),_tid(tid)
+    _D_values(0),_rho(0),_fp(0),_rho1d(0),_drho1d(0),
+    _fdense(true),_nlocal(0),_ldelta(1),_gdelta(1),
+    _lfrom(0),_lto(0),_gfrom(0),_gto(0),_nbuf(0),_maxbuf(0),_bufidx(0),
+    _buff(0),_bufhash(0),_hashmask(0),_sortidx(0),_sortf(0),_sortstart(0),
+    _nthr(0),_memory(0),
+    _tid(tid)
 {
   // nothing else to do here.
 }
 
+/* ---------------------------------------------------------------------- */
+
+ThrData::~ThrData()
+{
+  if (_memory) {
+    _memory->destroy(_bufidx);
+    _memory->destroy(_buff);
+    _memory->destroy(_bufhash);
+    _memory->destroy(_sortidx);
+    _memory->destroy(_sortf);
+    _memory->destroy(_sortstart);
+  }
+}
+
 
 /* ---------------------------------------------------------------------- */
 
@@ -59,9 +80,14 @@ void ThrData::init_force(int nall, double **f, double **torque,
   eatom_pair=eatom_bond=eatom_angle=eatom_dihed=eatom_imprp=eatom_kspce=NULL;
   vatom_pair=vatom_bond=vatom_angle=vatom_dihed=vatom_imprp=vatom_kspce=NULL;
 
-  _f = f + _tid*nall;
-  if (nall > 0)
-    memset(&(_f[0][0]),0,nall*3*sizeof(double));
+  // without per thread force arrays only the first thread
+  // has a force array, which is atom->f itself
+
+  if (_fdense || (_tid == 0)) {
+    _f = f + _tid*nall;
+    if (nall > 0)
+      memset(&(_f[0][0]),0,nall*3*sizeof(double));
+  } else _f = NULL;
 
   if (torque) {
     _torque = torque + _tid*nall;
@@ -193,6 +219,115 @@ void ThrData::init_pppm_disp(int order_6, Memory *memory)
 }
 
 
+/* ----------------------------------------------------------------------
+   set up owner reduction of forces for this step
+   local and ghost atoms are each split into one contiguous chunk per
+     thread, local chunks are the same as used by loop_setup_thr()
+------------------------------------------------------------------------- */
+
+void ThrData::init_owner(int nlocal, int nghost, int nthreads, Memory *memory)
+{
+  _memory = memory;
+  _nlocal = nlocal;
+  _ldelta = 1 + nlocal/nthreads;
+  _gdelta = 1 + nghost/nthreads;
+
+  _lfrom = _tid*_ldelta;
+  _lto = _lfrom + _ldelta;
+  if (_lto > nlocal) _lto = nlocal;
+  _gfrom = nlocal + _tid*_gdelta;
+  _gto = _gfrom + _gdelta;
+  if (_gto > nlocal+nghost) _gto = nlocal+nghost;
+
+  if (nthreads != _nthr) {
+    _nthr = nthreads;
+    _memory->destroy(_sortstart);
+    _memory->create(_sortstart,_nthr+1,"thr_data:sortstart");
+  }
+  if (_maxbuf == 0) grow_buf();
+}
+
+/* ----------------------------------------------------------------------
+   add buffer entry for atom I at empty hash table slot H
+------------------------------------------------------------------------- */
+
+void ThrData::insert_f(unsigned int h, int i, double fx, double fy, double fz)
+{
+  if (_nbuf == _maxbuf) {
+    grow_buf();
+    h = ((unsigned int) i * 2654435761U) & _hashmask;
+    while (_bufhash[h] > 0) h = (h+1) & _hashmask;
+  }
+
+  _bufidx[_nbuf] = i;
+  _buff[3*_nbuf] = fx;
+  _buff[3*_nbuf+1] = fy;
+  _buff[3*_nbuf+2] = fz;
+  _bufhash[h] = ++_nbuf;
+}
+
+/* ----------------------------------------------------------------------
+   double size of buffers for forces on atoms owned by other threads
+   hash table is twice the size of buffers and rebuilt from scratch
+------------------------------------------------------------------------- */
+
+void ThrData::grow_buf()
+{
+  if (_maxbuf == 0) _maxbuf = BUFDELTA;
+  else _maxbuf *= 2;
+  _memory->grow(_bufidx,_maxbuf,"thr_data:bufidx");
+  _memory->grow(_buff,3*_maxbuf,"thr_data:buff");
+  _memory->grow(_sortidx,_maxbuf,"thr_data:sortidx");
+  _memory->grow(_sortf,3*_maxbuf,"thr_data:sortf");
+
+  _hashmask = 2*_maxbuf - 1;
+  _memory->destroy(_bufhash);
+  _memory->create(_bufhash,2*_maxbuf,"thr_data:bufhash");
+  memset(_bufhash,0,2*_maxbuf*sizeof(int));
+
+  for (int m = 0; m < _nbuf; m++) {
+    unsigned int h = ((unsigned int) _bufidx[m] * 2654435761U) & _hashmask;
+    while (_bufhash[h] > 0) h = (h+1) & _hashmask;
+    _bufhash[h] = m+1;
+  }
+}
+
+/* ----------------------------------------------------------------------
+   sort buffered forces by the thread that owns their atom
+   forces for thread N are then _sortstart[N] to _sortstart[N+1]-1
+------------------------------------------------------------------------- */
+
+void ThrData::sort_buf()
+{
+  int i,m,n;
+
+  for (n = 0; n <= _nthr; n++) _sortstart[n] = 0;
+
+  for (m = 0; m < _nbuf; m++) {
+    i = _bufidx[m];
+    if (i < _nlocal) n = i/_ldelta;
+    else n = (i-_nlocal)/_gdelta;
+    _sortstart[n+1]++;
+  }
+  for (n = 0; n < _nthr; n++) _sortstart[n+1] += _sortstart[n];
+
+  for (m = 0; m < _nbuf; m++) {
+    i = _bufidx[m];
+    if (i < _nlocal) n = i/_ldelta;
+    else n = (i-_nlocal)/_gdelta;
+    const int k = _sortstart[n]++;
+    _sortidx[k] = i;
+    _sortf[3*k] = _buff[3*m];
+    _sortf[3*k+1] = _buff[3*m+1];
+    _sortf[3*k+2] = _buff[3*m+2];
+  }
+
+  // counts were used as insert positions, shift back to start of each thread
+
+  for (n = _nthr; n > 0; n--) _sortstart[n] = _sortstart[n-1];
+  _sortstart[0] = 0;
+}
+
 /* ----------------------------------------------------------------------
    compute global pair virial via summing F dot r over own & ghost atoms
    at this point, only pairwise forces have been accumulated in atom->f
@@ -239,6 +374,46 @@ void ThrData::virial_fdotr_compute(double **x, int nlocal, int nghost, int nfirs
   }
 }
 
+/* ----------------------------------------------------------------------
+   empty buffers once buffered forces have been added to owning threads
+------------------------------------------------------------------------- */
+
+void ThrData::clear_buf()
+{
+  if (_nbuf == 0) return;
+  memset(_bufhash,0,(_hashmask+1)*sizeof(int));
+  _nbuf = 0;
+}
+
+/* ----------------------------------------------------------------------
+   compute global pair virial from the local and ghost atoms this thread owns
+   forces are taken from the global force array after owner reduction
+------------------------------------------------------------------------- */
+
+void ThrData::virial_fdotr_owned(double **x, double **f, int nfirst)
+{
+  int lto = _lto;
+  if ((nfirst >= 0) && (lto > nfirst)) lto = nfirst;
+
+  for (int i = _lfrom; i < lto; i++) {
+    virial_pair[0] += f[i][0]*x[i][0];
+    virial_pair[1] += f[i][1]*x[i][1];
+    virial_pair[2] += f[i][2]*x[i][2];
+    virial_pair[3] += f[i][1]*x[i][0];
+    virial_pair[4] += f[i][2]*x[i][0];
+    virial_pair[5] += f[i][2]*x[i][1];
+  }
+
+  for (int i = _gfrom; i < _gto; i++) {
+    virial_pair[0] += f[i][0]*x[i][0];
+    virial_pair[1] += f[i][1]*x[i][1];
+    virial_pair[2] += f[i][2]*x[i][2];
+    virial_pair[3] += f[i][1]*x[i][0];
+    virial_pair[4] += f[i][2]*x[i][0];
+    virial_pair[5] += f[i][2]*x[i][1];
+  }
+}
+
 /* ---------------------------------------------------------------------- */
 
 double ThrData::memory_usage()
@@ -246,6 +421,9 @@ double ThrData::memory_usage()
   double bytes = (7 + 6*6) * sizeof(double);
   bytes += 2 * sizeof(double*);
   bytes += 4 * sizeof(int);
+  bytes += (double) _maxbuf * 2*(sizeof(int) + 3*sizeof(double));
+  bytes += (double) _maxbuf * 2*sizeof(int);
+  bytes += (_nthr+1) * sizeof(int);
 
   return bytes;
 }
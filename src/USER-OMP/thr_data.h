@@ -33,7 +33,7 @@ class ThrData {
 
  public:
   ThrData(int tid);
-  ~ThrData() {};
+  ~ThrData();
 
   void check_tid(int);    // thread id consistency check
   int get_tid() const { return _tid; }; // our thread id.
@@ -54,6 +54,30 @@ class ThrData {
   void init_eim(int, double *, double *);             // EIM (+ EAM)
 
   void init_pppm(int, class Memory *);
+
+  // owner reduction: forces on atoms owned by this thread are added
+  // directly to atom->f, forces on all other atoms are buffered
+  void init_owner(int, int, int, class Memory *);
+  bool owns(const int i) const {
+    return ((i >= _lfrom) && (i < _lto)) || ((i >= _gfrom) && (i < _gto));
+  };
+  // forces on the same atom are summed in one buffer entry,
+  // found via a hash table of the buffered atom indices
+  void add_f(const int i, const double fx, const double fy, const double fz) {
+    unsigned int h = ((unsigned int) i * 2654435761U) & _hashmask;
+    int m;
+    while ((m = _bufhash[h]) > 0) {
+      if (_bufidx[m-1] == i) {
+        double * const b = _buff + 3*(m-1);
+        b[0] += fx;
+        b[1] += fy;
+        b[2] += fz;
+        return;
+      }
+      h = (h+1) & _hashmask;
+    }
+    insert_f(h,i,fx,fy,fz);
+  };
   void init_pppm_disp(int, class Memory *);
 
   // access methods for arrays that we handle in this class
@@ -116,12 +140,35 @@ class ThrData {
   // this is for pppm/disp/omp
   void *_rho1d_6;
   void *_drho1d_6;
+  // this is for owner reduction of forces
+  bool _fdense;              // true if per thread force arrays are in use,
+                             // set by FixOMP::init() for all threads
+  int _nlocal,_ldelta,_gdelta;   // owned atoms of each thread
+  int _lfrom,_lto,_gfrom,_gto;   // owned local and ghost atoms of this thread
+  int _nbuf,_maxbuf;         // # of buffered atoms and size of buffers
+  int *_bufidx;              // atom index of each buffered atom
+  double *_buff;             // buffered force on each buffered atom
+  int *_bufhash;             // hash table of buffered atoms, 0 = empty slot
+  unsigned int _hashmask;    // size of hash table - 1
+  int *_sortidx;             // buffered forces sorted by owning thread
+  double *_sortf;
+  int *_sortstart;           // first sorted force of each owning thread
+  int _nthr;                 // # of threads when owner ranges were set
+  class Memory *_memory;
+
+  void insert_f(unsigned int, int, double, double, double);
+  void grow_buf();
+  void sort_buf();
+  void clear_buf();
+
   // my thread id
   const int _tid;
 
  public:
   // compute global per thread virial contribution from global forces and positions
   void virial_fdotr_compute(double **, int, int, int);
+  // same from the atoms owned by this thread in the global force array
+  void virial_fdotr_owned(double **, double **, int);
 
   double memory_usage();
 
@@ -43,7 +43,7 @@ using namespace MathConst;
 /* ---------------------------------------------------------------------- */
 
 ThrOMP::ThrOMP(LAMMPS *ptr, int style)
-  : lmp(ptr), fix(NULL), thr_style(style), thr_error(0)
+  : lmp(ptr), fix(NULL), thr_style(style), thr_error(0), thr_owner(0)
 {
   // register fix omp with this class
   int ifix = lmp->modify->find_fix("package_omp");
@@ -161,8 +161,11 @@ void ThrOMP::reduce_thr(void *style, const int eflag, const int vflag,
   double **x = lmp->atom->x;
 
   int need_force_reduce = 1;
+  const bool owner = use_owner_thr();
 
-  if (evflag)
+  if (owner)
+    reduce_owner_thr(thr);
+  else if (evflag)
     sync_threads();
 
   switch (thr_style) {
@@ -174,7 +177,12 @@ void ThrOMP::reduce_thr(void *style, const int eflag, const int vflag,
 
       // this is a non-hybrid pair style. compute per thread fdotr
       if (fix->last_pair_hybrid == NULL) {
-        if (lmp->neighbor->includegroup == 0)
+        if (owner) {
+          if (lmp->neighbor->includegroup == 0)
+            thr->virial_fdotr_owned(x, f, -1);
+          else
+            thr->virial_fdotr_owned(x, f, nfirst);
+        } else if (lmp->neighbor->includegroup == 0)
           thr->virial_fdotr_compute(x, nlocal, nghost, -1);
         else
           thr->virial_fdotr_compute(x, nlocal, nghost, nfirst);
@@ -182,7 +190,7 @@ void ThrOMP::reduce_thr(void *style, const int eflag, const int vflag,
         if (style == fix->last_pair_hybrid) {
           // pair_style hybrid will compute fdotr for us
           // but we first need to reduce the forces
-          data_reduce_thr(&(f[0][0]), nall, nthreads, 3, tid);
+          reduce_force_thr(thr);
 	  fix->did_reduce();
           need_force_reduce = 0;
         }
@@ -395,7 +403,7 @@ void ThrOMP::reduce_thr(void *style, const int eflag, const int vflag,
 
   if (style == fix->last_omp_style) {
     if (need_force_reduce) {
-      data_reduce_thr(&(f[0][0]), nall, nthreads, 3, tid);
+      reduce_force_thr(thr);
       fix->did_reduce();
     }
 
@@ -404,6 +412,57 @@ void ThrOMP::reduce_thr(void *style, const int eflag, const int vflag,
   }
 }
 
+/* ----------------------------------------------------------------------
+   owner reduction: add forces that threads buffered for atoms owned
+   by this thread to the global force array
+   this thread adds its own forces without a race, since no other thread
+   writes to the atoms it owns
+   ---------------------------------------------------------------------- */
+
+void ThrOMP::reduce_owner_thr(ThrData * const thr)
+{
+  const int nthreads = lmp->comm->nthreads;
+  const int tid = thr->get_tid();
+  double **f = lmp->atom->f;
+
+  thr->sort_buf();
+  sync_threads();
+
+  for (int n = 0; n < nthreads; ++n) {
+    const ThrData * const other = fix->get_thr(n);
+    const int mfrom = other->_sortstart[tid];
+    const int mto = other->_sortstart[tid+1];
+    for (int m = mfrom; m < mto; ++m) {
+      const int i = other->_sortidx[m];
+      f[i][0] += other->_sortf[3*m];
+      f[i][1] += other->_sortf[3*m+1];
+      f[i][2] += other->_sortf[3*m+2];
+    }
+  }
+
+  // buffers can only be reused once all threads have read them
+
+  sync_threads();
+  thr->clear_buf();
+}
+
+/* ----------------------------------------------------------------------
+   sum per thread force arrays into the global force array
+   skipped if all styles use owner reduction, since then there are none
+   ---------------------------------------------------------------------- */
+
+void ThrOMP::reduce_force_thr(ThrData * const thr)
+{
+  if (!thr->_fdense) return;
+
+  const int nall = lmp->atom->nlocal + lmp->atom->nghost;
+  const int nthreads = lmp->comm->nthreads;
+  const int tid = thr->get_tid();
+  double **f = lmp->atom->f;
+
+  data_reduce_thr(&(f[0][0]), nall, nthreads, 3, tid);
+}
+
 /* ----------------------------------------------------------------------
    tally eng_vdwl and eng_coul into per thread global and per-atom accumulators
 ------------------------------------------------------------------------- */
@@ -42,6 +42,7 @@ class ThrOMP {
 
   const int thr_style;
   int thr_error;
+  int thr_owner;   // 1 if style supports owner reduction of forces
 
  public:
   ThrOMP(LAMMPS *, int);
@@ -49,6 +50,9 @@ class ThrOMP {
 
   double memory_usage_thr();
 
+  // true if style supports owner reduction of forces
+  bool get_owner_thr() const { return thr_owner != 0; };
+
   inline void sync_threads() {
 #if defined(_OPENMP)
 #pragma omp barrier
@@ -74,6 +78,15 @@ class ThrOMP {
   void reduce_thr(void * const style, const int eflag, const int vflag,
                   ThrData * const thr);
 
+  // true if this style adds forces with owner reduction in this run
+  bool use_owner_thr() const { return thr_owner && fix->get_owner(); };
+
+  // add buffered forces of all threads to atoms owned by this thread
+  void reduce_owner_thr(ThrData * const thr);
+
+  // sum per thread force arrays, unless none was used with owner reduction
+  void reduce_force_thr(ThrData * const thr);
+
   // thread safe variant error abort support.
   // signals an error condition in any thread by making
   // thr_error > 0, if condition "cond" is true.
@@ -50,6 +50,13 @@ using namespace FixConst;
 #define CUBE(x) ((x)*(x)*(x))
 #define MIN_NBRS 100
 
+// MPI-3 libraries provide a nonblocking allreduce, which lets pipelined CG
+// overlap its global dot products with the matrix-vector product
+
+#if defined(MPI_VERSION) && (MPI_VERSION >= 3)
+#define QEQ_IALLREDUCE
+#endif
+
 static const char cite_fix_qeq_reax[] =
   "fix qeq/reax command:\n\n"
   "@Article{Aktulga12,\n"
@@ -68,7 +75,7 @@ FixQEqReax::FixQEqReax(LAMMPS *lmp, int narg, char **arg) :
 {
   if (lmp->citeme) lmp->citeme->add(cite_fix_qeq_reax);
 
-  if (narg != 8) error->all(FLERR,"Illegal fix qeq/reax command");
+  if (narg < 8) error->all(FLERR,"Illegal fix qeq/reax command");
 
   nevery = force->inumeric(FLERR,arg[3]);
   swa = force->numeric(FLERR,arg[4]);
@@ -76,6 +83,41 @@ FixQEqReax::FixQEqReax(LAMMPS *lmp, int narg, char **arg) :
   tolerance = force->numeric(FLERR,arg[6]);
   pertype_parameters(arg[7]);
 
+  // optional keywords
+
+  dualflag = 0;
+  pipeflag = 0;
+  extrap_s = 3;
+  extrap_t = 2;
+
+  int iarg = 8;
+  while (iarg < narg) {
+    if (strcmp(arg[iarg],"dual") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal fix qeq/reax command");
+      if (strcmp(arg[iarg+1],"yes") == 0) dualflag = 1;
+      else if (strcmp(arg[iarg+1],"no") == 0) dualflag = 0;
+      else error->all(FLERR,"Illegal fix qeq/reax command");
+      iarg += 2;
+    } else if (strcmp(arg[iarg],"pipeline") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal fix qeq/reax command");
+      if (strcmp(arg[iarg+1],"yes") == 0) pipeflag = 1;
+      else if (strcmp(arg[iarg+1],"no") == 0) pipeflag = 0;
+      else error->all(FLERR,"Illegal fix qeq/reax command");
+      iarg += 2;
+    } else if (strcmp(arg[iarg],"extrapolate") == 0) {
+      if (iarg+3 > narg) error->all(FLERR,"Illegal fix qeq/reax command");
+      extrap_s = force->inumeric(FLERR,arg[iarg+1]);
+      extrap_t = force->inumeric(FLERR,arg[iarg+2]);
+      if (extrap_s < 0 || extrap_s > 4 || extrap_t < 0 || extrap_t > 4)
+        error->all(FLERR,"Illegal fix qeq/reax command");
+      iarg += 3;
+    } else error->all(FLERR,"Illegal fix qeq/reax command");
+  }
+
+  // pipelined CG always solves for s and t together
+
+  if (pipeflag) dualflag = 1;
+
   shld = NULL;
 
   n = n_cap = 0;
@@ -98,6 +140,10 @@ FixQEqReax::FixQEqReax(LAMMPS *lmp, int narg, char **arg) :
   r = NULL;
   d = NULL;
 
+  x2 = b2 = p2 = q2 = r2 = d2 = NULL;
+  u2 = w2 = m2 = n2 = z2 = s2 = NULL;
+  fwd2 = rev2 = NULL;
+
   // H matrix
   H.firstnbr = NULL;
   H.numnbrs = NULL;
@@ -105,6 +151,7 @@ FixQEqReax::FixQEqReax(LAMMPS *lmp, int narg, char **arg) :
   H.val = NULL;
 
   comm_forward = comm_reverse = 1;
+  if (dualflag) comm_forward = comm_reverse = 2;
 
   // perform initial allocation of atom-based arrays
   // register with Atom class
@@ -224,6 +271,24 @@ void FixQEqReax::allocate_storage()
   memory->create(q,nmax,"qeq:q");
   memory->create(r,nmax,"qeq:r");
   memory->create(d,nmax,"qeq:d");
+
+  if (dualflag) {
+    memory->create(x2,nmax,2,"qeq:x2");
+    memory->create(b2,nmax,2,"qeq:b2");
+    memory->create(p2,nmax,2,"qeq:p2");
+    memory->create(q2,nmax,2,"qeq:q2");
+    memory->create(r2,nmax,2,"qeq:r2");
+    memory->create(d2,nmax,2,"qeq:d2");
+  }
+
+  if (pipeflag) {
+    memory->create(u2,nmax,2,"qeq:u2");
+    memory->create(w2,nmax,2,"qeq:w2");
+    memory->create(m2,nmax,2,"qeq:m2");
+    memory->create(n2,nmax,2,"qeq:n2");
+    memory->create(z2,nmax,2,"qeq:z2");
+    memory->create(s2,nmax,2,"qeq:s2");
+  }
 }
 
 /* ---------------------------------------------------------------------- */
@@ -243,6 +308,20 @@ void FixQEqReax::deallocate_storage()
   memory->destroy( q );
   memory->destroy( r );
   memory->destroy( d );
+
+  memory->destroy( x2 );
+  memory->destroy( b2 );
+  memory->destroy( p2 );
+  memory->destroy( q2 );
+  memory->destroy( r2 );
+  memory->destroy( d2 );
+
+  memory->destroy( u2 );
+  memory->destroy( w2 );
+  memory->destroy( m2 );
+  memory->destroy( n2 );
+  memory->destroy( z2 );
+  memory->destroy( s2 );
 }
 
 /* ---------------------------------------------------------------------- */
@@ -477,8 +556,12 @@ void FixQEqReax::pre_force(int vflag)
     reallocate_matrix();
 
   init_matvec();
-  matvecs = CG(b_s, s);    	// CG on s - parallel
-  matvecs += CG(b_t, t); 	// CG on t - parallel
+  if (pipeflag) matvecs = pipelined_CG2();  // CG on s and t together
+  else if (dualflag) matvecs = CG2();       // CG on s and t together
+  else {
+    matvecs = CG(b_s, s);    	// CG on s - parallel
+    matvecs += CG(b_t, t); 	// CG on t - parallel
+  }
   calculate_Q();
 
   if( comm->me == 0 ) {
@@ -528,17 +611,9 @@ void FixQEqReax::init_matvec()
       b_s[i]      = -chi[ atom->type[i] ];
       b_t[i]      = -1.0;
 
-      /* linear extrapolation for s & t from previous solutions */
-      //s[i] = 2 * s_hist[i][0] - s_hist[i][1];
-      //t[i] = 2 * t_hist[i][0] - t_hist[i][1];
-
-      /* quadratic extrapolation for s & t from previous solutions */
-      //s[i] = s_hist[i][2] + 3 * ( s_hist[i][0] - s_hist[i][1] );
-      t[i] = t_hist[i][2] + 3 * ( t_hist[i][0] - t_hist[i][1] );
-
-      /* cubic extrapolation for s & t from previous solutions */
-      s[i] = 4*(s_hist[i][0]+s_hist[i][2])-(6*s_hist[i][1]+s_hist[i][3]);
-      //t[i] = 4*(t_hist[i][0]+t_hist[i][2])-(6*t_hist[i][1]+t_hist[i][3]);
+      /* polynomial extrapolation for s & t from previous solutions */
+      s[i] = extrapolate(s_hist[i],extrap_s);
+      t[i] = extrapolate(t_hist[i],extrap_t);
     }
   }
 
@@ -548,6 +623,27 @@ void FixQEqReax::init_matvec()
   comm->forward_comm_fix(this); //Dist_vector( t );
 }
 
+/* ----------------------------------------------------------------------
+   extrapolate next value from history h of previous solutions
+   h[0] is the most recent, order = degree of the fitted polynomial
+------------------------------------------------------------------------- */
+
+double FixQEqReax::extrapolate(double *h, int order)
+{
+  switch (order) {
+  case 0:   // constant
+    return h[0];
+  case 1:   // linear
+    return 2 * h[0] - h[1];
+  case 2:   // quadratic
+    return h[2] + 3 * ( h[0] - h[1] );
+  case 3:   // cubic
+    return 4*(h[0]+h[2])-(6*h[1]+h[3]);
+  default:  // quartic
+    return 5*(h[0]-h[3]) + 10*(h[2]-h[1]) + h[4];
+  }
+}
+
 /* ---------------------------------------------------------------------- */
 
 void FixQEqReax::compute_H()
@@ -717,6 +813,369 @@ int FixQEqReax::CG( double *b, double *x )
 }
 
 
+/* ----------------------------------------------------------------------
+   copy s,t and their right-hand sides into the 2-column CG arrays
+------------------------------------------------------------------------- */
+
+void FixQEqReax::init_CG2()
+{
+  for( int i = 0; i < N; ++i ) {
+    x2[i][0] = s[i];
+    x2[i][1] = t[i];
+    b2[i][0] = b_s[i];
+    b2[i][1] = b_t[i];
+  }
+}
+
+/* ----------------------------------------------------------------------
+   copy solutions of the 2-column CG back into s,t
+------------------------------------------------------------------------- */
+
+void FixQEqReax::finish_CG2()
+{
+  for( int i = 0; i < N; ++i ) {
+    s[i] = x2[i][0];
+    t[i] = x2[i][1];
+  }
+}
+
+/* ----------------------------------------------------------------------
+   preconditioned CG for s and t together
+   each iteration does one matvec, one forward and one reverse comm,
+     and two MPI_Allreduce() for both systems, instead of twice that
+   each system stops being updated once it has converged, so s,t
+     are identical to solving for them one after the other with CG()
+   return sum of iteration counts of both systems, as for 2 CG() calls
+------------------------------------------------------------------------- */
+
+int FixQEqReax::CG2()
+{
+  int i, j, jj, c, imax, nn;
+  int *ilist;
+  int active[2], niter[2];
+  double alpha[2], beta[2], b_norm[2], sig_old[2], sig_new[2];
+  double my_sum[4], sum[4];
+
+  if (reaxc) {
+    nn = reaxc->list->inum;
+    ilist = reaxc->list->ilist;
+  } else {
+    nn = list->inum;
+    ilist = list->ilist;
+  }
+
+  int *mask = atom->mask;
+  imax = 200;
+
+  init_CG2();
+  matvec2( x2, q2 );
+
+  my_sum[0] = my_sum[1] = my_sum[2] = my_sum[3] = 0.0;
+  for( jj = 0; jj < nn; ++jj ) {
+    j = ilist[jj];
+    if (mask[j] & groupbit)
+      for( c = 0; c < 2; ++c ) {
+        r2[j][c] = 1. * b2[j][c] + -1. * q2[j][c];
+        d2[j][c] = r2[j][c] * Hdia_inv[j]; //pre-condition
+        my_sum[c] += SQR( b2[j][c] );
+        my_sum[2+c] += r2[j][c] * d2[j][c];
+      }
+  }
+
+  MPI_Allreduce( my_sum, sum, 4, MPI_DOUBLE, MPI_SUM, world );
+
+  for( c = 0; c < 2; ++c ) {
+    b_norm[c] = sqrt( sum[c] );
+    sig_new[c] = sum[2+c];
+    active[c] = sqrt(sig_new[c]) / b_norm[c] > tolerance;
+    niter[c] = 1;
+  }
+
+  for( i = 1; i < imax && (active[0] || active[1]); ++i ) {
+    matvec2( d2, q2 );
+
+    my_sum[0] = my_sum[1] = 0.0;
+    for( jj = 0; jj < nn; ++jj ) {
+      j = ilist[jj];
+      if (mask[j] & groupbit) {
+        my_sum[0] += d2[j][0] * q2[j][0];
+        my_sum[1] += d2[j][1] * q2[j][1];
+      }
+    }
+    MPI_Allreduce( my_sum, sum, 2, MPI_DOUBLE, MPI_SUM, world );
+
+    for( c = 0; c < 2; ++c ) alpha[c] = sig_new[c] / sum[c];
+
+    // update and pre-condition active systems
+
+    my_sum[0] = my_sum[1] = 0.0;
+    for( jj = 0; jj < nn; ++jj ) {
+      j = ilist[jj];
+      if (mask[j] & groupbit)
+        for( c = 0; c < 2; ++c ) {
+          if (!active[c]) continue;
+          x2[j][c] += alpha[c] * d2[j][c];
+          r2[j][c] += -alpha[c] * q2[j][c];
+          p2[j][c] = r2[j][c] * Hdia_inv[j];
+          my_sum[c] += r2[j][c] * p2[j][c];
+        }
+    }
+
+    for( c = 0; c < 2; ++c ) sig_old[c] = sig_new[c];
+    MPI_Allreduce( my_sum, sig_new, 2, MPI_DOUBLE, MPI_SUM, world );
+
+    for( c = 0; c < 2; ++c ) beta[c] = sig_new[c] / sig_old[c];
+
+    for( jj = 0; jj < nn; ++jj ) {
+      j = ilist[jj];
+      if (mask[j] & groupbit)
+        for( c = 0; c < 2; ++c )
+          if (active[c]) d2[j][c] = 1. * p2[j][c] + beta[c] * d2[j][c];
+    }
+
+    for( c = 0; c < 2; ++c )
+      if (active[c] && !(sqrt(sig_new[c]) / b_norm[c] > tolerance)) {
+        active[c] = 0;
+        niter[c] = i+1;
+      }
+  }
+
+  for( c = 0; c < 2; ++c )
+    if (active[c]) niter[c] = i;
+
+  finish_CG2();
+
+  if ((active[0] || active[1]) && comm->me == 0) {
+    char str[128];
+    sprintf(str,"Fix qeq/reax CG convergence failed after %d iterations "
+            "at " BIGINT_FORMAT " step",i,update->ntimestep);
+    error->warning(FLERR,str);
+  }
+
+  return niter[0] + niter[1];
+}
+
+/* ----------------------------------------------------------------------
+   pipelined preconditioned CG for s and t together, following
+     Ghysels and Vanroose, Parallel Computing, 40, 224 (2014)
+   both dot products of an iteration are combined into one reduction,
+     which overlaps with the next matvec and its comm if MPI-3 is available
+   converges to the same tolerance as CG(), but rounding differs
+   return sum of iteration counts of both systems
+------------------------------------------------------------------------- */
+
+int FixQEqReax::pipelined_CG2()
+{
+  int i, j, jj, c, imax, nn;
+  int *ilist;
+  int active[2], niter[2];
+  double alpha[2], beta[2], b_norm[2], gamma[2], delta[2];
+  double alpha_old[2], gamma_old[2];
+  double my_sum[4], sum[4];
+
+  if (reaxc) {
+    nn = reaxc->list->inum;
+    ilist = reaxc->list->ilist;
+  } else {
+    nn = list->inum;
+    ilist = list->ilist;
+  }
+
+  int *mask = atom->mask;
+  imax = 200;
+
+  // r = b - Ax, u = M^-1 r, w = Au
+
+  init_CG2();
+  matvec2( x2, q2 );
+
+  my_sum[0] = my_sum[1] = 0.0;
+  for( jj = 0; jj < nn; ++jj ) {
+    j = ilist[jj];
+    if (mask[j] & groupbit)
+      for( c = 0; c < 2; ++c ) {
+        r2[j][c] = b2[j][c] - q2[j][c];
+        u2[j][c] = r2[j][c] * Hdia_inv[j];
+        my_sum[c] += SQR( b2[j][c] );
+      }
+  }
+
+  MPI_Allreduce( my_sum, sum, 2, MPI_DOUBLE, MPI_SUM, world );
+  for( c = 0; c < 2; ++c ) {
+    b_norm[c] = sqrt( sum[c] );
+    active[c] = 1;
+    niter[c] = imax;
+  }
+
+  matvec2( u2, w2 );
+
+  for( i = 1; i < imax; ++i ) {
+
+    // gamma = (r,u), delta = (w,u)
+
+    my_sum[0] = my_sum[1] = my_sum[2] = my_sum[3] = 0.0;
+    for( jj = 0; jj < nn; ++jj ) {
+      j = ilist[jj];
+      if (mask[j] & groupbit)
+        for( c = 0; c < 2; ++c ) {
+          my_sum[c] += r2[j][c] * u2[j][c];
+          my_sum[2+c] += w2[j][c] * u2[j][c];
+        }
+    }
+
+#ifdef QEQ_IALLREDUCE
+    MPI_Request request;
+    MPI_Iallreduce( my_sum, sum, 4, MPI_DOUBLE, MPI_SUM, world, &request );
+#else
+    MPI_Allreduce( my_sum, sum, 4, MPI_DOUBLE, MPI_SUM, world );
+#endif
+
+    // m = M^-1 w, n = Am, while the reduction is in progress
+
+    for( jj = 0; jj < nn; ++jj ) {
+      j = ilist[jj];
+      if (mask[j] & groupbit) {
+        m2[j][0] = w2[j][0] * Hdia_inv[j];
+        m2[j][1] = w2[j][1] * Hdia_inv[j];
+      }
+    }
+
+    matvec2( m2, n2 );
+
+#ifdef QEQ_IALLREDUCE
+    MPI_Wait( &request, MPI_STATUS_IGNORE );
+#endif
+
+    for( c = 0; c < 2; ++c ) {
+      gamma[c] = sum[c];
+      delta[c] = sum[2+c];
+      if (active[c] && !(sqrt(gamma[c]) / b_norm[c] > tolerance)) {
+        active[c] = 0;
+        niter[c] = i;
+      }
+    }
+    if (!active[0] && !active[1]) break;
+
+    for( c = 0; c < 2; ++c ) {
+      if (!active[c]) continue;
+      if (i > 1) {
+        beta[c] = gamma[c] / gamma_old[c];
+        alpha[c] = gamma[c] /
+          (delta[c] - beta[c] * gamma[c] / alpha_old[c]);
+      } else {
+        beta[c] = 0.0;
+        alpha[c] = gamma[c] / delta[c];
+      }
+    }
+
+    // z = n + beta z, q = m + beta q, s = w + beta s, p = u + beta p
+    // x += alpha p, r -= alpha s, u -= alpha q, w -= alpha z
+
+    for( jj = 0; jj < nn; ++jj ) {
+      j = ilist[jj];
+      if (mask[j] & groupbit)
+        for( c = 0; c < 2; ++c ) {
+          if (!active[c]) continue;
+          if (i > 1) {
+            z2[j][c] = n2[j][c] + beta[c] * z2[j][c];
+            q2[j][c] = m2[j][c] + beta[c] * q2[j][c];
+            s2[j][c] = w2[j][c] + beta[c] * s2[j][c];
+            p2[j][c] = u2[j][c] + beta[c] * p2[j][c];
+          } else {
+            z2[j][c] = n2[j][c];
+            q2[j][c] = m2[j][c];
+            s2[j][c] = w2[j][c];
+            p2[j][c] = u2[j][c];
+          }
+          x2[j][c] += alpha[c] * p2[j][c];
+          r2[j][c] -= alpha[c] * s2[j][c];
+          u2[j][c] -= alpha[c] * q2[j][c];
+          w2[j][c] -= alpha[c] * z2[j][c];
+        }
+    }
+
+    for( c = 0; c < 2; ++c ) {
+      alpha_old[c] = alpha[c];
+      gamma_old[c] = gamma[c];
+    }
+  }
+
+  finish_CG2();
+
+  if ((active[0] || active[1]) && comm->me == 0) {
+    char str[128];
+    sprintf(str,"Fix qeq/reax CG convergence failed after %d iterations "
+            "at " BIGINT_FORMAT " step",i,update->ntimestep);
+    error->warning(FLERR,str);
+  }
+
+  return niter[0] + niter[1];
+}
+
+/* ----------------------------------------------------------------------
+   b = Hx for both columns of x
+   x is communicated to ghost atoms first, partial sums of b on ghost
+     atoms are summed back to their owners, both columns in one message
+------------------------------------------------------------------------- */
+
+void FixQEqReax::matvec2( double **x, double **b )
+{
+  pack_flag = 5;
+  fwd2 = x;
+  rev2 = b;
+  comm->forward_comm_fix(this); //Dist_vector( x );
+  sparse_matvec2( &H, x, b );
+  comm->reverse_comm_fix(this); //Coll_vector( b );
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixQEqReax::sparse_matvec2( sparse_matrix *A, double **x, double **b )
+{
+  int i, j, itr_j;
+  int nn, NN, ii;
+  int *ilist;
+  double val;
+
+  if (reaxc) {
+    nn = reaxc->list->inum;
+    NN = reaxc->list->inum + reaxc->list->gnum;
+    ilist = reaxc->list->ilist;
+  } else {
+    nn = list->inum;
+    NN = list->inum + list->gnum;
+    ilist = list->ilist;
+  }
+
+  for( ii = 0; ii < nn; ++ii ) {
+    i = ilist[ii];
+    if (atom->mask[i] & groupbit) {
+      b[i][0] = eta[ atom->type[i] ] * x[i][0];
+      b[i][1] = eta[ atom->type[i] ] * x[i][1];
+    }
+  }
+
+  for( ii = nn; ii < NN; ++ii ) {
+    i = ilist[ii];
+    if (atom->mask[i] & groupbit)
+      b[i][0] = b[i][1] = 0;
+  }
+
+  for( ii = 0; ii < nn; ++ii ) {
+    i = ilist[ii];
+    if (atom->mask[i] & groupbit) {
+      for( itr_j=A->firstnbr[i]; itr_j<A->firstnbr[i]+A->numnbrs[i]; itr_j++) {
+        j = A->jlist[itr_j];
+        val = A->val[itr_j];
+        b[i][0] += val * x[j][0];
+        b[i][1] += val * x[j][1];
+        b[j][0] += val * x[i][0];
+        b[j][1] += val * x[i][1];
+      }
+    }
+  }
+}
+
 /* ---------------------------------------------------------------------- */
 
 void FixQEqReax::sparse_matvec( sparse_matrix *A, double *x, double *b )
@@ -817,6 +1276,13 @@ int FixQEqReax::pack_forward_comm(int n, int *list, double *buf,
     for(m = 0; m < n; m++) buf[m] = t[list[m]];
   else if( pack_flag == 4 )
     for(m = 0; m < n; m++) buf[m] = atom->q[list[m]];
+  else if( pack_flag == 5 ) {
+    for(m = 0; m < n; m++) {
+      buf[2*m] = fwd2[list[m]][0];
+      buf[2*m+1] = fwd2[list[m]][1];
+    }
+    return 2*n;
+  }
 
   return n;
 }
@@ -835,6 +1301,11 @@ void FixQEqReax::unpack_forward_comm(int n, int first, double *buf)
     for(m = 0, i = first; m < n; m++, i++) t[i] = buf[m];
   else if( pack_flag == 4)
     for(m = 0, i = first; m < n; m++, i++) atom->q[i] = buf[m];
+  else if( pack_flag == 5)
+    for(m = 0, i = first; m < n; m++, i++) {
+      fwd2[i][0] = buf[2*m];
+      fwd2[i][1] = buf[2*m+1];
+    }
 }
 
 /* ---------------------------------------------------------------------- */
@@ -842,6 +1313,13 @@ void FixQEqReax::unpack_forward_comm(int n, int first, double *buf)
 int FixQEqReax::pack_reverse_comm(int n, int first, double *buf)
 {
   int i, m;
+  if( pack_flag == 5 ) {
+    for(m = 0, i = first; m < n; m++, i++) {
+      buf[2*m] = rev2[i][0];
+      buf[2*m+1] = rev2[i][1];
+    }
+    return 2*n;
+  }
   for(m = 0, i = first; m < n; m++, i++) buf[m] = q[i];
   return n;
 }
@@ -850,6 +1328,13 @@ int FixQEqReax::pack_reverse_comm(int n, int first, double *buf)
 
 void FixQEqReax::unpack_reverse_comm(int n, int *list, double *buf)
 {
+  if( pack_flag == 5 ) {
+    for(int m = 0; m < n; m++) {
+      rev2[list[m]][0] += buf[2*m];
+      rev2[list[m]][1] += buf[2*m+1];
+    }
+    return;
+  }
   for(int m = 0; m < n; m++) q[list[m]] += buf[m];
 }
 
@@ -863,6 +1348,8 @@ double FixQEqReax::memory_usage()
 
   bytes = atom->nmax*nprev*2 * sizeof(double); // s_hist & t_hist
   bytes += atom->nmax*11 * sizeof(double); // storage
+  if (dualflag) bytes += atom->nmax*12 * sizeof(double); // s,t CG storage
+  if (pipeflag) bytes += atom->nmax*12 * sizeof(double); // pipelined CG
   bytes += n_cap*2 * sizeof(int); // matrix...
   bytes += m_cap * sizeof(int);
   bytes += m_cap * sizeof(double);
@@ -66,6 +66,9 @@ class FixQEqReax : public Fix {
   double swa, swb;      // lower/upper Taper cutoff radius
   double Tap[8];        // Taper function
   double tolerance;     // tolerance for the norm of the rel residual in CG
+  int dualflag;         // 1 if solve for s and t together
+  int pipeflag;         // 1 if use pipelined CG for s and t together
+  int extrap_s,extrap_t;    // order of extrapolation of s,t from history
 
   double *chi,*eta,*gamma;  // qeq parameters
   double **shld;
@@ -94,6 +97,11 @@ class FixQEqReax : public Fix {
   //CG storage
   double *p, *q, *r, *d;
 
+  // storage for s and t solved together, column 0 = s, column 1 = t
+  double **x2, **b2, **p2, **q2, **r2, **d2;
+  double **u2, **w2, **m2, **n2, **z2, **s2;   // pipelined CG only
+  double **fwd2, **rev2;    // vectors to forward/reverse comm
+
   //GMRES storage
   //double *g,*y;
   //double **v;
@@ -117,8 +125,15 @@ class FixQEqReax : public Fix {
   void calculate_Q();
 
   int CG(double*,double*);
+  int CG2();
+  int pipelined_CG2();
+  void init_CG2();
+  void finish_CG2();
+  double extrapolate(double *, int);
   //int GMRES(double*,double*);
   void sparse_matvec(sparse_matrix*,double*,double*);
+  void sparse_matvec2(sparse_matrix*,double**,double**);
+  void matvec2(double**,double**);
 
   int pack_forward_comm(int, int *, double *, int, int *);
   void unpack_forward_comm(int, int, double *);
@@ -55,6 +55,7 @@ Atom::Atom(LAMMPS *lmp) : Pointers(lmp)
 {
   natoms = 0;
   nlocal = nghost = nmax = 0;
+  fthread = 1;
   ntypes = 0;
   nbondtypes = nangletypes = ndihedraltypes = nimpropertypes = 0;
   nbonds = nangles = ndihedrals = nimpropers = 0;
@@ -725,9 +726,10 @@ void Atom::deallocate_topology()
 /* ----------------------------------------------------------------------
    unpack n lines from Atom section of data file
    call style-specific routine to parse line
+   if allflag, keep all atoms inside global box, caller migrates them to owners
 ------------------------------------------------------------------------- */
 
-void Atom::data_atoms(int n, char *buf)
+void Atom::data_atoms(int n, char *buf, int allflag)
 {
   int m,xptr,iptr;
   imageint imagedata;
@@ -799,6 +801,31 @@ void Atom::data_atoms(int n, char *buf)
     }
   }
 
+  // if allflag, bounds are entire global box
+
+  if (allflag) {
+    if (triclinic == 0) {
+      sublo[0] = domain->boxlo[0]; subhi[0] = domain->boxhi[0];
+      sublo[1] = domain->boxlo[1]; subhi[1] = domain->boxhi[1];
+      sublo[2] = domain->boxlo[2]; subhi[2] = domain->boxhi[2];
+    } else {
+      sublo[0] = sublo[1] = sublo[2] = 0.0;
+      subhi[0] = subhi[1] = subhi[2] = 1.0;
+    }
+    if (domain->xperiodic) {
+      sublo[0] -= epsilon[0];
+      subhi[0] += epsilon[0];
+    }
+    if (domain->yperiodic) {
+      sublo[1] -= epsilon[1];
+      subhi[1] += epsilon[1];
+    }
+    if (domain->zperiodic) {
+      sublo[2] -= epsilon[2];
+      subhi[2] += epsilon[2];
+    }
+  }
+
   // xptr = which word in line starts xyz coords
   // iptr = which word in line starts ix,iy,iz image flags
 
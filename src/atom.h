@@ -29,6 +29,7 @@ class Atom : protected Pointers {
                                 // natoms may not be current if atoms lost
   int nlocal,nghost;            // # of owned and ghost atoms on this proc
   int nmax;                     // max # of owned+ghost in arrays on this proc
+  int fthread;                  // 1 if f holds a copy per OpenMP thread
   int tag_enable;               // 0/1 if atom ID tags are defined
   int molecular;                // 0 = atomic, 1 = standard molecular system,
                                 // 2 = molecule template system
@@ -187,7 +188,7 @@ class Atom : protected Pointers {
 
   void deallocate_topology();
 
-  void data_atoms(int, char *);
+  void data_atoms(int, char *, int allflag = 0);
   void data_vels(int, char *);
 
   void data_bonds(int, char *, int *);
@@ -15,6 +15,7 @@
 #include "stdlib.h"
 #include "atom_vec.h"
 #include "atom.h"
+#include "comm.h"
 #include "force.h"
 #include "domain.h"
 #include "error.h"
@@ -97,6 +98,16 @@ void AtomVec::grow_nmax()
   nmax += DELTA;
 }
 
+/* ----------------------------------------------------------------------
+   # of copies of f to allocate, one per thread unless no style uses them
+------------------------------------------------------------------------- */
+
+int AtomVec::nthreads_f()
+{
+  if (atom->fthread) return comm->nthreads;
+  return 1;
+}
+
 /* ----------------------------------------------------------------------
    grow nmax_bonus so it is a multiple of DELTA_BONUS
 ------------------------------------------------------------------------- */
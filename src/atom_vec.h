@@ -146,6 +146,7 @@ class AtomVec : protected Pointers {
 
   void grow_nmax();
   int grow_nmax_bonus(int);
+  int nthreads_f();
 };
 
 }
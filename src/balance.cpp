@@ -25,6 +25,13 @@
 #include "domain.h"
 #include "force.h"
 #include "update.h"
+#include "modify.h"
+#include "fix_store.h"
+#include "imbalance.h"
+#include "imbalance_neigh.h"
+#include "imbalance_time.h"
+#include "imbalance_fix.h"
+#include "imbalance_var.h"
 #include "memory.h"
 #include "error.h"
 
@@ -35,6 +42,8 @@ enum{NONE,UNIFORM,USER};
 enum{X,Y,Z};
 enum{LAYOUT_UNIFORM,LAYOUT_NONUNIFORM,LAYOUT_TILED};    // several files
 
+#define BIG 1.0e20
+
 /* ---------------------------------------------------------------------- */
 
 Balance::Balance(LAMMPS *lmp) : Pointers(lmp)
@@ -48,6 +57,12 @@ Balance::Balance(LAMMPS *lmp) : Pointers(lmp)
   user_xsplit = user_ysplit = user_zsplit = NULL;
   shift_allocate = 0;
 
+  wtflag = 0;
+  nimbalance = 0;
+  imbalances = NULL;
+  id_fixstore = NULL;
+  fixstore = NULL;
+
   rcb = NULL;
 
   fp = NULL;
@@ -79,6 +94,14 @@ Balance::~Balance()
 
   delete rcb;
 
+  for (int i = 0; i < nimbalance; i++) delete imbalances[i];
+  delete [] imbalances;
+
+  // check nfix in case all fixes have already been deleted
+
+  if (id_fixstore && modify->nfix) modify->delete_fix(id_fixstore);
+  delete [] id_fixstore;
+
   if (fp) fclose(fp);
 }
 
@@ -201,6 +224,8 @@ void Balance::command(int narg, char **arg)
         if (fp == NULL) error->one(FLERR,"Cannot open balance output file");
       }
       iarg += 2;
+    } else if (strcmp(arg[iarg],"weight") == 0) {
+      iarg += weight_options(narg-iarg,&arg[iarg]);
     } else error->all(FLERR,"Illegal balance command");
   }
 
@@ -246,6 +271,15 @@ void Balance::command(int narg, char **arg)
 
   lmp->init();
 
+  // per-atom weights are stored in a fix so they migrate with atoms
+  // set them before exchange(), while neighbor list indices are valid
+
+  if (wtflag) {
+    weight_storage(NULL);
+    init_imbalance();
+    set_weights();
+  }
+
   if (domain->triclinic) domain->x2lamda(atom->nlocal);
   domain->pbc();
   domain->reset_box();
@@ -253,10 +287,12 @@ void Balance::command(int narg, char **arg)
   comm->exchange();
   if (domain->triclinic) domain->lamda2x(atom->nlocal);
 
-  // imbinit = initial imbalance
+  // imbinit = initial imbalance, weighted if requested
 
   int maxinit;
-  double imbinit = imbalance_nlocal(maxinit);
+  double maxwtinit;
+  imbalance_nlocal(maxinit);
+  double imbinit = imbalance_factor(maxwtinit);
 
   // no load-balance if imbalance doesn't exceed threshhold
   // unless switching from tiled to non tiled layout, then force rebalance
@@ -357,15 +393,21 @@ void Balance::command(int narg, char **arg)
   }
 
   // imbfinal = final imbalance based on final nlocal
+  // weights moved with the atoms, so also valid for weighted imbalance
 
   int maxfinal;
-  double imbfinal = imbalance_nlocal(maxfinal);
+  double maxwtfinal;
+  imbalance_nlocal(maxfinal);
+  double imbfinal = imbalance_factor(maxwtfinal);
 
   if (me == 0) {
     if (screen) {
       fprintf(screen,"  iteration count = %d\n",niter);
       fprintf(screen,"  initial/final max atoms/proc = %d %d\n",
               maxinit,maxfinal);
+      if (wtflag) 
+        fprintf(screen,"  initial/final max weight/proc = %g %g\n",
+                maxwtinit,maxwtfinal);
       fprintf(screen,"  initial/final imbalance factor = %g %g\n",
               imbinit,imbfinal);
     }
@@ -373,11 +415,16 @@ void Balance::command(int narg, char **arg)
       fprintf(logfile,"  iteration count = %d\n",niter);
       fprintf(logfile,"  initial/final max atoms/proc = %d %d\n",
               maxinit,maxfinal);
+      if (wtflag) 
+        fprintf(logfile,"  initial/final max weight/proc = %g %g\n",
+                maxwtinit,maxwtfinal);
       fprintf(logfile,"  initial/final imbalance factor = %g %g\n",
               imbinit,imbfinal);
     }
   }
 
+  if (wtflag) weight_info();
+
   if (style != BISECTION) {
     if (me == 0) {
       if (screen) {
@@ -426,15 +473,40 @@ double Balance::imbalance_nlocal(int &max)
   return imbalance;
 }
 
+/* ----------------------------------------------------------------------
+   calculate imbalance based on per-atom weights if defined, else nlocal
+   return max = max weight per proc
+   return imbalance factor = max weight per proc / ave weight per proc
+------------------------------------------------------------------------- */
+
+double Balance::imbalance_factor(double &max)
+{
+  double mycost,totalcost;
+  int nlocal = atom->nlocal;
+
+  if (wtflag) {
+    double *weight = fixstore->vstore;
+    mycost = 0.0;
+    for (int i = 0; i < nlocal; i++) mycost += weight[i];
+  } else mycost = nlocal;
+
+  MPI_Allreduce(&mycost,&max,1,MPI_DOUBLE,MPI_MAX,world);
+  MPI_Allreduce(&mycost,&totalcost,1,MPI_DOUBLE,MPI_SUM,world);
+
+  double imbalance = 1.0;
+  if (max > 0.0) imbalance = max / (totalcost/nprocs);
+  return imbalance;
+}
+
 /* ----------------------------------------------------------------------
    calculate imbalance based on processor splits in 3 dims
    atoms must be in lamda coords (0-1) before called
    map atoms to 3d grid of procs
-   return max = max atom per proc
+   return max = max atom (or weight) per proc
    return imbalance factor = max atom per proc / ave atom per proc
 ------------------------------------------------------------------------- */
 
-double Balance::imbalance_splits(int &max)
+double Balance::imbalance_splits(double &max)
 {
   double *xsplit = comm->xsplit;
   double *ysplit = comm->ysplit;
@@ -444,24 +516,38 @@ double Balance::imbalance_splits(int &max)
   int ny = comm->procgrid[1];
   int nz = comm->procgrid[2];
 
-  for (int i = 0; i < nprocs; i++) proccount[i] = 0;
+  for (int i = 0; i < nprocs; i++) proccount[i] = 0.0;
 
   double **x = atom->x;
   int nlocal = atom->nlocal;
   int ix,iy,iz;
 
-  for (int i = 0; i < nlocal; i++) {
-    ix = binary(x[i][0],nx,xsplit);
-    iy = binary(x[i][1],ny,ysplit);
-    iz = binary(x[i][2],nz,zsplit);
-    proccount[iz*nx*ny + iy*nx + ix]++;
+  if (wtflag) {
+    double *weight = fixstore->vstore;
+    for (int i = 0; i < nlocal; i++) {
+      ix = binary(x[i][0],nx,xsplit);
+      iy = binary(x[i][1],ny,ysplit);
+      iz = binary(x[i][2],nz,zsplit);
+      proccount[iz*nx*ny + iy*nx + ix] += weight[i];
+    }
+  } else {
+    for (int i = 0; i < nlocal; i++) {
+      ix = binary(x[i][0],nx,xsplit);
+      iy = binary(x[i][1],ny,ysplit);
+      iz = binary(x[i][2],nz,zsplit);
+      proccount[iz*nx*ny + iy*nx + ix] += 1.0;
+    }
   }
 
-  MPI_Allreduce(proccount,allproccount,nprocs,MPI_INT,MPI_SUM,world);
-  max = 0;
-  for (int i = 0; i < nprocs; i++) max = MAX(max,allproccount[i]);
+  MPI_Allreduce(proccount,allproccount,nprocs,MPI_DOUBLE,MPI_SUM,world);
+  max = 0.0;
+  double total = 0.0;
+  for (int i = 0; i < nprocs; i++) {
+    max = MAX(max,allproccount[i]);
+    total += allproccount[i];
+  }
   double imbalance = 1.0;
-  if (max) imbalance = max / (1.0 * atom->natoms / nprocs);
+  if (max > 0.0) imbalance = max / (total / nprocs);
   return imbalance;
 }
 
@@ -509,11 +595,14 @@ int *Balance::bisection(int sortflag)
   double *shrinklo = &shrinkall[0];
   double *shrinkhi = &shrinkall[3];
 
-  // invoke RCB
+  // invoke RCB, with per-atom weights if defined
   // then invert() to create list of proc assignements for my atoms 
 
-  //rcb->compute(dim,atom->nlocal,atom->x,NULL,boxlo,boxhi);
-  rcb->compute(dim,atom->nlocal,atom->x,NULL,shrinklo,shrinkhi);
+  double *wt = NULL;
+  if (wtflag) wt = fixstore->vstore;
+
+  //rcb->compute(dim,atom->nlocal,atom->x,wt,boxlo,boxhi);
+  rcb->compute(dim,atom->nlocal,atom->x,wt,shrinklo,shrinkhi);
   rcb->invert(sortflag);
 
   // reset RCB lo/hi bounding box to full simulation box as needed
@@ -582,14 +671,14 @@ void Balance::shift_setup_static(char *str)
   int max = MAX(comm->procgrid[0],comm->procgrid[1]);
   max = MAX(max,comm->procgrid[2]);
 
-  count = new bigint[max];
-  onecount = new bigint[max];
-  sum = new bigint[max+1];
-  target = new bigint[max+1];
+  count = new double[max];
+  onecount = new double[max];
+  sum = new double[max+1];
+  target = new double[max+1];
   lo = new double[max+1];
   hi = new double[max+1];
-  losum = new bigint[max+1];
-  hisum = new bigint[max+1];
+  losum = new double[max+1];
+  hisum = new double[max+1];
 
   // if current layout is TILED, set initial uniform splits in Comm
   // this gives starting point to subsequent shift balancing
@@ -631,7 +720,8 @@ void Balance::shift_setup(char *str, int nitermax_in, double thresh_in)
 
 int Balance::shift()
 {
-  int i,j,k,m,np,max;
+  int i,j,k,m,np;
+  double max;
   double *split;
 
   // no balancing if no atoms
@@ -661,23 +751,29 @@ int Balance::shift()
     else if (bdim[idim] == Z) split = comm->zsplit;
 
     // intial count and sum
+    // totalcost = total # of atoms or total weight of all atoms
 
     np = procgrid[bdim[idim]];
     tally(bdim[idim],np,split);
+    double totalcost = sum[np];
 
     // target[i] = desired sum at split I
+    // use whole atom counts if unweighted
 
-    for (i = 0; i < np; i++)
-      target[i] = static_cast<int> (1.0*natoms/np * i + 0.5);
-    target[np] = natoms;
+    if (wtflag)
+      for (i = 0; i < np; i++) target[i] = totalcost/np * i;
+    else
+      for (i = 0; i < np; i++)
+        target[i] = static_cast<bigint> (totalcost/np * i + 0.5);
+    target[np] = totalcost;
 
     // lo[i] = closest split <= split[i] with a sum <= target
     // hi[i] = closest split >= split[i] with a sum >= target
 
     lo[0] = hi[0] = 0.0;
     lo[np] = hi[np] = 1.0;
-    losum[0] = hisum[0] = 0;
-    losum[np] = hisum[np] = natoms;
+    losum[0] = hisum[0] = 0.0;
+    losum[np] = hisum[np] = totalcost;
 
     for (i = 1; i < np; i++) {
       for (j = i; j >= 0; j--)
@@ -723,7 +819,7 @@ int Balance::shift()
 
       doneflag = 1;
       for (i = 1; i < np; i++)
-        if (fabs(1.0*(sum[i]-target[i]))/target[i] > delta) doneflag = 0;
+        if (fabs(sum[i]-target[i])/target[i] > delta) doneflag = 0;
       if (doneflag) break;
     }
 
@@ -790,25 +886,33 @@ int Balance::shift()
    count atoms in each slice, based on their dim coordinate
    N = # of slices
    split = N+1 cuts between N slices
-   return updated count = particles per slice
+   return updated count = particles (or particle weight) per slice
    retrun updated sum = cummulative count below each of N+1 splits
    use binary search to find which slice each atom is in
 ------------------------------------------------------------------------- */
 
 void Balance::tally(int dim, int n, double *split)
 {
-  for (int i = 0; i < n; i++) onecount[i] = 0;
+  for (int i = 0; i < n; i++) onecount[i] = 0.0;
 
   double **x = atom->x;
   int nlocal = atom->nlocal;
   int index;
 
-  for (int i = 0; i < nlocal; i++) {
-    index = binary(x[i][dim],n,split);
-    onecount[index]++;
+  if (wtflag) {
+    double *weight = fixstore->vstore;
+    for (int i = 0; i < nlocal; i++) {
+      index = binary(x[i][dim],n,split);
+      onecount[index] += weight[i];
+    }
+  } else {
+    for (int i = 0; i < nlocal; i++) {
+      index = binary(x[i][dim],n,split);
+      onecount[index] += 1.0;
+    }
   }
 
-  MPI_Allreduce(onecount,count,n,MPI_LMP_BIGINT,MPI_SUM,world);
+  MPI_Allreduce(onecount,count,n,MPI_DOUBLE,MPI_SUM,world);
 
   sum[0] = 0;
   for (int i = 1; i < n+1; i++)
@@ -867,7 +971,7 @@ int Balance::adjust(int n, double *split)
       change = 1;
       if (rho == 0) split[i] = 0.5 * (lo[i]+hi[i]);
       else {
-        fraction = 1.0*(target[i]-losum[i]) / (hisum[i]-losum[i]);
+        fraction = (target[i]-losum[i]) / (hisum[i]-losum[i]);
         split[i] = lo[i] + fraction * (hi[i]-lo[i]);
       }
     }
@@ -908,6 +1012,130 @@ int Balance::binary(double value, int n, double *vec)
   return index;
 }
 
+/* ----------------------------------------------------------------------
+   parse one weight keyword and its style args
+   called from balance command and fix balance
+   return # of args consumed, including the "weight" keyword
+------------------------------------------------------------------------- */
+
+int Balance::weight_options(int narg, char **arg)
+{
+  if (narg < 2) error->all(FLERR,"Illegal balance weight command");
+
+  Imbalance *imb = NULL;
+  if (strcmp(arg[1],"neigh") == 0) imb = new ImbalanceNeigh(lmp);
+  else if (strcmp(arg[1],"time") == 0) imb = new ImbalanceTime(lmp);
+  else if (strcmp(arg[1],"fix") == 0) imb = new ImbalanceFix(lmp);
+  else if (strcmp(arg[1],"var") == 0) imb = new ImbalanceVar(lmp);
+  else error->all(FLERR,"Unknown balance weight style");
+
+  int n = imb->options(narg-2,&arg[2]);
+
+  Imbalance **newlist = new Imbalance*[nimbalance+1];
+  for (int i = 0; i < nimbalance; i++) newlist[i] = imbalances[i];
+  newlist[nimbalance++] = imb;
+  delete [] imbalances;
+  imbalances = newlist;
+
+  wtflag = 1;
+  return n+2;
+}
+
+/* ----------------------------------------------------------------------
+   create fix STORE to hold per-atom weights, so they migrate with atoms
+   prefix = ID of caller, NULL for balance command
+------------------------------------------------------------------------- */
+
+void Balance::weight_storage(char *prefix)
+{
+  if (fixstore) return;
+
+  const char *suffix = "_IMBALANCE_WEIGHTS";
+  int n = strlen(suffix) + 1;
+  if (prefix) n += strlen(prefix);
+  id_fixstore = new char[n];
+  if (prefix) {
+    strcpy(id_fixstore,prefix);
+    strcat(id_fixstore,suffix);
+  } else strcpy(id_fixstore,suffix+1);
+
+  char **newarg = new char*[5];
+  newarg[0] = id_fixstore;
+  newarg[1] = (char *) "all";
+  newarg[2] = (char *) "STORE";
+  newarg[3] = (char *) "0";
+  newarg[4] = (char *) "1";
+  modify->add_fix(5,newarg);
+  fixstore = (FixStore *) modify->fix[modify->nfix-1];
+  delete [] newarg;
+
+  // all atoms start with unit weight
+
+  double *weight = fixstore->vstore;
+  int nlocal = atom->nlocal;
+  for (int i = 0; i < nlocal; i++) weight[i] = 1.0;
+}
+
+/* ----------------------------------------------------------------------
+   invoke init() of all weight styles
+------------------------------------------------------------------------- */
+
+void Balance::init_imbalance()
+{
+  for (int n = 0; n < nimbalance; n++) imbalances[n]->init();
+}
+
+/* ----------------------------------------------------------------------
+   reset per-atom weights of owned atoms
+   each weight style multiplies its contribution into the weight
+------------------------------------------------------------------------- */
+
+void Balance::set_weights()
+{
+  if (!wtflag) return;
+
+  double *weight = fixstore->vstore;
+  int nlocal = atom->nlocal;
+  for (int i = 0; i < nlocal; i++) weight[i] = 1.0;
+
+  for (int n = 0; n < nimbalance; n++) imbalances[n]->compute(weight);
+}
+
+/* ----------------------------------------------------------------------
+   print weight styles and range of per-atom weights
+------------------------------------------------------------------------- */
+
+void Balance::weight_info()
+{
+  double *weight = fixstore->vstore;
+  int nlocal = atom->nlocal;
+
+  double wtlo = BIG;
+  double wthi = 0.0;
+  for (int i = 0; i < nlocal; i++) {
+    wtlo = MIN(wtlo,weight[i]);
+    wthi = MAX(wthi,weight[i]);
+  }
+
+  double range[2],rangeall[2];
+  range[0] = -wtlo;
+  range[1] = wthi;
+  MPI_Allreduce(range,rangeall,2,MPI_DOUBLE,MPI_MAX,world);
+
+  if (me == 0) {
+    if (screen) {
+      for (int n = 0; n < nimbalance; n++) imbalances[n]->info(screen);
+      fprintf(screen,"  min/max per-atom weight = %g %g\n",
+              -rangeall[0],rangeall[1]);
+    }
+    if (logfile) {
+      for (int n = 0; n < nimbalance; n++) imbalances[n]->info(logfile);
+      fprintf(logfile,"  min/max per-atom weight = %g %g\n",
+              -rangeall[0],rangeall[1]);
+    }
+  }
+}
+
 /* ----------------------------------------------------------------------
    write dump snapshot of line segments in Pizza.py mdump mesh format
    write xy lines around each proc's sub-domain for 2d
@@ -1074,13 +1302,13 @@ void Balance::debug_shift_output(int idim, int m, int np, double *split)
   fprintf(stderr,"Dimension %s, Iteration %d\n",dim,m);
 
   fprintf(stderr,"  Count:");
-  for (i = 0; i < np; i++) fprintf(stderr," " BIGINT_FORMAT,count[i]);
+  for (i = 0; i < np; i++) fprintf(stderr," %g",count[i]);
   fprintf(stderr,"\n");
   fprintf(stderr,"  Sum:");
-  for (i = 0; i <= np; i++) fprintf(stderr," " BIGINT_FORMAT,sum[i]);
+  for (i = 0; i <= np; i++) fprintf(stderr," %g",sum[i]);
   fprintf(stderr,"\n");
   fprintf(stderr,"  Target:");
-  for (i = 0; i <= np; i++) fprintf(stderr," " BIGINT_FORMAT,target[i]);
+  for (i = 0; i <= np; i++) fprintf(stderr," %g",target[i]);
   fprintf(stderr,"\n");
   fprintf(stderr,"  Actual cut:");
   for (i = 0; i <= np; i++)
@@ -1093,19 +1321,19 @@ void Balance::debug_shift_output(int idim, int m, int np, double *split)
   for (i = 0; i <= np; i++) fprintf(stderr," %g",lo[i]);
   fprintf(stderr,"\n");
   fprintf(stderr,"  Low-sum:");
-  for (i = 0; i <= np; i++) fprintf(stderr," " BIGINT_FORMAT,losum[i]);
+  for (i = 0; i <= np; i++) fprintf(stderr," %g",losum[i]);
   fprintf(stderr,"\n");
   fprintf(stderr,"  Hi:");
   for (i = 0; i <= np; i++) fprintf(stderr," %g",hi[i]);
   fprintf(stderr,"\n");
   fprintf(stderr,"  Hi-sum:");
-  for (i = 0; i <= np; i++) fprintf(stderr," " BIGINT_FORMAT,hisum[i]);
+  for (i = 0; i <= np; i++) fprintf(stderr," %g",hisum[i]);
   fprintf(stderr,"\n");
   fprintf(stderr,"  Delta:");
   for (i = 0; i < np; i++) fprintf(stderr," %g",split[i+1]-split[i]);
   fprintf(stderr,"\n");
 
-  bigint max = 0;
+  double max = 0.0;
   for (i = 0; i < np; i++) max = MAX(max,count[i]);
   fprintf(stderr,"  Imbalance factor: %g\n",1.0*max*np/target[np]);
 }
@@ -36,8 +36,18 @@ class Balance : protected Pointers {
   int shift();
   int *bisection(int sortflag = 0);
   double imbalance_nlocal(int &);
+  double imbalance_factor(double &);
   void dumpout(bigint, FILE *);
 
+  // per-atom weighting of load, used by balance and fix balance
+
+  int wtflag;                       // 1 if particle weighting is used
+  int weight_options(int, char **);
+  void weight_storage(char *);
+  void init_imbalance();
+  void set_weights();
+  void weight_info();
+
  private:
   int me,nprocs;
 
@@ -53,23 +63,28 @@ class Balance : protected Pointers {
   int shift_allocate;        // 1 if SHIFT vectors have been allocated
   int ndim;                  // length of balance string bstr
   int *bdim;                 // XYZ for each character in bstr
-  bigint *count;             // counts for slices in one dim
-  bigint *onecount;          // work vector of counts in one dim
-  bigint *sum;               // cummulative count for slices in one dim
-  bigint *target;            // target sum for slices in one dim
+  double *count;             // counts (or weights) for slices in one dim
+  double *onecount;          // work vector of counts in one dim
+  double *sum;               // cummulative count for slices in one dim
+  double *target;            // target sum for slices in one dim
   double *lo,*hi;            // lo/hi split coords that bound each target
-  bigint *losum,*hisum;      // cummulative counts at lo/hi coords
+  double *losum,*hisum;      // cummulative counts at lo/hi coords
   int rho;                   // 0 for geometric recursion
                              // 1 for density weighted recursion
 
-  int *proccount;            // particle count per processor
-  int *allproccount;
+  double *proccount;         // particle count (or weight) per processor
+  double *allproccount;
+
+  int nimbalance;            // # of weight styles
+  class Imbalance **imbalances;  // list of weight styles
+  char *id_fixstore;         // ID of fix storing per-atom weights
+  class FixStore *fixstore;  // per-atom weights, migrate with atoms
 
   int outflag;               // for output of balance results to file
   FILE *fp;
   int firststep;
 
-  double imbalance_splits(int &);
+  double imbalance_splits(double &);
   void shift_setup_static(char *);
   void tally(int, int, double *);
   int adjust(int, double *);
@@ -113,6 +128,14 @@ E: Lost atoms via balance: original %ld current %ld
 
 This should not occur.  Report the problem to the developers.
 
+E: Illegal balance weight command
+
+Self-explanatory.
+
+E: Unknown balance weight style
+
+The weight keyword must be followed by neigh, time, fix, or var.
+
 E: Balance produced bad splits
 
 This should not occur.  It means two or more cutting plane locations
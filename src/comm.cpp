@@ -28,6 +28,8 @@
 #include "dump.h"
 #include "group.h"
 #include "procmap.h"
+#include "neighbor.h"
+#include "irregular.h"
 #include "accelerator_kokkos.h"
 #include "memory.h"
 #include "error.h"
@@ -36,13 +38,15 @@
 #include "omp.h"
 #endif
 
+#include <map>
+
 using namespace LAMMPS_NS;
 
 #define BUFMIN 1000             // also in comm styles
 
 enum{SINGLE,MULTI};             // same as in Comm sub-styles
 enum{MULTIPLE};                   // same as in ProcMap
-enum{ONELEVEL,TWOLEVEL,NUMA,CUSTOM};
+enum{ONELEVEL,TWOLEVEL,NUMA,CUSTOM,NODE};
 enum{CART,CARTREORDER,XYZ};
 enum{LAYOUT_UNIFORM,LAYOUT_NONUNIFORM,LAYOUT_TILED};    // several files
 
@@ -57,6 +61,9 @@ Comm::Comm(LAMMPS *lmp) : Pointers(lmp)
   bordergroup = 0;
   cutghostuser = 0.0;
   ghost_velocity = 0;
+  overlap = 0;
+  persist = 0;
+  shm = 0;
 
   user_procgrid[0] = user_procgrid[1] = user_procgrid[2] = 0;
   coregrid[0] = coregrid[1] = coregrid[2] = 1;
@@ -71,6 +78,7 @@ Comm::Comm(LAMMPS *lmp) : Pointers(lmp)
   grid2proc = NULL;
   xsplit = ysplit = zsplit = NULL;
   rcbnew = 0;
+  rcbnode = 0;
 
   // use of OpenMP threads
   // query OpenMP for number of threads/process set by user at run-time
@@ -259,6 +267,24 @@ void Comm::modify_params(int narg, char **arg)
       else if (strcmp(arg[iarg+1],"no") == 0) ghost_velocity = 0;
       else error->all(FLERR,"Illegal comm_modify command");
       iarg += 2;
+    } else if (strcmp(arg[iarg],"overlap") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal comm_modify command");
+      if (strcmp(arg[iarg+1],"yes") == 0) overlap = 1;
+      else if (strcmp(arg[iarg+1],"no") == 0) overlap = 0;
+      else error->all(FLERR,"Illegal comm_modify command");
+      iarg += 2;
+    } else if (strcmp(arg[iarg],"persist") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal comm_modify command");
+      if (strcmp(arg[iarg+1],"yes") == 0) persist = 1;
+      else if (strcmp(arg[iarg+1],"no") == 0) persist = 0;
+      else error->all(FLERR,"Illegal comm_modify command");
+      iarg += 2;
+    } else if (strcmp(arg[iarg],"shm") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal comm_modify command");
+      if (strcmp(arg[iarg+1],"yes") == 0) shm = 1;
+      else if (strcmp(arg[iarg+1],"no") == 0) shm = 0;
+      else error->all(FLERR,"Illegal comm_modify command");
+      iarg += 2;
     } else error->all(FLERR,"Illegal comm_modify command");
   }
 }
@@ -314,6 +340,9 @@ void Comm::set_processors(int narg, char **arg)
       } else if (strcmp(arg[iarg+1],"numa") == 0) {
         gridflag = NUMA;
 
+      } else if (strcmp(arg[iarg+1],"node") == 0) {
+        gridflag = NODE;
+
       } else if (strcmp(arg[iarg],"custom") == 0) {
         if (iarg+3 > narg) error->all(FLERR,"Illegal processors command");
         gridflag = CUSTOM;
@@ -392,7 +421,10 @@ void Comm::set_processors(int narg, char **arg)
 
   if (gridflag == NUMA && mapflag != CART)
     error->all(FLERR,"Processors grid numa and map style are incompatible");
-  if (otherflag && (gridflag == NUMA || gridflag == CUSTOM))
+  if (gridflag == NODE && mapflag != CART)
+    error->all(FLERR,"Processors grid node and map style are incompatible");
+  if (otherflag &&
+      (gridflag == NUMA || gridflag == CUSTOM || gridflag == NODE))
     error->all(FLERR,
                "Processors part option and grid style are incompatible");
 }
@@ -440,6 +472,10 @@ void Comm::set_proc_grid(int outflag)
 
   } else if (gridflag == CUSTOM) {
     pmap->custom_grid(customfile,nprocs,user_procgrid,procgrid);
+
+  } else if (gridflag == NODE) {
+    double cut = MAX(cutghostuser,neighbor->cutneighmax);
+    pmap->node_grid(nprocs,user_procgrid,procgrid,coregrid,cut);
   }
 
   // error check on procgrid
@@ -480,22 +516,31 @@ void Comm::set_proc_grid(int outflag)
 
   } else if (gridflag == CUSTOM) {
     pmap->custom_map(procgrid,myloc,procneigh,grid2proc);
+
+  } else if (gridflag == NODE) {
+    pmap->node_map(procgrid,coregrid,myloc,procneigh,grid2proc);
   }
 
+  // RCB cuts for comm_style tiled are aligned with node boundaries
+  //   if procs on each node have contiguous IDs
+
+  if (gridflag == NODE) rcbnode = pmap->node_block();
+  else rcbnode = 0;
+
   // print 3d grid info to screen and logfile
 
   if (outflag && me == 0) {
     if (screen) {
       fprintf(screen,"  %d by %d by %d MPI processor grid\n",
               procgrid[0],procgrid[1],procgrid[2]);
-      if (gridflag == NUMA || gridflag == TWOLEVEL)
+      if (gridflag == NUMA || gridflag == TWOLEVEL || gridflag == NODE)
         fprintf(screen,"  %d by %d by %d core grid within node\n",
                 coregrid[0],coregrid[1],coregrid[2]);
     }
     if (logfile) {
       fprintf(logfile,"  %d by %d by %d MPI processor grid\n",
               procgrid[0],procgrid[1],procgrid[2]);
-      if (gridflag == NUMA || gridflag == TWOLEVEL)
+      if (gridflag == NUMA || gridflag == TWOLEVEL || gridflag == NODE)
         fprintf(logfile,"  %d by %d by %d core grid within node\n",
                 coregrid[0],coregrid[1],coregrid[2]);
     }
@@ -669,6 +714,159 @@ void Comm::ring(int n, int nper, void *inbuf, int messtag,
   memory->destroy(bufcopy);
 }
 
+/* ----------------------------------------------------------------------
+   rendezvous communication of datums via two irregular exchanges
+   inbuf = N datums of insize bytes, procs = rendezvous proc for each datum
+     typically an atom or molecule ID hashed to a proc, e.g. ID % nprocs
+   callback() is invoked once on each rendezvous proc with all datums it
+     received, it returns # of output datums and allocates two arrays:
+     procs = proc each output datum is sent to (via memory->create)
+     outbuf = output datums of outsize bytes (via memory->smalloc)
+     both are freed here, callback can store other results via ptr
+   outbuf = datums received back from rendezvous procs, allocated here
+     via memory->smalloc, caller must free it with memory->sfree
+   return # of datums in outbuf
+   cost is O(N/P) per proc for balanced hashing, vs O(N) for ring()
+------------------------------------------------------------------------- */
+
+int Comm::rendezvous(int n, int *procs, char *inbuf, int insize,
+                     int (*callback)(int, char *, int *&, char *&, void *),
+                     char *&outbuf, int outsize, void *ptr)
+{
+  // send input datums to rendezvous procs
+
+  Irregular *irregular = new Irregular(lmp);
+  int nrvous = irregular->create_data(n,procs,1);
+  char *inbuf_rvous = (char *)
+    memory->smalloc((bigint) nrvous*insize,"rendezvous:inbuf");
+  irregular->exchange_data(inbuf,insize,inbuf_rvous);
+  irregular->destroy_data();
+
+  // invoke callback on rendezvous datums
+
+  int *procs_rvous = NULL;
+  char *outbuf_rvous = NULL;
+  int nout = callback(nrvous,inbuf_rvous,procs_rvous,outbuf_rvous,ptr);
+  memory->sfree(inbuf_rvous);
+
+  // send output datums back from rendezvous procs
+
+  int nrecv = irregular->create_data(nout,procs_rvous,1);
+  outbuf = (char *) memory->smalloc((bigint) nrecv*outsize,"rendezvous:outbuf");
+  irregular->exchange_data(outbuf_rvous,outsize,outbuf);
+  irregular->destroy_data();
+  delete irregular;
+
+  memory->destroy(procs_rvous);
+  memory->sfree(outbuf_rvous);
+
+  return nrecv;
+}
+
+/* ----------------------------------------------------------------------
+   extend per-atom flags to entire molecules
+   flag = 1 for each owned atom that is flagged, else 0
+   on return flag = 1 for all owned atoms in a molecule with any flagged
+     atom on any proc, molID = 0 is not included
+   molecules are resolved via rendezvous comm, rendezvous proc = molID % P
+------------------------------------------------------------------------- */
+
+void Comm::flag_molecules(int *flag)
+{
+  // hash = unique molecule IDs of my atoms
+  // value = 1 if any of my atoms in the molecule are flagged
+
+  std::map<tagint,int> hash;
+  std::map<tagint,int>::iterator pos;
+
+  tagint *molecule = atom->molecule;
+  int nlocal = atom->nlocal;
+
+  for (int i = 0; i < nlocal; i++) {
+    if (molecule[i] == 0) continue;
+    pos = hash.find(molecule[i]);
+    if (pos == hash.end()) hash[molecule[i]] = flag[i] ? 1 : 0;
+    else if (flag[i]) pos->second = 1;
+  }
+
+  // one datum per unique molecule ID = ID, my proc, flag
+
+  int n = hash.size();
+  int *proclist;
+  memory->create(proclist,n,"comm:proclist");
+  MolRvous *inbuf = (MolRvous *)
+    memory->smalloc((bigint) n*sizeof(MolRvous),"comm:inbuf");
+
+  n = 0;
+  for (pos = hash.begin(); pos != hash.end(); ++pos) {
+    proclist[n] = pos->first % nprocs;
+    inbuf[n].molID = pos->first;
+    inbuf[n].proc = me;
+    inbuf[n].flag = pos->second;
+    n++;
+  }
+
+  // outbuf = IDs of my molecules with atoms flagged on other procs
+
+  char *buf;
+  int nreturn = rendezvous(n,proclist,(char *) inbuf,sizeof(MolRvous),
+                           rendezvous_molecules,buf,sizeof(tagint),
+                           (void *) this);
+  tagint *outbuf = (tagint *) buf;
+
+  memory->destroy(proclist);
+  memory->sfree(inbuf);
+
+  for (int m = 0; m < nreturn; m++) hash[outbuf[m]] = 1;
+  memory->sfree(outbuf);
+
+  // flag my atoms in any flagged molecule
+
+  for (int i = 0; i < nlocal; i++) {
+    if (molecule[i] == 0) continue;
+    if (hash[molecule[i]]) flag[i] = 1;
+  }
+}
+
+/* ----------------------------------------------------------------------
+   callback from rendezvous() in flag_molecules()
+   inbuf = list of N molecule datums from all procs
+   return molecule ID to each proc that did not flag it,
+     if some other proc flagged it
+------------------------------------------------------------------------- */
+
+int Comm::rendezvous_molecules(int n, char *inbuf,
+                               int *&procs, char *&outbuf, void *ptr)
+{
+  Comm *cptr = (Comm *) ptr;
+  Memory *memory = cptr->memory;
+
+  MolRvous *in = (MolRvous *) inbuf;
+
+  std::map<tagint,int> hash;
+  for (int i = 0; i < n; i++)
+    if (in[i].flag) hash[in[i].molID] = 1;
+
+  int nout = 0;
+  for (int i = 0; i < n; i++)
+    if (!in[i].flag && hash.find(in[i].molID) != hash.end()) nout++;
+
+  memory->create(procs,nout,"comm:procs");
+  tagint *out = (tagint *)
+    memory->smalloc((bigint) nout*sizeof(tagint),"comm:outbuf");
+
+  nout = 0;
+  for (int i = 0; i < n; i++)
+    if (!in[i].flag && hash.find(in[i].molID) != hash.end()) {
+      procs[nout] = in[i].proc;
+      out[nout] = in[i].molID;
+      nout++;
+    }
+
+  outbuf = (char *) out;
+  return nout;
+}
+
 /* ----------------------------------------------------------------------
    proc 0 reads Nlines from file into buf and bcasts buf to all procs
    caller allocates buf to max size needed
@@ -27,6 +27,11 @@ class Comm : protected Pointers {
 
   int me,nprocs;                    // proc info
   int ghost_velocity;               // 1 if ghost atoms have velocity, 0 if not
+  int overlap;                      // 1 if forward comm can overlap with
+                                    //   pair computation, 0 if not
+  int persist;                      // 1 if ghost comm uses persistent requests
+  int shm;                          // 1 if ghost comm on a node uses
+                                    //   shared memory, 0 if not
   double cutghost[3];               // cutoffs used for acquiring ghost atoms
   double cutghostuser;              // user-specified ghost cutoff
   int recv_from_partition;          // recv proc layout from this partition
@@ -53,6 +58,8 @@ class Comm : protected Pointers {
   double mysplit[3][2];             // fractional (0-1) bounds of my sub-domain
   double rcbcutfrac;                // fractional RCB cut by this proc
   int rcbcutdim;                    // dimension of RCB cut
+  int rcbnode;                      // # of procs per node if RCB cuts
+                                    //   align with nodes, else 0
 
   // methods
 
@@ -67,6 +74,8 @@ class Comm : protected Pointers {
 
   virtual void setup() = 0;                      // setup 3d comm pattern
   virtual void forward_comm(int dummy = 0) = 0;  // forward comm of atom coords
+  virtual void forward_comm_start() {}           // post forward comm msgs
+  virtual void forward_comm_finish() {forward_comm();} // complete forward comm
   virtual void reverse_comm() = 0;               // reverse comm of forces
   virtual void exchange() = 0;                   // move atoms to new procs
   virtual void borders() = 0;                    // setup list of atoms to comm
@@ -103,6 +112,10 @@ class Comm : protected Pointers {
 
   void ring(int, int, void *, int, void (*)(int, char *),
             void *, int self = 1);
+  int rendezvous(int, int *, char *, int,
+                 int (*)(int, char *, int *&, char *&, void *),
+                 char *&, int, void *);
+  void flag_molecules(int *);
   int read_lines_from_file(FILE *, int, int, char *);  
   int read_lines_from_file_universe(FILE *, int, int, char *);  
 
@@ -134,6 +147,19 @@ class Comm : protected Pointers {
   int ncores;                       // # of cores per node
   int coregrid[3];                  // 3d grid of cores within a node
   int user_coregrid[3];             // user request for cores in each dim
+
+ private:
+  // datum sent to rendezvous proc for a molecule ID
+  // flag = 1 if sending proc has a flagged atom of the molecule
+
+  struct MolRvous {
+    tagint molID;
+    int proc,flag;
+  };
+
+  // callback function for rendezvous communication
+
+  static int rendezvous_molecules(int, char *, int *&, char *&, void *);
 };
 
 }
@@ -22,6 +22,7 @@
 #include "stdlib.h"
 #include "comm_brick.h"
 #include "comm_tiled.h"
+#include "lammps.h"
 #include "universe.h"
 #include "atom.h"
 #include "atom_vec.h"
@@ -74,6 +75,10 @@ CommBrick::~CommBrick()
 
   memory->destroy(buf_send);
   memory->destroy(buf_recv);
+  memory->destroy(buf_start);
+  memory->destroy(buf_persist);
+  MPI_Type_free(&xtype);
+  free_shm();
 }
 
 /* ---------------------------------------------------------------------- */
@@ -111,6 +116,25 @@ void CommBrick::init_buffers()
   maxrecv = BUFMIN;
   memory->create(buf_recv,maxrecv,"comm:buf_recv");
 
+  nstart = nrequest = 0;
+  maxstart = 0;
+  buf_start = NULL;
+
+  persist_valid = persist_started = 0;
+  persist_x = persist_f = NULL;
+  nstage = 0;
+  nforwardreq = nreversereq = nsendtype = 0;
+  maxpersist = 0;
+  buf_persist = NULL;
+  MPI_Type_contiguous(3,MPI_DOUBLE,&xtype);
+  MPI_Type_commit(&xtype);
+
+  shmflag = shmnode = 0;
+  nodecomm = MPI_COMM_NULL;
+  nodeproc = NULL;
+  shmbase = NULL;
+  maxshm = 0;
+
   maxswap = 6;
   allocate_swap(maxswap);
 
@@ -128,6 +152,28 @@ void CommBrick::init()
 {
   Comm::init();
 
+  if ((persist || shm) && (lmp->cuda || lmp->kokkos))
+    error->all(FLERR,"Comm_modify persist or shm is not supported "
+               "with accelerator packages");
+  if (persist && shm)
+    error->all(FLERR,"Comm_modify persist and shm cannot be used together");
+  persist_valid = 0;
+
+  // shared memory is only used for coords, and only if procs share a node
+
+#ifndef LMP_COMM_SHM
+  if (shm) error->all(FLERR,"Comm_modify shm requires an MPI-3 library");
+#endif
+  // shmflag is set by next borders(), which sets up shared segments
+
+  shmflag = shmnode = 0;
+  if (shm && comm_x_only) {
+    if (nodecomm == MPI_COMM_NULL) init_shm();
+    int nodeprocs;
+    MPI_Comm_size(nodecomm,&nodeprocs);
+    if (nodeprocs > 1) shmnode = 1;
+  }
+
   // memory for multi-style communication
 
   if (mode == MULTI && multilo == NULL) {
@@ -149,6 +195,8 @@ void CommBrick::init()
 
 void CommBrick::setup()
 {
+  persist_valid = 0;
+
   // cutghost[] = max distance at which ghost atoms need to be acquired
   // for orthogonal:
   //   cutghost is in box coords = neigh->cutghost in all 3 dims
@@ -448,6 +496,24 @@ void CommBrick::forward_comm(int dummy)
   double **x = atom->x;
   double *buf;
 
+  if (shmflag) {
+    forward_comm_shm();
+    return;
+  }
+
+  // persistent requests, swaps within a stage are all in flight together
+
+  if (persist && comm_x_only) {
+    check_persist();
+    for (int istage = 0; istage < nstage; istage++) {
+      start_forward_stage(istage);
+      n = forwardfirst[istage+1] - forwardfirst[istage];
+      if (n) MPI_Waitall(n,&forwardreq[forwardfirst[istage]],
+                         MPI_STATUSES_IGNORE);
+    }
+    return;
+  }
+
   // exchange data with another proc
   // if other proc is self, just copy
   // if comm_x_only set, exchange or copy directly to x, don't unpack
@@ -503,6 +569,113 @@ void CommBrick::forward_comm(int dummy)
   }
 }
 
+/* ----------------------------------------------------------------------
+   begin forward communication of atom coords, as 1st phase of forward_comm()
+   post non-blocking send/recv for leading swaps that only send owned atoms,
+     since their coords do not depend on data received in earlier swaps
+   remaining swaps are performed by forward_comm_finish()
+   only done if comm_x_only is set, so that coords are recv'd directly into x
+   caller must not access ghost atom coords until forward_comm_finish()
+------------------------------------------------------------------------- */
+
+void CommBrick::forward_comm_start()
+{
+  int iswap,n,offset;
+  AtomVec *avec = atom->avec;
+  double **x = atom->x;
+
+  nstart = nrequest = 0;
+  persist_started = 0;
+  if (!comm_x_only || shmflag) return;
+
+  if (persist) {
+    check_persist();
+    if (nstage) start_forward_stage(0);
+    persist_started = 1;
+    return;
+  }
+
+  n = 0;
+  for (iswap = 0; iswap < nswap; iswap++) {
+    if (!sendowned[iswap]) break;
+    if (sendproc[iswap] != me) n += maxforward*sendnum[iswap];
+  }
+  if (n > maxstart) {
+    maxstart = static_cast<int> (BUFFACTOR * n);
+    memory->destroy(buf_start);
+    memory->create(buf_start,maxstart,"comm:buf_start");
+  }
+
+  offset = 0;
+  for (iswap = 0; iswap < nswap; iswap++) {
+    if (!sendowned[iswap]) break;
+    if (sendproc[iswap] != me) {
+      if (size_forward_recv[iswap])
+        MPI_Irecv(x[firstrecv[iswap]],size_forward_recv[iswap],MPI_DOUBLE,
+                  recvproc[iswap],0,world,&requests[nrequest++]);
+      n = avec->pack_comm(sendnum[iswap],sendlist[iswap],
+                          &buf_start[offset],pbc_flag[iswap],pbc[iswap]);
+      if (n) MPI_Isend(&buf_start[offset],n,MPI_DOUBLE,
+                       sendproc[iswap],0,world,&requests[nrequest++]);
+      offset += n;
+    } else if (sendnum[iswap])
+      avec->pack_comm(sendnum[iswap],sendlist[iswap],
+                      x[firstrecv[iswap]],pbc_flag[iswap],pbc[iswap]);
+  }
+  nstart = iswap;
+}
+
+/* ----------------------------------------------------------------------
+   complete forward communication begun by forward_comm_start()
+   wait on posted swaps, then perform remaining swaps as in forward_comm()
+------------------------------------------------------------------------- */
+
+void CommBrick::forward_comm_finish()
+{
+  int n;
+  MPI_Request request;
+  AtomVec *avec = atom->avec;
+  double **x = atom->x;
+
+  if (!comm_x_only || shmflag) {
+    forward_comm();
+    return;
+  }
+
+  if (persist) {
+    if (!persist_started) {
+      forward_comm();
+      return;
+    }
+    for (int istage = 0; istage < nstage; istage++) {
+      if (istage) start_forward_stage(istage);
+      n = forwardfirst[istage+1] - forwardfirst[istage];
+      if (n) MPI_Waitall(n,&forwardreq[forwardfirst[istage]],
+                         MPI_STATUSES_IGNORE);
+    }
+    persist_started = 0;
+    return;
+  }
+
+  if (nrequest) MPI_Waitall(nrequest,requests,MPI_STATUS_IGNORE);
+
+  for (int iswap = nstart; iswap < nswap; iswap++) {
+    if (sendproc[iswap] != me) {
+      if (size_forward_recv[iswap])
+        MPI_Irecv(x[firstrecv[iswap]],size_forward_recv[iswap],MPI_DOUBLE,
+                  recvproc[iswap],0,world,&request);
+      n = avec->pack_comm(sendnum[iswap],sendlist[iswap],
+                          buf_send,pbc_flag[iswap],pbc[iswap]);
+      if (n) MPI_Send(buf_send,n,MPI_DOUBLE,sendproc[iswap],0,world);
+      if (size_forward_recv[iswap]) MPI_Wait(&request,MPI_STATUS_IGNORE);
+    } else if (sendnum[iswap])
+      avec->pack_comm(sendnum[iswap],sendlist[iswap],
+                      x[firstrecv[iswap]],pbc_flag[iswap],pbc[iswap]);
+  }
+
+  nstart = nrequest = 0;
+}
+
 /* ----------------------------------------------------------------------
    reverse communication of forces on atoms every timestep
    other per-atom attributes may also be sent via pack/unpack routines
@@ -516,6 +689,30 @@ void CommBrick::reverse_comm()
   double **f = atom->f;
   double *buf;
 
+  // persistent requests, stages in reverse order
+  // unpack in reverse swap order within a stage, same as below
+
+  if (persist && comm_f_only) {
+    check_persist();
+    for (int istage = nstage-1; istage >= 0; istage--) {
+      n = reversefirst[istage+1] - reversefirst[istage];
+      if (n) {
+        MPI_Startall(n,&reversereq[reversefirst[istage]]);
+        MPI_Waitall(n,&reversereq[reversefirst[istage]],MPI_STATUSES_IGNORE);
+      }
+      for (int iswap = stagefirst[istage+1]-1;
+           iswap >= stagefirst[istage]; iswap--) {
+        if (sendproc[iswap] != me)
+          avec->unpack_reverse(sendnum[iswap],sendlist[iswap],
+                               &buf_persist[reverseoffset[iswap]]);
+        else if (sendnum[iswap])
+          avec->unpack_reverse(sendnum[iswap],sendlist[iswap],
+                               f[firstrecv[iswap]]);
+      }
+    }
+    return;
+  }
+
   // exchange data with another proc
   // if other proc is self, just copy
   // if comm_f_only set, exchange or copy directly from f, don't pack
@@ -692,7 +889,8 @@ void CommBrick::exchange()
 void CommBrick::borders()
 {
   int i,n,itype,iswap,dim,ineed,twoneed;
-  int nsend,nrecv,sendflag,nfirst,nlast,ngroup;
+  int nsend,nrecv,sendflag,nfirst,nlast,ngroup,nshm;
+  int sendinfo[2],recvinfo[2];
   double lo,hi;
   int *type;
   double **x;
@@ -704,6 +902,9 @@ void CommBrick::borders()
 
   iswap = 0;
   smax = rmax = 0;
+  persist_valid = 0;
+  shmflag = shmnode;
+  nshm = 0;
 
   for (dim = 0; dim < 3; dim++) {
     nlast = 0;
@@ -795,6 +996,15 @@ void CommBrick::borders()
         }
       }
 
+      // flag swaps that only send owned atoms, see forward_comm_start()
+
+      sendowned[iswap] = 1;
+      for (i = 0; i < nsend; i++)
+        if (sendlist[iswap][i] >= atom->nlocal) {
+          sendowned[iswap] = 0;
+          break;
+        }
+
       // pack up list of border atoms
 
       if (nsend*size_border > maxsend) grow_send(nsend*size_border,0);
@@ -810,7 +1020,29 @@ void CommBrick::borders()
       // put incoming ghosts at end of my atom arrays
       // if swapping with self, simply copy, no messages
 
-      if (sendproc[iswap] != me) {
+      // with shared memory, also tell recvproc where in my segment
+      //   forward comm data for this swap will be
+
+      if (sendproc[iswap] != me && shmflag) {
+        shmoffset[iswap] = -1;
+        if (nodeproc[sendproc[iswap]] >= 0) {
+          shmoffset[iswap] = nshm;
+          nshm += size_forward*nsend;
+        }
+        sendinfo[0] = nsend;
+        sendinfo[1] = shmoffset[iswap];
+        MPI_Sendrecv(sendinfo,2,MPI_INT,sendproc[iswap],0,
+                     recvinfo,2,MPI_INT,recvproc[iswap],0,world,
+                     MPI_STATUS_IGNORE);
+        nrecv = recvinfo[0];
+        shmsrc[iswap] = recvinfo[1];
+        if (nrecv*size_border > maxrecv) grow_recv(nrecv*size_border);
+        if (nrecv) MPI_Irecv(buf_recv,nrecv*size_border,MPI_DOUBLE,
+                             recvproc[iswap],0,world,&request);
+        if (n) MPI_Send(buf_send,n,MPI_DOUBLE,sendproc[iswap],0,world);
+        if (nrecv) MPI_Wait(&request,MPI_STATUS_IGNORE);
+        buf = buf_recv;
+      } else if (sendproc[iswap] != me) {
         MPI_Sendrecv(&nsend,1,MPI_INT,sendproc[iswap],0,
                      &nrecv,1,MPI_INT,recvproc[iswap],0,world,MPI_STATUS_IGNORE);
         if (nrecv*size_border > maxrecv) grow_recv(nrecv*size_border);
@@ -853,6 +1085,8 @@ void CommBrick::borders()
   max = MAX(maxforward*rmax,maxreverse*smax);
   if (max > maxrecv) grow_recv(max);
 
+  if (shmflag) setup_shm(nshm);
+
   // reset global->local map
 
   if (map_style) atom->map_set();
@@ -1284,6 +1518,317 @@ int CommBrick::exchange_variable(int n, double *inbuf, double *&outbuf)
   return nrecv;
 }
 
+/* ----------------------------------------------------------------------
+   recreate persistent requests if swaps or x,f storage changed since
+   they were created
+------------------------------------------------------------------------- */
+
+void CommBrick::check_persist()
+{
+  double *xstore = atom->x ? atom->x[0] : NULL;
+  double *fstore = atom->f ? atom->f[0] : NULL;
+  if (!persist_valid || xstore != persist_x || fstore != persist_f)
+    setup_persist();
+}
+
+/* ----------------------------------------------------------------------
+   create persistent requests for forward and reverse comm
+   swaps are grouped into stages, a swap starts a new stage
+     if it sends ghost atoms recv'd by a swap in the current stage
+   typically 3 stages of 2 swaps, one per dimension
+   forward comm recvs directly into x, and sends x of sendlist atoms
+     via indexed datatype unless swap is thru PBC and must be packed
+   reverse comm sends directly from f and recvs into buf_persist
+------------------------------------------------------------------------- */
+
+void CommBrick::setup_persist()
+{
+  int iswap,istage,n;
+  double **x = atom->x;
+  double **f = atom->f;
+
+  free_persist();
+
+  // sendlist is ascending, so last sent atom has largest index
+
+  nstage = 0;
+  stagefirst[0] = 0;
+  for (iswap = 0; iswap < nswap; iswap++) {
+    if (iswap == 0) nstage = 1;
+    else if (sendnum[iswap] &&
+             sendlist[iswap][sendnum[iswap]-1] >=
+             firstrecv[stagefirst[nstage-1]])
+      stagefirst[nstage++] = iswap;
+  }
+  stagefirst[nstage] = nswap;
+
+  n = 0;
+  for (iswap = 0; iswap < nswap; iswap++) {
+    forwardoffset[iswap] = n;
+    if (sendproc[iswap] != me && pbc_flag[iswap])
+      n += size_forward*sendnum[iswap];
+    reverseoffset[iswap] = n;
+    if (sendproc[iswap] != me) n += size_reverse_recv[iswap];
+  }
+  if (n > maxpersist) {
+    maxpersist = static_cast<int> (BUFFACTOR * n);
+    memory->destroy(buf_persist);
+    memory->create(buf_persist,maxpersist,"comm:buf_persist");
+  }
+
+  for (istage = 0; istage < nstage; istage++) {
+    forwardfirst[istage] = nforwardreq;
+    reversefirst[istage] = nreversereq;
+    for (iswap = stagefirst[istage]; iswap < stagefirst[istage+1]; iswap++) {
+      if (sendproc[iswap] == me) continue;
+
+      if (comm_x_only) {
+        if (size_forward_recv[iswap])
+          MPI_Recv_init(x[firstrecv[iswap]],size_forward_recv[iswap],
+                        MPI_DOUBLE,recvproc[iswap],iswap,world,
+                        &forwardreq[nforwardreq++]);
+        if (sendnum[iswap] && pbc_flag[iswap])
+          MPI_Send_init(&buf_persist[forwardoffset[iswap]],
+                        size_forward*sendnum[iswap],MPI_DOUBLE,
+                        sendproc[iswap],iswap,world,
+                        &forwardreq[nforwardreq++]);
+        else if (sendnum[iswap]) {
+          MPI_Type_create_indexed_block(sendnum[iswap],1,sendlist[iswap],
+                                        xtype,&sendtype[nsendtype]);
+          MPI_Type_commit(&sendtype[nsendtype]);
+          MPI_Send_init(x[0],1,sendtype[nsendtype],sendproc[iswap],iswap,
+                        world,&forwardreq[nforwardreq++]);
+          nsendtype++;
+        }
+      }
+
+      if (comm_f_only) {
+        if (size_reverse_recv[iswap])
+          MPI_Recv_init(&buf_persist[reverseoffset[iswap]],
+                        size_reverse_recv[iswap],MPI_DOUBLE,
+                        sendproc[iswap],iswap,world,
+                        &reversereq[nreversereq++]);
+        if (size_reverse_send[iswap])
+          MPI_Send_init(f[firstrecv[iswap]],size_reverse_send[iswap],
+                        MPI_DOUBLE,recvproc[iswap],iswap,world,
+                        &reversereq[nreversereq++]);
+      }
+    }
+  }
+  forwardfirst[nstage] = nforwardreq;
+  reversefirst[nstage] = nreversereq;
+
+  persist_x = x ? x[0] : NULL;
+  persist_f = f ? f[0] : NULL;
+  persist_valid = 1;
+}
+
+/* ----------------------------------------------------------------------
+   free persistent requests and datatypes, all must be inactive
+------------------------------------------------------------------------- */
+
+void CommBrick::free_persist()
+{
+  int i;
+  for (i = 0; i < nforwardreq; i++) MPI_Request_free(&forwardreq[i]);
+  for (i = 0; i < nreversereq; i++) MPI_Request_free(&reversereq[i]);
+  for (i = 0; i < nsendtype; i++) MPI_Type_free(&sendtype[i]);
+  nforwardreq = nreversereq = nsendtype = 0;
+  persist_valid = 0;
+}
+
+/* ----------------------------------------------------------------------
+   begin forward comm of all swaps in one stage
+   pack swaps thru PBC and copy swaps with self, then start requests
+------------------------------------------------------------------------- */
+
+void CommBrick::start_forward_stage(int istage)
+{
+  AtomVec *avec = atom->avec;
+  double **x = atom->x;
+
+  for (int iswap = stagefirst[istage]; iswap < stagefirst[istage+1]; iswap++) {
+    if (sendproc[iswap] == me) {
+      if (sendnum[iswap])
+        avec->pack_comm(sendnum[iswap],sendlist[iswap],
+                        x[firstrecv[iswap]],pbc_flag[iswap],pbc[iswap]);
+    } else if (sendnum[iswap] && pbc_flag[iswap])
+      avec->pack_comm(sendnum[iswap],sendlist[iswap],
+                      &buf_persist[forwardoffset[iswap]],
+                      pbc_flag[iswap],pbc[iswap]);
+  }
+
+  int n = forwardfirst[istage+1] - forwardfirst[istage];
+  if (n) MPI_Startall(n,&forwardreq[forwardfirst[istage]]);
+}
+
+/* ----------------------------------------------------------------------
+   create communicator of procs on my node and map procs into it
+------------------------------------------------------------------------- */
+
+void CommBrick::init_shm()
+{
+#ifdef LMP_COMM_SHM
+  MPI_Comm_split_type(world,MPI_COMM_TYPE_SHARED,me,MPI_INFO_NULL,&nodecomm);
+  MPI_Comm_rank(nodecomm,&nodeme);
+
+  int *ranks;
+  memory->create(ranks,nprocs,"comm:ranks");
+  memory->create(nodeproc,nprocs,"comm:nodeproc");
+  for (int i = 0; i < nprocs; i++) ranks[i] = i;
+
+  MPI_Group worldgroup,nodegroup;
+  MPI_Comm_group(world,&worldgroup);
+  MPI_Comm_group(nodecomm,&nodegroup);
+  MPI_Group_translate_ranks(worldgroup,nprocs,ranks,nodegroup,nodeproc);
+  MPI_Group_free(&worldgroup);
+  MPI_Group_free(&nodegroup);
+  for (int i = 0; i < nprocs; i++)
+    if (nodeproc[i] == MPI_UNDEFINED) nodeproc[i] = -1;
+  memory->destroy(ranks);
+
+  int nodeprocs;
+  MPI_Comm_size(nodecomm,&nodeprocs);
+  shmbase = new char*[nodeprocs];
+#endif
+}
+
+/* ----------------------------------------------------------------------
+   insure my shared segment holds n doubles of forward comm data
+   segment = 2 counters per swap, then data
+   counters = # of times swap was posted by me as sender,
+              # of times swap was consumed by me as receiver
+   called at end of borders() by all procs, so collective on node
+   counters are reset, node barrier insures no proc starts forward comm
+     before all procs on node have reset theirs
+------------------------------------------------------------------------- */
+
+void CommBrick::setup_shm(int n)
+{
+#ifdef LMP_COMM_SHM
+  bigint header = 2*nswap*sizeof(int);
+  header = (header + sizeof(double)-1) / sizeof(double) * sizeof(double);
+  bigint nbytes = header + (bigint) n*sizeof(double);
+
+  int flag = (nbytes > maxshm) ? 1 : 0;
+  int flagall;
+  MPI_Allreduce(&flag,&flagall,1,MPI_INT,MPI_MAX,nodecomm);
+
+  if (flagall) {
+    if (maxshm) {
+      MPI_Win_unlock_all(shmwin);
+      MPI_Win_free(&shmwin);
+    }
+    if (nbytes > maxshm) maxshm = static_cast<bigint> (BUFFACTOR * nbytes);
+
+    char *mybase;
+    MPI_Win_allocate_shared(maxshm,1,MPI_INFO_NULL,nodecomm,
+                            &mybase,&shmwin);
+    MPI_Win_lock_all(MPI_MODE_NOCHECK,shmwin);
+
+    int nodeprocs,dispunit;
+    MPI_Aint size;
+    MPI_Comm_size(nodecomm,&nodeprocs);
+    for (int i = 0; i < nodeprocs; i++)
+      MPI_Win_shared_query(shmwin,i,&size,&dispunit,&shmbase[i]);
+  }
+
+  // convert data offsets from doubles to bytes from segment start
+
+  for (int iswap = 0; iswap < nswap; iswap++) {
+    if (sendproc[iswap] == me) continue;
+    if (shmoffset[iswap] >= 0)
+      shmoffset[iswap] = header + shmoffset[iswap]*sizeof(double);
+    if (shmsrc[iswap] >= 0)
+      shmsrc[iswap] = header + shmsrc[iswap]*sizeof(double);
+  }
+
+  int *counter = (int *) shmbase[nodeme];
+  for (int i = 0; i < 2*nswap; i++) counter[i] = 0;
+  MPI_Win_sync(shmwin);
+  MPI_Barrier(nodecomm);
+#endif
+}
+
+/* ----------------------------------------------------------------------
+   free shared window and node communicator
+------------------------------------------------------------------------- */
+
+void CommBrick::free_shm()
+{
+#ifdef LMP_COMM_SHM
+  if (maxshm) {
+    MPI_Win_unlock_all(shmwin);
+    MPI_Win_free(&shmwin);
+  }
+  if (nodecomm != MPI_COMM_NULL) MPI_Comm_free(&nodecomm);
+  memory->destroy(nodeproc);
+  delete [] shmbase;
+#endif
+}
+
+/* ----------------------------------------------------------------------
+   forward comm of atom coords using shared memory for procs on my node
+   sender packs into its own segment and bumps its posted counter
+   receiver copies from sender's segment into x when posted counter
+     advances, then bumps its consumed counter
+   sender waits for receiver to consume previous data before packing
+   swaps with procs on other nodes are done via messages
+------------------------------------------------------------------------- */
+
+void CommBrick::forward_comm_shm()
+{
+#ifdef LMP_COMM_SHM
+  int n;
+  MPI_Request request;
+  AtomVec *avec = atom->avec;
+  double **x = atom->x;
+  volatile int *posted = (volatile int *) shmbase[nodeme];
+  volatile int *consumed = posted + nswap;
+  volatile int *other;
+
+  for (int iswap = 0; iswap < nswap; iswap++) {
+    if (sendproc[iswap] == me) {
+      if (sendnum[iswap])
+        avec->pack_comm(sendnum[iswap],sendlist[iswap],
+                        x[firstrecv[iswap]],pbc_flag[iswap],pbc[iswap]);
+      continue;
+    }
+
+    if (shmsrc[iswap] < 0 && size_forward_recv[iswap])
+      MPI_Irecv(x[firstrecv[iswap]],size_forward_recv[iswap],MPI_DOUBLE,
+                recvproc[iswap],0,world,&request);
+
+    if (shmoffset[iswap] >= 0) {
+      other = (volatile int *) shmbase[nodeproc[sendproc[iswap]]] + nswap;
+      while (other[iswap] != posted[iswap]) MPI_Win_sync(shmwin);
+      avec->pack_comm(sendnum[iswap],sendlist[iswap],
+                      (double *) &shmbase[nodeme][shmoffset[iswap]],
+                      pbc_flag[iswap],pbc[iswap]);
+      MPI_Win_sync(shmwin);
+      posted[iswap]++;
+    } else {
+      n = avec->pack_comm(sendnum[iswap],sendlist[iswap],
+                          buf_send,pbc_flag[iswap],pbc[iswap]);
+      if (n) MPI_Send(buf_send,n,MPI_DOUBLE,sendproc[iswap],0,world);
+    }
+
+    if (shmsrc[iswap] >= 0) {
+      other = (volatile int *) shmbase[nodeproc[recvproc[iswap]]];
+      while (other[iswap] == consumed[iswap]) MPI_Win_sync(shmwin);
+      MPI_Win_sync(shmwin);
+      if (size_forward_recv[iswap])
+        memcpy(x[firstrecv[iswap]],
+               &shmbase[nodeproc[recvproc[iswap]]][shmsrc[iswap]],
+               size_forward_recv[iswap]*sizeof(double));
+      MPI_Win_sync(shmwin);
+      consumed[iswap]++;
+    } else if (size_forward_recv[iswap])
+      MPI_Wait(&request,MPI_STATUS_IGNORE);
+  }
+#endif
+}
+
 /* ----------------------------------------------------------------------
    realloc the size of the send buffer as needed with BUFFACTOR and bufextra
    if flag = 1, realloc
@@ -1363,6 +1908,19 @@ void CommBrick::allocate_swap(int n)
   memory->create(firstrecv,n,"comm:firstrecv");
   memory->create(pbc_flag,n,"comm:pbc_flag");
   memory->create(pbc,n,6,"comm:pbc");
+  memory->create(sendowned,n,"comm:sendowned");
+  requests = new MPI_Request[2*n];
+
+  memory->create(stagefirst,n+1,"comm:stagefirst");
+  memory->create(forwardfirst,n+1,"comm:forwardfirst");
+  memory->create(reversefirst,n+1,"comm:reversefirst");
+  memory->create(forwardoffset,n,"comm:forwardoffset");
+  memory->create(reverseoffset,n,"comm:reverseoffset");
+  forwardreq = new MPI_Request[2*n];
+  reversereq = new MPI_Request[2*n];
+  sendtype = new MPI_Datatype[n];
+  memory->create(shmoffset,n,"comm:shmoffset");
+  memory->create(shmsrc,n,"comm:shmsrc");
 }
 
 /* ----------------------------------------------------------------------
@@ -1393,6 +1951,20 @@ void CommBrick::free_swap()
   memory->destroy(firstrecv);
   memory->destroy(pbc_flag);
   memory->destroy(pbc);
+  memory->destroy(sendowned);
+  delete [] requests;
+
+  free_persist();
+  memory->destroy(stagefirst);
+  memory->destroy(forwardfirst);
+  memory->destroy(reversefirst);
+  memory->destroy(forwardoffset);
+  memory->destroy(reverseoffset);
+  delete [] forwardreq;
+  delete [] reversereq;
+  delete [] sendtype;
+  memory->destroy(shmoffset);
+  memory->destroy(shmsrc);
 }
 
 /* ----------------------------------------------------------------------
@@ -1417,5 +1989,8 @@ bigint CommBrick::memory_usage()
     bytes += memory->usage(sendlist[i],maxsendlist[i]);
   bytes += memory->usage(buf_send,maxsend+bufextra);
   bytes += memory->usage(buf_recv,maxrecv);
+  bytes += memory->usage(buf_start,maxstart);
+  bytes += memory->usage(buf_persist,maxpersist);
+  bytes += maxshm;
   return bytes;
 }
@@ -16,6 +16,13 @@
 
 #include "comm.h"
 
+// MPI-3 libraries provide shared-memory windows, which let procs on the
+// same node read each other's forward comm data without messages
+
+#if defined(MPI_VERSION) && (MPI_VERSION >= 3)
+#define LMP_COMM_SHM
+#endif
+
 namespace LAMMPS_NS {
 
 class CommBrick : public Comm {
@@ -27,6 +34,8 @@ class CommBrick : public Comm {
   virtual void init();
   virtual void setup();                        // setup 3d comm pattern
   virtual void forward_comm(int dummy = 0);    // forward comm of atom coords
+  virtual void forward_comm_start();           // post forward comm msgs
+  virtual void forward_comm_finish();          // complete forward comm
   virtual void reverse_comm();                 // reverse comm of forces
   virtual void exchange();                     // move atoms to new procs
   virtual void borders();                      // setup list of atoms to comm
@@ -66,6 +75,44 @@ class CommBrick : public Comm {
   int *firstrecv;                   // where to put 1st recv atom in each swap
   int **sendlist;                   // list of atoms to send in each swap
   int *maxsendlist;                 // max size of send list for each swap
+  int *sendowned;                   // 1 if swap sends only owned atoms
+
+  int nstart;                       // # of swaps posted by forward_comm_start
+  int nrequest;                     // # of pending requests for those swaps
+  MPI_Request *requests;            // pending requests, 2 per swap
+  double *buf_start;                // send buffer for forward_comm_start
+  int maxstart;                     // current size of buf_start
+
+  int persist_valid;                // 1 if persistent requests match swaps
+  double *persist_x,*persist_f;     // storage of x,f the requests point into
+  int persist_started;              // 1 if forward_comm_start began stage 0
+  int nstage;                       // # of stages of independent swaps
+  int *stagefirst;                  // 1st swap of each stage, nstage+1 values
+  MPI_Request *forwardreq;          // persistent forward requests, 2 per swap
+  MPI_Request *reversereq;          // persistent reverse requests, 2 per swap
+  int nforwardreq,nreversereq;      // # of persistent requests
+  int *forwardfirst,*reversefirst;  // 1st request of each stage
+  MPI_Datatype xtype;               // coords of one atom
+  MPI_Datatype *sendtype;           // coords of sendlist atoms for each swap
+  int nsendtype;                    // # of committed sendtypes
+  int *forwardoffset;               // where PBC swap is packed in buf_persist
+  int *reverseoffset;               // where reverse swap is recv'd in buf_persist
+  double *buf_persist;              // buffer for persistent requests
+  int maxpersist;                   // current size of buf_persist
+
+  int shmnode;                      // 1 if shm requested and node has procs
+  int shmflag;                      // 1 if forward comm uses shared memory
+  MPI_Comm nodecomm;                // procs on my node
+  int nodeme;                       // my rank in nodecomm
+  int *nodeproc;                    // rank in nodecomm of each proc, -1 if
+                                    //   proc is on another node
+  int *shmoffset;                   // where swap is packed in my segment
+  int *shmsrc;                      // where swap is packed in recvproc segment
+  char **shmbase;                   // shared segment of each proc on node
+  bigint maxshm;                    // size of my segment in bytes
+#ifdef LMP_COMM_SHM
+  MPI_Win shmwin;                   // window of all segments on node
+#endif
 
   double *buf_send;                 // send buffer for all comm
   double *buf_recv;                 // recv buffer for all comm
@@ -84,6 +131,16 @@ class CommBrick : public Comm {
   virtual void allocate_multi(int);         // allocate multi arrays
   virtual void free_swap();                 // free swap arrays
   virtual void free_multi();                // free multi arrays
+
+  void check_persist();                     // setup requests if outdated
+  void setup_persist();                     // create persistent requests
+  void free_persist();                      // free persistent requests
+  void start_forward_stage(int);            // begin forward comm of a stage
+
+  void init_shm();                          // create node communicator
+  void setup_shm(int);                      // size shared segments
+  void free_shm();                          // free node window and comm
+  void forward_comm_shm();                  // forward comm via shared memory
 };
 
 }
@@ -106,6 +163,20 @@ E: Processor count in z must be 1 for 2d simulation
 
 Self-explanatory.
 
+E: Comm_modify persist or shm is not supported with accelerator packages
+
+The USER-CUDA and KOKKOS packages use their own communication
+routines, which do not create persistent requests.
+
+E: Comm_modify shm requires an MPI-3 library
+
+LAMMPS was built with an MPI library that does not support shared
+memory windows, e.g. the STUBS library.
+
+E: Comm_modify persist and shm cannot be used together
+
+Only one of these communication modes can be selected.
+
 E: Illegal ... command
 
 Self-explanatory.  Check the input script syntax and compare to the
@@ -151,8 +222,13 @@ E: Processors grid numa and map style are incompatible
 Using numa for gstyle in the processors command requires using
 cart for the map option.
 
+E: Processors grid node and map style are incompatible
+
+Using node for gstyle in the processors command requires using
+cart for the map option.
+
 E: Processors part option and grid style are incompatible
 
-Cannot use gstyle numa or custom with the part option.
+Cannot use gstyle numa, custom, or node with the part option.
 
 */
@@ -1546,10 +1546,14 @@ void CommTiled::box_drop_tiled_recurse(double *lo, double *hi,
   // use > and < criteria so does not include a box it only touches
   // procmid = 1st processor in upper half of partition
   //         = location in tree that stores this cut
+  //         = node boundary if partition spans several nodes and rcbnode set
   // dim = 0,1,2 dimension of cut
   // cut = position of cut
 
   int procmid = proclower + (procupper - proclower) / 2 + 1;
+  if (rcbnode && procupper - proclower >= rcbnode)
+    procmid = proclower +
+      ((procupper - proclower + 1) / rcbnode + 1) / 2 * rcbnode;
   int idim = rcbinfo[procmid].dim;
   double cut = boxlo[idim] + prd[idim]*rcbinfo[procmid].cutfrac;
   
@@ -1756,10 +1760,14 @@ int CommTiled::point_drop_tiled_recurse(double *x,
   // use < criterion so point is not on high edge of proc sub-domain
   // procmid = 1st processor in upper half of partition
   //         = location in tree that stores this cut
+  //         = node boundary if partition spans several nodes and rcbnode set
   // dim = 0,1,2 dimension of cut
   // cut = position of cut
 
   int procmid = proclower + (procupper - proclower) / 2 + 1;
+  if (rcbnode && procupper - proclower >= rcbnode)
+    procmid = proclower +
+      ((procupper - proclower + 1) / rcbnode + 1) / 2 * rcbnode;
   int idim = rcbinfo[procmid].dim;
   double cut = boxlo[idim] + prd[idim]*rcbinfo[procmid].cutfrac;
 
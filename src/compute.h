@@ -98,6 +98,14 @@ class Compute : protected Pointers {
   virtual void compute_peratom() {}
   virtual void compute_local() {}
 
+  // compute_scalar() (flag = 0) or compute_vector() (flag = 1) split into
+  //   local values summed across procs and final result,
+  //   used by Modify::reduce_compute() to sum values of many computes at once
+
+  virtual int size_reduce(int) {return 0;}
+  virtual void pack_reduce(int, double *) {}
+  virtual void unpack_reduce(int, double *) {}
+
   virtual int pack_forward_comm(int, int *, double *, int, int *) {return 0;}
   virtual void unpack_forward_comm(int, int, double *) {}
   virtual int pack_reverse_comm(int, int, double *) {return 0;}
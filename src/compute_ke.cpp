@@ -43,6 +43,24 @@ void ComputeKE::init()
 /* ---------------------------------------------------------------------- */
 
 double ComputeKE::compute_scalar()
+{
+  double one,all;
+  pack_reduce(0,&one);
+  MPI_Allreduce(&one,&all,1,MPI_DOUBLE,MPI_SUM,world);
+  unpack_reduce(0,&all);
+  return scalar;
+}
+
+/* ---------------------------------------------------------------------- */
+
+int ComputeKE::size_reduce(int flag)
+{
+  return 1;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void ComputeKE::pack_reduce(int flag, double *buf)
 {
   invoked_scalar = update->ntimestep;
 
@@ -66,7 +84,12 @@ double ComputeKE::compute_scalar()
           (v[i][0]*v[i][0] + v[i][1]*v[i][1] + v[i][2]*v[i][2]);
   }
 
-  MPI_Allreduce(&ke,&scalar,1,MPI_DOUBLE,MPI_SUM,world);
-  scalar *= pfactor;
-  return scalar;
+  buf[0] = ke;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void ComputeKE::unpack_reduce(int flag, double *buf)
+{
+  scalar = buf[0] * pfactor;
 }
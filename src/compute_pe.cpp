@@ -69,6 +69,26 @@ ComputePE::ComputePE(LAMMPS *lmp, int narg, char **arg) :
 /* ---------------------------------------------------------------------- */
 
 double ComputePE::compute_scalar()
+{
+  double one,all;
+  pack_reduce(0,&one);
+  MPI_Allreduce(&one,&all,1,MPI_DOUBLE,MPI_SUM,world);
+  unpack_reduce(0,&all);
+  return scalar;
+}
+
+/* ---------------------------------------------------------------------- */
+
+int ComputePE::size_reduce(int flag)
+{
+  return 1;
+}
+
+/* ----------------------------------------------------------------------
+   sum energy contributions tallied on this proc
+------------------------------------------------------------------------- */
+
+void ComputePE::pack_reduce(int flag, double *buf)
 {
   invoked_scalar = update->ntimestep;
   if (update->eflag_global != invoked_scalar)
@@ -85,7 +105,16 @@ double ComputePE::compute_scalar()
     if (improperflag && force->improper) one += force->improper->energy;
   }
 
-  MPI_Allreduce(&one,&scalar,1,MPI_DOUBLE,MPI_SUM,world);
+  buf[0] = one;
+}
+
+/* ----------------------------------------------------------------------
+   add energy contributions that are already global to summed energy
+------------------------------------------------------------------------- */
+
+void ComputePE::unpack_reduce(int flag, double *buf)
+{
+  scalar = buf[0];
 
   if (kspaceflag && force->kspace) scalar += force->kspace->energy;
 
@@ -95,6 +124,4 @@ double ComputePE::compute_scalar()
   }
 
   if (thermoflag && modify->n_thermo_energy) scalar += modify->thermo_energy();
-
-  return scalar;
 }
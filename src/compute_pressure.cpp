@@ -176,56 +176,105 @@ void ComputePressure::init()
 
 double ComputePressure::compute_scalar()
 {
-  invoked_scalar = update->ntimestep;
-  if (update->vflag_global != invoked_scalar)
-    error->all(FLERR,"Virial was not tallied on needed timestep");
+  double one[3],all[3];
+  int n = size_reduce(0);
+  pack_reduce(0,one);
+  MPI_Allreduce(one,all,n,MPI_DOUBLE,MPI_SUM,world);
+  unpack_reduce(0,all);
+  return scalar;
+}
 
-  // invoke temperature if it hasn't been already
+/* ----------------------------------------------------------------------
+   compute pressure tensor
+   assume KE tensor has already been computed
+------------------------------------------------------------------------- */
 
-  double t;
-  if (keflag) {
-    if (temperature->invoked_scalar != update->ntimestep)
-      t = temperature->compute_scalar();
-    else t = temperature->scalar;
-  }
+void ComputePressure::compute_vector()
+{
+  double one[6],all[6];
+  int n = size_reduce(1);
+  pack_reduce(1,one);
+  MPI_Allreduce(one,all,n,MPI_DOUBLE,MPI_SUM,world);
+  unpack_reduce(1,all);
+}
 
-  if (dimension == 3) {
-    inv_volume = 1.0 / (domain->xprd * domain->yprd * domain->zprd);
-    virial_compute(3,3);
-    if (keflag)
-      scalar = (temperature->dof * boltz * t +
-                virial[0] + virial[1] + virial[2]) / 3.0 * inv_volume * nktv2p;
-    else
-      scalar = (virial[0] + virial[1] + virial[2]) / 3.0 * inv_volume * nktv2p;
+/* ----------------------------------------------------------------------
+   # of virial components summed across procs for scalar or vector
+------------------------------------------------------------------------- */
+
+int ComputePressure::size_reduce(int flag)
+{
+  if (flag == 0) return dimension;
+  if (dimension == 3) return 6;
+  return 4;
+}
+
+/* ----------------------------------------------------------------------
+   sum contributions to virial from forces and fixes on this proc
+------------------------------------------------------------------------- */
+
+void ComputePressure::pack_reduce(int flag, double *buf)
+{
+  if (flag == 0) {
+    invoked_scalar = update->ntimestep;
+    if (update->vflag_global != invoked_scalar)
+      error->all(FLERR,"Virial was not tallied on needed timestep");
   } else {
-    inv_volume = 1.0 / (domain->xprd * domain->yprd);
-    virial_compute(2,2);
-    if (keflag)
-      scalar = (temperature->dof * boltz * t +
-                virial[0] + virial[1]) / 2.0 * inv_volume * nktv2p;
-    else
-      scalar = (virial[0] + virial[1]) / 2.0 * inv_volume * nktv2p;
+    invoked_vector = update->ntimestep;
+    if (update->vflag_global != invoked_vector)
+      error->all(FLERR,"Virial was not tallied on needed timestep");
+
+    if (force->kspace && kspace_virial && force->kspace->scalar_pressure_flag)
+      error->all(FLERR,"Kspace_modify pressure/scalar no required "
+                 "for components of pressure tensor with kspace_style msm");
   }
 
-  return scalar;
+  int i,j;
+  double *vcomponent;
+
+  int n = size_reduce(flag);
+  for (i = 0; i < n; i++) buf[i] = 0.0;
+
+  for (j = 0; j < nvirial; j++) {
+    vcomponent = vptr[j];
+    for (i = 0; i < n; i++) buf[i] += vcomponent[i];
+  }
 }
 
 /* ----------------------------------------------------------------------
-   compute pressure tensor
-   assume KE tensor has already been computed
+   compute total pressure or pressure tensor from virial summed across procs
+   invoke temperature if it hasn't been already
 ------------------------------------------------------------------------- */
 
-void ComputePressure::compute_vector()
+void ComputePressure::unpack_reduce(int flag, double *buf)
 {
-  invoked_vector = update->ntimestep;
-  if (update->vflag_global != invoked_vector)
-    error->all(FLERR,"Virial was not tallied on needed timestep");
-
-  if (force->kspace && kspace_virial && force->kspace->scalar_pressure_flag)
-    error->all(FLERR,"Kspace_modify pressure/scalar no required "
-               "for components of pressure tensor with kspace_style msm");
+  if (flag == 0) {
+    double t;
+    if (keflag) {
+      if (temperature->invoked_scalar != update->ntimestep)
+        t = temperature->compute_scalar();
+      else t = temperature->scalar;
+    }
 
-  // invoke temperature if it hasn't been already
+    if (dimension == 3) {
+      inv_volume = 1.0 / (domain->xprd * domain->yprd * domain->zprd);
+      virial_compute(3,3,buf);
+      if (keflag)
+        scalar = (temperature->dof * boltz * t +
+                  virial[0] + virial[1] + virial[2]) / 3.0 * inv_volume * nktv2p;
+      else
+        scalar = (virial[0] + virial[1] + virial[2]) / 3.0 * inv_volume * nktv2p;
+    } else {
+      inv_volume = 1.0 / (domain->xprd * domain->yprd);
+      virial_compute(2,2,buf);
+      if (keflag)
+        scalar = (temperature->dof * boltz * t +
+                  virial[0] + virial[1]) / 2.0 * inv_volume * nktv2p;
+      else
+        scalar = (virial[0] + virial[1]) / 2.0 * inv_volume * nktv2p;
+    }
+    return;
+  }
 
   double *ke_tensor;
   if (keflag) {
@@ -236,7 +285,7 @@ void ComputePressure::compute_vector()
 
   if (dimension == 3) {
     inv_volume = 1.0 / (domain->xprd * domain->yprd * domain->zprd);
-    virial_compute(6,3);
+    virial_compute(6,3,buf);
     if (keflag) {
       for (int i = 0; i < 6; i++)
         vector[i] = (ke_tensor[i] + virial[i]) * inv_volume * nktv2p;
@@ -245,7 +294,7 @@ void ComputePressure::compute_vector()
         vector[i] = virial[i] * inv_volume * nktv2p;
   } else {
     inv_volume = 1.0 / (domain->xprd * domain->yprd);
-    virial_compute(4,2);
+    virial_compute(4,2,buf);
     if (keflag) {
       vector[0] = (ke_tensor[0] + virial[0]) * inv_volume * nktv2p;
       vector[1] = (ke_tensor[1] + virial[1]) * inv_volume * nktv2p;
@@ -260,25 +309,15 @@ void ComputePressure::compute_vector()
   }
 }
 
-/* ---------------------------------------------------------------------- */
+/* ----------------------------------------------------------------------
+   set virial from N components of force/fix virial summed across procs
+------------------------------------------------------------------------- */
 
-void ComputePressure::virial_compute(int n, int ndiag)
+void ComputePressure::virial_compute(int n, int ndiag, double *vall)
 {
-  int i,j;
-  double v[6],*vcomponent;
-
-  for (i = 0; i < n; i++) v[i] = 0.0;
-
-  // sum contributions to virial from forces and fixes
-
-  for (j = 0; j < nvirial; j++) {
-    vcomponent = vptr[j];
-    for (i = 0; i < n; i++) v[i] += vcomponent[i];
-  }
-
-  // sum virial across procs
+  int i;
 
-  MPI_Allreduce(v,virial,n,MPI_DOUBLE,MPI_SUM,world);
+  for (i = 0; i < n; i++) virial[i] = vall[i];
 
   // KSpace virial contribution is already summed across procs
 
@@ -31,6 +31,9 @@ class ComputePressure : public Compute {
   void init();
   double compute_scalar();
   void compute_vector();
+  int size_reduce(int);
+  void pack_reduce(int, double *);
+  void unpack_reduce(int, double *);
   void reset_extra_compute_fix(const char *);
 
  protected:
@@ -44,7 +47,7 @@ class ComputePressure : public Compute {
   int keflag,pairflag,bondflag,angleflag,dihedralflag,improperflag;
   int fixflag,kspaceflag;
 
-  void virial_compute(int, int);
+  void virial_compute(int, int, double *);
 };
 
 }
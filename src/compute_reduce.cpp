@@ -370,8 +370,7 @@ void ComputeReduce::compute_vector()
     }
 
   if (mode == SUM) {
-    for (int m = 0; m < nvalues; m++)
-      MPI_Allreduce(&onevec[m],&vector[m],1,MPI_DOUBLE,MPI_SUM,world);
+    MPI_Allreduce(onevec,vector,nvalues,MPI_DOUBLE,MPI_SUM,world);
 
   } else if (mode == MINN) {
     if (!replace) {
@@ -426,6 +425,40 @@ void ComputeReduce::compute_vector()
   }
 }
 
+/* ----------------------------------------------------------------------
+   only mode = SUM is summed by Modify::reduce_compute()
+   other modes reduce with their own MPI operation
+------------------------------------------------------------------------- */
+
+int ComputeReduce::size_reduce(int flag)
+{
+  if (mode != SUM) return 0;
+  if (flag == 0) return 1;
+  return nvalues;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void ComputeReduce::pack_reduce(int flag, double *buf)
+{
+  if (flag == 0) {
+    invoked_scalar = update->ntimestep;
+    buf[0] = compute_one(0,-1);
+  } else {
+    invoked_vector = update->ntimestep;
+    for (int m = 0; m < nvalues; m++) buf[m] = compute_one(m,-1);
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+
+void ComputeReduce::unpack_reduce(int flag, double *buf)
+{
+  if (flag == 0) scalar = buf[0];
+  else
+    for (int m = 0; m < nvalues; m++) vector[m] = buf[m];
+}
+
 /* ----------------------------------------------------------------------
    calculate reduced value for one input M and return it
    if flag = -1:
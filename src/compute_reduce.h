@@ -31,6 +31,9 @@ class ComputeReduce : public Compute {
   void init();
   double compute_scalar();
   void compute_vector();
+  int size_reduce(int);
+  void pack_reduce(int, double *);
+  void unpack_reduce(int, double *);
   double memory_usage();
 
  protected:
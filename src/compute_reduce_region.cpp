@@ -58,7 +58,7 @@ double ComputeReduceRegion::compute_one(int m, int flag)
   int i;
 
   Region *region = domain->regions[iregion];
-  region->prematch();
+  int *inregion = region->match_atoms();
 
   // invoke the appropriate attribute,compute,fix,variable
   // compute scalar quantity by summing over atom scalars
@@ -81,21 +81,21 @@ double ComputeReduceRegion::compute_one(int m, int flag)
   if (which[m] == X) {
     if (flag < 0) {
       for (i = 0; i < nlocal; i++)
-        if (mask[i] & groupbit && region->match(x[i][0],x[i][1],x[i][2]))
+        if (mask[i] & groupbit && inregion[i])
           combine(one,x[i][j],i);
     } else one = x[flag][j];
   } else if (which[m] == V) {
     double **v = atom->v;
     if (flag < 0) {
       for (i = 0; i < nlocal; i++)
-        if (mask[i] & groupbit && region->match(x[i][0],x[i][1],x[i][2]))
+        if (mask[i] & groupbit && inregion[i])
           combine(one,v[i][j],i);
     } else one = v[flag][j];
   } else if (which[m] == F) {
     double **f = atom->f;
     if (flag < 0) {
       for (i = 0; i < nlocal; i++)
-        if (mask[i] & groupbit && region->match(x[i][0],x[i][1],x[i][2]))
+        if (mask[i] & groupbit && inregion[i])
           combine(one,f[i][j],i);
     } else one = f[flag][j];
 
@@ -115,7 +115,7 @@ double ComputeReduceRegion::compute_one(int m, int flag)
         int n = nlocal;
         if (flag < 0) {
           for (i = 0; i < n; i++)
-            if (mask[i] & groupbit && region->match(x[i][0],x[i][1],x[i][2]))
+            if (mask[i] & groupbit && inregion[i])
               combine(one,compute_vector[i],i);
         } else one = compute_vector[flag];
       } else {
@@ -124,7 +124,7 @@ double ComputeReduceRegion::compute_one(int m, int flag)
         int jm1 = j - 1;
         if (flag < 0) {
           for (i = 0; i < n; i++)
-            if (mask[i] & groupbit && region->match(x[i][0],x[i][1],x[i][2]))
+            if (mask[i] & groupbit && inregion[i])
               combine(one,compute_array[i][jm1],i);
         } else one = compute_array[flag][jm1];
       }
@@ -167,7 +167,7 @@ double ComputeReduceRegion::compute_one(int m, int flag)
         int n = nlocal;
         if (flag < 0) {
           for (i = 0; i < n; i++)
-            if (mask[i] & groupbit && region->match(x[i][0],x[i][1],x[i][2]))
+            if (mask[i] & groupbit && inregion[i])
               combine(one,fix_vector[i],i);
         } else one = fix_vector[flag];
       } else {
@@ -175,7 +175,7 @@ double ComputeReduceRegion::compute_one(int m, int flag)
         int jm1 = j - 1;
         if (flag < 0) {
           for (i = 0; i < nlocal; i++)
-            if (mask[i] & groupbit && region->match(x[i][0],x[i][1],x[i][2]))
+            if (mask[i] & groupbit && inregion[i])
               combine(one,fix_array[i][jm1],i);
         } else one = fix_array[flag][jm1];
       }
@@ -211,7 +211,7 @@ double ComputeReduceRegion::compute_one(int m, int flag)
     input->variable->compute_atom(n,igroup,varatom,1,0);
     if (flag < 0) {
       for (i = 0; i < nlocal; i++)
-        if (mask[i] & groupbit && region->match(x[i][0],x[i][1],x[i][2]))
+        if (mask[i] & groupbit && inregion[i])
           combine(one,varatom[i],i);
     } else one = varatom[flag];
   }
@@ -72,31 +72,10 @@ void ComputeTemp::dof_compute()
 
 double ComputeTemp::compute_scalar()
 {
-  invoked_scalar = update->ntimestep;
-
-  double **v = atom->v;
-  double *mass = atom->mass;
-  double *rmass = atom->rmass;
-  int *type = atom->type;
-  int *mask = atom->mask;
-  int nlocal = atom->nlocal;
-
-  double t = 0.0;
-
-  if (rmass) {
-    for (int i = 0; i < nlocal; i++)
-      if (mask[i] & groupbit)
-        t += (v[i][0]*v[i][0] + v[i][1]*v[i][1] + v[i][2]*v[i][2]) * rmass[i];
-  } else {
-    for (int i = 0; i < nlocal; i++)
-      if (mask[i] & groupbit)
-        t += (v[i][0]*v[i][0] + v[i][1]*v[i][1] + v[i][2]*v[i][2]) *
-          mass[type[i]];
-  }
-
-  MPI_Allreduce(&t,&scalar,1,MPI_DOUBLE,MPI_SUM,world);
-  if (dynamic) dof_compute();
-  scalar *= tfactor;
+  double t,tall;
+  pack_reduce(0,&t);
+  MPI_Allreduce(&t,&tall,1,MPI_DOUBLE,MPI_SUM,world);
+  unpack_reduce(0,&tall);
   return scalar;
 }
 
@@ -104,9 +83,27 @@ double ComputeTemp::compute_scalar()
 
 void ComputeTemp::compute_vector()
 {
-  int i;
+  double t[6],tall[6];
+  pack_reduce(1,t);
+  MPI_Allreduce(t,tall,6,MPI_DOUBLE,MPI_SUM,world);
+  unpack_reduce(1,tall);
+}
 
-  invoked_vector = update->ntimestep;
+/* ---------------------------------------------------------------------- */
+
+int ComputeTemp::size_reduce(int flag)
+{
+  if (flag) return 6;
+  return 1;
+}
+
+/* ----------------------------------------------------------------------
+   local sum of mv^2 for scalar or of the KE tensor for vector
+------------------------------------------------------------------------- */
+
+void ComputeTemp::pack_reduce(int flag, double *buf)
+{
+  int i;
 
   double **v = atom->v;
   double *mass = atom->mass;
@@ -115,6 +112,29 @@ void ComputeTemp::compute_vector()
   int *mask = atom->mask;
   int nlocal = atom->nlocal;
 
+  if (flag == 0) {
+    invoked_scalar = update->ntimestep;
+
+    double t = 0.0;
+
+    if (rmass) {
+      for (i = 0; i < nlocal; i++)
+        if (mask[i] & groupbit)
+          t += (v[i][0]*v[i][0] + v[i][1]*v[i][1] + v[i][2]*v[i][2]) *
+            rmass[i];
+    } else {
+      for (i = 0; i < nlocal; i++)
+        if (mask[i] & groupbit)
+          t += (v[i][0]*v[i][0] + v[i][1]*v[i][1] + v[i][2]*v[i][2]) *
+            mass[type[i]];
+    }
+
+    buf[0] = t;
+    return;
+  }
+
+  invoked_vector = update->ntimestep;
+
   double massone,t[6];
   for (i = 0; i < 6; i++) t[i] = 0.0;
 
@@ -130,6 +150,19 @@ void ComputeTemp::compute_vector()
       t[5] += massone * v[i][1]*v[i][2];
     }
 
-  MPI_Allreduce(t,vector,6,MPI_DOUBLE,MPI_SUM,world);
-  for (i = 0; i < 6; i++) vector[i] *= force->mvv2e;
+  for (i = 0; i < 6; i++) buf[i] = t[i];
+}
+
+/* ---------------------------------------------------------------------- */
+
+void ComputeTemp::unpack_reduce(int flag, double *buf)
+{
+  if (flag == 0) {
+    scalar = buf[0];
+    if (dynamic) dof_compute();
+    scalar *= tfactor;
+    return;
+  }
+
+  for (int i = 0; i < 6; i++) vector[i] = buf[i] * force->mvv2e;
 }
@@ -102,7 +102,6 @@ double ComputeTempRegion::compute_scalar()
 {
   invoked_scalar = update->ntimestep;
 
-  double **x = atom->x;
   double **v = atom->v;
   double *mass = atom->mass;
   double *rmass = atom->rmass;
@@ -111,20 +110,20 @@ double ComputeTempRegion::compute_scalar()
   int nlocal = atom->nlocal;
 
   Region *region = domain->regions[iregion];
-  region->prematch();
+  int *inregion = region->match_atoms();
 
   int count = 0;
   double t = 0.0;
 
   if (rmass) {
     for (int i = 0; i < nlocal; i++)
-      if (mask[i] & groupbit && region->match(x[i][0],x[i][1],x[i][2])) {
+      if (mask[i] & groupbit && inregion[i]) {
         count++;
         t += (v[i][0]*v[i][0] + v[i][1]*v[i][1] + v[i][2]*v[i][2]) * rmass[i];
       }
   } else {
     for (int i = 0; i < nlocal; i++)
-      if (mask[i] & groupbit && region->match(x[i][0],x[i][1],x[i][2])) {
+      if (mask[i] & groupbit && inregion[i]) {
         count++;
         t += (v[i][0]*v[i][0] + v[i][1]*v[i][1] + v[i][2]*v[i][2]) *
           mass[type[i]];
@@ -149,7 +148,6 @@ void ComputeTempRegion::compute_vector()
 
   invoked_vector = update->ntimestep;
 
-  double **x = atom->x;
   double **v = atom->v;
   double *mass = atom->mass;
   double *rmass = atom->rmass;
@@ -158,13 +156,13 @@ void ComputeTempRegion::compute_vector()
   int nlocal = atom->nlocal;
 
   Region *region = domain->regions[iregion];
-  region->prematch();
+  int *inregion = region->match_atoms();
 
   double massone,t[6];
   for (i = 0; i < 6; i++) t[i] = 0.0;
 
   for (i = 0; i < nlocal; i++)
-    if (mask[i] & groupbit && region->match(x[i][0],x[i][1],x[i][2])) {
+    if (mask[i] & groupbit && inregion[i]) {
       if (rmass) massone = rmass[i];
       else massone = mass[type[i]];
       t[0] += massone * v[i][0]*v[i][0];
@@ -33,10 +33,6 @@
 
 using namespace LAMMPS_NS;
 
-// allocate space for static class variable
-
-DeleteAtoms *DeleteAtoms::cptr;
-
 /* ---------------------------------------------------------------------- */
 
 DeleteAtoms::DeleteAtoms(LAMMPS *lmp) : Pointers(lmp) {}
@@ -411,35 +407,7 @@ void DeleteAtoms::delete_porosity(int narg, char **arg)
 
 void DeleteAtoms::delete_molecule()
 {
-  // hash = unique molecule IDs from which I deleted atoms
-
-  hash = new std::map<tagint,int>();
-
-  tagint *molecule = atom->molecule;
-  int nlocal = atom->nlocal;
-
-  for (int i = 0; i < nlocal; i++) {
-    if (molecule[i] == 0) continue;
-    if (dlist[i] && hash->find(molecule[i]) == hash->end())
-      (*hash)[molecule[i]] = 1;
-  }
-
-  // list = set of unique molecule IDs from which I deleted atoms
-  // pass list to all other procs via comm->ring()
-
-  int n = hash->size();
-  tagint *list;
-  memory->create(list,n,"delete_atoms:list");
-
-  n = 0;
-  std::map<tagint,int>::iterator pos;
-  for (pos = hash->begin(); pos != hash->end(); ++pos) list[n++] = pos->first;
-
-  cptr = this;
-  comm->ring(n,sizeof(tagint),list,1,molring,NULL);
-
-  delete hash;
-  memory->destroy(list);
+  comm->flag_molecules(dlist);
 }
 
 /* ----------------------------------------------------------------------
@@ -504,27 +472,6 @@ void DeleteAtoms::recount_topology()
   }
 }
 
-/* ----------------------------------------------------------------------
-   callback from comm->ring()
-   cbuf = list of N molecule IDs, put them in hash
-   loop over my atoms, if matches molecule ID in hash, delete that atom
-------------------------------------------------------------------------- */
-
-void DeleteAtoms::molring(int n, char *cbuf)
-{
-  tagint *list = (tagint *) cbuf;
-  int *dlist = cptr->dlist;
-  std::map<tagint,int> *hash = cptr->hash;
-  int nlocal = cptr->atom->nlocal;
-  tagint *molecule = cptr->atom->molecule;
-
-  hash->clear();
-  for (int i = 0; i < n; i++) (*hash)[list[i]] = 1;
-
-  for (int i = 0; i < nlocal; i++)
-    if (hash->find(molecule[i]) != hash->end()) dlist[i] = 1;
-}
-
 /* ----------------------------------------------------------------------
    process command options
 ------------------------------------------------------------------------- */
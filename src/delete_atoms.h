@@ -33,7 +33,6 @@ class DeleteAtoms : protected Pointers {
  private:
   int *dlist;
   int compress_flag,mol_flag;
-  std::map<tagint,int> *hash;
 
   void delete_group(int, char **);
   void delete_region(int, char **);
@@ -46,12 +45,6 @@ class DeleteAtoms : protected Pointers {
   inline int sbmask(int j) {
     return j >> SBBITS & 3;
   }
-
-  // static variable for ring communication callback to access class data
-  // callback functions for ring communication
-
-  static DeleteAtoms *cptr;
-  static void molring(int, char *);
 };
 
 }
@@ -26,6 +26,14 @@
 #include "error.h"
 #include "force.h"
 
+#ifdef LAMMPS_ZLIB
+#include "zlib.h"
+#endif
+
+#if defined(LAMMPS_ASYNC_DUMP)
+#include "pthread.h"
+#endif
+
 using namespace LAMMPS_NS;
 
 // allocate space for static class variable
@@ -34,6 +42,8 @@ Dump *Dump::dumpptr;
 
 #define BIG 1.0e20
 #define EPSILON 1.0e-6
+#define ZLEVEL 6                // same compression level as gzip pipe
+#define DELTA_ZSNAP 64
 
 enum{ASCEND,DESCEND};
 
@@ -82,6 +92,24 @@ Dump::Dump(LAMMPS *lmp, int narg, char **arg) : Pointers(lmp)
   maxsbuf = 0;
   sbuf = NULL;
 
+  zflag = zindex = 0;
+  maxzbuf = 0;
+  zbuf = NULL;
+  fpheader = NULL;
+  nzsnap = maxzsnap = 0;
+  zsteps = zoffsets = NULL;
+  zfooter = 0;
+
+  async_flag = 0;
+  maxstage = nstage = 0;
+  stage = NULL;
+  nstagechunk = maxstagechunk = 0;
+  stagecount = NULL;
+  stageoffset = NULL;
+  stageheader = 0;
+  stagestep = 0;
+  iothread_started = 0;
+
   // parse filename for special syntax
   // if contains '%', write one file per proc and replace % with proc-ID
   // if contains '*', write one file per timestep and replace * with timestep
@@ -131,6 +159,23 @@ Dump::Dump(LAMMPS *lmp, int narg, char **arg) : Pointers(lmp)
 
 Dump::~Dump()
 {
+  // finish and stop background I/O thread before file is closed
+  // owners must call async_wait() before delete, since a derived class
+  //   destructor has already freed its data by the time this runs
+
+#if defined(LAMMPS_ASYNC_DUMP)
+  if (iothread_started) {
+    async_wait();
+    pthread_mutex_lock(&job_mutex);
+    job = -1;
+    pthread_cond_broadcast(&job_cond);
+    pthread_mutex_unlock(&job_mutex);
+    pthread_join(iothread,NULL);
+    pthread_mutex_destroy(&job_mutex);
+    pthread_cond_destroy(&job_cond);
+  }
+#endif
+
   delete [] id;
   delete [] style;
   delete [] filename;
@@ -149,13 +194,20 @@ Dump::~Dump()
   delete irregular;
 
   memory->destroy(sbuf);
+  memory->destroy(zbuf);
+  memory->destroy(zsteps);
+  memory->destroy(zoffsets);
+  if (fpheader) fclose(fpheader);
+  memory->destroy(stage);
+  memory->destroy(stagecount);
+  memory->destroy(stageoffset);
 
   if (multiproc) MPI_Comm_free(&clustercomm);
 
   // XTC style sets fp to NULL since it closes file in its destructor
 
   if (multifile == 0 && fp != NULL) {
-    if (compressed) {
+    if (compressed && !zflag) {
       if (filewriter) pclose(fp);
     } else {
       if (filewriter) fclose(fp);
@@ -169,6 +221,22 @@ void Dump::init()
 {
   init_style();
 
+  if (zflag && (buffer_flag == 0 || binary))
+    error->all(FLERR,"Dump_modify buffer no not allowed "
+               "after opening in-process gzipped dump file");
+
+  // launch background I/O thread on procs that write files
+
+#if defined(LAMMPS_ASYNC_DUMP)
+  if (async_flag && filewriter && !iothread_started) {
+    job = 0;
+    pthread_mutex_init(&job_mutex,NULL);
+    pthread_cond_init(&job_cond,NULL);
+    pthread_create(&iothread,NULL,&dump_ioworker,this);
+    iothread_started = 1;
+  }
+#endif
+
   if (!sort_flag) {
     memory->destroy(bufsort);
     memory->destroy(ids);
@@ -262,6 +330,11 @@ int Dump::count()
 
 void Dump::write()
 {
+  // if async, wait until previous snapshot is written
+  // this bounds staged data to one snapshot and frees fp and zbuf
+
+  if (async_flag) async_wait();
+
   // if file per timestep, open new file
 
   if (multifile) openfile();
@@ -309,7 +382,11 @@ void Dump::write()
   if (multiproc)
     MPI_Allreduce(&bnme,&nheader,1,MPI_LMP_BIGINT,MPI_SUM,clustercomm);
 
-  if (filewriter) write_header(nheader);
+  if (filewriter) {
+    if (async_flag) stage_header(nheader);
+    else if (zflag) write_zheader(nheader);
+    else write_header(nheader);
+  }
 
   // insure buf is sized for packing and communicating
   // use nmax to insure filewriter proc can receive info from others
@@ -348,6 +425,21 @@ void Dump::write()
     int nsmin,nsmax;
     MPI_Allreduce(&nsme,&nsmin,1,MPI_INT,MPI_MIN,world);
     if (nsmin < 0) error->all(FLERR,"Too much buffered per-proc info for dump");
+
+    // if compressing in-process, each proc deflates its own string
+    //   into an independent gzip member which filewriter concatenates
+    // swap sbuf and zbuf so compressed chars are sent and written
+
+    if (zflag) {
+      nsme = deflate_chars(sbuf,nsme);
+      char *ctmp = sbuf;
+      sbuf = zbuf;
+      zbuf = ctmp;
+      int itmp = maxsbuf;
+      maxsbuf = maxzbuf;
+      maxzbuf = itmp;
+    }
+
     if (multiproc != nprocs) 
       MPI_Allreduce(&nsme,&nsmax,1,MPI_INT,MPI_MAX,world);
     else nsmax = nsme;
@@ -378,9 +470,12 @@ void Dump::write()
           nlines /= size_one;
         } else nlines = nme;
         
-        write_data(nlines,buf);
+        if (async_flag)
+          stage_data(nlines,(char *) buf,nlines*size_one*sizeof(double));
+        else write_data(nlines,buf);
       }
-      if (flush_flag) fflush(fp);
+      if (async_flag) async_start();
+      else if (flush_flag) fflush(fp);
     
     } else {
       MPI_Recv(&tmp,0,MPI_INT,fileproc,0,world,MPI_STATUS_IGNORE);
@@ -399,9 +494,14 @@ void Dump::write()
           MPI_Get_count(&status,MPI_CHAR,&nchars);
         } else nchars = nsme;
         
-        write_data(nchars,(double *) sbuf);
+        if (async_flag) stage_data(nchars,sbuf,nchars);
+        else write_data(nchars,(double *) sbuf);
+      }
+      if (async_flag) async_start();
+      else {
+        if (zindex) write_zindex();
+        if (flush_flag) fflush(fp);
       }
-      if (flush_flag) fflush(fp);
       
     } else {
       MPI_Recv(&tmp,0,MPI_INT,fileproc,0,world,MPI_STATUS_IGNORE);
@@ -410,9 +510,10 @@ void Dump::write()
   }
 
   // if file per timestep, close file if I am filewriter
+  // if async, background thread closes it after writing
 
-  if (multifile) {
-    if (compressed) {
+  if (multifile && !async_flag) {
+    if (compressed && !zflag) {
       if (filewriter) pclose(fp);
     } else {
       if (filewriter) fclose(fp);
@@ -423,6 +524,8 @@ void Dump::write()
 /* ----------------------------------------------------------------------
    generic opening of a dump file
    ASCII or binary or gzipped
+   gzipped text is compressed in-process if LAMMPS_ZLIB is defined
+     and the style buffers its output, else piped through gzip
    some derived classes override this function
 ------------------------------------------------------------------------- */
 
@@ -455,10 +558,22 @@ void Dump::openfile()
     *ptr = '*';
   }
 
+  // all procs compress their own output if gzipped in-process
+
+#ifdef LAMMPS_ZLIB
+  if (compressed && buffer_flag && !binary) zflag = 1;
+#endif
+
   // each proc with filewriter = 1 opens a file
 
   if (filewriter) {
-    if (compressed) {
+    if (zflag) {
+      if (append_flag) fp = fopen(filecurrent,"ab");
+      else fp = fopen(filecurrent,"wb");
+      zindex = 1 - append_flag;
+      nzsnap = 0;
+      zfooter = 0;
+    } else if (compressed) {
 #ifdef LAMMPS_GZIP
       char gzip[128];
       sprintf(gzip,"gzip -6 > %s",filecurrent);
@@ -486,6 +601,291 @@ void Dump::openfile()
   if (multifile) delete [] filecurrent;
 }
 
+/* ----------------------------------------------------------------------
+   compress N chars from str into zbuf as one complete gzip member
+   return # of compressed chars in zbuf, 0 if N = 0
+------------------------------------------------------------------------- */
+
+int Dump::deflate_chars(char *str, int n)
+{
+  if (n == 0) return 0;
+
+#ifdef LAMMPS_ZLIB
+  z_stream zs;
+  zs.zalloc = Z_NULL;
+  zs.zfree = Z_NULL;
+  zs.opaque = Z_NULL;
+  if (deflateInit2(&zs,ZLEVEL,Z_DEFLATED,15+16,8,Z_DEFAULT_STRATEGY) != Z_OK)
+    error->one(FLERR,"Cannot compress dump output");
+
+  int bound = deflateBound(&zs,n);
+  if (bound > maxzbuf) {
+    maxzbuf = bound;
+    memory->destroy(zbuf);
+    memory->create(zbuf,maxzbuf,"dump:zbuf");
+  }
+
+  zs.next_in = (Bytef *) str;
+  zs.avail_in = n;
+  zs.next_out = (Bytef *) zbuf;
+  zs.avail_out = maxzbuf;
+  if (deflate(&zs,Z_FINISH) != Z_STREAM_END)
+    error->one(FLERR,"Cannot compress dump output");
+  int nz = zs.total_out;
+  deflateEnd(&zs);
+  return nz;
+#else
+  return 0;
+#endif
+}
+
+/* ----------------------------------------------------------------------
+   capture header text of snapshot in sbuf via scratch file
+   allows write_header() of each style to be used unchanged
+   return # of chars in sbuf
+------------------------------------------------------------------------- */
+
+int Dump::capture_header(bigint ndump)
+{
+  if (fpheader == NULL) fpheader = tmpfile();
+  if (fpheader == NULL) error->one(FLERR,"Cannot open dump file");
+
+  FILE *fpsave = fp;
+  fp = fpheader;
+  rewind(fp);
+  write_header(ndump);
+  int nchars = ftell(fp);
+  fp = fpsave;
+
+  if (nchars > maxsbuf) {
+    maxsbuf = nchars;
+    memory->grow(sbuf,maxsbuf,"dump:sbuf");
+  }
+  rewind(fpheader);
+  fread(sbuf,sizeof(char),nchars,fpheader);
+  return nchars;
+}
+
+/* ----------------------------------------------------------------------
+   if file is indexed, overwrite old index footer with new snapshot
+     and record its timestep and offset
+------------------------------------------------------------------------- */
+
+void Dump::zindex_snapshot(bigint ntimestep)
+{
+  fseek(fp,zfooter,SEEK_SET);
+  if (nzsnap == maxzsnap) {
+    maxzsnap += DELTA_ZSNAP;
+    memory->grow(zsteps,maxzsnap,"dump:zsteps");
+    memory->grow(zoffsets,maxzsnap,"dump:zoffsets");
+  }
+  zsteps[nzsnap] = ntimestep;
+  zoffsets[nzsnap] = zfooter;
+  nzsnap++;
+}
+
+/* ----------------------------------------------------------------------
+   write header of in-process gzipped snapshot as its own gzip member
+------------------------------------------------------------------------- */
+
+void Dump::write_zheader(bigint ndump)
+{
+  if (zindex) zindex_snapshot(update->ntimestep);
+  int nchars = capture_header(ndump);
+  int nz = deflate_chars(sbuf,nchars);
+  fwrite(zbuf,sizeof(char),nz,fp);
+}
+
+/* ----------------------------------------------------------------------
+   write index of in-process gzipped file as an empty gzip member
+   index is the text comment in its gzip header, which decompressors ignore
+   comment = "LAMMPS dump index", a "timestep offset" line per snapshot,
+     and "index offset" of the footer itself as last line for readers
+   overwritten by the next snapshot, so file is always complete and indexed
+------------------------------------------------------------------------- */
+
+void Dump::write_zindex()
+{
+#ifdef LAMMPS_ZLIB
+  zfooter = ftell(fp);
+
+  int n = 32 + 48*(nzsnap+1);
+  char *comment = new char[n];
+  int m = sprintf(comment,"LAMMPS dump index\n");
+  for (int i = 0; i < nzsnap; i++)
+    m += sprintf(&comment[m],BIGINT_FORMAT " " BIGINT_FORMAT "\n",
+                 zsteps[i],zoffsets[i]);
+  sprintf(&comment[m],"index " BIGINT_FORMAT,zfooter);
+
+  z_stream zs;
+  gz_header head;
+  memset(&head,0,sizeof(gz_header));
+  head.os = 255;
+  head.comment = (Bytef *) comment;
+
+  zs.zalloc = Z_NULL;
+  zs.zfree = Z_NULL;
+  zs.opaque = Z_NULL;
+  if (deflateInit2(&zs,ZLEVEL,Z_DEFLATED,15+16,8,Z_DEFAULT_STRATEGY) != Z_OK)
+    error->one(FLERR,"Cannot compress dump output");
+  deflateSetHeader(&zs,&head);
+
+  int nout = n + 64;
+  if (nout > maxzbuf) {
+    maxzbuf = nout;
+    memory->destroy(zbuf);
+    memory->create(zbuf,maxzbuf,"dump:zbuf");
+  }
+
+  zs.next_in = Z_NULL;
+  zs.avail_in = 0;
+  zs.next_out = (Bytef *) zbuf;
+  zs.avail_out = maxzbuf;
+  if (deflate(&zs,Z_FINISH) != Z_STREAM_END)
+    error->one(FLERR,"Cannot compress dump output");
+  fwrite(zbuf,sizeof(char),zs.total_out,fp);
+  deflateEnd(&zs);
+
+  delete [] comment;
+#endif
+}
+
+/* ----------------------------------------------------------------------
+   start staged snapshot for background thread with its header
+   header is compressed here if gzipped in-process
+------------------------------------------------------------------------- */
+
+void Dump::stage_header(bigint ndump)
+{
+  int nchars = capture_header(ndump);
+  char *str = sbuf;
+  if (zflag) {
+    nchars = deflate_chars(sbuf,nchars);
+    str = zbuf;
+  }
+
+  nstage = nstagechunk = 0;
+  stagestep = update->ntimestep;
+  stage_data(0,str,nchars);
+  stageheader = nchars;
+  nstagechunk = 0;
+}
+
+/* ----------------------------------------------------------------------
+   append chunk of N lines or chars, Nbytes long, to staged snapshot
+   chunks are aligned to doubles since write_data() may read them as such
+------------------------------------------------------------------------- */
+
+void Dump::stage_data(int n, char *data, bigint nbytes)
+{
+  bigint offset = nstage;
+  if (offset % sizeof(double))
+    offset += sizeof(double) - offset % sizeof(double);
+  if (offset + nbytes > MAXSMALLINT)
+    error->one(FLERR,"Too much dump data to stage for async output");
+
+  if (offset + nbytes > maxstage) {
+    maxstage = offset + nbytes;
+    memory->grow(stage,maxstage,"dump:stage");
+  }
+  if (nstagechunk == maxstagechunk) {
+    maxstagechunk += DELTA_ZSNAP;
+    memory->grow(stagecount,maxstagechunk,"dump:stagecount");
+    memory->grow(stageoffset,maxstagechunk,"dump:stageoffset");
+  }
+
+  memcpy(&stage[offset],data,nbytes);
+  stagecount[nstagechunk] = n;
+  stageoffset[nstagechunk] = offset;
+  nstagechunk++;
+  nstage = offset + nbytes;
+}
+
+/* ----------------------------------------------------------------------
+   write staged snapshot to file, invoked by background thread
+   same sequence of file operations as a synchronous write()
+------------------------------------------------------------------------- */
+
+void Dump::write_stage()
+{
+  if (zindex) zindex_snapshot(stagestep);
+  fwrite(stage,sizeof(char),stageheader,fp);
+  for (int i = 0; i < nstagechunk; i++)
+    write_data(stagecount[i],(double *) &stage[stageoffset[i]]);
+  if (zindex) write_zindex();
+  if (flush_flag) fflush(fp);
+
+  if (multifile) {
+    if (compressed && !zflag) pclose(fp);
+    else fclose(fp);
+  }
+}
+
+/* ----------------------------------------------------------------------
+   hand staged snapshot to background thread
+------------------------------------------------------------------------- */
+
+void Dump::async_start()
+{
+#if defined(LAMMPS_ASYNC_DUMP)
+  pthread_mutex_lock(&job_mutex);
+  job = 1;
+  pthread_cond_broadcast(&job_cond);
+  pthread_mutex_unlock(&job_mutex);
+#else
+  write_stage();
+#endif
+}
+
+/* ----------------------------------------------------------------------
+   wait until background thread has written staged snapshot
+   called at start of each write() and at end of each run
+------------------------------------------------------------------------- */
+
+void Dump::async_wait()
+{
+#if defined(LAMMPS_ASYNC_DUMP)
+  if (!iothread_started) return;
+  pthread_mutex_lock(&job_mutex);
+  while (job > 0) pthread_cond_wait(&job_cond,&job_mutex);
+  pthread_mutex_unlock(&job_mutex);
+#endif
+}
+
+#if defined(LAMMPS_ASYNC_DUMP)
+
+/* ----------------------------------------------------------------------
+   C binding for background I/O thread
+------------------------------------------------------------------------- */
+
+void *dump_ioworker(void *ptr)
+{
+  Dump *dump = (Dump *) ptr;
+  dump->ioworker();
+  return NULL;
+}
+
+/* ----------------------------------------------------------------------
+   background I/O thread: write each staged snapshot until told to exit
+------------------------------------------------------------------------- */
+
+void Dump::ioworker()
+{
+  pthread_mutex_lock(&job_mutex);
+  while (1) {
+    while (job == 0) pthread_cond_wait(&job_cond,&job_mutex);
+    if (job < 0) break;
+    pthread_mutex_unlock(&job_mutex);
+    write_stage();
+    pthread_mutex_lock(&job_mutex);
+    job = 0;
+    pthread_cond_broadcast(&job_cond);
+  }
+  pthread_mutex_unlock(&job_mutex);
+}
+
+#endif
+
 /* ----------------------------------------------------------------------
    parallel sort of buf across all procs
    changes nme, reorders datums in buf, grows buf if necessary
@@ -714,6 +1114,8 @@ void Dump::modify_params(int narg, char **arg)
 {
   if (narg == 0) error->all(FLERR,"Illegal dump_modify command");
 
+  async_wait();
+
   int iarg = 0;
   while (iarg < narg) {
     if (strcmp(arg[iarg],"append") == 0) {
@@ -723,6 +1125,20 @@ void Dump::modify_params(int narg, char **arg)
       else error->all(FLERR,"Illegal dump_modify command");
       iarg += 2;
 
+    } else if (strcmp(arg[iarg],"async") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal dump_modify command");
+      if (strcmp(arg[iarg+1],"yes") == 0) async_flag = 1;
+      else if (strcmp(arg[iarg+1],"no") == 0) async_flag = 0;
+      else error->all(FLERR,"Illegal dump_modify command");
+#if !defined(LAMMPS_ASYNC_DUMP)
+      if (async_flag)
+        error->all(FLERR,"Dump_modify async yes requires LAMMPS "
+                   "compiled with -DLAMMPS_ASYNC_DUMP");
+#endif
+      if (async_flag && buffer_allow == 0)
+        error->all(FLERR,"Dump_modify async yes not allowed for this style");
+      iarg += 2;
+
     } else if (strcmp(arg[iarg],"buffer") == 0) {
       if (iarg+2 > narg) error->all(FLERR,"Illegal dump_modify command");
       if (strcmp(arg[iarg+1],"yes") == 0) buffer_flag = 1;
@@ -879,6 +1295,8 @@ bigint Dump::memory_usage()
 {
   bigint bytes = memory->usage(buf,size_one*maxbuf);
   bytes += memory->usage(sbuf,maxsbuf);
+  bytes += memory->usage(zbuf,maxzbuf);
+  bytes += memory->usage(stage,maxstage);
   if (sort_flag) {
     if (sortcol == 0) bytes += memory->usage(ids,maxids);
     bytes += memory->usage(bufsort,size_one*maxsort);
@@ -18,6 +18,14 @@
 #include "stdio.h"
 #include "pointers.h"
 
+#if defined(LAMMPS_ASYNC_DUMP)
+#include "pthread.h"
+#endif
+
+// C wrapper that runs the background I/O thread of a dump
+
+extern "C" void *dump_ioworker(void *);
+
 namespace LAMMPS_NS {
 
 class Dump : protected Pointers {
@@ -48,6 +56,11 @@ class Dump : protected Pointers {
 
   void modify_params(int, char **);
   virtual bigint memory_usage();
+  void async_wait();
+
+#if defined(LAMMPS_ASYNC_DUMP)
+  void ioworker();
+#endif
 
  protected:
   int me,nprocs;             // proc info
@@ -101,6 +114,36 @@ class Dump : protected Pointers {
   int maxsbuf;               // size of sbuf
   char *sbuf;                // memory for atom quantities in string format
 
+  int zflag;                 // 1 if gzipped in-process via zlib, 0 if not
+  int zindex;                // 1 if zlib file has a snapshot index footer
+  int maxzbuf;               // size of zbuf
+  char *zbuf;                // memory for zlib compressed chars
+  FILE *fpheader;            // scratch file to capture header text
+  int nzsnap,maxzsnap;       // # of snapshots in index, size of index
+  bigint *zsteps;            // timestep of each snapshot in index
+  bigint *zoffsets;          // file offset of each snapshot in index
+  bigint zfooter;            // file offset of index footer
+
+  int async_flag;            // 1 if background thread writes file, 0 if not
+  int maxstage;              // size of stage
+  char *stage;               // snapshot staged for background thread
+  bigint nstage;             // # of bytes in stage
+  int nstagechunk;           // # of chunks in stage, after header
+  int maxstagechunk;         // size of stagecount, stageoffset
+  int *stagecount;           // # of lines or chars in each chunk
+  bigint *stageoffset;       // byte offset of each chunk in stage
+  int stageheader;           // # of header bytes at start of stage
+  bigint stagestep;          // timestep of staged snapshot
+  int iothread_started;      // 1 if background thread is running
+
+#if defined(LAMMPS_ASYNC_DUMP)
+  int job;                   // 1 = stage holds snapshot to write, 0 = idle,
+                             // -1 = thread should exit
+  pthread_mutex_t job_mutex; // guards job
+  pthread_cond_t job_cond;   // signals change of job
+  pthread_t iothread;        // background I/O thread
+#endif
+
   int maxids;                // size of ids
   int maxsort;               // size of bufsort, idsort, index
   int maxproc;               // size of proclist
@@ -121,6 +164,15 @@ class Dump : protected Pointers {
   virtual void write_data(int, double *) = 0;
 
   void sort();
+  int deflate_chars(char *, int);
+  int capture_header(bigint);
+  void zindex_snapshot(bigint);
+  void write_zheader(bigint);
+  void write_zindex();
+  void stage_header(bigint);
+  void stage_data(int, char *, bigint);
+  void write_stage();
+  void async_start();
   static int idcompare(const void *, const void *);
   static int bufcompare(const void *, const void *);
   static int bufcompare_reverse(const void *, const void *);
@@ -137,6 +189,32 @@ E: Dump file MPI-IO output not allowed with % in filename
 This is because a % signifies one file per processor and MPI-IO
 creates one large file for all processors.
 
+E: Dump_modify buffer no not allowed after opening in-process gzipped dump file
+
+A gzipped dump file that is compressed by LAMMPS itself requires
+buffered output.  Set dump_modify buffer before the file is opened.
+
+E: Dump_modify async yes requires LAMMPS compiled with -DLAMMPS_ASYNC_DUMP
+
+Writing dump files from a background thread uses pthreads, which must
+be enabled when LAMMPS is built.
+
+E: Dump_modify async yes not allowed for this style
+
+Only dump styles that can buffer their output support asynchronous
+writing.
+
+E: Too much dump data to stage for async output
+
+The snapshot gathered on a proc that writes a dump file is larger
+than 2^31 bytes.  Use the % option in the dump file name to spread
+output over more files.
+
+E: Cannot compress dump output
+
+The zlib library returned an error while compressing a gzipped dump
+file in-process.
+
 E: Cannot dump sort when multiple dump files are written
 
 In this mode, each processor dumps its atoms to a file, so
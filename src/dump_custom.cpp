@@ -12,6 +12,7 @@
 ------------------------------------------------------------------------- */
 
 #include "math.h"
+#include "float.h"
 #include "stdlib.h"
 #include "string.h"
 #include "dump_custom.h"
@@ -26,9 +27,14 @@
 #include "modify.h"
 #include "compute.h"
 #include "fix.h"
+#include "comm.h"
 #include "memory.h"
 #include "error.h"
 
+#if defined(_OPENMP)
+#include "omp.h"
+#endif
+
 using namespace LAMMPS_NS;
 
 // customize by adding keyword
@@ -45,10 +51,26 @@ enum{ID,MOL,PROC,PROCP1,TYPE,ELEMENT,MASS,
      COMPUTE,FIX,VARIABLE,INAME,DNAME};
 enum{LT,LE,GT,GE,EQ,NEQ};
 enum{INT,DOUBLE,STRING,BIGINT};    // same as in DumpCFG
+enum{PRINTF,DCONV,ECONV,FCONV,GCONV};
 
 #define INVOKED_PERATOM 8
 #define ONEFIELD 32
 #define DELTA 1048576
+#define MINCHUNK 1024       // fewest lines converted by one thread
+
+// flags of a format element
+
+#define LEFT 1
+#define PLUS 2
+#define SPACE 4
+#define ZERO 8
+
+#define MAXPOW10 27         // largest power of 10 exact in a long double
+#define MAXDIGITS 17        // most significant digits converted directly
+
+static int parse_format(const char *, int &, int &, int &);
+static int format_int(char *, bigint, int, int);
+static int format_double(char *, double, int, int, int, int);
 
 /* ---------------------------------------------------------------------- */
 
@@ -124,6 +146,19 @@ DumpCustom::DumpCustom(LAMMPS *lmp, int narg, char **arg) :
   // setup format strings
 
   vformat = new char*[size_one];
+  fconv = new int[size_one];
+  fflags = new int[size_one];
+  fwidth = new int[size_one];
+  fprec = new int[size_one];
+  for (int i = 0; i < size_one; i++) {
+    fconv[i] = PRINTF;
+    fwidth[i] = 0;
+  }
+  maxline = size_one*ONEFIELD + 2;
+
+  nthreadbuf = 0;
+  tbuf = NULL;
+  maxtbuf = ntbuf = NULL;
 
   format_default = new char[3*size_one+1];
   format_default[0] = '\0';
@@ -191,6 +226,15 @@ DumpCustom::~DumpCustom()
 
   for (int i = 0; i < size_one; i++) delete [] vformat[i];
   delete [] vformat;
+  delete [] fconv;
+  delete [] fflags;
+  delete [] fwidth;
+  delete [] fprec;
+
+  for (int i = 0; i < nthreadbuf; i++) memory->destroy(tbuf[i]);
+  delete [] tbuf;
+  delete [] maxtbuf;
+  delete [] ntbuf;
 
   delete [] columns;
 }
@@ -231,6 +275,8 @@ void DumpCustom::init_style()
     vformat[i] = strcat(vformat[i]," ");
   }
 
+  setup_conversions();
+
   // setup boundary string
 
   domain->boundary_string(boundstr);
@@ -297,6 +343,23 @@ void DumpCustom::init_style()
   if (multifile == 0) openfile();
 }
 
+/* ----------------------------------------------------------------------
+   parse each format element for conversion without sprintf()
+   set maxline = bound on chars in one line of values, newline, and null
+------------------------------------------------------------------------- */
+
+void DumpCustom::setup_conversions()
+{
+  maxline = 2;
+  for (int i = 0; i < size_one; i++) {
+    fconv[i] = parse_format(vformat[i],fflags[i],fwidth[i],fprec[i]);
+    if (fconv[i] == DCONV && vtype[i] != INT && vtype[i] != BIGINT)
+      fconv[i] = PRINTF;
+    if (fconv[i] > DCONV && vtype[i] != DOUBLE) fconv[i] = PRINTF;
+    maxline += ONEFIELD + fwidth[i];
+  }
+}
+
 /* ---------------------------------------------------------------------- */
 
 void DumpCustom::write_header(bigint ndump)
@@ -444,10 +507,9 @@ int DumpCustom::count()
 
   if (iregion >= 0) {
     Region *region = domain->regions[iregion];
-    region->prematch();
-    double **x = atom->x;
+    int *inregion = region->match_atoms();
     for (i = 0; i < nlocal; i++)
-      if (choose[i] && region->match(x[i][0],x[i][1],x[i][2]) == 0)
+      if (choose[i] && inregion[i] == 0)
         choose[i] = 0;
   }
 
@@ -932,36 +994,116 @@ void DumpCustom::pack(tagint *ids)
 
 /* ----------------------------------------------------------------------
    convert mybuf of doubles to one big formatted string in sbuf
+   with OpenMP, each thread converts a contiguous chunk of lines into
+     its own buffer and the chunks are then concatenated in order
    return -1 if strlen exceeds an int, since used as arg in MPI calls in Dump
 ------------------------------------------------------------------------- */
 
 int DumpCustom::convert_string(int n, double *mybuf)
 {
-  int i,j;
+  int nthreads = comm->nthreads;
+  if (n < nthreads*MINCHUNK) nthreads = n/MINCHUNK;
+  if (nthreads <= 1) return convert_lines(n,mybuf,sbuf,maxsbuf);
+
+  if (nthreads > nthreadbuf) {
+    for (int i = 0; i < nthreadbuf; i++) memory->destroy(tbuf[i]);
+    delete [] tbuf;
+    delete [] maxtbuf;
+    delete [] ntbuf;
+    nthreadbuf = nthreads;
+    tbuf = new char*[nthreadbuf];
+    maxtbuf = new int[nthreadbuf];
+    ntbuf = new int[nthreadbuf];
+    for (int i = 0; i < nthreadbuf; i++) {
+      tbuf[i] = NULL;
+      maxtbuf[i] = 0;
+    }
+  }
+
+#if defined(_OPENMP)
+#pragma omp parallel num_threads(nthreads) default(none) shared(n,mybuf,nthreads)
+#endif
+  {
+    int tid = 0;
+#if defined(_OPENMP)
+    tid = omp_get_thread_num();
+#endif
+    int lo = static_cast<int> ((bigint) n*tid/nthreads);
+    int hi = static_cast<int> ((bigint) n*(tid+1)/nthreads);
+    ntbuf[tid] = convert_lines(hi-lo,&mybuf[lo*size_one],
+                               tbuf[tid],maxtbuf[tid]);
+  }
+
+  bigint total = 0;
+  for (int i = 0; i < nthreads; i++) {
+    if (ntbuf[i] < 0) return -1;
+    total += ntbuf[i];
+  }
+  if (total >= MAXSMALLINT) return -1;
+  if (total >= maxsbuf) {
+    maxsbuf = total + 1;
+    memory->grow(sbuf,maxsbuf,"dump:sbuf");
+  }
+
+  int offset = 0;
+  for (int i = 0; i < nthreads; i++) {
+    memcpy(&sbuf[offset],tbuf[i],ntbuf[i]);
+    offset += ntbuf[i];
+  }
+  sbuf[offset] = '\0';
+
+  return offset;
+}
+
+/* ----------------------------------------------------------------------
+   convert N lines of mybuf into str, grown as needed to maxstr
+   use fast conversion for each value if its format element allows,
+     fall back to sprintf() if value cannot be converted identically
+   return # of chars or -1 if strlen exceeds an int
+------------------------------------------------------------------------- */
+
+int DumpCustom::convert_lines(int n, double *mybuf, char *&str, int &maxstr)
+{
+  int i,j,len;
 
   int offset = 0;
   int m = 0;
   for (i = 0; i < n; i++) {
-    if (offset + size_one*ONEFIELD > maxsbuf) {
-      if ((bigint) maxsbuf + DELTA > MAXSMALLINT) return -1;
-      maxsbuf += DELTA;
-      memory->grow(sbuf,maxsbuf,"dump:sbuf");
+    if (offset + maxline > maxstr) {
+      if ((bigint) maxstr + DELTA > MAXSMALLINT) return -1;
+      maxstr += DELTA;
+      memory->grow(str,maxstr,"dump:sbuf");
     }
 
     for (j = 0; j < size_one; j++) {
-      if (vtype[j] == INT) 
-        offset += sprintf(&sbuf[offset],vformat[j],static_cast<int> (mybuf[m]));
+      if (fconv[j] == DCONV) {
+        if (vtype[j] == INT)
+          len = format_int(&str[offset],static_cast<int> (mybuf[m]),
+                           fflags[j],fwidth[j]);
+        else
+          len = format_int(&str[offset],static_cast<bigint> (mybuf[m]),
+                           fflags[j],fwidth[j]);
+        str[offset+len] = ' ';
+        offset += len + 1;
+      } else if (fconv[j] != PRINTF &&
+                 (len = format_double(&str[offset],mybuf[m],fconv[j],
+                                      fflags[j],fwidth[j],fprec[j])) >= 0) {
+        str[offset+len] = ' ';
+        offset += len + 1;
+      } else if (vtype[j] == INT) 
+        offset += sprintf(&str[offset],vformat[j],static_cast<int> (mybuf[m]));
       else if (vtype[j] == DOUBLE) 
-        offset += sprintf(&sbuf[offset],vformat[j],mybuf[m]);
+        offset += sprintf(&str[offset],vformat[j],mybuf[m]);
       else if (vtype[j] == STRING)
-        offset += sprintf(&sbuf[offset],vformat[j],typenames[(int) mybuf[m]]);
+        offset += sprintf(&str[offset],vformat[j],typenames[(int) mybuf[m]]);
       else if (vtype[j] == BIGINT) 
-        offset += sprintf(&sbuf[offset],vformat[j],
+        offset += sprintf(&str[offset],vformat[j],
                           static_cast<bigint> (mybuf[m]));
       m++;
     }
-    offset += sprintf(&sbuf[offset],"\n");
+    str[offset++] = '\n';
   }
+  if (maxstr) str[offset] = '\0';
 
   return offset;
 }
@@ -1765,6 +1907,7 @@ bigint DumpCustom::memory_usage()
   bytes += memory->usage(dchoose,maxlocal);
   bytes += memory->usage(clist,maxlocal);
   bytes += memory->usage(vbuf,nvariable,maxlocal);
+  for (int i = 0; i < nthreadbuf; i++) bytes += maxtbuf[i];
   return bytes;
 }
 
@@ -2586,3 +2729,303 @@ void DumpCustom::pack_tqz(int n)
     n += size_one;
   }
 }
+
+/* ----------------------------------------------------------------------
+   fast conversion of values to text, without sprintf() and its format
+     parsing for every value, and independent of the C locale
+   a format element of the form %[-+ 0][width][.precision]C followed by
+     the space added in init_style() is converted directly,
+     where C = d or i for integers, e or f or g for floating point
+   all other format elements are passed to sprintf()
+------------------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------------
+   parse format element str
+   set flags, width, precision (-1 if not given)
+   return conversion type, PRINTF if not converted directly
+------------------------------------------------------------------------- */
+
+static int parse_format(const char *str, int &flags, int &width, int &prec)
+{
+  flags = width = 0;
+  prec = -1;
+
+  const char *ptr = str;
+  if (*ptr++ != '%') return PRINTF;
+
+  while (1) {
+    if (*ptr == '-') flags |= LEFT;
+    else if (*ptr == '+') flags |= PLUS;
+    else if (*ptr == ' ') flags |= SPACE;
+    else if (*ptr == '0') flags |= ZERO;
+    else break;
+    ptr++;
+  }
+  if (flags & LEFT) flags &= ~ZERO;
+  if (flags & PLUS) flags &= ~SPACE;
+
+  while (*ptr >= '0' && *ptr <= '9') width = 10*width + (*ptr++ - '0');
+  if (*ptr == '.') {
+    ptr++;
+    prec = 0;
+    while (*ptr >= '0' && *ptr <= '9') prec = 10*prec + (*ptr++ - '0');
+  }
+  if (width > ONEFIELD) return PRINTF;
+
+  int nlong = 0;
+  while (*ptr == 'l') {
+    nlong++;
+    ptr++;
+  }
+  if (nlong > 2) return PRINTF;
+
+  int conv;
+  if (*ptr == 'd' || *ptr == 'i') conv = DCONV;
+  else if (*ptr == 'e' && nlong < 2) conv = ECONV;
+  else if (*ptr == 'f' && nlong < 2) conv = FCONV;
+  else if (*ptr == 'g' && nlong < 2) conv = GCONV;
+  else return PRINTF;
+  ptr++;
+
+  if (strcmp(ptr," ") != 0) return PRINTF;
+  if (conv == DCONV && prec >= 0) return PRINTF;
+  if (conv != DCONV && prec < 0) prec = 6;
+  return conv;
+}
+
+/* ----------------------------------------------------------------------
+   write N digits of value into str, most significant first
+   return # of digits written
+------------------------------------------------------------------------- */
+
+static int write_digits(char *str, unsigned long long value)
+{
+  char tmp[24];
+  int n = 0;
+  do {
+    tmp[n++] = '0' + static_cast<int> (value % 10);
+    value /= 10;
+  } while (value);
+  for (int i = 0; i < n; i++) str[i] = tmp[n-1-i];
+  return n;
+}
+
+/* ----------------------------------------------------------------------
+   write sign and body of n chars into str, padded to width as per flags
+   return # of chars written
+------------------------------------------------------------------------- */
+
+static int write_padded(char *str, char sign, const char *body, int n,
+                        int flags, int width)
+{
+  int len = n + (sign ? 1 : 0);
+  int npad = width > len ? width - len : 0;
+  int m = 0;
+
+  if (npad && !(flags & (LEFT | ZERO)))
+    for (int i = 0; i < npad; i++) str[m++] = ' ';
+  if (sign) str[m++] = sign;
+  if (npad && (flags & ZERO))
+    for (int i = 0; i < npad; i++) str[m++] = '0';
+  memcpy(&str[m],body,n);
+  m += n;
+  if (npad && (flags & LEFT))
+    for (int i = 0; i < npad; i++) str[m++] = ' ';
+
+  return m;
+}
+
+/* ----------------------------------------------------------------------
+   convert integer value into str as per flags and width
+   return # of chars written
+------------------------------------------------------------------------- */
+
+static int format_int(char *str, bigint value, int flags, int width)
+{
+  char sign = 0;
+  unsigned long long uvalue;
+  if (value < 0) {
+    sign = '-';
+    uvalue = 0ULL - static_cast<unsigned long long> (value);
+  } else {
+    if (flags & PLUS) sign = '+';
+    else if (flags & SPACE) sign = ' ';
+    uvalue = value;
+  }
+
+  char body[24];
+  int n = write_digits(body,uvalue);
+  return write_padded(str,sign,body,n,flags,width);
+}
+
+/* ----------------------------------------------------------------------
+   round non-negative value*10^k to nearest integer in r
+   done in extended precision where 10^k is exact,
+     so the only error is one rounding of the product
+   return 0 if out of range or if the product is so close to a
+     half-integer that rounding may differ from printf(), else 1
+------------------------------------------------------------------------- */
+
+static int round_scaled(double value, int k, unsigned long long &r)
+{
+#if LDBL_MANT_DIG >= 64
+  static const long double pow10[MAXPOW10+1] =
+    {1e0L,1e1L,1e2L,1e3L,1e4L,1e5L,1e6L,1e7L,1e8L,1e9L,
+     1e10L,1e11L,1e12L,1e13L,1e14L,1e15L,1e16L,1e17L,1e18L,1e19L,
+     1e20L,1e21L,1e22L,1e23L,1e24L,1e25L,1e26L,1e27L};
+
+  if (k > MAXPOW10 || k < -MAXPOW10) return 0;
+
+  long double scaled;
+  if (k >= 0) scaled = value * pow10[k];
+  else scaled = value / pow10[-k];
+  if (scaled >= 1e18L) return 0;
+
+  long double whole = floorl(scaled);
+  long double frac = scaled - whole;
+  if (fabsl(frac - 0.5L) <= scaled*LDBL_EPSILON) return 0;
+
+  r = static_cast<unsigned long long> (whole);
+  if (frac > 0.5L) r++;
+  return 1;
+#else
+  return 0;
+#endif
+}
+
+/* ----------------------------------------------------------------------
+   round non-negative value to N significant digits, N <= MAXDIGITS
+   return digits as an integer in r, and decimal exponent of first digit
+   return 0 if rounding may differ from printf(), else 1
+------------------------------------------------------------------------- */
+
+static int round_significant(double value, int n, unsigned long long &r,
+                             int &exponent)
+{
+  static const unsigned long long pow10[MAXDIGITS+1] =
+    {1ULL,10ULL,100ULL,1000ULL,10000ULL,100000ULL,1000000ULL,
+     10000000ULL,100000000ULL,1000000000ULL,10000000000ULL,
+     100000000000ULL,1000000000000ULL,10000000000000ULL,
+     100000000000000ULL,1000000000000000ULL,10000000000000000ULL,
+     100000000000000000ULL};
+
+  if (value == 0.0) {
+    r = 0;
+    exponent = 0;
+    return 1;
+  }
+
+  // log10() may be off by one, so adjust exponent until N digits result
+
+  exponent = static_cast<int> (floor(log10(value)));
+  for (int iter = 0; iter < 3; iter++) {
+    if (!round_scaled(value,n-1-exponent,r)) return 0;
+    if (r >= pow10[n]) exponent++;
+    else if (r < pow10[n-1]) exponent--;
+    else return 1;
+  }
+  return 0;
+}
+
+/* ----------------------------------------------------------------------
+   convert floating-point value into str as per conversion type,
+     flags, width and precision, identical to sprintf()
+   return # of chars written, -1 if value must be converted by sprintf()
+------------------------------------------------------------------------- */
+
+static int format_double(char *str, double value, int conv, int flags,
+                         int width, int prec)
+{
+  if (value != value || value > DBL_MAX || value < -DBL_MAX) return -1;
+
+  char sign = 0;
+  if (value < 0.0 || (value == 0.0 && 1.0/value < 0.0)) sign = '-';
+  else if (flags & PLUS) sign = '+';
+  else if (flags & SPACE) sign = ' ';
+  double absvalue = fabs(value);
+
+  char digits[24],body[64];
+  unsigned long long r;
+  int i,n,nd,nfrac,exponent,estyle;
+
+  // fixed point: round to prec decimals, pad to at least one whole digit
+
+  if (conv == FCONV) {
+    if (!round_scaled(absvalue,prec,r)) return -1;
+    nd = write_digits(digits,r);
+    n = 0;
+    if (nd <= prec) {
+      body[n++] = '0';
+      body[n++] = '.';
+      for (i = nd; i < prec; i++) body[n++] = '0';
+      memcpy(&body[n],digits,nd);
+      n += nd;
+    } else {
+      memcpy(body,digits,nd-prec);
+      n = nd-prec;
+      if (prec) {
+        body[n++] = '.';
+        memcpy(&body[n],&digits[nd-prec],prec);
+        n += prec;
+      }
+    }
+    return write_padded(str,sign,body,n,flags,width);
+  }
+
+  // exponential and general: round to nd significant digits
+  // general uses exponential style if exponent < -4 or >= precision
+
+  if (conv == ECONV) nd = prec + 1;
+  else nd = prec ? prec : 1;
+  if (nd > MAXDIGITS) return -1;
+  if (!round_significant(absvalue,nd,r,exponent)) return -1;
+  n = write_digits(digits,r);
+  for (i = n; i < nd; i++) digits[i] = '0';
+
+  if (conv == ECONV) estyle = 1;
+  else estyle = (exponent < -4 || exponent >= nd);
+
+  n = 0;
+  if (estyle) {
+    body[n++] = digits[0];
+    nfrac = nd - 1;
+    if (nfrac) {
+      body[n++] = '.';
+      memcpy(&body[n],&digits[1],nfrac);
+      n += nfrac;
+    }
+  } else if (exponent >= 0) {
+    memcpy(body,digits,exponent+1);
+    n = exponent + 1;
+    nfrac = nd - 1 - exponent;
+    if (nfrac) {
+      body[n++] = '.';
+      memcpy(&body[n],&digits[exponent+1],nfrac);
+      n += nfrac;
+    }
+  } else {
+    body[n++] = '0';
+    body[n++] = '.';
+    for (i = 0; i < -exponent-1; i++) body[n++] = '0';
+    memcpy(&body[n],digits,nd);
+    n += nd;
+    nfrac = nd - 1 - exponent;
+  }
+
+  // general style strips trailing zeros and a trailing decimal point
+
+  if (conv == GCONV && nfrac) {
+    while (body[n-1] == '0') n--;
+    if (body[n-1] == '.') n--;
+  }
+
+  if (estyle) {
+    body[n++] = 'e';
+    body[n++] = exponent < 0 ? '-' : '+';
+    int absexp = exponent < 0 ? -exponent : exponent;
+    if (absexp < 10) body[n++] = '0';
+    n += write_digits(&body[n],absexp);
+  }
+
+  return write_padded(str,sign,body,n,flags,width);
+}
@@ -40,6 +40,16 @@ class DumpCustom : public Dump {
 
   int *vtype;                // type of each vector (INT, DOUBLE)
   char **vformat;            // format string for each vector element
+  int *fconv;                // direct conversion of each format element
+  int *fflags;               // flags, width, precision of format element
+  int *fwidth;
+  int *fprec;
+  int maxline;               // max # of chars in one converted line
+
+  int nthreadbuf;            // # of per-thread conversion buffers
+  char **tbuf;               // converted chunk of lines for each thread
+  int *maxtbuf;              // size of each tbuf
+  int *ntbuf;                // # of chars in each tbuf
 
   char *columns;             // column labels
 
@@ -83,6 +93,8 @@ class DumpCustom : public Dump {
   int count();
   void pack(tagint *);
   virtual int convert_string(int, double *);
+  int convert_lines(int, double *, char *&, int &);
+  void setup_conversions();
   virtual void write_data(int, double *);
   bigint memory_usage();
 
@@ -0,0 +1,331 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#include "stdlib.h"
+#include "string.h"
+#include "dump_custom_columnar.h"
+#include "domain.h"
+#include "update.h"
+#include "memory.h"
+#include "error.h"
+
+#ifdef LAMMPS_ZLIB
+#include "zlib.h"
+#endif
+
+using namespace LAMMPS_NS;
+
+enum{INT,DOUBLE,STRING,BIGINT};            // same as in DumpCustom
+enum{INT32,INT64,FLOAT32,FLOAT64};         // also in reader_columnar.cpp
+
+#define ZLEVEL 6                 // same compression level as gzip pipe
+#define DELTA 16
+
+/* ---------------------------------------------------------------------- */
+
+DumpCustomColumnar::DumpCustomColumnar(LAMMPS *lmp, int narg, char **arg) :
+  DumpCustom(lmp, narg, arg)
+{
+  if (compressed)
+    error->all(FLERR,"Dump custom/columnar cannot write gzipped files");
+
+  // frames are assembled from unformatted doubles and written in binary
+
+  binary = 1;
+  buffer_allow = 0;
+  buffer_flag = 0;
+
+  singleflag = 0;
+  deflateflag = 0;
+
+  // one label per column, split from the column string of DumpCustom
+
+  coltype = new int[size_one];
+  collabel = new char*[size_one];
+  char *copy = new char[strlen(columns)+1];
+  strcpy(copy,columns);
+  char *ptr = strtok(copy," ");
+  for (int i = 0; i < size_one; i++) {
+    collabel[i] = new char[strlen(ptr)+1];
+    strcpy(collabel[i],ptr);
+    ptr = strtok(NULL," ");
+  }
+  delete [] copy;
+
+  nchunk = 0;
+  nframerows = maxframe = 0;
+  frame = NULL;
+  maxcolbuf = 0;
+  colbuf = NULL;
+
+  fileend = 0;
+  nframe = maxindex = 0;
+  indexstep = indexoffset = NULL;
+}
+
+/* ---------------------------------------------------------------------- */
+
+DumpCustomColumnar::~DumpCustomColumnar()
+{
+  delete [] coltype;
+  for (int i = 0; i < size_one; i++) delete [] collabel[i];
+  delete [] collabel;
+  memory->sfree(frame);
+  memory->sfree(colbuf);
+  memory->destroy(indexstep);
+  memory->destroy(indexoffset);
+}
+
+/* ---------------------------------------------------------------------- */
+
+void DumpCustomColumnar::init_style()
+{
+  // each file has one header and an index rewritten in place at its end
+
+  if (append_flag)
+    error->all(FLERR,"Dump custom/columnar cannot append to a file");
+
+  // binary type of each column, element names are stored as atom types
+
+  for (int i = 0; i < size_one; i++) {
+    if (vtype[i] == INT || vtype[i] == STRING) coltype[i] = INT32;
+    else if (vtype[i] == BIGINT) coltype[i] = INT64;
+    else if (singleflag) coltype[i] = FLOAT32;
+    else coltype[i] = FLOAT64;
+  }
+
+  DumpCustom::init_style();
+}
+
+/* ----------------------------------------------------------------------
+   open file and write file header if file is new
+   file header = magic string, endian and version flags,
+     # of columns, type and label of each column
+------------------------------------------------------------------------- */
+
+void DumpCustomColumnar::openfile()
+{
+  int opened = singlefile_opened;
+  DumpCustom::openfile();
+  if (opened || !filewriter) return;
+
+  int endian = 0x0001;
+  int version = 1;
+  fwrite("LMPCOLMN",sizeof(char),8,fp);
+  fwrite(&endian,sizeof(int),1,fp);
+  fwrite(&version,sizeof(int),1,fp);
+  fwrite(&size_one,sizeof(int),1,fp);
+  for (int i = 0; i < size_one; i++) {
+    int n = strlen(collabel[i]) + 1;
+    fwrite(&coltype[i],sizeof(int),1,fp);
+    fwrite(&n,sizeof(int),1,fp);
+    fwrite(collabel[i],sizeof(char),n,fp);
+  }
+
+  fileend = ftell(fp);
+  nframe = 0;
+}
+
+/* ----------------------------------------------------------------------
+   write frame header over index at end of file
+   frame header = FRME marker, timestep, # of rows,
+     triclinic flag, boundary string, box bounds as in text dump header
+   only called by filewriter procs
+------------------------------------------------------------------------- */
+
+void DumpCustomColumnar::write_header(bigint ndump)
+{
+  if (nframe == maxindex) {
+    maxindex += DELTA;
+    memory->grow(indexstep,maxindex,"dump:indexstep");
+    memory->grow(indexoffset,maxindex,"dump:indexoffset");
+  }
+  indexstep[nframe] = update->ntimestep;
+  indexoffset[nframe] = fileend;
+  nframe++;
+
+  fseek(fp,fileend,SEEK_SET);
+
+  int triclinic = domain->triclinic;
+  double box[9];
+  box[0] = boxxlo; box[1] = boxxhi; box[2] = 0.0;
+  box[3] = boxylo; box[4] = boxyhi; box[5] = 0.0;
+  box[6] = boxzlo; box[7] = boxzhi; box[8] = 0.0;
+  if (triclinic) {
+    box[2] = boxxy;
+    box[5] = boxxz;
+    box[8] = boxyz;
+  }
+
+  fwrite("FRME",sizeof(char),4,fp);
+  fwrite(&update->ntimestep,sizeof(bigint),1,fp);
+  fwrite(&ndump,sizeof(bigint),1,fp);
+  fwrite(&triclinic,sizeof(int),1,fp);
+  fwrite(boundstr,sizeof(char),8,fp);
+  fwrite(box,sizeof(double),9,fp);
+
+  // rows from each proc in cluster are collected until frame is complete
+
+  nchunk = 0;
+  nframerows = 0;
+  if (ndump > maxframe) {
+    maxframe = ndump;
+    memory->sfree(frame);
+    frame = (double *)
+      memory->smalloc(maxframe*size_one*sizeof(double),"dump:frame");
+    memory->sfree(colbuf);
+    maxcolbuf = maxframe*sizeof(double);
+    colbuf = (char *) memory->smalloc(maxcolbuf,"dump:colbuf");
+  }
+}
+
+/* ----------------------------------------------------------------------
+   append rows of one proc to frame
+   write frame once rows of all procs in cluster are received
+------------------------------------------------------------------------- */
+
+void DumpCustomColumnar::write_data(int n, double *mybuf)
+{
+  memcpy(&frame[nframerows*size_one],mybuf,n*size_one*sizeof(double));
+  nframerows += n;
+  if (++nchunk == nclusterprocs) write_frame();
+}
+
+/* ----------------------------------------------------------------------
+   write frame column by column
+   each column = compression flag, # of bytes, values in binary type
+   compressed column is kept only if smaller than raw column
+------------------------------------------------------------------------- */
+
+void DumpCustomColumnar::write_frame()
+{
+  bigint i,nbytes;
+  int flag;
+  char *data;
+
+  for (int j = 0; j < size_one; j++) {
+    double *col = &frame[j];
+
+    if (coltype[j] == INT32) {
+      int *values = (int *) colbuf;
+      for (i = 0; i < nframerows; i++)
+        values[i] = static_cast<int> (col[i*size_one]);
+      nbytes = nframerows*sizeof(int);
+    } else if (coltype[j] == INT64) {
+      bigint *values = (bigint *) colbuf;
+      for (i = 0; i < nframerows; i++)
+        values[i] = static_cast<bigint> (col[i*size_one]);
+      nbytes = nframerows*sizeof(bigint);
+    } else if (coltype[j] == FLOAT32) {
+      float *values = (float *) colbuf;
+      for (i = 0; i < nframerows; i++)
+        values[i] = static_cast<float> (col[i*size_one]);
+      nbytes = nframerows*sizeof(float);
+    } else {
+      double *values = (double *) colbuf;
+      for (i = 0; i < nframerows; i++) values[i] = col[i*size_one];
+      nbytes = nframerows*sizeof(double);
+    }
+
+    flag = 0;
+    data = colbuf;
+
+#ifdef LAMMPS_ZLIB
+    if (deflateflag && nbytes) {
+      uLong bound = compressBound(nbytes);
+      if (bound > MAXSMALLINT)
+        error->one(FLERR,"Dump custom/columnar frame is too large");
+      if (bound > maxzbuf) {
+        maxzbuf = bound;
+        memory->destroy(zbuf);
+        memory->create(zbuf,maxzbuf,"dump:zbuf");
+      }
+      uLongf nz = maxzbuf;
+      if (compress2((Bytef *) zbuf,&nz,(Bytef *) colbuf,nbytes,ZLEVEL) != Z_OK)
+        error->one(FLERR,"Cannot compress dump output");
+      if (nz < nbytes) {
+        flag = 1;
+        data = zbuf;
+        nbytes = nz;
+      }
+    }
+#endif
+
+    fwrite(&flag,sizeof(int),1,fp);
+    fwrite(&nbytes,sizeof(bigint),1,fp);
+    fwrite(data,sizeof(char),nbytes,fp);
+  }
+
+  fileend = ftell(fp);
+  write_index();
+}
+
+/* ----------------------------------------------------------------------
+   write index of all frames in file at end of file
+   index = INDX marker, # of frames, timestep and offset of each frame,
+     file offset of index, trailing magic string
+   overwritten by next frame, so file always ends with a complete index
+------------------------------------------------------------------------- */
+
+void DumpCustomColumnar::write_index()
+{
+  fwrite("INDX",sizeof(char),4,fp);
+  fwrite(&nframe,sizeof(int),1,fp);
+  fwrite(indexstep,sizeof(bigint),nframe,fp);
+  fwrite(indexoffset,sizeof(bigint),nframe,fp);
+  fwrite(&fileend,sizeof(bigint),1,fp);
+  fwrite("LMPCOLIX",sizeof(char),8,fp);
+}
+
+/* ---------------------------------------------------------------------- */
+
+int DumpCustomColumnar::modify_param(int narg, char **arg)
+{
+  if (strcmp(arg[0],"precision") == 0) {
+    if (narg < 2) error->all(FLERR,"Illegal dump_modify command");
+    int flag = 0;
+    if (strcmp(arg[1],"single") == 0) flag = 1;
+    else if (strcmp(arg[1],"double") != 0)
+      error->all(FLERR,"Illegal dump_modify command");
+    if (flag != singleflag && singlefile_opened)
+      error->all(FLERR,
+                 "Dump_modify precision cannot be changed after file is opened");
+    singleflag = flag;
+    return 2;
+  }
+
+  if (strcmp(arg[0],"compress") == 0) {
+    if (narg < 2) error->all(FLERR,"Illegal dump_modify command");
+    if (strcmp(arg[1],"yes") == 0) deflateflag = 1;
+    else if (strcmp(arg[1],"no") == 0) deflateflag = 0;
+    else error->all(FLERR,"Illegal dump_modify command");
+#ifndef LAMMPS_ZLIB
+    if (deflateflag)
+      error->all(FLERR,"Dump_modify compress requires LAMMPS_ZLIB");
+#endif
+    return 2;
+  }
+
+  return DumpCustom::modify_param(narg,arg);
+}
+
+/* ---------------------------------------------------------------------- */
+
+bigint DumpCustomColumnar::memory_usage()
+{
+  bigint bytes = DumpCustom::memory_usage();
+  bytes += maxframe*size_one * sizeof(double);
+  bytes += maxcolbuf;
+  bytes += 2*maxindex * sizeof(bigint);
+  return bytes;
+}
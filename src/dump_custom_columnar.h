@@ -0,0 +1,98 @@
+/* -*- c++ -*- ----------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#ifdef DUMP_CLASS
+
+DumpStyle(custom/columnar,DumpCustomColumnar)
+
+#else
+
+#ifndef LMP_DUMP_CUSTOM_COLUMNAR_H
+#define LMP_DUMP_CUSTOM_COLUMNAR_H
+
+#include "dump_custom.h"
+
+namespace LAMMPS_NS {
+
+class DumpCustomColumnar : public DumpCustom {
+ public:
+  DumpCustomColumnar(class LAMMPS *, int, char **);
+  virtual ~DumpCustomColumnar();
+
+ protected:
+  int singleflag;            // 1 if floating-point columns are float32
+  int deflateflag;           // 1 if columns are zlib compressed
+  int *coltype;              // binary type of each column (INT32, etc)
+  char **collabel;           // label of each column
+
+  int nchunk;                // # of procs whose rows are in frame so far
+  bigint nframerows;         // # of rows in frame so far
+  bigint maxframe;           // size of frame buffer in rows
+  double *frame;             // rows of frame as received, row-major
+  bigint maxcolbuf;          // size of colbuf in bytes
+  char *colbuf;              // one column of frame in its binary type
+
+  bigint fileend;            // file offset where next frame is written
+  int nframe;                // # of frames in current file
+  int maxindex;              // size of index arrays
+  bigint *indexstep;         // timestep of each frame in file
+  bigint *indexoffset;       // file offset of each frame in file
+
+  void init_style();
+  void openfile();
+  void write_header(bigint);
+  void write_data(int, double *);
+  int modify_param(int, char **);
+  bigint memory_usage();
+
+  void write_frame();
+  void write_index();
+};
+
+}
+
+#endif
+#endif
+
+/* ERROR/WARNING messages:
+
+E: Dump custom/columnar cannot write gzipped files
+
+Columns can instead be compressed individually with the dump_modify
+compress option.
+
+E: Dump custom/columnar cannot append to a file
+
+The file header and frame index are written for a new file, so the
+dump_modify append option cannot be used with this style.
+
+E: Dump custom/columnar frame is too large
+
+The bytes of a single column of a snapshot exceed the size that can be
+compressed in one call.
+
+E: Cannot compress dump output
+
+An error was returned by the zlib library while compressing a column.
+
+E: Dump_modify precision cannot be changed after file is opened
+
+All snapshots in a single columnar dump file must use the same column
+types, which are stored once at the start of the file.
+
+E: Dump_modify compress requires LAMMPS_ZLIB
+
+LAMMPS must be compiled with -DLAMMPS_ZLIB and linked with the zlib
+library to compress columns.
+
+*/
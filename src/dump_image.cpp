@@ -38,6 +38,7 @@ using namespace MathConst;
 enum{NUMERIC,ATOM,TYPE,ELEMENT,ATTRIBUTE};
 enum{STATIC,DYNAMIC};
 enum{NO,YES};
+enum{TREE,SWAP};                  // also in image.cpp
 
 /* ---------------------------------------------------------------------- */
 
@@ -317,6 +318,13 @@ DumpImage::DumpImage(LAMMPS *lmp, int narg, char **arg) :
       image->ssaoint = ssaoint;
       iarg += 4;
 
+    } else if (strcmp(arg[iarg],"composite") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal dump image command");
+      if (strcmp(arg[iarg+1],"tree") == 0) image->composite = TREE;
+      else if (strcmp(arg[iarg+1],"swap") == 0) image->composite = SWAP;
+      else error->all(FLERR,"Illegal dump image command");
+      iarg += 2;
+
     } else error->all(FLERR,"Illegal dump image command");
   }
 
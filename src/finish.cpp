@@ -32,6 +32,7 @@
 #include "neigh_request.h"
 #include "timer.h"
 #include "output.h"
+#include "dump.h"
 #include "memory.h"
 
 using namespace LAMMPS_NS;
@@ -54,6 +55,10 @@ void Finish::end(int flag)
   MPI_Comm_rank(world,&me);
   MPI_Comm_size(world,&nprocs);
 
+  // complete any dump snapshots still being written in the background
+
+  for (i = 0; i < output->ndump; i++) output->dump[i]->async_wait();
+
   // recompute natoms in case atoms have been lost
 
   bigint nblocal = atom->nlocal;
@@ -422,6 +427,10 @@ void Finish::end(int flag)
     }
   }
 
+  // per-proc imbalance, detailed timers, per-node breakdown
+
+  if (timeflag && timer->fullflag) timing_full(time_loop);
+
   // FFT timing statistics
   // time3d,time1d = total time during run for 3d and 1d FFTs
   // loop on timing() until nsample FFTs require at least 1.0 CPU sec
@@ -682,6 +691,117 @@ void Finish::end(int flag)
   }
 
   if (logfile) fflush(logfile);
+
+  // final timer output in JSON format
+
+  if (timer->jsonflag) timer->write_json(timer->array[TIME_LOOP]);
+}
+
+/* ----------------------------------------------------------------------
+   print min/ave/max over procs of each timer category and detailed timer
+   then print per-node averages to identify slow nodes
+   time_loop = loop time averaged over procs
+------------------------------------------------------------------------- */
+
+void Finish::timing_full(double time_loop)
+{
+  int i,j,depth;
+  char line[256];
+
+  int nprocs;
+  MPI_Comm_size(world,&nprocs);
+
+  static const char *names[TIME_N] =
+    {"Loop","Pair","Bond","Kspace","Neigh","Comm","Output"};
+
+  // values = per-proc time in each category, then each detailed timer
+  // categories do not include loop time itself
+
+  int nsub = timer->nsub;
+  int n = TIME_N + nsub;
+  double *values = new double[n];
+  double *vmin = new double[n];
+  double *vmax = new double[n];
+  double *vsum = new double[n];
+
+  for (i = 0; i < TIME_N; i++) values[i] = timer->array[i];
+  timer->sub_totals(&values[TIME_N]);
+
+  MPI_Allreduce(values,vmin,n,MPI_DOUBLE,MPI_MIN,world);
+  MPI_Allreduce(values,vmax,n,MPI_DOUBLE,MPI_MAX,world);
+  MPI_Allreduce(values,vsum,n,MPI_DOUBLE,MPI_SUM,world);
+
+  print("\nTiming breakdown over procs:\n");
+  print("Section                            min time   avg time   max time  "
+        "max/avg  %total\n");
+
+  for (i = 1; i < TIME_N; i++) {
+    if (vmax[i] == 0.0) continue;
+    double ave = vsum[i]/nprocs;
+    sprintf(line,"%-32s %10.4g %10.4g %10.4g %8.3g %7.2f\n",names[i],
+            vmin[i],ave,vmax[i],ave > 0.0 ? vmax[i]/ave : 1.0,
+            ave/time_loop*100.0);
+    print(line);
+  }
+
+  // detailed timers, indented by depth below their root
+
+  for (i = 0; i < nsub; i++) {
+    j = TIME_N + i;
+    if (vmax[j] == 0.0) continue;
+    depth = 0;
+    for (int k = timer->subparent[i]; k >= 0; k = timer->subparent[k])
+      depth++;
+    char name[64];
+    snprintf(name,64,"%*s%s",2*depth,"",timer->subname[i]);
+    double ave = vsum[j]/nprocs;
+    sprintf(line,"  %-30s %10.4g %10.4g %10.4g %8.3g %7.2f\n",name,
+            vmin[j],ave,vmax[j],ave > 0.0 ? vmax[j]/ave : 1.0,
+            ave/time_loop*100.0);
+    print(line);
+  }
+
+  // per-node averages, report fastest and slowest node for each category
+
+  timer->node_setup();
+  int nnodes = timer->nnodes;
+  double *nodeave = new double[nnodes*TIME_N];
+  timer->node_average(TIME_N,values,nodeave);
+
+  sprintf(line,"\nTiming breakdown over %d nodes:\n",nnodes);
+  print(line);
+  print("Section     min node avg   max node avg  slowest node\n");
+
+  for (i = 0; i < TIME_N; i++) {
+    if (vmax[i] == 0.0) continue;
+    int imin = 0;
+    int imax = 0;
+    for (j = 1; j < nnodes; j++) {
+      if (nodeave[j*TIME_N+i] < nodeave[imin*TIME_N+i]) imin = j;
+      if (nodeave[j*TIME_N+i] > nodeave[imax*TIME_N+i]) imax = j;
+    }
+    sprintf(line,"%-10s %13.4g  %13.4g  %s (%d procs)\n",names[i],
+            nodeave[imin*TIME_N+i],nodeave[imax*TIME_N+i],
+            timer->nodenames[imax],timer->nodeprocs[imax]);
+    print(line);
+  }
+
+  delete [] values;
+  delete [] vmin;
+  delete [] vmax;
+  delete [] vsum;
+  delete [] nodeave;
+}
+
+/* ----------------------------------------------------------------------
+   print a line to screen and logfile on proc 0
+------------------------------------------------------------------------- */
+
+void Finish::print(const char *str)
+{
+  if (comm->me) return;
+  if (screen) fputs(str,screen);
+  if (logfile) fputs(str,logfile);
 }
 
 /* ---------------------------------------------------------------------- */
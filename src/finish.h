@@ -25,6 +25,8 @@ class Finish : protected Pointers {
 
  private:
   void stats(int, double *, double *, double *, double *, int, int *);
+  void timing_full(double);
+  void print(const char *);
 };
 
 }
@@ -15,6 +15,7 @@
    Contributing author: Pieter in 't Veld (SNL)
 ------------------------------------------------------------------------- */
 
+#include "math.h"
 #include "stdlib.h"
 #include "string.h"
 #include "unistd.h"
@@ -29,6 +30,8 @@
 #include "compute.h"
 #include "input.h"
 #include "variable.h"
+#include "neighbor.h"
+#include "irregular.h"
 #include "memory.h"
 #include "error.h"
 
@@ -43,6 +46,7 @@ enum{ONE,RUNNING,WINDOW};
 enum{NODISCARD,MIXED,YESDISCARD};
 
 #define INVOKED_PERATOM 8
+#define DELTASLOT 1024
 
 /* ---------------------------------------------------------------------- */
 
@@ -52,6 +56,7 @@ FixAveSpatial::FixAveSpatial(LAMMPS *lmp, int narg, char **arg) :
   if (narg < 6) error->all(FLERR,"Illegal fix ave/spatial command");
 
   MPI_Comm_rank(world,&me);
+  MPI_Comm_size(world,&nprocs);
 
   nevery = force->inumeric(FLERR,arg[3]);
   nrepeat = force->inumeric(FLERR,arg[4]);
@@ -162,6 +167,7 @@ FixAveSpatial::FixAveSpatial(LAMMPS *lmp, int narg, char **arg) :
 
   regionflag = 0;
   idregion = NULL;
+  inregion = NULL;
   minflag[0] = LOWER;
   minflag[1] = LOWER;
   minflag[2] = LOWER;
@@ -173,8 +179,10 @@ FixAveSpatial::FixAveSpatial(LAMMPS *lmp, int narg, char **arg) :
   ave = ONE;
   scaleflag = LATTICE;
   fp = NULL;
+  fileflag = 0;
   nwindow = 0;
   overwrite = 0;
+  decompflag = 0;
   char *title1 = NULL;
   char *title2 = NULL;
   char *title3 = NULL;
@@ -242,6 +250,7 @@ FixAveSpatial::FixAveSpatial(LAMMPS *lmp, int narg, char **arg) :
       iarg += 2;
     } else if (strcmp(arg[iarg],"file") == 0) {
       if (iarg+2 > narg) error->all(FLERR,"Illegal fix ave/spatial command");
+      fileflag = 1;
       if (me == 0) {
         fp = fopen(arg[iarg+1],"w");
         if (fp == NULL) {
@@ -251,6 +260,12 @@ FixAveSpatial::FixAveSpatial(LAMMPS *lmp, int narg, char **arg) :
         }
       }
       iarg += 2;
+    } else if (strcmp(arg[iarg],"decomp") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal fix ave/spatial command");
+      if (strcmp(arg[iarg+1],"no") == 0) decompflag = 0;
+      else if (strcmp(arg[iarg+1],"yes") == 0) decompflag = 1;
+      else error->all(FLERR,"Illegal fix ave/spatial command");
+      iarg += 2;
     } else if (strcmp(arg[iarg],"overwrite") == 0) {
       overwrite = 1;
       iarg += 1;
@@ -361,8 +376,10 @@ FixAveSpatial::FixAveSpatial(LAMMPS *lmp, int narg, char **arg) :
 
   // this fix produces a global array
   // size_array_rows set by setup_bins()
+  // not if bins are decomposed, since no proc stores all of them
 
   array_flag = 1;
+  if (decompflag) array_flag = 0;
   size_array_cols = 1 + ndim + nvalues;
   extarray = 0;
 
@@ -414,6 +431,16 @@ FixAveSpatial::FixAveSpatial(LAMMPS *lmp, int narg, char **arg) :
   values_one = values_many = values_sum = values_total = NULL;
   values_list = NULL;
 
+  nown = nslot = maxslot = nbox = 0;
+  slotbin = NULL;
+  count_own = NULL;
+  values_own = NULL;
+  maxlist = maxsend = maxrecv = 0;
+  proclist = NULL;
+  sendbuf = recvbuf = NULL;
+  irregular = NULL;
+  if (decompflag) irregular = new Irregular(lmp);
+
   setup_bins();
 
   // nvalid = next step on which end_of_step does something
@@ -452,6 +479,14 @@ FixAveSpatial::~FixAveSpatial()
   memory->destroy(values_sum);
   memory->destroy(values_total);
   memory->destroy(values_list);
+
+  memory->destroy(slotbin);
+  memory->destroy(count_own);
+  memory->destroy(values_own);
+  memory->destroy(proclist);
+  memory->destroy(sendbuf);
+  memory->destroy(recvbuf);
+  delete irregular;
 }
 
 /* ---------------------------------------------------------------------- */
@@ -544,31 +579,45 @@ void FixAveSpatial::end_of_step()
   bigint ntimestep = update->ntimestep;
   if (ntimestep != nvalid) return;
 
-  // update region if necessary
+  // update region match of atoms if necessary
 
-  if (regionflag) region->prematch();
+  if (regionflag) inregion = region->match_atoms();
 
   // zero out arrays that accumulate over many samples
   // if box changes, first re-setup bins
 
+  // if decomp, also re-setup slots for bins near my sub-domain,
+  //   since it may have changed
+
   if (irepeat == 0) {
     if (domain->box_change) setup_bins();
-    for (m = 0; m < nbins; m++) {
-      count_many[m] = count_sum[m] = 0.0;
-      for (i = 0; i < nvalues; i++) values_many[m][i] = 0.0;
+    if (decompflag) {
+      setup_slots();
+      for (m = 0; m < nslot; m++) {
+        count_many[m] = 0.0;
+        for (i = 0; i < nvalues; i++) values_many[m][i] = 0.0;
+      }
+      for (m = 0; m < nown; m++) {
+        count_sum[m] = 0.0;
+        for (i = 0; i < nvalues; i++) values_sum[m][i] = 0.0;
+      }
+    } else {
+      for (m = 0; m < nbins; m++) {
+        count_many[m] = count_sum[m] = 0.0;
+        for (i = 0; i < nvalues; i++) values_many[m][i] = 0.0;
+      }
     }
   }
 
   // zero out arrays for one sample
 
-  for (m = 0; m < nbins; m++) {
+  for (m = 0; m < nslot; m++) {
     count_one[m] = 0.0;
     for (i = 0; i < nvalues; i++) values_one[m][i] = 0.0;
   }
 
   // assign each atom to a bin
 
-  double **x = atom->x;
   int *mask = atom->mask;
   int nlocal = atom->nlocal;
 
@@ -578,10 +627,21 @@ void FixAveSpatial::end_of_step()
     memory->create(bin,maxatom,"ave/spatial:bin");
   }
 
+  for (i = 0; i < nlocal; i++) bin[i] = -1;
+
   if (ndim == 1) atom2bin1d();
   else if (ndim == 2) atom2bin2d();
   else atom2bin3d();
 
+  // if decomp, convert global bin of each atom to its slot on this proc
+
+  if (decompflag)
+    for (i = 0; i < nlocal; i++)
+      if (bin[i] >= 0) bin[i] = bin2slot(bin[i]);
+
+  for (i = 0; i < nlocal; i++)
+    if (bin[i] >= 0) count_one[bin[i]] += 1.0;
+
   // perform the computation for one sample
   // accumulate results of attributes,computes,fixes,variables to local copy
   // sum within each bin, only include atoms in fix group
@@ -606,8 +666,7 @@ void FixAveSpatial::end_of_step()
             values_one[bin[i]][m] += attribute[i][j];
       } else {
         for (i = 0; i < nlocal; i++)
-          if (mask[i] & groupbit && region->match(x[i][0],x[i][1],x[i][2]) && 
-              bin[i] >= 0)
+          if (mask[i] & groupbit && inregion[i] && bin[i] >= 0)
             values_one[bin[i]][m] += attribute[i][j];
       }
 
@@ -621,8 +680,7 @@ void FixAveSpatial::end_of_step()
             values_one[bin[i]][m] += 1.0;
       } else {
         for (i = 0; i < nlocal; i++)
-          if (mask[i] & groupbit && region->match(x[i][0],x[i][1],x[i][2]) && 
-              bin[i] >= 0)
+          if (mask[i] & groupbit && inregion[i] && bin[i] >= 0)
             values_one[bin[i]][m] += 1.0;
       }
 
@@ -641,8 +699,7 @@ void FixAveSpatial::end_of_step()
           }
       } else {
         for (i = 0; i < nlocal; i++)
-          if (mask[i] & groupbit && region->match(x[i][0],x[i][1],x[i][2]) && 
-              bin[i] >= 0) {
+          if (mask[i] & groupbit && inregion[i] && bin[i] >= 0) {
             if (rmass) values_one[bin[i]][m] += rmass[i];
             else values_one[bin[i]][m] += mass[type[i]];
           }
@@ -669,8 +726,7 @@ void FixAveSpatial::end_of_step()
           }
       } else {
         for (i = 0; i < nlocal; i++)
-          if (mask[i] & groupbit && region->match(x[i][0],x[i][1],x[i][2]) && 
-              bin[i] >= 0) {
+          if (mask[i] & groupbit && inregion[i] && bin[i] >= 0) {
             if (j == 0) values_one[bin[i]][m] += vector[i];
             else values_one[bin[i]][m] += array[i][jm1];
           }
@@ -692,8 +748,7 @@ void FixAveSpatial::end_of_step()
           }
       } else {
         for (i = 0; i < nlocal; i++)
-          if (mask[i] & groupbit && region->match(x[i][0],x[i][1],x[i][2]) && 
-              bin[i] >= 0) {
+          if (mask[i] & groupbit && inregion[i] && bin[i] >= 0) {
             if (j == 0) values_one[bin[i]][m] += vector[i];
             else values_one[bin[i]][m] += array[i][jm1];
           }
@@ -717,8 +772,7 @@ void FixAveSpatial::end_of_step()
             values_one[bin[i]][m] += varatom[i];
       } else {
         for (i = 0; i < nlocal; i++)
-          if (mask[i] & groupbit && region->match(x[i][0],x[i][1],x[i][2]) && 
-              bin[i] >= 0)
+          if (mask[i] & groupbit && inregion[i] && bin[i] >= 0)
             values_one[bin[i]][m] += varatom[i];
       }
     }
@@ -728,8 +782,29 @@ void FixAveSpatial::end_of_step()
   // if normflag = ALL, accumulate values,count separately to many
   // if normflag = SAMPLE, one = value/count, accumulate one to many
   // exception is SAMPLE density: no normalization by atom count
-
-  if (normflag == ALL) {
+  // if decomp and normflag = SAMPLE, sum sample on bin owners,
+  //   owner normalizes it and accumulates directly to sum
+
+  if (decompflag) {
+    if (normflag == ALL) {
+      for (m = 0; m < nslot; m++) {
+        count_many[m] += count_one[m];
+        for (j = 0; j < nvalues; j++)
+          values_many[m][j] += values_one[m][j];
+      }
+    } else {
+      reduce_bins(count_one,values_one,count_own,values_own);
+      for (m = 0; m < nown; m++) {
+        if (count_own[m] > 0.0)
+          for (j = 0; j < nvalues; j++) {
+            if (which[j] == DENSITY_NUMBER || which[j] == DENSITY_MASS)
+              values_sum[m][j] += values_own[m][j];
+            else values_sum[m][j] += values_own[m][j]/count_own[m];
+          }
+        count_sum[m] += count_own[m];
+      }
+    }
+  } else if (normflag == ALL) {
     for (m = 0; m < nbins; m++) {
       count_many[m] += count_one[m];
       for (j = 0; j < nvalues; j++)
@@ -767,14 +842,19 @@ void FixAveSpatial::end_of_step()
   // if normflag = SAMPLE, final is sum of ave / repeat
   // exception is densities: normalized by repeat, not total count
 
+  // if decomp, sum of samples is only stored by bin owners
+
   double repeat = nrepeat;
   double mv2d = force->mv2d;
 
   if (normflag == ALL) {
-    MPI_Allreduce(count_many,count_sum,nbins,MPI_DOUBLE,MPI_SUM,world);
-    MPI_Allreduce(&values_many[0][0],&values_sum[0][0],nbins*nvalues,
-                  MPI_DOUBLE,MPI_SUM,world);
-    for (m = 0; m < nbins; m++) {
+    if (decompflag) reduce_bins(count_many,values_many,count_sum,values_sum);
+    else {
+      MPI_Allreduce(count_many,count_sum,nbins,MPI_DOUBLE,MPI_SUM,world);
+      MPI_Allreduce(&values_many[0][0],&values_sum[0][0],nbins*nvalues,
+                    MPI_DOUBLE,MPI_SUM,world);
+    }
+    for (m = 0; m < nown; m++) {
       if (count_sum[m] > 0.0)
         for (j = 0; j < nvalues; j++) {
           if (which[j] == DENSITY_NUMBER) values_sum[m][j] /= repeat;
@@ -785,9 +865,10 @@ void FixAveSpatial::end_of_step()
       count_sum[m] /= repeat;
     }
   } else {
-    MPI_Allreduce(&values_many[0][0],&values_sum[0][0],nbins*nvalues,
-                  MPI_DOUBLE,MPI_SUM,world);
-    for (m = 0; m < nbins; m++) {
+    if (!decompflag)
+      MPI_Allreduce(&values_many[0][0],&values_sum[0][0],nbins*nvalues,
+                    MPI_DOUBLE,MPI_SUM,world);
+    for (m = 0; m < nown; m++) {
       for (j = 0; j < nvalues; j++)
         values_sum[m][j] /= repeat;
       count_sum[m] /= repeat;
@@ -798,7 +879,7 @@ void FixAveSpatial::end_of_step()
 
   for (j = 0; j < nvalues; j++)
     if (which[j] == DENSITY_NUMBER || which[j] == DENSITY_MASS)
-      for (m = 0; m < nbins; m++)
+      for (m = 0; m < nown; m++)
         values_sum[m][j] /= bin_volume;
 
   // if ave = ONE, only single Nfreq timestep value is needed
@@ -806,7 +887,7 @@ void FixAveSpatial::end_of_step()
   // if ave = WINDOW, comine with nwindow most recent Nfreq timestep values
 
   if (ave == ONE) {
-    for (m = 0; m < nbins; m++) {
+    for (m = 0; m < nown; m++) {
       for (i = 0; i < nvalues; i++)
         values_total[m][i] = values_sum[m][i];
       count_total[m] = count_sum[m];
@@ -814,7 +895,7 @@ void FixAveSpatial::end_of_step()
     norm = 1;
 
   } else if (ave == RUNNING) {
-    for (m = 0; m < nbins; m++) {
+    for (m = 0; m < nown; m++) {
       for (i = 0; i < nvalues; i++)
         values_total[m][i] += values_sum[m][i];
       count_total[m] += count_sum[m];
@@ -822,7 +903,7 @@ void FixAveSpatial::end_of_step()
     norm++;
 
   } else if (ave == WINDOW) {
-    for (m = 0; m < nbins; m++) {
+    for (m = 0; m < nown; m++) {
       for (i = 0; i < nvalues; i++) {
         values_total[m][i] += values_sum[m][i];
         if (window_limit) values_total[m][i] -= values_list[iwindow][m][i];
@@ -843,8 +924,11 @@ void FixAveSpatial::end_of_step()
   }
 
   // output result to file
+  // if decomp, bin owners send their results to proc 0
 
-  if (fp && me == 0) {
+  if (decompflag) {
+    if (fileflag) write_decomp(ntimestep);
+  } else if (fp && me == 0) {
     if (overwrite) fseek(fp,filepos,SEEK_SET);
     fprintf(fp,BIGINT_FORMAT " %d\n",ntimestep,nbins);
     if (ndim == 1) {
@@ -960,40 +1044,65 @@ void FixAveSpatial::setup_bins()
 
   size_array_rows = nbins;
 
+  // nown = # of bins whose results I store, all of them unless decomp
+  // if decomp, each proc owns a contiguous block of bins
+  //   and samples into slots setup by setup_slots()
+  // else nslot = nbins, since I sample into all bins
+
+  if (decompflag) {
+    binlo_me = firstbin(me);
+    nown = firstbin(me+1) - binlo_me;
+  } else {
+    binlo_me = 0;
+    nown = nslot = nbins;
+  }
+
   // reallocate bin arrays if needed
 
-  if (nbins > maxbin) {
-    maxbin = nbins;
-    memory->grow(count_one,nbins,"ave/spatial:count_one");
-    memory->grow(count_many,nbins,"ave/spatial:count_many");
-    memory->grow(count_sum,nbins,"ave/spatial:count_sum");
-    memory->grow(count_total,nbins,"ave/spatial:count_total");
+  if (nown > maxbin) {
+    maxbin = nown;
+    if (decompflag) {
+      memory->grow(count_own,nown,"ave/spatial:count_own");
+      memory->grow(values_own,nown,nvalues,"ave/spatial:values_own");
+    } else {
+      memory->grow(count_one,nbins,"ave/spatial:count_one");
+      memory->grow(count_many,nbins,"ave/spatial:count_many");
+      memory->grow(values_one,nbins,nvalues,"ave/spatial:values_one");
+      memory->grow(values_many,nbins,nvalues,"ave/spatial:values_many");
+    }
+    memory->grow(count_sum,nown,"ave/spatial:count_sum");
+    memory->grow(count_total,nown,"ave/spatial:count_total");
 
-    memory->grow(coord,nbins,ndim,"ave/spatial:coord");
-    memory->grow(values_one,nbins,nvalues,"ave/spatial:values_one");
-    memory->grow(values_many,nbins,nvalues,"ave/spatial:values_many");
-    memory->grow(values_sum,nbins,nvalues,"ave/spatial:values_sum");
-    memory->grow(values_total,nbins,nvalues,"ave/spatial:values_total");
+    memory->grow(coord,nown,ndim,"ave/spatial:coord");
+    memory->grow(values_sum,nown,nvalues,"ave/spatial:values_sum");
+    memory->grow(values_total,nown,nvalues,"ave/spatial:values_total");
 
     // only allocate count and values list for ave = WINDOW
 
     if (ave == WINDOW) {
-      memory->create(count_list,nwindow,nbins,"ave/spatial:count_list");
-      memory->create(values_list,nwindow,nbins,nvalues,
+      memory->create(count_list,nwindow,nown,"ave/spatial:count_list");
+      memory->create(values_list,nwindow,nown,nvalues,
                      "ave/spatial:values_list");
     }
 
     // reinitialize regrown count/values total since they accumulate
 
-    for (m = 0; m < nbins; m++) {
+    for (m = 0; m < nown; m++) {
       for (i = 0; i < nvalues; i++) values_total[m][i] = 0.0;
       count_total[m] = 0.0;
     }
   }
 
-  // set bin coordinates
+  // set coordinates of bins I own
 
-  if (ndim == 1) {
+  if (decompflag) {
+    int index[3];
+    for (m = 0; m < nown; m++) {
+      bin2index(binlo_me+m,index);
+      for (i = 0; i < ndim; i++)
+        coord[m][i] = offset[i] + (index[i]+0.5)*delta[i];
+    }
+  } else if (ndim == 1) {
     for (i = 0; i < nlayers[0]; i++)
       coord[i][0] = offset[0] + (i+0.5)*delta[0];
   } else if (ndim == 2) {
@@ -1023,6 +1132,271 @@ void FixAveSpatial::setup_bins()
   }
 }
 
+/* ----------------------------------------------------------------------
+   setup slots for decomposed bins
+   slots are a brick of bins overlapping my sub-domain, extended by
+     the neighbor skin since atoms move that far before they migrate
+   more slots are added by bin2slot() as needed for atoms in other bins,
+     e.g. those outside the box that are remapped via PBC
+   called when averaging over Nrepeat samples begins
+------------------------------------------------------------------------- */
+
+void FixAveSpatial::setup_slots()
+{
+  int m,idim,ilo,ihi;
+  double lo,hi,halo;
+
+  nbox = 1;
+  for (m = 0; m < ndim; m++) {
+    idim = dim[m];
+    if (scaleflag == REDUCED) {
+      lo = domain->sublo_lamda[idim];
+      hi = domain->subhi_lamda[idim];
+      halo = neighbor->skin / domain->prd[idim];
+    } else {
+      lo = domain->sublo[idim];
+      hi = domain->subhi[idim];
+      halo = neighbor->skin;
+    }
+    ilo = static_cast<int> (floor((lo - halo - offset[m]) * invdelta[m]));
+    ihi = static_cast<int> (floor((hi + halo - offset[m]) * invdelta[m]));
+    ilo = MAX(ilo,0);
+    ihi = MIN(ihi,nlayers[m]-1);
+    boxlo[m] = ilo;
+    boxn[m] = MAX(ihi-ilo+1,0);
+    nbox *= boxn[m];
+  }
+
+  if (nbox > maxslot) grow_slots(nbox);
+  nslot = nbox;
+
+  // slotbin = global bin of each slot in brick, ordered like global bins
+
+  int i1,i2,i3;
+  int n = 0;
+  if (ndim == 1) {
+    for (i1 = 0; i1 < boxn[0]; i1++)
+      slotbin[n++] = boxlo[0]+i1;
+  } else if (ndim == 2) {
+    for (i1 = 0; i1 < boxn[0]; i1++)
+      for (i2 = 0; i2 < boxn[1]; i2++)
+        slotbin[n++] = (boxlo[0]+i1)*nlayers[1] + boxlo[1]+i2;
+  } else {
+    for (i1 = 0; i1 < boxn[0]; i1++)
+      for (i2 = 0; i2 < boxn[1]; i2++)
+        for (i3 = 0; i3 < boxn[2]; i3++)
+          slotbin[n++] = (boxlo[0]+i1)*nlayers[1]*nlayers[2] +
+            (boxlo[1]+i2)*nlayers[2] + boxlo[2]+i3;
+  }
+}
+
+/* ----------------------------------------------------------------------
+   reallocate slot arrays to hold at least N slots, preserving contents
+------------------------------------------------------------------------- */
+
+void FixAveSpatial::grow_slots(int n)
+{
+  maxslot = n;
+  memory->grow(slotbin,maxslot,"ave/spatial:slotbin");
+  memory->grow(count_one,maxslot,"ave/spatial:count_one");
+  memory->grow(count_many,maxslot,"ave/spatial:count_many");
+  memory->grow(values_one,maxslot,nvalues,"ave/spatial:values_one");
+  memory->grow(values_many,maxslot,nvalues,"ave/spatial:values_many");
+}
+
+/* ----------------------------------------------------------------------
+   return slot for global bin Ibin
+   if Ibin is outside my brick of bins, find or add its extra slot
+------------------------------------------------------------------------- */
+
+int FixAveSpatial::bin2slot(int ibin)
+{
+  int m,j;
+  int index[3];
+
+  bin2index(ibin,index);
+
+  int islot = 0;
+  for (m = 0; m < ndim; m++) {
+    j = index[m] - boxlo[m];
+    if (j < 0 || j >= boxn[m]) break;
+    islot = islot*boxn[m] + j;
+  }
+  if (m == ndim) return islot;
+
+  for (islot = nbox; islot < nslot; islot++)
+    if (slotbin[islot] == ibin) return islot;
+
+  if (nslot == maxslot) grow_slots(maxslot+DELTASLOT);
+  slotbin[nslot] = ibin;
+  count_one[nslot] = count_many[nslot] = 0.0;
+  for (j = 0; j < nvalues; j++)
+    values_one[nslot][j] = values_many[nslot][j] = 0.0;
+  return nslot++;
+}
+
+/* ----------------------------------------------------------------------
+   convert global bin Ibin to its bin index in each of ndim dimensions
+------------------------------------------------------------------------- */
+
+void FixAveSpatial::bin2index(int ibin, int *index)
+{
+  if (ndim == 1) index[0] = ibin;
+  else if (ndim == 2) {
+    index[0] = ibin / nlayers[1];
+    index[1] = ibin % nlayers[1];
+  } else {
+    index[0] = ibin / (nlayers[1]*nlayers[2]);
+    index[1] = (ibin / nlayers[2]) % nlayers[1];
+    index[2] = ibin % nlayers[2];
+  }
+}
+
+/* ----------------------------------------------------------------------
+   return 1st bin owned by proc Iproc, or nbins if Iproc = nprocs
+   bin M is owned by proc M*nprocs/nbins
+------------------------------------------------------------------------- */
+
+int FixAveSpatial::firstbin(int iproc)
+{
+  return static_cast<int> (((bigint) iproc*nbins + nprocs-1) / nprocs);
+}
+
+/* ----------------------------------------------------------------------
+   sum per-slot counts and values of all procs on owners of bins
+   only slots with a non-zero count are sent, since values of a slot
+     are only accumulated for atoms also counted in it
+   received in order of sending proc ID, so sums are reproducible
+   countown,valuesown = summed values of bins I own
+------------------------------------------------------------------------- */
+
+void FixAveSpatial::reduce_bins(double *count, double **values,
+                                double *countown, double **valuesown)
+{
+  int i,j,m,n;
+
+  int nper = 2 + nvalues;
+
+  n = 0;
+  for (m = 0; m < nslot; m++)
+    if (count[m] > 0.0) n++;
+
+  if (n > maxlist) {
+    maxlist = n;
+    memory->destroy(proclist);
+    memory->create(proclist,maxlist,"ave/spatial:proclist");
+  }
+  if (n*nper > maxsend) {
+    maxsend = n*nper;
+    memory->destroy(sendbuf);
+    memory->create(sendbuf,maxsend,"ave/spatial:sendbuf");
+  }
+
+  n = 0;
+  for (m = 0; m < nslot; m++) {
+    if (count[m] == 0.0) continue;
+    proclist[n] = static_cast<int> ((bigint) slotbin[m]*nprocs / nbins);
+    double *buf = &sendbuf[n*nper];
+    buf[0] = slotbin[m];
+    buf[1] = count[m];
+    for (j = 0; j < nvalues; j++) buf[2+j] = values[m][j];
+    n++;
+  }
+
+  int nrecv = irregular->create_data(n,proclist,1);
+
+  if (nrecv*nper > maxrecv) {
+    maxrecv = nrecv*nper;
+    memory->destroy(recvbuf);
+    memory->create(recvbuf,maxrecv,"ave/spatial:recvbuf");
+  }
+
+  irregular->exchange_data((char *) sendbuf,nper*sizeof(double),
+                           (char *) recvbuf);
+  irregular->destroy_data();
+
+  for (m = 0; m < nown; m++) {
+    countown[m] = 0.0;
+    for (j = 0; j < nvalues; j++) valuesown[m][j] = 0.0;
+  }
+
+  for (i = 0; i < nrecv; i++) {
+    double *buf = &recvbuf[i*nper];
+    m = static_cast<int> (buf[0]) - binlo_me;
+    countown[m] += buf[1];
+    for (j = 0; j < nvalues; j++) valuesown[m][j] += buf[2+j];
+  }
+}
+
+/* ----------------------------------------------------------------------
+   write decomposed bins to file
+   proc 0 pings each proc in turn, receives its block of bins,
+     and writes it, so only one block at a time is stored on proc 0
+------------------------------------------------------------------------- */
+
+void FixAveSpatial::write_decomp(bigint ntimestep)
+{
+  int i,m,n,tmp,ibin;
+  double *buf;
+  MPI_Request request;
+
+  // pack my bins: coords, count, values
+
+  int nper = ndim + 1 + nvalues;
+  int nmax = firstbin(1) - firstbin(0);
+
+  if (nown*nper > maxsend) {
+    maxsend = nown*nper;
+    memory->destroy(sendbuf);
+    memory->create(sendbuf,maxsend,"ave/spatial:sendbuf");
+  }
+  if (me == 0 && nmax*nper > maxrecv) {
+    maxrecv = nmax*nper;
+    memory->destroy(recvbuf);
+    memory->create(recvbuf,maxrecv,"ave/spatial:recvbuf");
+  }
+
+  for (m = 0; m < nown; m++) {
+    buf = &sendbuf[m*nper];
+    for (i = 0; i < ndim; i++) buf[i] = coord[m][i];
+    buf[ndim] = count_total[m]/norm;
+    for (i = 0; i < nvalues; i++) buf[ndim+1+i] = values_total[m][i]/norm;
+  }
+
+  if (me == 0) {
+    if (overwrite) fseek(fp,filepos,SEEK_SET);
+    fprintf(fp,BIGINT_FORMAT " %d\n",ntimestep,nbins);
+
+    for (int iproc = 0; iproc < nprocs; iproc++) {
+      ibin = firstbin(iproc);
+      n = firstbin(iproc+1) - ibin;
+      if (n == 0) continue;
+      if (iproc) {
+        MPI_Irecv(recvbuf,n*nper,MPI_DOUBLE,iproc,0,world,&request);
+        MPI_Send(&tmp,0,MPI_INT,iproc,0,world);
+        MPI_Wait(&request,MPI_STATUS_IGNORE);
+        buf = recvbuf;
+      } else buf = sendbuf;
+
+      for (m = 0; m < n; m++) {
+        fprintf(fp,"  %d",ibin+m+1);
+        for (i = 0; i < nper; i++) fprintf(fp," %g",buf[m*nper+i]);
+        fprintf(fp,"\n");
+      }
+    }
+
+    fflush(fp);
+    if (overwrite) {
+      long fileend = ftell(fp);
+      ftruncate(fileno(fp),fileend);
+    }
+
+  } else if (nown) {
+    MPI_Recv(&tmp,0,MPI_INT,0,0,world,MPI_STATUS_IGNORE);
+    MPI_Rsend(sendbuf,nown*nper,MPI_DOUBLE,0,0,world);
+  }
+}
+
 /* ----------------------------------------------------------------------
    assign each atom to a 1d bin
 ------------------------------------------------------------------------- */
@@ -1086,13 +1460,12 @@ void FixAveSpatial::atom2bin1d()
         }
 
         bin[i] = ibin;
-        count_one[ibin] += 1.0;
       }
     if (scaleflag == REDUCED) domain->lamda2x(nlocal);
 
   } else {
     for (i = 0; i < nlocal; i++)
-      if (mask[i] & groupbit && region->match(x[i][0],x[i][1],x[i][2])) {
+      if (mask[i] & groupbit && inregion[i]) {
         bin[i] = -1;
 
         if (scaleflag == REDUCED) {
@@ -1120,7 +1493,6 @@ void FixAveSpatial::atom2bin1d()
         }
 
         bin[i] = ibin;
-        count_one[ibin] += 1.0;
       }
   }
 }
@@ -1212,13 +1584,12 @@ void FixAveSpatial::atom2bin2d()
 
         ibin = i1bin*nlayers[1] + i2bin;
         bin[i] = ibin;
-        count_one[ibin] += 1.0;
       }
     if (scaleflag == REDUCED) domain->lamda2x(nlocal);
 
   } else {
     for (i = 0; i < nlocal; i++)
-      if (mask[i] & groupbit && region->match(x[i][0],x[i][1],x[i][2])) {
+      if (mask[i] & groupbit && inregion[i]) {
         bin[i] = -1;
 
         if (scaleflag == REDUCED) {
@@ -1272,7 +1643,6 @@ void FixAveSpatial::atom2bin2d()
 
         ibin = i1bin*nlayers[1] + i2bin;
         bin[i] = ibin;
-        count_one[ibin] += 1.0;
       }
   }
 }
@@ -1387,13 +1757,12 @@ void FixAveSpatial::atom2bin3d()
 
         ibin = i1bin*nlayers[1]*nlayers[2] + i2bin*nlayers[2] + i3bin;
         bin[i] = ibin;
-        count_one[ibin] += 1.0;
       }
     if (scaleflag == REDUCED) domain->lamda2x(nlocal);
 
   } else {
     for (i = 0; i < nlocal; i++)
-      if (mask[i] & groupbit && region->match(x[i][0],x[i][1],x[i][2])) {
+      if (mask[i] & groupbit && inregion[i]) {
         bin[i] = -1;
 
         if (scaleflag == REDUCED) {
@@ -1469,7 +1838,6 @@ void FixAveSpatial::atom2bin3d()
 
         ibin = i1bin*nlayers[1]*nlayers[2] + i2bin*nlayers[2] + i3bin;
         bin[i] = ibin;
-        count_one[ibin] += 1.0;
       }
   }
 }
@@ -1482,7 +1850,7 @@ void FixAveSpatial::atom2bin3d()
 
 double FixAveSpatial::compute_array(int i, int j)
 {
-  if (values_total == NULL) return 0.0;
+  if (values_total == NULL || decompflag) return 0.0;
   if (i >= nbins) return 0.0;
   if (j < ndim) return coord[i][j];
   j -= ndim+1;
@@ -1516,11 +1884,21 @@ double FixAveSpatial::memory_usage()
 {
   double bytes = maxvar * sizeof(double);         // varatom
   bytes += maxatom * sizeof(int);                 // bin
-  bytes += 4*nbins * sizeof(double);              // count one,many,sum,total
-  bytes += ndim*nbins * sizeof(double);           // coord
-  bytes += nvalues*nbins * sizeof(double);        // values one,many,sum,total
-  bytes += nwindow*nbins * sizeof(double);          // count_list
-  bytes += nwindow*nbins*nvalues * sizeof(double);  // values_list
+  if (decompflag) {
+    bytes += maxslot * sizeof(int);                 // slotbin
+    bytes += 2*maxslot * sizeof(double);            // count one,many
+    bytes += 2*maxslot*nvalues * sizeof(double);    // values one,many
+    bytes += 3*nown * sizeof(double);               // count own,sum,total
+    bytes += 3*nown*nvalues * sizeof(double);       // values own,sum,total
+    bytes += maxlist * sizeof(int);                 // proclist
+    bytes += (maxsend+maxrecv) * sizeof(double);    // sendbuf,recvbuf
+  } else {
+    bytes += 4*nbins * sizeof(double);              // count one,many,sum,total
+    bytes += nvalues*nbins * sizeof(double);        // values one,many,sum,total
+  }
+  bytes += ndim*nown * sizeof(double);            // coord
+  bytes += nwindow*nown * sizeof(double);           // count_list
+  bytes += nwindow*nown*nvalues * sizeof(double);   // values_list
   return bytes;
 }
 
@@ -38,15 +38,16 @@ class FixAveSpatial : public Fix {
   void reset_timestep(bigint);
 
  private:
-  int me,nvalues;
+  int me,nprocs,nvalues;
   int nrepeat,nfreq,irepeat;
   bigint nvalid;
-  int ndim,normflag,regionflag,overwrite,discard;
+  int ndim,normflag,regionflag,overwrite,discard,fileflag;
   char *tstring,*sstring,*idregion;
   int *which,*argindex,*value2index;
   char **ids;
   FILE *fp;
   class Region *region;
+  int *inregion;             // region match of each owned atom
 
   int ave,nwindow,scaleflag;
   int norm,iwindow,window_limit;
@@ -74,7 +75,29 @@ class FixAveSpatial : public Fix {
   int minflag[3],maxflag[3];
   double minvalue[3],maxvalue[3];
 
+  // decomposed bins: each proc samples into the slots of bins near its
+  // sub-domain, and stores the final results only for the bins it owns
+
+  int decompflag;
+  class Irregular *irregular;
+  int nown,binlo_me;            // # of bins I own, 1st bin I own
+  int nslot,maxslot;            // # of slots I sample into
+  int nbox;                     // # of slots in my brick of bins
+  int boxlo[3],boxn[3];         // 1st bin and # of bins in my brick
+  int *slotbin;                 // global bin of each slot
+  double *count_own,**values_own;
+  int maxlist,maxsend,maxrecv;
+  int *proclist;
+  double *sendbuf,*recvbuf;
+
   void setup_bins();
+  void setup_slots();
+  void grow_slots(int);
+  int bin2slot(int);
+  void bin2index(int, int *);
+  int firstbin(int);
+  void reduce_bins(double *, double **, double *, double **);
+  void write_decomp(bigint);
   void atom2bin1d();
   void atom2bin2d();
   void atom2bin3d();
@@ -72,6 +72,11 @@ FixBalance::FixBalance(LAMMPS *lmp, int narg, char **arg) :
     iarg++;
   }
 
+  // create instance of Balance class
+  // optional weight args are stored in it
+
+  balance = new Balance(lmp);
+
   // optional args
 
   outflag = 0;
@@ -84,6 +89,8 @@ FixBalance::FixBalance(LAMMPS *lmp, int narg, char **arg) :
       outflag = 1;
       outarg = iarg+1;
       iarg += 2;
+    } else if (strcmp(arg[iarg],"weight") == 0) {
+      iarg += balance->weight_options(narg-iarg,&arg[iarg]);
     } else error->all(FLERR,"Illegal fix balance command");
   }
 
@@ -105,10 +112,8 @@ FixBalance::FixBalance(LAMMPS *lmp, int narg, char **arg) :
   if (lbstyle == BISECTION && comm->style == 0) 
     error->all(FLERR,"Fix balance rcb cannot be used with comm_style brick");
 
-  // create instance of Balance class
-  // if SHIFT, initialize it with params
+  // if SHIFT, initialize Balance with params
 
-  balance = new Balance(lmp);
   if (lbstyle == SHIFT) balance->shift_setup(bstr,nitermax,thresh);
 
   // create instance of Irregular class
@@ -127,12 +132,25 @@ FixBalance::FixBalance(LAMMPS *lmp, int narg, char **arg) :
   if (nevery) force_reneighbor = 1;
 
   // compute initial outputs
+  // per-atom weights do not yet exist, so based on nlocal
 
-  imbfinal = imbprev = balance->imbalance_nlocal(maxperproc);
+  int maxnlocal;
+  imbfinal = imbprev = balance->imbalance_nlocal(maxnlocal);
+  maxperproc = maxnlocal;
   itercount = 0;
   pending = 0;
 }
 
+/* ----------------------------------------------------------------------
+   create fix STORE for per-atom weights, if weighting was requested
+   cannot be done in constructor, b/c this fix is not yet in Modify list
+------------------------------------------------------------------------- */
+
+void FixBalance::post_constructor()
+{
+  if (balance->wtflag) balance->weight_storage(id);
+}
+
 /* ---------------------------------------------------------------------- */
 
 FixBalance::~FixBalance()
@@ -158,6 +176,8 @@ void FixBalance::init()
 {
   if (force->kspace) kspace_flag = 1;
   else kspace_flag = 0;
+
+  balance->init_imbalance();
 }
 
 /* ---------------------------------------------------------------------- */
@@ -187,7 +207,8 @@ void FixBalance::setup_pre_exchange()
 
   // perform a rebalance if threshhold exceeded
 
-  imbnow = balance->imbalance_nlocal(maxperproc);
+  balance->set_weights();
+  imbnow = balance->imbalance_factor(maxperproc);
   if (imbnow > thresh) rebalance();
 
   // next_reneighbor = next time to force reneighboring
@@ -215,7 +236,8 @@ void FixBalance::pre_exchange()
 
   // return if imbalance < threshhold
 
-  imbnow = balance->imbalance_nlocal(maxperproc);
+  balance->set_weights();
+  imbnow = balance->imbalance_factor(maxperproc);
   if (imbnow <= thresh) {
     if (nevery) next_reneighbor = (update->ntimestep/nevery)*nevery + nevery;
     return;
@@ -236,7 +258,7 @@ void FixBalance::pre_exchange()
 void FixBalance::pre_neighbor()
 {
   if (!pending) return;
-  imbfinal = balance->imbalance_nlocal(maxperproc);
+  imbfinal = balance->imbalance_factor(maxperproc);
   pending = 0;
 }
 
@@ -305,7 +327,7 @@ double FixBalance::compute_scalar()
 
 double FixBalance::compute_vector(int i)
 {
-  if (i == 0) return (double) maxperproc;
+  if (i == 0) return maxperproc;
   if (i == 1) return (double) itercount;
   return imbprev;
 }
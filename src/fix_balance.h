@@ -29,6 +29,7 @@ class FixBalance : public Fix {
  public:
   FixBalance(class LAMMPS *, int, char **);
   ~FixBalance();
+  void post_constructor();
   int setmask();
   void init();
   void setup(int);
@@ -48,7 +49,7 @@ class FixBalance : public Fix {
   double imbnow;                // current imbalance factor
   double imbprev;               // imbalance factor before last rebalancing
   double imbfinal;              // imbalance factor after last rebalancing
-  int maxperproc;               // max atoms on any processor
+  double maxperproc;            // max atoms (or weight) on any processor
   int itercount;                // iteration count of last call to Balance
   int kspace_flag;              // 1 if KSpace solver defined
   int pending;
@@ -185,19 +185,23 @@ void FixGroup::set_group()
     modify->addstep_compute(update->ntimestep + nevery);
   }
   
+  // region match of each atom, only re-evaluated for atoms that moved
+
+  int *inregion = NULL;
+  if (regionflag) inregion = region->match_atoms();
+
   // set mask for each atom
   // only in group if in parent group, in region, variable is non-zero
   // if compute, fix, etc needs updated masks of ghost atoms,
   // it must do forward_comm() to update them
 
-  double **x = atom->x;
   int *mask = atom->mask;
   int inflag;
 
   for (int i = 0; i < nlocal; i++) {
     if (mask[i] & groupbit) {
       inflag = 1;
-      if (regionflag && !region->match(x[i][0],x[i][1],x[i][2])) inflag = 0;
+      if (regionflag && !inregion[i]) inflag = 0;
       if (varflag && var[i] == 0.0) inflag = 0;
     } else inflag = 0;
 
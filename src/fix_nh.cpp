@@ -722,12 +722,11 @@ void FixNH::setup(int vflag)
 
   if (pstat_flag) compute_press_target();
 
-  t_current = temperature->compute_scalar();
+  compute_temp_press(0);
+  t_current = temperature->scalar;
   tdof = temperature->dof;
 
   if (pstat_flag) {
-    if (pstyle == ISO) pressure->compute_scalar();
-    else pressure->compute_vector();
     couple();
     pressure->addstep(update->ntimestep+1);
   }
@@ -796,13 +795,8 @@ void FixNH::initial_integrate(int vflag)
   // compute appropriately coupled elements of mvv_current
 
   if (pstat_flag) {
-    if (pstyle == ISO) {
-      temperature->compute_scalar();
-      pressure->compute_scalar();
-    } else {
-      temperature->compute_vector();
-      pressure->compute_vector();
-    }
+    if (pstyle == ISO) compute_temp_press(0);
+    else compute_temp_press(1);
     couple();
     pressure->addstep(update->ntimestep+1);
   }
@@ -852,12 +846,11 @@ void FixNH::final_integrate()
   // compute new T,P after velocities rescaled by nh_v_press()
   // compute appropriately coupled elements of mvv_current
 
-  t_current = temperature->compute_scalar();
+  compute_temp_press(0);
+  t_current = temperature->scalar;
   tdof = temperature->dof;
 
   if (pstat_flag) {
-    if (pstyle == ISO) pressure->compute_scalar();
-    else pressure->compute_vector();
     couple();
     pressure->addstep(update->ntimestep+1);
   }
@@ -903,13 +896,8 @@ void FixNH::initial_integrate_respa(int vflag, int ilevel, int iloop)
     // compute appropriately coupled elements of mvv_current
 
     if (pstat_flag) {
-      if (pstyle == ISO) {
-        temperature->compute_scalar();
-        pressure->compute_scalar();
-      } else {
-        temperature->compute_vector();
-        pressure->compute_vector();
-      }
+      if (pstyle == ISO) compute_temp_press(0);
+      else compute_temp_press(1);
       couple();
       pressure->addstep(update->ntimestep+1);
     }
@@ -956,6 +944,31 @@ void FixNH::final_integrate_respa(int ilevel, int iloop)
   else nve_v();
 }
 
+/* ----------------------------------------------------------------------
+   compute temperature scalar (flag = 0) or tensor (flag = 1)
+     and pressure if barostatting, summed across procs together
+   pressure is scalar for ISO and tensor otherwise
+------------------------------------------------------------------------- */
+
+void FixNH::compute_temp_press(int flag)
+{
+  Compute *list[2];
+  int which[2];
+
+  list[0] = temperature;
+  which[0] = flag;
+  int n = 1;
+
+  if (pstat_flag) {
+    list[1] = pressure;
+    if (pstyle == ISO) which[1] = 0;
+    else which[1] = 1;
+    n = 2;
+  }
+
+  modify->reduce_compute(n,list,which);
+}
+
 /* ---------------------------------------------------------------------- */
 
 void FixNH::couple()
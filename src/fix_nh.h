@@ -120,6 +120,7 @@ class FixNH : public Fix {
   double fixedpoint[3];            // location of dilation fixed-point
 
   void couple();
+  void compute_temp_press(int);
   void remap();
   void nhc_temp_integrate();
   void nhc_press_integrate();
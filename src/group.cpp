@@ -43,10 +43,6 @@ enum{LT,LE,GT,GE,EQ,NEQ,BETWEEN};
 
 #define BIG 1.0e20
 
-// allocate space for static class variable
-
-Group *Group::cptr;
-
 /* ----------------------------------------------------------------------
    initialize group memory
 ------------------------------------------------------------------------- */
@@ -169,7 +165,6 @@ void Group::assign(int narg, char **arg)
     ngroup++;
   }
 
-  double **x = atom->x;
   int *mask = atom->mask;
   int nlocal = atom->nlocal;
   int bit = bitmask[igroup];
@@ -184,11 +179,10 @@ void Group::assign(int narg, char **arg)
     int iregion = domain->find_region(arg[2]);
     if (iregion == -1) error->all(FLERR,"Group region ID does not exist");
     domain->regions[iregion]->init();
-    domain->regions[iregion]->prematch();
+    int *inregion = domain->regions[iregion]->match_atoms();
 
     for (i = 0; i < nlocal; i++)
-      if (domain->regions[iregion]->match(x[i][0],x[i][1],x[i][2]))
-        mask[i] |= bit;
+      if (inregion[i]) mask[i] |= bit;
 
   // style = type, molecule, id
   // add to group if atom matches type/molecule/id or condition
@@ -606,60 +600,18 @@ int Group::find_unused()
 
 void Group::add_molecules(int igroup, int bit)
 {
-  // hash = unique molecule IDs of atoms already in group
-
-  hash = new std::map<tagint,int>();
-
-  tagint *molecule = atom->molecule;
   int *mask = atom->mask;
   int nlocal = atom->nlocal;
 
-  for (int i = 0; i < nlocal; i++)
-    if (mask[i] & bit) {
-      if (molecule[i] == 0) continue;
-      if (hash->find(molecule[i]) == hash->end()) (*hash)[molecule[i]] = 1;
-    }
-
-  // list = set of unique molecule IDs for atoms to add
-  // pass list to all other procs via comm->ring()
-
-  int n = hash->size();
-  tagint *list;
-  memory->create(list,n,"group:list");
-
-  n = 0;
-  std::map<tagint,int>::iterator pos;
-  for (pos = hash->begin(); pos != hash->end(); ++pos) list[n++] = pos->first;
-
-  cptr = this;
-  molbit = bit;
-  comm->ring(n,sizeof(tagint),list,1,molring,NULL);
-
-  delete hash;
-  memory->destroy(list);
-}
+  int *flag;
+  memory->create(flag,nlocal,"group:flag");
+  for (int i = 0; i < nlocal; i++) flag[i] = (mask[i] & bit) ? 1 : 0;
 
-/* ----------------------------------------------------------------------
-   callback from comm->ring()
-   cbuf = list of N molecule IDs, put them in hash
-   loop over my atoms, if matches molecule ID in hash,
-     add atom to group flagged by molbit
-------------------------------------------------------------------------- */
-
-void Group::molring(int n, char *cbuf)
-{
-  tagint *list = (tagint *) cbuf;
-  std::map<tagint,int> *hash = cptr->hash;
-  int nlocal = cptr->atom->nlocal;
-  tagint *molecule = cptr->atom->molecule;
-  int *mask = cptr->atom->mask;
-  int molbit = cptr->molbit;
-
-  hash->clear();
-  for (int i = 0; i < n; i++) (*hash)[list[i]] = 1;
+  comm->flag_molecules(flag);
 
   for (int i = 0; i < nlocal; i++)
-    if (hash->find(molecule[i]) != hash->end()) mask[i] |= molbit;
+    if (flag[i]) mask[i] |= bit;
+  memory->destroy(flag);
 }
 
 /* ----------------------------------------------------------------------
@@ -758,15 +710,14 @@ bigint Group::count(int igroup, int iregion)
 {
   int groupbit = bitmask[igroup];
   Region *region = domain->regions[iregion];
-  region->prematch();
+  int *inregion = region->match_atoms();
 
-  double **x = atom->x;
   int *mask = atom->mask;
   int nlocal = atom->nlocal;
 
   int n = 0;
   for (int i = 0; i < nlocal; i++)
-    if (mask[i] & groupbit && region->match(x[i][0],x[i][1],x[i][2])) n++;
+    if (mask[i] & groupbit && inregion[i]) n++;
 
   bigint nsingle = n;
   bigint nall;
@@ -813,9 +764,8 @@ double Group::mass(int igroup, int iregion)
 {
   int groupbit = bitmask[igroup];
   Region *region = domain->regions[iregion];
-  region->prematch();
+  int *inregion = region->match_atoms();
 
-  double **x = atom->x;
   double *mass = atom->mass;
   double *rmass = atom->rmass;
   int *mask = atom->mask;
@@ -826,11 +776,11 @@ double Group::mass(int igroup, int iregion)
 
   if (rmass) {
     for (int i = 0; i < nlocal; i++)
-      if (mask[i] & groupbit && region->match(x[i][0],x[i][1],x[i][2]))
+      if (mask[i] & groupbit && inregion[i])
         one += rmass[i];
   } else {
     for (int i = 0; i < nlocal; i++)
-      if (mask[i] & groupbit && region->match(x[i][0],x[i][1],x[i][2]))
+      if (mask[i] & groupbit && inregion[i])
         one += mass[type[i]];
   }
 
@@ -868,16 +818,15 @@ double Group::charge(int igroup, int iregion)
 {
   int groupbit = bitmask[igroup];
   Region *region = domain->regions[iregion];
-  region->prematch();
+  int *inregion = region->match_atoms();
 
-  double **x = atom->x;
   double *q = atom->q;
   int *mask = atom->mask;
   int nlocal = atom->nlocal;
 
   double qone = 0.0;
   for (int i = 0; i < nlocal; i++)
-    if (mask[i] & groupbit && region->match(x[i][0],x[i][1],x[i][2]))
+    if (mask[i] & groupbit && inregion[i])
       qone += q[i];
 
   double qall;
@@ -937,7 +886,7 @@ void Group::bounds(int igroup, double *minmax, int iregion)
 {
   int groupbit = bitmask[igroup];
   Region *region = domain->regions[iregion];
-  region->prematch();
+  int *inregion = region->match_atoms();
 
   double extent[6];
   extent[0] = extent[2] = extent[4] = BIG;
@@ -948,7 +897,7 @@ void Group::bounds(int igroup, double *minmax, int iregion)
   int nlocal = atom->nlocal;
 
   for (int i = 0; i < nlocal; i++) {
-    if (mask[i] & groupbit && region->match(x[i][0],x[i][1],x[i][2])) {
+    if (mask[i] & groupbit && inregion[i]) {
       extent[0] = MIN(extent[0],x[i][0]);
       extent[1] = MAX(extent[1],x[i][0]);
       extent[2] = MIN(extent[2],x[i][1]);
@@ -1037,7 +986,7 @@ void Group::xcm(int igroup, double masstotal, double *cm, int iregion)
 {
   int groupbit = bitmask[igroup];
   Region *region = domain->regions[iregion];
-  region->prematch();
+  int *inregion = region->match_atoms();
 
   double **x = atom->x;
   int *mask = atom->mask;
@@ -1055,7 +1004,7 @@ void Group::xcm(int igroup, double masstotal, double *cm, int iregion)
 
   if (rmass) {
     for (int i = 0; i < nlocal; i++)
-      if (mask[i] & groupbit && region->match(x[i][0],x[i][1],x[i][2])) {
+      if (mask[i] & groupbit && inregion[i]) {
         massone = rmass[i];
         domain->unmap(x[i],image[i],unwrap);
         cmone[0] += unwrap[0] * massone;
@@ -1064,7 +1013,7 @@ void Group::xcm(int igroup, double masstotal, double *cm, int iregion)
       }
   } else {
     for (int i = 0; i < nlocal; i++)
-      if (mask[i] & groupbit && region->match(x[i][0],x[i][1],x[i][2])) {
+      if (mask[i] & groupbit && inregion[i]) {
         massone = mass[type[i]];
         domain->unmap(x[i],image[i],unwrap);
         cmone[0] += unwrap[0] * massone;
@@ -1137,9 +1086,8 @@ void Group::vcm(int igroup, double masstotal, double *cm, int iregion)
 {
   int groupbit = bitmask[igroup];
   Region *region = domain->regions[iregion];
-  region->prematch();
+  int *inregion = region->match_atoms();
 
-  double **x = atom->x;
   double **v = atom->v;
   int *mask = atom->mask;
   int *type = atom->type;
@@ -1152,7 +1100,7 @@ void Group::vcm(int igroup, double masstotal, double *cm, int iregion)
 
   if (rmass) {
     for (int i = 0; i < nlocal; i++)
-      if (mask[i] & groupbit && region->match(x[i][0],x[i][1],x[i][2])) {
+      if (mask[i] & groupbit && inregion[i]) {
         massone = rmass[i];
         p[0] += v[i][0]*massone;
         p[1] += v[i][1]*massone;
@@ -1160,7 +1108,7 @@ void Group::vcm(int igroup, double masstotal, double *cm, int iregion)
       }
   } else {
     for (int i = 0; i < nlocal; i++)
-      if (mask[i] & groupbit && region->match(x[i][0],x[i][1],x[i][2])) {
+      if (mask[i] & groupbit && inregion[i]) {
         massone = mass[type[i]];
         p[0] += v[i][0]*massone;
         p[1] += v[i][1]*massone;
@@ -1209,9 +1157,8 @@ void Group::fcm(int igroup, double *cm, int iregion)
 {
   int groupbit = bitmask[igroup];
   Region *region = domain->regions[iregion];
-  region->prematch();
+  int *inregion = region->match_atoms();
 
-  double **x = atom->x;
   double **f = atom->f;
   int *mask = atom->mask;
   int nlocal = atom->nlocal;
@@ -1220,7 +1167,7 @@ void Group::fcm(int igroup, double *cm, int iregion)
   flocal[0] = flocal[1] = flocal[2] = 0.0;
 
   for (int i = 0; i < nlocal; i++)
-    if (mask[i] & groupbit && region->match(x[i][0],x[i][1],x[i][2])) {
+    if (mask[i] & groupbit && inregion[i]) {
       flocal[0] += f[i][0];
       flocal[1] += f[i][1];
       flocal[2] += f[i][2];
@@ -1272,9 +1219,8 @@ double Group::ke(int igroup, int iregion)
 {
   int groupbit = bitmask[igroup];
   Region *region = domain->regions[iregion];
-  region->prematch();
+  int *inregion = region->match_atoms();
 
-  double **x = atom->x;
   double **v = atom->v;
   int *mask = atom->mask;
   int *type = atom->type;
@@ -1286,12 +1232,12 @@ double Group::ke(int igroup, int iregion)
 
   if (rmass) {
     for (int i = 0; i < nlocal; i++)
-      if (mask[i] & groupbit && region->match(x[i][0],x[i][1],x[i][2]))
+      if (mask[i] & groupbit && inregion[i])
         one += (v[i][0]*v[i][0] + v[i][1]*v[i][1] + v[i][2]*v[i][2]) *
           rmass[i];
   } else {
     for (int i = 0; i < nlocal; i++)
-      if (mask[i] & groupbit && region->match(x[i][0],x[i][1],x[i][2]))
+      if (mask[i] & groupbit && inregion[i])
         one += (v[i][0]*v[i][0] + v[i][1]*v[i][1] + v[i][2]*v[i][2]) *
           mass[type[i]];
   }
@@ -1351,7 +1297,7 @@ double Group::gyration(int igroup, double masstotal, double *cm, int iregion)
 {
   int groupbit = bitmask[igroup];
   Region *region = domain->regions[iregion];
-  region->prematch();
+  int *inregion = region->match_atoms();
 
   double **x = atom->x;
   int *mask = atom->mask;
@@ -1366,7 +1312,7 @@ double Group::gyration(int igroup, double masstotal, double *cm, int iregion)
   double rg = 0.0;
 
   for (int i = 0; i < nlocal; i++)
-    if (mask[i] & groupbit && region->match(x[i][0],x[i][1],x[i][2])) {
+    if (mask[i] & groupbit && inregion[i]) {
       domain->unmap(x[i],image[i],unwrap);
       dx = unwrap[0] - cm[0];
       dy = unwrap[1] - cm[1];
@@ -1433,7 +1379,7 @@ void Group::angmom(int igroup, double *cm, double *lmom, int iregion)
 {
   int groupbit = bitmask[igroup];
   Region *region = domain->regions[iregion];
-  region->prematch();
+  int *inregion = region->match_atoms();
 
   double **x = atom->x;
   double **v = atom->v;
@@ -1451,7 +1397,7 @@ void Group::angmom(int igroup, double *cm, double *lmom, int iregion)
   p[0] = p[1] = p[2] = 0.0;
 
   for (int i = 0; i < nlocal; i++)
-    if (mask[i] & groupbit && region->match(x[i][0],x[i][1],x[i][2])) {
+    if (mask[i] & groupbit && inregion[i]) {
       domain->unmap(x[i],image[i],unwrap);
       dx = unwrap[0] - cm[0];
       dy = unwrap[1] - cm[1];
@@ -1512,7 +1458,7 @@ void Group::torque(int igroup, double *cm, double *tq, int iregion)
 {
   int groupbit = bitmask[igroup];
   Region *region = domain->regions[iregion];
-  region->prematch();
+  int *inregion = region->match_atoms();
 
   double **x = atom->x;
   double **f = atom->f;
@@ -1527,7 +1473,7 @@ void Group::torque(int igroup, double *cm, double *tq, int iregion)
   tlocal[0] = tlocal[1] = tlocal[2] = 0.0;
 
   for (int i = 0; i < nlocal; i++)
-    if (mask[i] & groupbit && region->match(x[i][0],x[i][1],x[i][2])) {
+    if (mask[i] & groupbit && inregion[i]) {
       domain->unmap(x[i],image[i],unwrap);
       dx = unwrap[0] - cm[0];
       dy = unwrap[1] - cm[1];
@@ -1600,7 +1546,7 @@ void Group::inertia(int igroup, double *cm, double itensor[3][3], int iregion)
 
   int groupbit = bitmask[igroup];
   Region *region = domain->regions[iregion];
-  region->prematch();
+  int *inregion = region->match_atoms();
 
   double **x = atom->x;
   int *mask = atom->mask;
@@ -1619,7 +1565,7 @@ void Group::inertia(int igroup, double *cm, double itensor[3][3], int iregion)
       ione[i][j] = 0.0;
 
   for (i = 0; i < nlocal; i++)
-    if (mask[i] & groupbit && region->match(x[i][0],x[i][1],x[i][2])) {
+    if (mask[i] & groupbit && inregion[i]) {
       domain->unmap(x[i],image[i],unwrap);
       dx = unwrap[0] - cm[0];
       dy = unwrap[1] - cm[1];
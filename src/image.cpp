@@ -50,6 +50,7 @@ enum{NUMERIC,MINVALUE,MAXVALUE};
 enum{CONTINUOUS,DISCRETE,SEQUENTIAL};
 enum{ABSOLUTE,FRACTIONAL};
 enum{NO,YES};
+enum{TREE,SWAP};                  // also in dump_image.cpp
 
 /* ---------------------------------------------------------------------- */
 
@@ -67,6 +68,13 @@ Image::Image(LAMMPS *lmp, int nmap_caller) : Pointers(lmp)
   persp = 0.0;
   shiny = 1.0;
   ssao = NO;
+  composite = TREE;
+
+  pof2 = 1;
+  while (2*pof2 <= nprocs) pof2 *= 2;
+  if (me < 2*(nprocs-pof2)) myslot = (me % 2) ? -1 : me/2;
+  else myslot = me - (nprocs-pof2);
+  rowcounts = rowdispls = NULL;
 
   up[0] = 0.0;
   up[1] = 0.0;
@@ -133,6 +141,8 @@ Image::~Image()
   memory->destroy(depthcopy);
   memory->destroy(surfacecopy);
   memory->destroy(rgbcopy);
+  memory->destroy(rowcounts);
+  memory->destroy(rowdispls);
 
   if (random) delete random;
 }
@@ -151,6 +161,20 @@ void Image::buffers()
   memory->create(depthcopy,npixels,"image:depthcopy");
   memory->create(surfacecopy,2*npixels,"image:surfacecopy");
   memory->create(rgbcopy,3*npixels,"image:rgbcopy");
+
+  // rows gathered from each proc after binary-swap compositing
+
+  memory->create(rowcounts,nprocs,"image:rowcounts");
+  memory->create(rowdispls,nprocs,"image:rowdispls");
+  int rlo,rhi;
+  for (int iproc = 0; iproc < nprocs; iproc++)
+    rowcounts[iproc] = rowdispls[iproc] = 0;
+  for (int islot = 0; islot < pof2; islot++) {
+    int iblock = swap_block(islot);
+    block_rows(iblock,iblock+1,rlo,rhi);
+    rowcounts[swap_proc(islot)] = (rhi-rlo) * width*3;
+    rowdispls[swap_proc(islot)] = rlo * width*3;
+  }
 }
 
 /* ----------------------------------------------------------------------
@@ -289,25 +313,38 @@ void Image::clear()
    merge image from each processor into one composite image
    done pixel by pixel, respecting depth buffer
    hi procs send to lo procs, cascading down logarithmically
+   ties in depth are won by the lowest proc
 ------------------------------------------------------------------------- */
 
 void Image::merge()
 {
+  if (composite == SWAP) {
+    merge_swap();
+    return;
+  }
+
   MPI_Request requests[3];
 
+  // each round, a proc that has merged procs me to me+nhalf-1
+  //   sends to partner nhalf below or receives from partner nhalf above
+
   int nhalf = 1;
-  while (nhalf < nprocs) nhalf *= 2;
-  nhalf /= 2;
+  while (nhalf < nprocs) {
+    if (me % (2*nhalf)) {
+      MPI_Send(imageBuffer,npixels*3,MPI_BYTE,me-nhalf,0,world);
+      MPI_Send(depthBuffer,npixels,MPI_DOUBLE,me-nhalf,0,world);
+      if (ssao) MPI_Send(surfaceBuffer,npixels*2,MPI_DOUBLE,me-nhalf,0,world);
+      break;
+    }
 
-  while (nhalf) {
-    if (me < nhalf && me+nhalf < nprocs) {
+    if (me+nhalf < nprocs) {
       MPI_Irecv(rgbcopy,npixels*3,MPI_BYTE,me+nhalf,0,world,&requests[0]);
       MPI_Irecv(depthcopy,npixels,MPI_DOUBLE,me+nhalf,0,world,&requests[1]);
       if (ssao)
         MPI_Irecv(surfacecopy,npixels*2,MPI_DOUBLE,
                   me+nhalf,0,world,&requests[2]);
-      if (ssao) MPI_Waitall(3,requests,MPI_STATUS_IGNORE);
-      else MPI_Waitall(2,requests,MPI_STATUS_IGNORE);
+      if (ssao) MPI_Waitall(3,requests,MPI_STATUSES_IGNORE);
+      else MPI_Waitall(2,requests,MPI_STATUSES_IGNORE);
 
       for (int i = 0; i < npixels; i++) {
         if (depthBuffer[i] < 0 || (depthcopy[i] >= 0 &&
@@ -322,14 +359,9 @@ void Image::merge()
           }
         }
       }
-
-    } else if (me >= nhalf && me < 2*nhalf) {
-      MPI_Send(imageBuffer,npixels*3,MPI_BYTE,me-nhalf,0,world);
-      MPI_Send(depthBuffer,npixels,MPI_DOUBLE,me-nhalf,0,world);
-      if (ssao) MPI_Send(surfaceBuffer,npixels*2,MPI_DOUBLE,me-nhalf,0,world);
     }
 
-    nhalf /= 2;
+    nhalf *= 2;
   }
 
   // extra SSAO enhancement
@@ -341,8 +373,9 @@ void Image::merge()
     MPI_Bcast(imageBuffer,npixels*3,MPI_BYTE,0,world);
     MPI_Bcast(surfaceBuffer,npixels*2,MPI_DOUBLE,0,world);
     MPI_Bcast(depthBuffer,npixels,MPI_DOUBLE,0,world);
-    compute_SSAO();
-    int pixelPart = height/nprocs * width*3;
+    int hPart = height/nprocs;
+    compute_SSAO(me*hPart,(me+1)*hPart);
+    int pixelPart = hPart * width*3;
     MPI_Gather(imageBuffer+me*pixelPart,pixelPart,MPI_BYTE,
                rgbcopy,pixelPart,MPI_BYTE,0,world);
     writeBuffer = rgbcopy;
@@ -351,6 +384,217 @@ void Image::merge()
   }
 }
 
+/* ----------------------------------------------------------------------
+   merge image from each processor by binary swap
+   first 2*(nprocs-pof2) procs fold in pairs, odd proc sends to even proc,
+     leaving pof2 procs whose slot order is the same as their proc order
+   each round, partners swap half of their current rows and
+     composite the half they keep, so slot I ends up owning row block
+     swap_block(I)
+   SSAO is done on owned rows, with a halo of depth rows from neighbors
+   only owned rows are gathered to proc 0
+   masks ascend, so partners hold disjoint contiguous ranges of procs
+     and ties in depth are won by the lowest proc, same as in merge()
+------------------------------------------------------------------------- */
+
+void Image::merge_swap()
+{
+  MPI_Request requests[3];
+  int nreq = ssao ? 3 : 2;
+
+  int nfold = nprocs - pof2;
+  if (me < 2*nfold && me % 2) {
+    MPI_Send(imageBuffer,npixels*3,MPI_BYTE,me-1,0,world);
+    MPI_Send(depthBuffer,npixels,MPI_DOUBLE,me-1,0,world);
+    if (ssao) MPI_Send(surfaceBuffer,npixels*2,MPI_DOUBLE,me-1,0,world);
+  } else if (me < 2*nfold) {
+    MPI_Irecv(rgbcopy,npixels*3,MPI_BYTE,me+1,0,world,&requests[0]);
+    MPI_Irecv(depthcopy,npixels,MPI_DOUBLE,me+1,0,world,&requests[1]);
+    if (ssao)
+      MPI_Irecv(surfacecopy,npixels*2,MPI_DOUBLE,me+1,0,world,&requests[2]);
+    MPI_Waitall(nreq,requests,MPI_STATUSES_IGNORE);
+    composite_rows(0,height,1);
+  }
+
+  int rlo,rhi;
+  rlo = rhi = 0;
+
+  if (myslot >= 0) {
+    int blo = 0;
+    int bhi = pof2;
+    int klo,khi,slo,shi;
+
+    for (int mask = 1; mask < pof2; mask *= 2) {
+      int partner = swap_proc(myslot ^ mask);
+      int bmid = (blo+bhi) / 2;
+      int lower = (myslot & mask) ? 0 : 1;
+      if (lower) {
+        block_rows(blo,bmid,klo,khi);
+        block_rows(bmid,bhi,slo,shi);
+        bhi = bmid;
+      } else {
+        block_rows(bmid,bhi,klo,khi);
+        block_rows(blo,bmid,slo,shi);
+        blo = bmid;
+      }
+
+      int k = klo*width;
+      int nk = (khi-klo) * width;
+      int ns = (shi-slo) * width;
+      MPI_Irecv(&rgbcopy[k*3],nk*3,MPI_BYTE,partner,0,world,&requests[0]);
+      MPI_Irecv(&depthcopy[k],nk,MPI_DOUBLE,partner,0,world,&requests[1]);
+      if (ssao)
+        MPI_Irecv(&surfacecopy[k*2],nk*2,MPI_DOUBLE,
+                  partner,0,world,&requests[2]);
+      MPI_Send(&imageBuffer[slo*width*3],ns*3,MPI_BYTE,partner,0,world);
+      MPI_Send(&depthBuffer[slo*width],ns,MPI_DOUBLE,partner,0,world);
+      if (ssao)
+        MPI_Send(&surfaceBuffer[slo*width*2],ns*2,MPI_DOUBLE,
+                 partner,0,world);
+      MPI_Waitall(nreq,requests,MPI_STATUSES_IGNORE);
+
+      composite_rows(klo,khi,lower);
+    }
+
+    block_rows(blo,bhi,rlo,rhi);
+  }
+
+  // SSAO on owned rows, depth of nearby rows is needed for shading
+
+  if (ssao && myslot >= 0) {
+    exchange_halo(rlo,rhi,ssao_radius());
+    compute_SSAO(rlo,rhi);
+  }
+
+  MPI_Gatherv(&imageBuffer[rlo*width*3],(rhi-rlo)*width*3,MPI_BYTE,
+              rgbcopy,rowcounts,rowdispls,MPI_BYTE,0,world);
+  writeBuffer = rgbcopy;
+}
+
+/* ----------------------------------------------------------------------
+   composite received copy into rows rlo to rhi-1 of image
+   lower = 1 if this proc is lower of the pair and keeps pixels on ties
+------------------------------------------------------------------------- */
+
+void Image::composite_rows(int rlo, int rhi, int lower)
+{
+  int take;
+  int ihi = rhi*width;
+
+  for (int i = rlo*width; i < ihi; i++) {
+    if (lower) take = (depthBuffer[i] < 0 ||
+                       (depthcopy[i] >= 0 && depthcopy[i] < depthBuffer[i]));
+    else take = (depthcopy[i] >= 0 &&
+                 (depthBuffer[i] < 0 || depthcopy[i] <= depthBuffer[i]));
+    if (take) {
+      depthBuffer[i] = depthcopy[i];
+      imageBuffer[i*3+0] = rgbcopy[i*3+0];
+      imageBuffer[i*3+1] = rgbcopy[i*3+1];
+      imageBuffer[i*3+2] = rgbcopy[i*3+2];
+      if (ssao) {
+        surfaceBuffer[i*2+0] = surfacecopy[i*2+0];
+        surfaceBuffer[i*2+1] = surfacecopy[i*2+1];
+      }
+    }
+  }
+}
+
+/* ----------------------------------------------------------------------
+   range of rows rlo to rhi-1 spanned by row blocks blo to bhi-1
+   image is split into pof2 blocks of nearly equal # of rows
+------------------------------------------------------------------------- */
+
+void Image::block_rows(int blo, int bhi, int &rlo, int &rhi)
+{
+  rlo = static_cast<int> ((bigint) blo*height / pof2);
+  rhi = static_cast<int> ((bigint) bhi*height / pof2);
+}
+
+/* ----------------------------------------------------------------------
+   proc in binary-swap slot islot
+------------------------------------------------------------------------- */
+
+int Image::swap_proc(int islot)
+{
+  int nfold = nprocs - pof2;
+  if (islot < nfold) return 2*islot;
+  return islot + nfold;
+}
+
+/* ----------------------------------------------------------------------
+   row block owned by binary-swap slot islot after all rounds
+   first round splits on lowest bit of slot, so block is bit-reversed slot
+   also maps a row block back to its slot
+------------------------------------------------------------------------- */
+
+int Image::swap_block(int islot)
+{
+  int iblock = 0;
+  for (int mask = 1; mask < pof2; mask *= 2) {
+    iblock *= 2;
+    if (islot & mask) iblock++;
+  }
+  return iblock;
+}
+
+/* ----------------------------------------------------------------------
+   exchange composited depth rows within radius of owned rows rlo to rhi-1
+   with procs owning neighboring row blocks
+   each proc receives rows of neighbor blocks that overlap its halo and
+     sends its rows that overlap the halo of the neighbor
+------------------------------------------------------------------------- */
+
+void Image::exchange_halo(int rlo, int rhi, int radius)
+{
+  int iblock,iproc,qlo,qhi,lo,hi;
+
+  // neighbors are contiguous in block, up to first one beyond radius
+
+  int myblock = swap_block(myslot);
+  int plo = myblock;
+  while (plo > 0) {
+    block_rows(plo-1,plo,qlo,qhi);
+    if (qhi <= rlo-radius) break;
+    plo--;
+  }
+  int phi = myblock;
+  while (phi < pof2-1) {
+    block_rows(phi+1,phi+2,qlo,qhi);
+    if (qlo >= rhi+radius) break;
+    phi++;
+  }
+
+  MPI_Request *requests = new MPI_Request[phi-plo+1];
+  int nreq = 0;
+
+  int hlo = MAX(rlo-radius,0);
+  int hhi = MIN(rhi+radius,height);
+
+  for (iblock = plo; iblock <= phi; iblock++) {
+    if (iblock == myblock) continue;
+    iproc = swap_proc(swap_block(iblock));
+    block_rows(iblock,iblock+1,qlo,qhi);
+    lo = MAX(qlo,hlo);
+    hi = MIN(qhi,hhi);
+    if (lo >= hi) continue;
+    MPI_Irecv(&depthBuffer[lo*width],(hi-lo)*width,MPI_DOUBLE,
+              iproc,0,world,&requests[nreq++]);
+  }
+
+  for (iblock = plo; iblock <= phi; iblock++) {
+    if (iblock == myblock) continue;
+    iproc = swap_proc(swap_block(iblock));
+    block_rows(iblock,iblock+1,qlo,qhi);
+    lo = MAX(rlo,MAX(qlo-radius,0));
+    hi = MIN(rhi,MIN(qhi+radius,height));
+    if (lo >= hi) continue;
+    MPI_Send(&depthBuffer[lo*width],(hi-lo)*width,MPI_DOUBLE,iproc,0,world);
+  }
+
+  if (nreq) MPI_Waitall(nreq,requests,MPI_STATUSES_IGNORE);
+  delete [] requests;
+}
+
 /* ----------------------------------------------------------------------
    draw simulation bounding box as 12 cylinders
 ------------------------------------------------------------------------- */
@@ -867,9 +1111,23 @@ void Image::draw_pixel(int ix, int iy, double depth,
   imageBuffer[2 + ix*3 + iy*width*3] = static_cast<int>(c[2] * 255.0);
 }
 
-/* ---------------------------------------------------------------------- */
+/* ----------------------------------------------------------------------
+   typical neighborhood in pixels for SSAO shading
+------------------------------------------------------------------------- */
+
+int Image::ssao_radius()
+{
+  double pixelWidth = (tanPerPixel > 0) ? tanPerPixel :
+        -tanPerPixel / zoom;
+  return (int) trunc (SSAORadius / pixelWidth + 0.5);
+}
+
+/* ----------------------------------------------------------------------
+   SSAO shading of rows ylo to yhi-1
+   depth of rows within ssao_radius() must be composited as well
+------------------------------------------------------------------------- */
 
-void Image::compute_SSAO()
+void Image::compute_SSAO(int ylo, int yhi)
 {
   // used for rasterizing the spheres
 
@@ -879,12 +1137,11 @@ void Image::compute_SSAO()
 
   double pixelWidth = (tanPerPixel > 0) ? tanPerPixel :
         -tanPerPixel / zoom;
-  int pixelRadius = (int) trunc (SSAORadius / pixelWidth + 0.5);
+  int pixelRadius = ssao_radius();
 
   int x,y,s;
-  int hPart = height / nprocs;
-  int index = me * hPart * width;
-  for (y = me * hPart; y < (me + 1) * hPart; y ++) {
+  int index = ylo * width;
+  for (y = ylo; y < yhi; y ++) {
     for (x = 0; x < width; x ++, index ++) {
       double cdepth = depthBuffer[index];
       if (cdepth < 0) { continue; }
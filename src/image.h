@@ -32,6 +32,7 @@ class Image : protected Pointers {
   int ssao;                     // SSAO on or off
   int seed;                     // RN seed for SSAO
   double ssaoint;               // strength of shading from 0 to 1
+  int composite;                // TREE or SWAP compositing of images
   double *boxcolor;             // color to draw box outline with
   int background[3];            // RGB values of background
 
@@ -74,6 +75,12 @@ class Image : protected Pointers {
   double *depthcopy,*surfacecopy;
   unsigned char *imageBuffer,*rgbcopy,*writeBuffer;
 
+  // binary-swap compositing
+
+  int pof2;                     // largest power of 2 <= nprocs
+  int myslot;                   // my slot in binary swap, -1 if folded
+  int *rowcounts,*rowdispls;    // pixel bytes of each proc's rows in gather
+
   // constant view params
 
   double FOV;
@@ -119,7 +126,14 @@ class Image : protected Pointers {
   // internal methods
 
   void draw_pixel(int, int, double, double *, double*);
-  void compute_SSAO();
+  void compute_SSAO(int, int);
+  void merge_swap();
+  void composite_rows(int, int, int);
+  void block_rows(int, int, int &, int &);
+  int swap_proc(int);
+  int swap_block(int);
+  void exchange_halo(int, int, int);
+  int ssao_radius();
 
   // inline functions
 
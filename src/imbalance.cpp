@@ -0,0 +1,59 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#include "imbalance.h"
+#include "atom.h"
+#include "neighbor.h"
+#include "neigh_list.h"
+#include "neigh_request.h"
+
+using namespace LAMMPS_NS;
+
+/* ---------------------------------------------------------------------- */
+
+Imbalance::Imbalance(LAMMPS *lmp) : Pointers(lmp) {}
+
+/* ----------------------------------------------------------------------
+   count = # of pairwise neighbors of each owned atom, from the pair list
+     built most recently, whose indices are valid until atoms migrate
+   skip lists derived from another list, they are subsets of it
+   atoms not in the list get a count of 0
+   return 1 if a list was found, 0 if not, e.g. before the first run
+------------------------------------------------------------------------- */
+
+int Imbalance::neigh_counts(double *count)
+{
+  NeighList *list = NULL;
+  for (int m = 0; m < neighbor->old_nrequest; m++) {
+    NeighRequest *rq = neighbor->old_requests[m];
+    if (!rq->pair || rq->skip || rq->copy) continue;
+    if (!rq->half && !rq->full) continue;
+    if (neighbor->lists[m] == NULL || neighbor->lists[m]->numneigh == NULL)
+      continue;
+    list = neighbor->lists[m];
+    break;
+  }
+  if (list == NULL || neighbor->lastcall < 0) return 0;
+
+  int nlocal = atom->nlocal;
+  for (int i = 0; i < nlocal; i++) count[i] = 0.0;
+
+  int inum = list->inum;
+  int *ilist = list->ilist;
+  int *numneigh = list->numneigh;
+  for (int ii = 0; ii < inum; ii++) {
+    int i = ilist[ii];
+    if (i < nlocal) count[i] = numneigh[i];
+  }
+  return 1;
+}
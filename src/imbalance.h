@@ -0,0 +1,43 @@
+/* -*- c++ -*- ----------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#ifndef LMP_IMBALANCE_H
+#define LMP_IMBALANCE_H
+
+#include "stdio.h"
+#include "pointers.h"
+
+namespace LAMMPS_NS {
+
+class Imbalance : protected Pointers {
+ public:
+  Imbalance(class LAMMPS *);
+  virtual ~Imbalance() {}
+
+  // parse options, return # of args consumed
+  virtual int options(int, char **) = 0;
+  // reset state before a balancing operation, check validity of settings
+  virtual void init() {}
+  // multiply per-atom weights of owned atoms by this style's weight
+  virtual void compute(double *) = 0;
+  // print description of weight style to screen/logfile
+  virtual void info(FILE *) = 0;
+
+ protected:
+  // per-atom neighbor counts of owned atoms from a pairwise list
+  int neigh_counts(double *);
+};
+
+}
+
+#endif
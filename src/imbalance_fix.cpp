@@ -0,0 +1,88 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#include "mpi.h"
+#include "string.h"
+#include "imbalance_fix.h"
+#include "atom.h"
+#include "modify.h"
+#include "fix.h"
+#include "error.h"
+
+using namespace LAMMPS_NS;
+
+/* ---------------------------------------------------------------------- */
+
+ImbalanceFix::ImbalanceFix(LAMMPS *lmp) : Imbalance(lmp)
+{
+  id = NULL;
+  fix = NULL;
+}
+
+/* ---------------------------------------------------------------------- */
+
+ImbalanceFix::~ImbalanceFix()
+{
+  delete [] id;
+}
+
+/* ---------------------------------------------------------------------- */
+
+int ImbalanceFix::options(int narg, char **arg)
+{
+  if (narg < 1) error->all(FLERR,"Illegal balance weight command");
+  int n = strlen(arg[0]) + 1;
+  id = new char[n];
+  strcpy(id,arg[0]);
+  return 1;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void ImbalanceFix::init()
+{
+  int ifix = modify->find_fix(id);
+  if (ifix < 0) error->all(FLERR,"Fix ID for balance weight does not exist");
+  fix = modify->fix[ifix];
+  if (fix->peratom_flag == 0)
+    error->all(FLERR,"Balance weight fix does not calculate per-atom values");
+  if (fix->size_peratom_cols != 0)
+    error->all(FLERR,"Balance weight fix does not calculate a per-atom vector");
+}
+
+/* ----------------------------------------------------------------------
+   weight = per-atom vector of fix, must be > 0.0
+------------------------------------------------------------------------- */
+
+void ImbalanceFix::compute(double *weight)
+{
+  double *values = fix->vector_atom;
+  int nlocal = atom->nlocal;
+
+  int flag = 0;
+  for (int i = 0; i < nlocal; i++) {
+    if (values[i] <= 0.0) flag = 1;
+    else weight[i] *= values[i];
+  }
+
+  int flagall;
+  MPI_Allreduce(&flag,&flagall,1,MPI_INT,MPI_MAX,world);
+  if (flagall) error->all(FLERR,"Balance weight <= 0.0");
+}
+
+/* ---------------------------------------------------------------------- */
+
+void ImbalanceFix::info(FILE *fp)
+{
+  fprintf(fp,"  weight from fix: %s\n",id);
+}
@@ -0,0 +1,61 @@
+/* -*- c++ -*- ----------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#ifndef LMP_IMBALANCE_FIX_H
+#define LMP_IMBALANCE_FIX_H
+
+#include "imbalance.h"
+
+namespace LAMMPS_NS {
+
+class ImbalanceFix : public Imbalance {
+ public:
+  ImbalanceFix(class LAMMPS *);
+  ~ImbalanceFix();
+  int options(int, char **);
+  void init();
+  void compute(double *);
+  void info(FILE *);
+
+ private:
+  char *id;                  // ID of fix providing per-atom weights
+  class Fix *fix;
+};
+
+}
+
+#endif
+
+/* ERROR/WARNING messages:
+
+E: Illegal balance weight command
+
+Self-explanatory.
+
+E: Fix ID for balance weight does not exist
+
+Self-explanatory.
+
+E: Balance weight fix does not calculate per-atom values
+
+Self-explanatory.
+
+E: Balance weight fix does not calculate a per-atom vector
+
+The fix must produce a single per-atom value, not a per-atom array.
+
+E: Balance weight <= 0.0
+
+Per-atom weights used for balancing must be strictly positive.
+
+*/
@@ -0,0 +1,87 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#include "mpi.h"
+#include "stdlib.h"
+#include "imbalance_neigh.h"
+#include "atom.h"
+#include "comm.h"
+#include "force.h"
+#include "memory.h"
+#include "error.h"
+
+using namespace LAMMPS_NS;
+
+/* ---------------------------------------------------------------------- */
+
+ImbalanceNeigh::ImbalanceNeigh(LAMMPS *lmp) : Imbalance(lmp)
+{
+  did_warn = 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+int ImbalanceNeigh::options(int narg, char **arg)
+{
+  if (narg < 1) error->all(FLERR,"Illegal balance weight command");
+  factor = force->numeric(FLERR,arg[0]);
+  if (factor <= 0.0 || factor > 1.0)
+    error->all(FLERR,"Illegal balance weight command");
+  return 1;
+}
+
+/* ----------------------------------------------------------------------
+   weight = fraction of cost that scales with # of neighbors of each atom
+   must be called before atoms migrate in exchange(),
+     while neighbor list indices still match owned atoms
+   wt = (1-factor) + factor * (neighs of atom) / (global neighs/atom)
+------------------------------------------------------------------------- */
+
+void ImbalanceNeigh::compute(double *weight)
+{
+  int nlocal = atom->nlocal;
+
+  double *count;
+  memory->create(count,nlocal,"imbalance:count");
+  int flag = neigh_counts(count);
+  int flagall;
+  MPI_Allreduce(&flag,&flagall,1,MPI_INT,MPI_MIN,world);
+
+  double mine[2],all[2];
+  mine[0] = 0.0;
+  mine[1] = nlocal;
+  if (flag)
+    for (int i = 0; i < nlocal; i++) mine[0] += count[i];
+  MPI_Allreduce(mine,all,2,MPI_DOUBLE,MPI_SUM,world);
+
+  if (!flagall || all[0] == 0.0 || all[1] == 0.0) {
+    if (comm->me == 0 && !did_warn)
+      error->warning(FLERR,"Balance weight neigh skipped b/c no list found");
+    did_warn = 1;
+    memory->destroy(count);
+    return;
+  }
+
+  double avg = all[0]/all[1];
+  for (int i = 0; i < nlocal; i++)
+    weight[i] *= (1.0-factor) + factor * count[i] / avg;
+
+  memory->destroy(count);
+}
+
+/* ---------------------------------------------------------------------- */
+
+void ImbalanceNeigh::info(FILE *fp)
+{
+  fprintf(fp,"  neighbor weight factor: %g\n",factor);
+}
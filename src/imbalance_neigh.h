@@ -0,0 +1,50 @@
+/* -*- c++ -*- ----------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#ifndef LMP_IMBALANCE_NEIGH_H
+#define LMP_IMBALANCE_NEIGH_H
+
+#include "imbalance.h"
+
+namespace LAMMPS_NS {
+
+class ImbalanceNeigh : public Imbalance {
+ public:
+  ImbalanceNeigh(class LAMMPS *);
+  ~ImbalanceNeigh() {}
+  int options(int, char **);
+  void compute(double *);
+  void info(FILE *);
+
+ private:
+  double factor;             // fraction of cost that scales with neighbors
+  int did_warn;              // 1 if already warned about missing list
+};
+
+}
+
+#endif
+
+/* ERROR/WARNING messages:
+
+E: Illegal balance weight command
+
+Self-explanatory.  The factor must be > 0.0 and <= 1.0.
+
+W: Balance weight neigh skipped b/c no list found
+
+No pairwise neighbor list with neighbor counts for the current atoms
+was found, so no neighbor-based weights are applied.  This is typically
+the case when the balance command is used before the first run.
+
+*/
@@ -0,0 +1,106 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#include "mpi.h"
+#include "imbalance_time.h"
+#include "atom.h"
+#include "timer.h"
+#include "force.h"
+#include "memory.h"
+#include "error.h"
+
+using namespace LAMMPS_NS;
+
+/* ---------------------------------------------------------------------- */
+
+ImbalanceTime::ImbalanceTime(LAMMPS *lmp) : Imbalance(lmp)
+{
+  last = 0.0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+int ImbalanceTime::options(int narg, char **arg)
+{
+  if (narg < 1) error->all(FLERR,"Illegal balance weight command");
+  factor = force->numeric(FLERR,arg[0]);
+  if (factor <= 0.0 || factor > 1.0)
+    error->all(FLERR,"Illegal balance weight command");
+  return 1;
+}
+
+/* ----------------------------------------------------------------------
+   reset last cost, timers are zeroed at the start of each run
+------------------------------------------------------------------------- */
+
+void ImbalanceTime::init()
+{
+  double cost = timer->array[TIME_PAIR] + timer->array[TIME_BOND] + 
+    timer->array[TIME_NEIGHBOR];
+  if (cost < last) last = 0.0;
+}
+
+/* ----------------------------------------------------------------------
+   weight = fraction of cost measured by pair, bond, neighbor timers
+     accumulated on this proc since the last balancing
+   time of this proc is split across its atoms by their # of neighbors,
+     or evenly if no neighbor list is available
+   must be called before atoms migrate in exchange(),
+     while neighbor list indices still match owned atoms
+   wt = (1-factor) + factor * (time of atom) / (global time/atom)
+------------------------------------------------------------------------- */
+
+void ImbalanceTime::compute(double *weight)
+{
+  double cost = timer->array[TIME_PAIR] + timer->array[TIME_BOND] + 
+    timer->array[TIME_NEIGHBOR];
+  if (cost < last) last = 0.0;
+
+  int nlocal = atom->nlocal;
+  double mine[2],all[2];
+  mine[0] = cost - last;
+  mine[1] = nlocal;
+  MPI_Allreduce(mine,all,2,MPI_DOUBLE,MPI_SUM,world);
+  last = cost;
+
+  // no timing data yet, e.g. balance command before first run
+
+  if (all[0] <= 0.0 || all[1] == 0.0) return;
+
+  double *count;
+  memory->create(count,nlocal,"imbalance:count");
+  int flag = neigh_counts(count);
+  int flagall;
+  MPI_Allreduce(&flag,&flagall,1,MPI_INT,MPI_MIN,world);
+
+  double sum = 0.0;
+  if (flagall)
+    for (int i = 0; i < nlocal; i++) sum += count[i];
+  if (!flagall || sum == 0.0) {
+    for (int i = 0; i < nlocal; i++) count[i] = 1.0;
+    sum = nlocal;
+  }
+
+  double avg = all[0]/all[1];
+  for (int i = 0; i < nlocal; i++)
+    weight[i] *= (1.0-factor) + factor * (mine[0]*count[i]/sum) / avg;
+
+  memory->destroy(count);
+}
+
+/* ---------------------------------------------------------------------- */
+
+void ImbalanceTime::info(FILE *fp)
+{
+  fprintf(fp,"  time weight factor: %g\n",factor);
+}
@@ -0,0 +1,45 @@
+/* -*- c++ -*- ----------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#ifndef LMP_IMBALANCE_TIME_H
+#define LMP_IMBALANCE_TIME_H
+
+#include "imbalance.h"
+
+namespace LAMMPS_NS {
+
+class ImbalanceTime : public Imbalance {
+ public:
+  ImbalanceTime(class LAMMPS *);
+  ~ImbalanceTime() {}
+  int options(int, char **);
+  void init();
+  void compute(double *);
+  void info(FILE *);
+
+ private:
+  double factor;             // fraction of cost that scales with timings
+  double last;               // cummulative cost at time of last balancing
+};
+
+}
+
+#endif
+
+/* ERROR/WARNING messages:
+
+E: Illegal balance weight command
+
+Self-explanatory.  The factor must be > 0.0 and <= 1.0.
+
+*/
@@ -0,0 +1,91 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#include "mpi.h"
+#include "string.h"
+#include "imbalance_var.h"
+#include "atom.h"
+#include "group.h"
+#include "input.h"
+#include "variable.h"
+#include "memory.h"
+#include "error.h"
+
+using namespace LAMMPS_NS;
+
+/* ---------------------------------------------------------------------- */
+
+ImbalanceVar::ImbalanceVar(LAMMPS *lmp) : Imbalance(lmp)
+{
+  name = NULL;
+}
+
+/* ---------------------------------------------------------------------- */
+
+ImbalanceVar::~ImbalanceVar()
+{
+  delete [] name;
+}
+
+/* ---------------------------------------------------------------------- */
+
+int ImbalanceVar::options(int narg, char **arg)
+{
+  if (narg < 1) error->all(FLERR,"Illegal balance weight command");
+  int n = strlen(arg[0]) + 1;
+  name = new char[n];
+  strcpy(name,arg[0]);
+  return 1;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void ImbalanceVar::init()
+{
+  ivar = input->variable->find(name);
+  if (ivar < 0)
+    error->all(FLERR,"Variable name for balance weight does not exist");
+  if (input->variable->atomstyle(ivar) == 0)
+    error->all(FLERR,"Balance weight variable is not atom-style variable");
+}
+
+/* ----------------------------------------------------------------------
+   weight = atom-style variable evaluated for all owned atoms, must be > 0.0
+------------------------------------------------------------------------- */
+
+void ImbalanceVar::compute(double *weight)
+{
+  int nlocal = atom->nlocal;
+
+  double *values;
+  memory->create(values,nlocal,"imbalance:values");
+  input->variable->compute_atom(ivar,0,values,1,0);
+
+  int flag = 0;
+  for (int i = 0; i < nlocal; i++) {
+    if (values[i] <= 0.0) flag = 1;
+    else weight[i] *= values[i];
+  }
+  memory->destroy(values);
+
+  int flagall;
+  MPI_Allreduce(&flag,&flagall,1,MPI_INT,MPI_MAX,world);
+  if (flagall) error->all(FLERR,"Balance weight <= 0.0");
+}
+
+/* ---------------------------------------------------------------------- */
+
+void ImbalanceVar::info(FILE *fp)
+{
+  fprintf(fp,"  weight from variable: %s\n",name);
+}
@@ -0,0 +1,57 @@
+/* -*- c++ -*- ----------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#ifndef LMP_IMBALANCE_VAR_H
+#define LMP_IMBALANCE_VAR_H
+
+#include "imbalance.h"
+
+namespace LAMMPS_NS {
+
+class ImbalanceVar : public Imbalance {
+ public:
+  ImbalanceVar(class LAMMPS *);
+  ~ImbalanceVar();
+  int options(int, char **);
+  void init();
+  void compute(double *);
+  void info(FILE *);
+
+ private:
+  char *name;                // name of atom-style variable
+  int ivar;                  // index of variable
+};
+
+}
+
+#endif
+
+/* ERROR/WARNING messages:
+
+E: Illegal balance weight command
+
+Self-explanatory.
+
+E: Variable name for balance weight does not exist
+
+Self-explanatory.
+
+E: Balance weight variable is not atom-style variable
+
+Self-explanatory.
+
+E: Balance weight <= 0.0
+
+Per-atom weights used for balancing must be strictly positive.
+
+*/
@@ -41,6 +41,7 @@
 #include "improper.h"
 #include "kspace.h"
 #include "update.h"
+#include "timer.h"
 #include "neighbor.h"
 #include "special.h"
 #include "variable.h"
@@ -595,6 +596,7 @@ int Input::execute_command()
   else if (!strcmp(command,"thermo")) thermo();
   else if (!strcmp(command,"thermo_modify")) thermo_modify();
   else if (!strcmp(command,"thermo_style")) thermo_style();
+  else if (!strcmp(command,"timer")) timer_command();
   else if (!strcmp(command,"timestep")) timestep();
   else if (!strcmp(command,"uncompute")) uncompute();
   else if (!strcmp(command,"undump")) undump();
@@ -1645,6 +1647,13 @@ void Input::thermo_style()
 
 /* ---------------------------------------------------------------------- */
 
+void Input::timer_command()
+{
+  timer->modify_params(narg,arg);
+}
+
+/* ---------------------------------------------------------------------- */
+
 void Input::timestep()
 {
   if (narg != 1) error->all(FLERR,"Illegal timestep command");
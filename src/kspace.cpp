@@ -36,6 +36,7 @@ KSpace::KSpace(LAMMPS *lmp, int narg, char **arg) : Pointers(lmp)
   virial[0] = virial[1] = virial[2] = virial[3] = virial[4] = virial[5] = 0.0;
 
   triclinic_support = 1;
+  mixed_support = 0;
   ewaldflag = pppmflag = msmflag = dispersionflag = tip4pflag = dipoleflag = 0;
   compute_flag = 1;
   group_group_enable = 0;
@@ -47,6 +48,8 @@ KSpace::KSpace(LAMMPS *lmp, int narg, char **arg) : Pointers(lmp)
   minorder = 2;
   overlap_allowed = 1;
   fftbench = 0;
+  mixed_flag = 0;
+  fftbatch_flag = 0;
 
   // default to using MPI collectives for FFT/remap only on IBM BlueGene
 
@@ -164,6 +167,14 @@ void KSpace::triclinic_check()
 
 /* ---------------------------------------------------------------------- */
 
+void KSpace::mixed_check()
+{
+  if (mixed_flag && mixed_support != 1)
+    error->all(FLERR,"KSpace style does not support kspace_modify mixed");
+}
+
+/* ---------------------------------------------------------------------- */
+
 void KSpace::compute_dummy(int eflag, int vflag)
 {
   if (eflag || vflag) ev_setup(eflag,vflag);
@@ -507,6 +518,18 @@ void KSpace::modify_params(int narg, char **arg)
       else if (strcmp(arg[iarg+1],"no") == 0) collective_flag = 0;
       else error->all(FLERR,"Illegal kspace_modify command");
       iarg += 2;
+    } else if (strcmp(arg[iarg],"mixed") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal kspace_modify command");
+      if (strcmp(arg[iarg+1],"yes") == 0) mixed_flag = 1;
+      else if (strcmp(arg[iarg+1],"no") == 0) mixed_flag = 0;
+      else error->all(FLERR,"Illegal kspace_modify command");
+      iarg += 2;
+    } else if (strcmp(arg[iarg],"fftbatch") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal kspace_modify command");
+      if (strcmp(arg[iarg+1],"yes") == 0) fftbatch_flag = 1;
+      else if (strcmp(arg[iarg+1],"no") == 0) fftbatch_flag = 0;
+      else error->all(FLERR,"Illegal kspace_modify command");
+      iarg += 2;
     } else if (strcmp(arg[iarg],"diff") == 0) {
       if (iarg+2 > narg) error->all(FLERR,"Illegal kspace_modify command");
       if (strcmp(arg[iarg+1],"ad") == 0) differentiation_flag = 1;
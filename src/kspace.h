@@ -37,6 +37,7 @@ class KSpace : protected Pointers {
   double e2group;                // accumulated group-group energy
   double f2group[3];             // accumulated group-group force
   int triclinic_support;         // 1 if supports triclinic geometries
+  int mixed_support;             // 1 if supports kspace_modify mixed
 
   int ewaldflag;                 // 1 if a Ewald solver
   int pppmflag;                  // 1 if a PPPM solver
@@ -83,6 +84,8 @@ class KSpace : protected Pointers {
   int compute_flag;               // 0 if skip compute()
   int fftbench;                   // 0 if skip FFT timing
   int collective_flag;            // 1 if use MPI collectives for FFT/remap
+  int mixed_flag;                 // 1 if PPPM grid comm in single precision
+  int fftbatch_flag;              // 1 if batch PPPM field FFTs together
   int stagger_flag;               // 1 if using staggered PPPM grids
 
   double splittol;                // tolerance for when to truncate splitting
@@ -90,6 +93,7 @@ class KSpace : protected Pointers {
   KSpace(class LAMMPS *, int, char **);
   virtual ~KSpace();
   void triclinic_check();
+  void mixed_check();
   void modify_params(int, char **);
   void *extract(const char *);
   void compute_dummy(int, int);
@@ -199,6 +203,11 @@ E: KSpace style does not yet support triclinic geometries
 The specified kspace style does not allow for non-orthogonal
 simulation boxes.
 
+E: KSpace style does not support kspace_modify mixed
+
+Single-precision grid communication is only implemented for the pppm
+style and its variants, not for pppm/disp, ewald, ewald/disp or msm.
+
 E: KSpace solver requires a pair style
 
 No pair style is defined.
@@ -23,6 +23,7 @@
 #include "group.h"
 #include "update.h"
 #include "domain.h"
+#include "timer.h"
 #include "memory.h"
 #include "error.h"
 
@@ -33,6 +34,12 @@ using namespace FixConst;
 #define BIG 1.0e20
 #define NEXCEPT 5       // change when add to exceptions in add_fix()
 
+// fix callbacks with a detailed timer
+// rRESPA and minimizer variants are timed as the matching callback
+
+enum{T_INITIAL_INTEGRATE,T_POST_INTEGRATE,T_PRE_EXCHANGE,T_PRE_NEIGHBOR,
+     T_PRE_FORCE,T_POST_FORCE,T_FINAL_INTEGRATE,T_END_OF_STEP,T_N};
+
 /* ---------------------------------------------------------------------- */
 
 Modify::Modify(LAMMPS *lmp) : Pointers(lmp)
@@ -61,6 +68,7 @@ Modify::Modify(LAMMPS *lmp) : Pointers(lmp)
   list_min_energy = NULL;
 
   end_of_step_every = NULL;
+  fixtimer = NULL;
 
   list_timeflag = NULL;
 
@@ -73,6 +81,10 @@ Modify::Modify(LAMMPS *lmp) : Pointers(lmp)
   ncompute = maxcompute = 0;
   compute = NULL;
 
+  maxreduce = maxreduce_value = 0;
+  reduce_offset = NULL;
+  reduce_one = reduce_all = NULL;
+
   // fill map with fixes listed in style_fix.h
 
   fix_map = new std::map<std::string,FixCreator>();
@@ -133,8 +145,13 @@ Modify::~Modify()
   delete [] list_min_energy;
 
   delete [] end_of_step_every;
+  memory->destroy(fixtimer);
   delete [] list_timeflag;
 
+  memory->destroy(reduce_offset);
+  memory->destroy(reduce_one);
+  memory->destroy(reduce_all);
+
   restart_deallocate();
 
   delete compute_map;
@@ -190,6 +207,10 @@ void Modify::init()
 
   for (i = 0; i < nfix; i++) fix[i]->init();
 
+  // register detailed timers for fix callbacks
+
+  timer_init();
+
   // set global flag if any fix has its restart_pbc flag set
 
   restart_pbc_any = 0;
@@ -337,8 +358,12 @@ void Modify::setup_pre_force(int vflag)
 
 void Modify::initial_integrate(int vflag)
 {
-  for (int i = 0; i < n_initial_integrate; i++)
-    fix[list_initial_integrate[i]]->initial_integrate(vflag);
+  for (int i = 0; i < n_initial_integrate; i++) {
+    int ifix = list_initial_integrate[i];
+    timer->sub_start(fixtimer[ifix][T_INITIAL_INTEGRATE]);
+    fix[ifix]->initial_integrate(vflag);
+    timer->sub_stop(fixtimer[ifix][T_INITIAL_INTEGRATE]);
+  }
 }
 
 /* ----------------------------------------------------------------------
@@ -347,8 +372,12 @@ void Modify::initial_integrate(int vflag)
 
 void Modify::post_integrate()
 {
-  for (int i = 0; i < n_post_integrate; i++)
-    fix[list_post_integrate[i]]->post_integrate();
+  for (int i = 0; i < n_post_integrate; i++) {
+    int ifix = list_post_integrate[i];
+    timer->sub_start(fixtimer[ifix][T_POST_INTEGRATE]);
+    fix[ifix]->post_integrate();
+    timer->sub_stop(fixtimer[ifix][T_POST_INTEGRATE]);
+  }
 }
 
 /* ----------------------------------------------------------------------
@@ -357,8 +386,12 @@ void Modify::post_integrate()
 
 void Modify::pre_exchange()
 {
-  for (int i = 0; i < n_pre_exchange; i++)
-    fix[list_pre_exchange[i]]->pre_exchange();
+  for (int i = 0; i < n_pre_exchange; i++) {
+    int ifix = list_pre_exchange[i];
+    timer->sub_start(fixtimer[ifix][T_PRE_EXCHANGE]);
+    fix[ifix]->pre_exchange();
+    timer->sub_stop(fixtimer[ifix][T_PRE_EXCHANGE]);
+  }
 }
 
 /* ----------------------------------------------------------------------
@@ -367,8 +400,12 @@ void Modify::pre_exchange()
 
 void Modify::pre_neighbor()
 {
-  for (int i = 0; i < n_pre_neighbor; i++)
-    fix[list_pre_neighbor[i]]->pre_neighbor();
+  for (int i = 0; i < n_pre_neighbor; i++) {
+    int ifix = list_pre_neighbor[i];
+    timer->sub_start(fixtimer[ifix][T_PRE_NEIGHBOR]);
+    fix[ifix]->pre_neighbor();
+    timer->sub_stop(fixtimer[ifix][T_PRE_NEIGHBOR]);
+  }
 }
 
 /* ----------------------------------------------------------------------
@@ -377,8 +414,12 @@ void Modify::pre_neighbor()
 
 void Modify::pre_force(int vflag)
 {
-  for (int i = 0; i < n_pre_force; i++)
-    fix[list_pre_force[i]]->pre_force(vflag);
+  for (int i = 0; i < n_pre_force; i++) {
+    int ifix = list_pre_force[i];
+    timer->sub_start(fixtimer[ifix][T_PRE_FORCE]);
+    fix[ifix]->pre_force(vflag);
+    timer->sub_stop(fixtimer[ifix][T_PRE_FORCE]);
+  }
 }
 
 /* ----------------------------------------------------------------------
@@ -387,8 +428,12 @@ void Modify::pre_force(int vflag)
 
 void Modify::post_force(int vflag)
 {
-  for (int i = 0; i < n_post_force; i++)
-    fix[list_post_force[i]]->post_force(vflag);
+  for (int i = 0; i < n_post_force; i++) {
+    int ifix = list_post_force[i];
+    timer->sub_start(fixtimer[ifix][T_POST_FORCE]);
+    fix[ifix]->post_force(vflag);
+    timer->sub_stop(fixtimer[ifix][T_POST_FORCE]);
+  }
 }
 
 /* ----------------------------------------------------------------------
@@ -397,8 +442,12 @@ void Modify::post_force(int vflag)
 
 void Modify::final_integrate()
 {
-  for (int i = 0; i < n_final_integrate; i++)
-    fix[list_final_integrate[i]]->final_integrate();
+  for (int i = 0; i < n_final_integrate; i++) {
+    int ifix = list_final_integrate[i];
+    timer->sub_start(fixtimer[ifix][T_FINAL_INTEGRATE]);
+    fix[ifix]->final_integrate();
+    timer->sub_stop(fixtimer[ifix][T_FINAL_INTEGRATE]);
+  }
 }
 
 /* ----------------------------------------------------------------------
@@ -409,8 +458,12 @@ void Modify::final_integrate()
 void Modify::end_of_step()
 {
   for (int i = 0; i < n_end_of_step; i++)
-    if (update->ntimestep % end_of_step_every[i] == 0)
-      fix[list_end_of_step[i]]->end_of_step();
+    if (update->ntimestep % end_of_step_every[i] == 0) {
+      int ifix = list_end_of_step[i];
+      timer->sub_start(fixtimer[ifix][T_END_OF_STEP]);
+      fix[ifix]->end_of_step();
+      timer->sub_stop(fixtimer[ifix][T_END_OF_STEP]);
+    }
 }
 
 /* ----------------------------------------------------------------------
@@ -452,9 +505,12 @@ void Modify::setup_pre_force_respa(int vflag, int ilevel)
 
 void Modify::initial_integrate_respa(int vflag, int ilevel, int iloop)
 {
-  for (int i = 0; i < n_initial_integrate_respa; i++)
-    fix[list_initial_integrate_respa[i]]->
-      initial_integrate_respa(vflag,ilevel,iloop);
+  for (int i = 0; i < n_initial_integrate_respa; i++) {
+    int ifix = list_initial_integrate_respa[i];
+    timer->sub_start(fixtimer[ifix][T_INITIAL_INTEGRATE]);
+    fix[ifix]->initial_integrate_respa(vflag,ilevel,iloop);
+    timer->sub_stop(fixtimer[ifix][T_INITIAL_INTEGRATE]);
+  }
 }
 
 /* ----------------------------------------------------------------------
@@ -463,8 +519,12 @@ void Modify::initial_integrate_respa(int vflag, int ilevel, int iloop)
 
 void Modify::post_integrate_respa(int ilevel, int iloop)
 {
-  for (int i = 0; i < n_post_integrate_respa; i++)
-    fix[list_post_integrate_respa[i]]->post_integrate_respa(ilevel,iloop);
+  for (int i = 0; i < n_post_integrate_respa; i++) {
+    int ifix = list_post_integrate_respa[i];
+    timer->sub_start(fixtimer[ifix][T_POST_INTEGRATE]);
+    fix[ifix]->post_integrate_respa(ilevel,iloop);
+    timer->sub_stop(fixtimer[ifix][T_POST_INTEGRATE]);
+  }
 }
 
 /* ----------------------------------------------------------------------
@@ -473,8 +533,12 @@ void Modify::post_integrate_respa(int ilevel, int iloop)
 
 void Modify::pre_force_respa(int vflag, int ilevel, int iloop)
 {
-  for (int i = 0; i < n_pre_force_respa; i++)
-    fix[list_pre_force_respa[i]]->pre_force_respa(vflag,ilevel,iloop);
+  for (int i = 0; i < n_pre_force_respa; i++) {
+    int ifix = list_pre_force_respa[i];
+    timer->sub_start(fixtimer[ifix][T_PRE_FORCE]);
+    fix[ifix]->pre_force_respa(vflag,ilevel,iloop);
+    timer->sub_stop(fixtimer[ifix][T_PRE_FORCE]);
+  }
 }
 
 /* ----------------------------------------------------------------------
@@ -483,8 +547,12 @@ void Modify::pre_force_respa(int vflag, int ilevel, int iloop)
 
 void Modify::post_force_respa(int vflag, int ilevel, int iloop)
 {
-  for (int i = 0; i < n_post_force_respa; i++)
-    fix[list_post_force_respa[i]]->post_force_respa(vflag,ilevel,iloop);
+  for (int i = 0; i < n_post_force_respa; i++) {
+    int ifix = list_post_force_respa[i];
+    timer->sub_start(fixtimer[ifix][T_POST_FORCE]);
+    fix[ifix]->post_force_respa(vflag,ilevel,iloop);
+    timer->sub_stop(fixtimer[ifix][T_POST_FORCE]);
+  }
 }
 
 /* ----------------------------------------------------------------------
@@ -493,8 +561,12 @@ void Modify::post_force_respa(int vflag, int ilevel, int iloop)
 
 void Modify::final_integrate_respa(int ilevel, int iloop)
 {
-  for (int i = 0; i < n_final_integrate_respa; i++)
-    fix[list_final_integrate_respa[i]]->final_integrate_respa(ilevel,iloop);
+  for (int i = 0; i < n_final_integrate_respa; i++) {
+    int ifix = list_final_integrate_respa[i];
+    timer->sub_start(fixtimer[ifix][T_FINAL_INTEGRATE]);
+    fix[ifix]->final_integrate_respa(ilevel,iloop);
+    timer->sub_stop(fixtimer[ifix][T_FINAL_INTEGRATE]);
+  }
 }
 
 /* ----------------------------------------------------------------------
@@ -503,8 +575,12 @@ void Modify::final_integrate_respa(int ilevel, int iloop)
 
 void Modify::min_pre_exchange()
 {
-  for (int i = 0; i < n_min_pre_exchange; i++)
-    fix[list_min_pre_exchange[i]]->min_pre_exchange();
+  for (int i = 0; i < n_min_pre_exchange; i++) {
+    int ifix = list_min_pre_exchange[i];
+    timer->sub_start(fixtimer[ifix][T_PRE_EXCHANGE]);
+    fix[ifix]->min_pre_exchange();
+    timer->sub_stop(fixtimer[ifix][T_PRE_EXCHANGE]);
+  }
 }
 
 /* ----------------------------------------------------------------------
@@ -513,8 +589,12 @@ void Modify::min_pre_exchange()
 
 void Modify::min_pre_neighbor()
 {
-  for (int i = 0; i < n_min_pre_neighbor; i++)
-    fix[list_min_pre_neighbor[i]]->min_pre_neighbor();
+  for (int i = 0; i < n_min_pre_neighbor; i++) {
+    int ifix = list_min_pre_neighbor[i];
+    timer->sub_start(fixtimer[ifix][T_PRE_NEIGHBOR]);
+    fix[ifix]->min_pre_neighbor();
+    timer->sub_stop(fixtimer[ifix][T_PRE_NEIGHBOR]);
+  }
 }
 
 /* ----------------------------------------------------------------------
@@ -523,8 +603,12 @@ void Modify::min_pre_neighbor()
 
 void Modify::min_pre_force(int vflag)
 {
-  for (int i = 0; i < n_min_pre_force; i++)
-    fix[list_min_pre_force[i]]->min_pre_force(vflag);
+  for (int i = 0; i < n_min_pre_force; i++) {
+    int ifix = list_min_pre_force[i];
+    timer->sub_start(fixtimer[ifix][T_PRE_FORCE]);
+    fix[ifix]->min_pre_force(vflag);
+    timer->sub_stop(fixtimer[ifix][T_PRE_FORCE]);
+  }
 }
 
 /* ----------------------------------------------------------------------
@@ -533,8 +617,12 @@ void Modify::min_pre_force(int vflag)
 
 void Modify::min_post_force(int vflag)
 {
-  for (int i = 0; i < n_min_post_force; i++)
-    fix[list_min_post_force[i]]->min_post_force(vflag);
+  for (int i = 0; i < n_min_post_force; i++) {
+    int ifix = list_min_post_force[i];
+    timer->sub_start(fixtimer[ifix][T_POST_FORCE]);
+    fix[ifix]->min_post_force(vflag);
+    timer->sub_stop(fixtimer[ifix][T_POST_FORCE]);
+  }
 }
 
 /* ----------------------------------------------------------------------
@@ -727,6 +815,7 @@ void Modify::add_fix(int narg, char **arg, int trysuffix)
       maxfix += DELTA;
       fix = (Fix **) memory->srealloc(fix,maxfix*sizeof(Fix *),"modify:fix");
       memory->grow(fmask,maxfix,"modify:fmask");
+      memory->grow(fixtimer,maxfix,T_N,"modify:fixtimer");
     }
   }
 
@@ -799,8 +888,11 @@ void Modify::add_fix(int narg, char **arg, int trysuffix)
   // nfix increment comes first so that recursive call to add_fix within
   //   post_constructor() will see updated nfix
 
+  // new Fix has no detailed timers until next init()
+
   if (newflag) nfix++;
   fmask[ifix] = fix[ifix]->setmask();
+  for (int m = 0; m < T_N; m++) fixtimer[ifix][m] = -1;
   fix[ifix]->post_constructor();
 }
 
@@ -844,10 +936,12 @@ void Modify::delete_fix(const char *id)
   delete fix[ifix];
   atom->update_callback(ifix);
 
-  // move other Fixes and fmask down in list one slot
+  // move other Fixes, fmask, and fixtimer down in list one slot
 
   for (int i = ifix+1; i < nfix; i++) fix[i-1] = fix[i];
   for (int i = ifix+1; i < nfix; i++) fmask[i-1] = fmask[i];
+  for (int i = ifix+1; i < nfix; i++)
+    for (int m = 0; m < T_N; m++) fixtimer[i-1][m] = fixtimer[i][m];
   nfix--;
 }
 
@@ -1033,6 +1127,61 @@ void Modify::addstep_compute_all(bigint newstep)
     if (compute[icompute]->timeflag) compute[icompute]->addstep(newstep);
 }
 
+/* ----------------------------------------------------------------------
+   invoke compute_scalar() (flag = 0) or compute_vector() (flag = 1)
+     of each of N computes in list
+   local values of all computes that can split them off via pack_reduce()
+     are summed across procs with a single MPI_Allreduce(),
+     other computes are invoked as usual
+   temperature computes are finished first, since others such as
+     compute pressure use their current result if it was computed this step
+   must be called by all procs with the same list
+------------------------------------------------------------------------- */
+
+void Modify::reduce_compute(int n, Compute **list, int *flag)
+{
+  int i,pass;
+
+  if (n > maxreduce) {
+    maxreduce = n;
+    memory->destroy(reduce_offset);
+    memory->create(reduce_offset,maxreduce,"modify:reduce_offset");
+  }
+
+  int nvalues = 0;
+  for (i = 0; i < n; i++) {
+    int m = list[i]->size_reduce(flag[i]);
+    if (m > 0) {
+      reduce_offset[i] = nvalues;
+      nvalues += m;
+    } else reduce_offset[i] = -1;
+  }
+
+  if (nvalues > maxreduce_value) {
+    maxreduce_value = nvalues;
+    memory->destroy(reduce_one);
+    memory->destroy(reduce_all);
+    memory->create(reduce_one,maxreduce_value,"modify:reduce_one");
+    memory->create(reduce_all,maxreduce_value,"modify:reduce_all");
+  }
+
+  for (i = 0; i < n; i++)
+    if (reduce_offset[i] >= 0)
+      list[i]->pack_reduce(flag[i],&reduce_one[reduce_offset[i]]);
+
+  if (nvalues)
+    MPI_Allreduce(reduce_one,reduce_all,nvalues,MPI_DOUBLE,MPI_SUM,world);
+
+  for (pass = 0; pass < 2; pass++)
+    for (i = 0; i < n; i++) {
+      if (list[i]->tempflag != (pass == 0)) continue;
+      if (reduce_offset[i] >= 0)
+        list[i]->unpack_reduce(flag[i],&reduce_all[reduce_offset[i]]);
+      else if (flag[i]) list[i]->compute_vector();
+      else list[i]->compute_scalar();
+    }
+}
+
 /* ----------------------------------------------------------------------
    write to restart file for all Fixes with restart info
    (1) fixes that have global state
@@ -1262,6 +1411,41 @@ void Modify::list_init_thermo_energy(int mask, int &n, int *&list)
     if (fmask[i] & mask && fix[i]->thermo_energy) list[n++] = i;
 }
 
+/* ----------------------------------------------------------------------
+   register a detailed timer for each callback of each fix
+   callback timer is -1 if fix does not use it or timer full is not set
+------------------------------------------------------------------------- */
+
+void Modify::timer_init()
+{
+  static const char *names[T_N] =
+    {"initial_integrate","post_integrate","pre_exchange","pre_neighbor",
+     "pre_force","post_force","final_integrate","end_of_step"};
+  const int masks[T_N] =
+    {INITIAL_INTEGRATE | INITIAL_INTEGRATE_RESPA,
+     POST_INTEGRATE | POST_INTEGRATE_RESPA,
+     PRE_EXCHANGE | MIN_PRE_EXCHANGE,
+     PRE_NEIGHBOR | MIN_PRE_NEIGHBOR,
+     PRE_FORCE | PRE_FORCE_RESPA | MIN_PRE_FORCE,
+     POST_FORCE | POST_FORCE_RESPA | MIN_POST_FORCE,
+     FINAL_INTEGRATE | FINAL_INTEGRATE_RESPA,
+     END_OF_STEP};
+
+  int root = timer->add("Modify");
+
+  for (int i = 0; i < nfix; i++) {
+    int n = strlen(fix[i]->id) + strlen(fix[i]->style) + 8;
+    char *name = new char[n];
+    sprintf(name,"fix %s %s",fix[i]->id,fix[i]->style);
+    int parent = timer->add(name,root);
+    delete [] name;
+    for (int m = 0; m < T_N; m++) {
+      if (fmask[i] & masks[m]) fixtimer[i][m] = timer->add(names[m],parent);
+      else fixtimer[i][m] = -1;
+    }
+  }
+}
+
 /* ----------------------------------------------------------------------
    create list of compute indices for computes which store invocation times
 ------------------------------------------------------------------------- */
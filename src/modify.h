@@ -96,6 +96,7 @@ class Modify : protected Pointers {
   void clearstep_compute();
   void addstep_compute(bigint);
   void addstep_compute_all(bigint);
+  void reduce_compute(int, class Compute **, int *);
 
   void write_restart(FILE *);
   int read_restart(FILE *);
@@ -120,9 +121,17 @@ class Modify : protected Pointers {
 
   int *end_of_step_every;
 
+  int **fixtimer;            // detailed timer index of each fix callback
+
   int n_timeflag;            // list of computes that store time invocation
   int *list_timeflag;
 
+  int maxreduce;             // size of reduce_offset
+  int *reduce_offset;        // offset of each compute in reduce buffers
+  int maxreduce_value;       // size of reduce buffers
+  double *reduce_one;        // local values of computes in reduce_compute()
+  double *reduce_all;        // reduce_one summed across procs
+
   char **id_restart_global;           // stored fix global info
   char **style_restart_global;        // from read-in restart file
   char **state_restart_global;
@@ -137,6 +146,7 @@ class Modify : protected Pointers {
   void list_init_end_of_step(int, int &, int *&);
   void list_init_thermo_energy(int, int &, int *&);
   void list_init_compute();
+  void timer_init();
 
  private:
   typedef Compute *(*ComputeCreator)(LAMMPS *, int, char **);
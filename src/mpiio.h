@@ -24,6 +24,7 @@
 #endif
 
 #include "restart_mpiio.h"
+#include "read_data_mpiio.h"
 
 #else
 
@@ -42,6 +43,19 @@ class RestartMPIIO {
   void openForWrite(char *) {}
   void write(MPI_Offset,int,double *) {}
   void read(MPI_Offset,long,double *) {}
+  void read_chunks(MPI_Offset,int,MPI_Offset *,int *,double *) {}
+  void close() {}
+};
+
+class ReadDataMPIIO {
+ public:
+  int mpiio_exists;
+
+  ReadDataMPIIO(class LAMMPS *) {mpiio_exists = 0;}
+  ~ReadDataMPIIO() {}
+  void openForRead(char *) {}
+  bigint read_lines(bigint, bigint, int, int, int &, char *&, bigint &)
+    {return 0;}
   void close() {}
 };
 
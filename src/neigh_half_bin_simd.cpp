@@ -0,0 +1,387 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#include "neighbor.h"
+#include "neigh_list.h"
+#include "atom.h"
+#include "atom_vec.h"
+#include "molecule.h"
+#include "domain.h"
+#include "memory.h"
+#include "my_page.h"
+#include "error.h"
+
+using namespace LAMMPS_NS;
+
+// distance tests over contiguous bin slices are vectorized by the compiler
+// explicitly requested via OpenMP 4.0 SIMD pragma when available
+
+#if defined(_OPENMP) && (_OPENMP >= 201307)
+#define NEIGH_SIMD _Pragma("omp simd")
+#else
+#define NEIGH_SIMD
+#endif
+
+/* ----------------------------------------------------------------------
+   copy binned atoms into bin-sorted SoA arrays
+   atoms in each bin are stored contiguously, in linked-list order
+   binstart[ibin] = first slot of bin ibin, binstart[mbins] = # of slots
+   binpos[i] = slot of atom I, binof[i] = bin of atom I
+   coords are re-copied on every call, so occasional lists built
+     with binatomflag = 0 see current coords in last binning order
+------------------------------------------------------------------------- */
+
+void Neighbor::bin_atoms_soa()
+{
+  int i,ibin,n,count;
+
+  double **x = atom->x;
+  int *type = atom->type;
+
+  if (mbins+1 > maxbinstart) {
+    maxbinstart = mbins+1;
+    memory->destroy(binstart);
+    memory->create(binstart,maxbinstart,"neigh:binstart");
+  }
+
+  if (atom->nmax > maxsoa) {
+    maxsoa = atom->nmax;
+    memory->destroy(xsoa);
+    memory->destroy(typesoa);
+    memory->destroy(idsoa);
+    memory->destroy(binpos);
+    memory->destroy(binof);
+    memory->create(xsoa,3*maxsoa,"neigh:xsoa");
+    memory->create(typesoa,maxsoa,"neigh:typesoa");
+    memory->create(idsoa,maxsoa,"neigh:idsoa");
+    memory->create(binpos,maxsoa,"neigh:binpos");
+    memory->create(binof,maxsoa,"neigh:binof");
+  }
+
+  double *xs = xsoa;
+  double *ys = &xsoa[maxsoa];
+  double *zs = &xsoa[2*maxsoa];
+
+  n = 0;
+  int maxcount = 0;
+
+  for (ibin = 0; ibin < mbins; ibin++) {
+    binstart[ibin] = n;
+    for (i = binhead[ibin]; i >= 0; i = bins[i]) {
+      binpos[i] = n;
+      binof[i] = ibin;
+      xs[n] = x[i][0];
+      ys[n] = x[i][1];
+      zs[n] = x[i][2];
+      typesoa[n] = type[i];
+      idsoa[n] = i;
+      n++;
+    }
+    count = n - binstart[ibin];
+    if (count > maxcount) maxcount = count;
+  }
+  binstart[mbins] = n;
+
+  if (maxcount > maxsimdflag) {
+    maxsimdflag = maxcount;
+    memory->destroy(simdflag);
+    memory->create(simdflag,maxsimdflag,"neigh:simdflag");
+  }
+}
+
+/* ----------------------------------------------------------------------
+   binned neighbor list construction with partial Newton's 3rd law
+   same list as half_bin_no_newton(), built from SoA bin copies
+   distance test for all atoms in a stencil bin done as one SIMD loop
+------------------------------------------------------------------------- */
+
+void Neighbor::half_bin_no_newton_simd(NeighList *list)
+{
+  int i,j,k,m,n,itype,jtype,ibin,jbin,which,moltemplate;
+  int imol = 0, iatom = 0;
+  int jfirst,jlast,ncount;
+  tagint tagprev = 0;
+  double xtmp,ytmp,ztmp,delx,dely,delz;
+  double *cutsqi;
+  int *neighptr;
+
+  // bin local & ghost atoms, then copy bins into SoA arrays
+
+  if (binatomflag) bin_atoms();
+  bin_atoms_soa();
+
+  double **x = atom->x;
+  int *type = atom->type;
+  int *mask = atom->mask;
+  tagint *tag = atom->tag;
+  tagint *molecule = atom->molecule;
+  tagint **special = atom->special;
+  int **nspecial = atom->nspecial;
+  int nlocal = atom->nlocal;
+  if (includegroup) nlocal = atom->nfirst;
+
+  int *molindex = atom->molindex;
+  int *molatom = atom->molatom;
+  Molecule **onemols = atom->avec->onemols;
+  int molecular = atom->molecular;
+  if (molecular == 2) moltemplate = 1;
+  else moltemplate = 0;
+
+  const double * const xs = xsoa;
+  const double * const ys = &xsoa[maxsoa];
+  const double * const zs = &xsoa[2*maxsoa];
+  const int * const ts = typesoa;
+  const int * const js = idsoa;
+  int * const flag = simdflag;
+
+  int *ilist = list->ilist;
+  int *numneigh = list->numneigh;
+  int **firstneigh = list->firstneigh;
+  int nstencil = list->nstencil;
+  int *stencil = list->stencil;
+  MyPage<int> *ipage = list->ipage;
+
+  int inum = 0;
+  ipage->reset();
+
+  // loop over each atom, storing neighbors
+
+  for (i = 0; i < nlocal; i++) {
+    n = 0;
+    neighptr = ipage->vget();
+
+    itype = type[i];
+    cutsqi = cutneighsq[itype];
+    xtmp = x[i][0];
+    ytmp = x[i][1];
+    ztmp = x[i][2];
+    if (moltemplate) {
+      imol = molindex[i];
+      iatom = molatom[i];
+      tagprev = tag[i] - iatom - 1;
+    }
+
+    // loop over all atoms in other bins in stencil including self
+    // only store pair if i < j
+    // flag = 1 for each j in bin within cutoff, computed as one SIMD loop
+    // remaining exclusion and special tests done only on flagged atoms
+
+    ibin = coord2bin(x[i]);
+
+    for (k = 0; k < nstencil; k++) {
+      jbin = ibin + stencil[k];
+      jfirst = binstart[jbin];
+      jlast = binstart[jbin+1];
+      ncount = jlast - jfirst;
+
+      NEIGH_SIMD
+      for (m = 0; m < ncount; m++) {
+        const double dx = xtmp - xs[jfirst+m];
+        const double dy = ytmp - ys[jfirst+m];
+        const double dz = ztmp - zs[jfirst+m];
+        const double r2 = dx*dx + dy*dy + dz*dz;
+        flag[m] = (r2 <= cutsqi[ts[jfirst+m]]) & (js[jfirst+m] > i);
+      }
+
+      for (m = 0; m < ncount; m++) {
+        if (!flag[m]) continue;
+        j = js[jfirst+m];
+
+        jtype = type[j];
+        if (exclude && exclusion(i,j,itype,jtype,mask,molecule)) continue;
+
+        if (molecular) {
+          delx = xtmp - x[j][0];
+          dely = ytmp - x[j][1];
+          delz = ztmp - x[j][2];
+          if (!moltemplate)
+            which = find_special(special[i],nspecial[i],tag[j]);
+          else if (imol >= 0)
+            which = find_special(onemols[imol]->special[iatom],
+                                 onemols[imol]->nspecial[iatom],
+                                 tag[j]-tagprev);
+          else which = 0;
+          if (which == 0) neighptr[n++] = j;
+          else if (domain->minimum_image_check(delx,dely,delz))
+            neighptr[n++] = j;
+          else if (which > 0) neighptr[n++] = j ^ (which << SBBITS);
+        } else neighptr[n++] = j;
+      }
+    }
+
+    ilist[inum++] = i;
+    firstneigh[i] = neighptr;
+    numneigh[i] = n;
+    ipage->vgot(n);
+    if (ipage->status())
+      error->one(FLERR,"Neighbor list overflow, boost neigh_modify one");
+  }
+
+  list->inum = inum;
+}
+
+/* ----------------------------------------------------------------------
+   binned neighbor list construction with full Newton's 3rd law
+   same list as half_bin_newton(), built from SoA bin copies
+   distance test for all atoms in a stencil bin done as one SIMD loop
+------------------------------------------------------------------------- */
+
+void Neighbor::half_bin_newton_simd(NeighList *list)
+{
+  int i,j,k,m,n,itype,jtype,ibin,jbin,which,moltemplate;
+  int imol = 0, iatom = 0;
+  int jfirst,jlast,ncount;
+  tagint tagprev = 0;
+  double xtmp,ytmp,ztmp,delx,dely,delz;
+  double *cutsqi;
+  int *neighptr;
+
+  // bin local & ghost atoms, then copy bins into SoA arrays
+
+  if (binatomflag) bin_atoms();
+  bin_atoms_soa();
+
+  double **x = atom->x;
+  int *type = atom->type;
+  int *mask = atom->mask;
+  tagint *tag = atom->tag;
+  tagint *molecule = atom->molecule;
+  tagint **special = atom->special;
+  int **nspecial = atom->nspecial;
+  int nlocal = atom->nlocal;
+  if (includegroup) nlocal = atom->nfirst;
+
+  int *molindex = atom->molindex;
+  int *molatom = atom->molatom;
+  Molecule **onemols = atom->avec->onemols;
+  int molecular = atom->molecular;
+  if (molecular == 2) moltemplate = 1;
+  else moltemplate = 0;
+
+  const double * const xs = xsoa;
+  const double * const ys = &xsoa[maxsoa];
+  const double * const zs = &xsoa[2*maxsoa];
+  const int * const ts = typesoa;
+  const int * const js = idsoa;
+  int * const flag = simdflag;
+
+  int *ilist = list->ilist;
+  int *numneigh = list->numneigh;
+  int **firstneigh = list->firstneigh;
+  int nstencil = list->nstencil;
+  int *stencil = list->stencil;
+  MyPage<int> *ipage = list->ipage;
+
+  int inum = 0;
+  ipage->reset();
+
+  // loop over each atom, storing neighbors
+  // k = -1 is rest of atoms in i's bin, k >= 0 is other bins in stencil
+
+  for (i = 0; i < nlocal; i++) {
+    n = 0;
+    neighptr = ipage->vget();
+
+    itype = type[i];
+    cutsqi = cutneighsq[itype];
+    xtmp = x[i][0];
+    ytmp = x[i][1];
+    ztmp = x[i][2];
+    if (moltemplate) {
+      imol = molindex[i];
+      iatom = molatom[i];
+      tagprev = tag[i] - iatom - 1;
+    }
+
+    ibin = coord2bin(x[i]);
+
+    for (k = -1; k < nstencil; k++) {
+
+      // rest of atoms in i's bin, ghosts are at end of bin
+      // if j is owned atom, store it, since j is beyond i in bin
+      // if j is ghost, only store if j coords are "above and to the right" of i
+
+      if (k < 0) {
+        jfirst = binpos[i] + 1;
+        jlast = binstart[binof[i]+1];
+        ncount = jlast - jfirst;
+
+        NEIGH_SIMD
+        for (m = 0; m < ncount; m++) {
+          const double xj = xs[jfirst+m];
+          const double yj = ys[jfirst+m];
+          const double zj = zs[jfirst+m];
+          const double dx = xtmp - xj;
+          const double dy = ytmp - yj;
+          const double dz = ztmp - zj;
+          const double r2 = dx*dx + dy*dy + dz*dz;
+          const int above = (zj > ztmp) |
+            ((zj == ztmp) & ((yj > ytmp) | ((yj == ytmp) & (xj >= xtmp))));
+          flag[m] = (r2 <= cutsqi[ts[jfirst+m]]) &
+            ((js[jfirst+m] < nlocal) | above);
+        }
+
+      // all atoms in other bins in stencil, store every pair
+
+      } else {
+        jbin = ibin + stencil[k];
+        jfirst = binstart[jbin];
+        jlast = binstart[jbin+1];
+        ncount = jlast - jfirst;
+
+        NEIGH_SIMD
+        for (m = 0; m < ncount; m++) {
+          const double dx = xtmp - xs[jfirst+m];
+          const double dy = ytmp - ys[jfirst+m];
+          const double dz = ztmp - zs[jfirst+m];
+          const double r2 = dx*dx + dy*dy + dz*dz;
+          flag[m] = (r2 <= cutsqi[ts[jfirst+m]]);
+        }
+      }
+
+      for (m = 0; m < ncount; m++) {
+        if (!flag[m]) continue;
+        j = js[jfirst+m];
+
+        jtype = type[j];
+        if (exclude && exclusion(i,j,itype,jtype,mask,molecule)) continue;
+
+        if (molecular) {
+          delx = xtmp - x[j][0];
+          dely = ytmp - x[j][1];
+          delz = ztmp - x[j][2];
+          if (!moltemplate)
+            which = find_special(special[i],nspecial[i],tag[j]);
+          else if (imol >= 0)
+            which = find_special(onemols[imol]->special[iatom],
+                                 onemols[imol]->nspecial[iatom],
+                                 tag[j]-tagprev);
+          else which = 0;
+          if (which == 0) neighptr[n++] = j;
+          else if (domain->minimum_image_check(delx,dely,delz))
+            neighptr[n++] = j;
+          else if (which > 0) neighptr[n++] = j ^ (which << SBBITS);
+        } else neighptr[n++] = j;
+      }
+    }
+
+    ilist[inum++] = i;
+    firstneigh[i] = neighptr;
+    numneigh[i] = n;
+    ipage->vgot(n);
+    if (ipage->status())
+      error->one(FLERR,"Neighbor list overflow, boost neigh_modify one");
+  }
+
+  list->inum = inum;
+}
@@ -35,6 +35,7 @@ NeighList::NeighList(LAMMPS *lmp) :
   maxatoms = 0;
 
   inum = gnum = 0;
+  inum_interior = 0;
   ilist = NULL;
   numneigh = NULL;
   firstneigh = NULL;
@@ -47,6 +48,9 @@ NeighList::NeighList(LAMMPS *lmp) :
   iskip = NULL;
   ijskip = NULL;
 
+  maxboundary = 0;
+  iboundary = NULL;
+
   listgranhistory = NULL;
   fix_history = NULL;
 
@@ -86,6 +90,7 @@ NeighList::~NeighList()
 
   delete [] iskip;
   memory->destroy(ijskip);
+  memory->destroy(iboundary);
 
   if (maxstencil) memory->destroy(stencil);
   if (ghostflag) memory->destroy(stencilxyz);
@@ -151,6 +156,51 @@ void NeighList::grow(int nmax)
                                               "neighlist:firstdouble");
 }
 
+/* ----------------------------------------------------------------------
+   reorder ilist so that interior atoms come first, set inum_interior
+   interior atom = owned atom whose neighbors are all owned atoms
+   forces on interior atoms can thus be computed before ghost coords
+     are updated by forward comm, see Pair::compute_interior()
+   relative order within interior and boundary atoms is preserved
+------------------------------------------------------------------------- */
+
+void NeighList::split_interior()
+{
+  int i,j,ii,jj,jnum,boundary;
+  int *jlist;
+
+  if (inum > maxboundary) {
+    maxboundary = MAX(inum,maxatoms);
+    memory->destroy(iboundary);
+    memory->create(iboundary,maxboundary,"neighlist:iboundary");
+  }
+
+  int nlocal = atom->nlocal;
+  int ninterior = 0;
+  int nboundary = 0;
+
+  for (ii = 0; ii < inum; ii++) {
+    i = ilist[ii];
+    jlist = firstneigh[i];
+    jnum = numneigh[i];
+
+    boundary = 0;
+    for (jj = 0; jj < jnum; jj++) {
+      j = jlist[jj] & NEIGHMASK;
+      if (j >= nlocal) {
+        boundary = 1;
+        break;
+      }
+    }
+
+    if (boundary) iboundary[nboundary++] = i;
+    else ilist[ninterior++] = i;
+  }
+
+  for (ii = 0; ii < nboundary; ii++) ilist[ninterior+ii] = iboundary[ii];
+  inum_interior = ninterior;
+}
+
 /* ----------------------------------------------------------------------
    insure stencils are large enough for smax bins
    style = BIN or MULTI
@@ -34,6 +34,7 @@ class NeighList : protected Pointers {
 
   int inum;                        // # of I atoms neighbors are stored for
   int gnum;                        // # of ghost atoms neighbors are stored for
+  int inum_interior;               // # of leading I atoms w/out ghost neighs
   int *ilist;                      // local indices of I atoms
   int *numneigh;                   // # of J neighbors for each I atom
   int **firstneigh;                // ptr to 1st J int value of each I atom
@@ -85,12 +86,15 @@ class NeighList : protected Pointers {
   void grow(int);                       // grow maxlocal
   void stencil_allocate(int, int);      // allocate stencil arrays
   void copy_skip_info(int *, int **);   // copy skip info from a neigh request
+  void split_interior();                // order interior I atoms first
   void print_attributes();              // debug routine
   int get_maxlocal() {return maxatoms;}
   bigint memory_usage();
 
  protected:
   int maxatoms;                    // size of allocated atom arrays
+  int maxboundary;                 // size of iboundary
+  int *iboundary;                  // scratch list for split_interior()
 };
 
 }
@@ -80,10 +80,12 @@ Neighbor::Neighbor(LAMMPS *lmp) : Pointers(lmp)
   pgsize = 100000;
   oneatom = 2000;
   binsizeflag = 0;
+  simd = 0;
   build_once = 0;
   cluster_check = 0;
   binatomflag = 1;
 
+  cutneighmax = 0.0;
   cutneighsq = NULL;
   cutneighghostsq = NULL;
   cuttype = NULL;
@@ -103,6 +105,14 @@ Neighbor::Neighbor(LAMMPS *lmp) : Pointers(lmp)
   maxbin = 0;
   bins = NULL;
 
+  binstart = NULL;
+  maxbinstart = 0;
+  xsoa = NULL;
+  typesoa = idsoa = binpos = binof = NULL;
+  maxsoa = 0;
+  simdflag = NULL;
+  maxsimdflag = 0;
+
   // pair exclusion list info
 
   includegroup = 0;
@@ -166,6 +176,14 @@ Neighbor::~Neighbor()
   memory->destroy(binhead);
   memory->destroy(bins);
 
+  memory->destroy(binstart);
+  memory->destroy(xsoa);
+  memory->destroy(typesoa);
+  memory->destroy(idsoa);
+  memory->destroy(binpos);
+  memory->destroy(binof);
+  memory->destroy(simdflag);
+
   memory->destroy(ex1_type);
   memory->destroy(ex2_type);
   memory->destroy(ex_type);
@@ -1063,6 +1081,15 @@ void Neighbor::choose_build(int index, NeighRequest *rq)
         error->all(FLERR,"Neighbor multi not yet enabled for rRESPA");
     }
 
+    // SIMD versions of half/bin builds, if requested
+
+    if (simd) {
+      if (pb == &Neighbor::half_bin_no_newton)
+        pb = &Neighbor::half_bin_no_newton_simd;
+      else if (pb == &Neighbor::half_bin_newton)
+        pb = &Neighbor::half_bin_newton_simd;
+    }
+
   // OMP versions of build methods
 
   } else {
@@ -1837,6 +1864,12 @@ void Neighbor::modify_params(int narg, char **arg)
       else if (strcmp(arg[iarg+1],"no") == 0) cluster_check = 0;
       else error->all(FLERR,"Illegal neigh_modify command");
       iarg += 2;
+    } else if (strcmp(arg[iarg],"simd") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal neigh_modify command");
+      if (strcmp(arg[iarg+1],"yes") == 0) simd = 1;
+      else if (strcmp(arg[iarg+1],"no") == 0) simd = 0;
+      else error->all(FLERR,"Illegal neigh_modify command");
+      iarg += 2;
 
     } else if (strcmp(arg[iarg],"include") == 0) {
       if (iarg+2 > narg) error->all(FLERR,"Illegal neigh_modify command");
@@ -2064,6 +2097,10 @@ bigint Neighbor::memory_usage()
   if (style != NSQ) {
     bytes += memory->usage(bins,maxbin);
     bytes += memory->usage(binhead,maxhead);
+    bytes += memory->usage(binstart,maxbinstart);
+    bytes += memory->usage(xsoa,3*maxsoa);
+    bytes += 4*memory->usage(typesoa,maxsoa);
+    bytes += memory->usage(simdflag,maxsimdflag);
   }
 
   for (int i = 0; i < nrequest; i++) 
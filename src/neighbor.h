@@ -39,6 +39,7 @@ class Neighbor : protected Pointers {
   double *cuttype;                 // for each type, max neigh cut w/ others
 
   int binsizeflag;                 // user-chosen bin size
+  int simd;                        // 1 if SIMD half/bin builds requested
   double binsize_user;             // set externally by some accelerator pkgs
 
   bigint ncalls;                   // # of times build has been called
@@ -129,6 +130,17 @@ class Neighbor : protected Pointers {
 
   int sx,sy,sz,smax;               // bin stencil extents
 
+  int *binstart;                   // 1st SoA slot of each bin, for SIMD builds
+  int maxbinstart;                 // size of binstart array
+  double *xsoa;                    // bin-sorted x,y,z coords as 3 SoA blocks
+  int *typesoa;                    // bin-sorted atom types
+  int *idsoa;                      // bin-sorted local atom indices
+  int *binpos;                     // SoA slot of each atom
+  int *binof;                      // bin of each atom
+  int maxsoa;                      // size of per-atom SoA arrays
+  int *simdflag;                   // within-cutoff flags for one bin
+  int maxsimdflag;                 // size of simdflag array
+
   int dimension;                   // 2/3 for 2d/3d
   int triclinic;                   // 0 if domain is orthog, 1 if triclinic
   int newton_pair;                 // 0 if newton off, 1 if on for pairwise
@@ -169,6 +181,7 @@ class Neighbor : protected Pointers {
   int *slist;                  // lists to grow stencil arrays every reneigh
 
   void bin_atoms();                     // bin all atoms
+  void bin_atoms_soa();                 // copy binned atoms into SoA arrays
   double bin_distance(int, int, int);   // distance between binx
   int coord2bin(double *);              // mapping atom coord to a bin
   int coord2bin(double *, int &, int &, int&); // ditto
@@ -202,6 +215,8 @@ class Neighbor : protected Pointers {
   void half_bin_no_newton_ghost(class NeighList *);
   void half_bin_newton(class NeighList *);
   void half_bin_newton_tri(class NeighList *);
+  void half_bin_no_newton_simd(class NeighList *);
+  void half_bin_newton_simd(class NeighList *);
 
   void half_multi_no_newton(class NeighList *);
   void half_multi_newton(class NeighList *);
@@ -107,7 +107,10 @@ Output::~Output()
   for (int i = 0; i < ndump; i++) delete [] var_dump[i];
   memory->sfree(var_dump);
   memory->destroy(ivar_dump);
-  for (int i = 0; i < ndump; i++) delete dump[i];
+  for (int i = 0; i < ndump; i++) {
+    dump[i]->async_wait();
+    delete dump[i];
+  }
   memory->sfree(dump);
 
   delete [] restart1;
@@ -611,6 +614,9 @@ void Output::delete_dump(char *id)
     if (strcmp(id,dump[idump]->id) == 0) break;
   if (idump == ndump) error->all(FLERR,"Could not find undump ID");
 
+  // background I/O thread must be idle before derived dump data is freed
+
+  dump[idump]->async_wait();
   delete dump[idump];
   delete [] var_dump[idump];
 
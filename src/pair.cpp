@@ -61,6 +61,8 @@ Pair::Pair(LAMMPS *lmp) : Pointers(lmp)
   no_virial_fdotr_compute = 0;
   writedata = 0;
   ghostneigh = 0;
+  overlap_enable = 0;
+  ev_accumulate = 0;
 
   nextra = 0;
   pvector = NULL;
@@ -672,6 +674,44 @@ void Pair::compute_dummy(int eflag, int vflag)
   else evflag = 0;
 }
 
+/* ----------------------------------------------------------------------
+   compute interactions of interior atoms, which have no ghost neighbors
+   can be invoked while forward comm of ghost atom coords is in progress
+   list->split_interior() must have been called after last reneighboring
+   global virial via F dot r is deferred to compute_boundary(),
+     since it needs ghost atom coords
+------------------------------------------------------------------------- */
+
+void Pair::compute_interior(int eflag, int vflag)
+{
+  if (vflag % 4 == 2 && no_virial_fdotr_compute == 0) vflag -= 2;
+
+  int inum = list->inum;
+  list->inum = list->inum_interior;
+  compute(eflag,vflag);
+  list->inum = inum;
+}
+
+/* ----------------------------------------------------------------------
+   compute interactions of remaining boundary atoms, after forward comm
+   energy and virial tallies from compute_interior() are kept
+------------------------------------------------------------------------- */
+
+void Pair::compute_boundary(int eflag, int vflag)
+{
+  int inum = list->inum;
+  int *ilist = list->ilist;
+  list->inum = inum - list->inum_interior;
+  list->ilist = &ilist[list->inum_interior];
+
+  ev_accumulate = 1;
+  compute(eflag,vflag);
+  ev_accumulate = 0;
+
+  list->inum = inum;
+  list->ilist = ilist;
+}
+
 /* ----------------------------------------------------------------------
    setup for energy, virial computation
    see integrate::ev_set() for values of eflag (0-3) and vflag (0-6)
@@ -707,15 +747,21 @@ void Pair::ev_setup(int eflag, int vflag)
   // zero accumulators
   // use force->newton instead of newton_pair
   //   b/c some bonds/dihedrals call pair::ev_tally with pairwise info
+  // skip if ev_accumulate is set by compute_boundary()
 
-  if (eflag_global) eng_vdwl = eng_coul = 0.0;
-  if (vflag_global) for (i = 0; i < 6; i++) virial[i] = 0.0;
-  if (eflag_atom) {
+  if (ev_accumulate) {
+    if (vflag_global == 2 && no_virial_fdotr_compute == 0)
+      for (i = 0; i < 6; i++) virial[i] = 0.0;
+  } else {
+    if (eflag_global) eng_vdwl = eng_coul = 0.0;
+    if (vflag_global) for (i = 0; i < 6; i++) virial[i] = 0.0;
+  }
+  if (eflag_atom && !ev_accumulate) {
     n = atom->nlocal;
     if (force->newton) n += atom->nghost;
     for (i = 0; i < n; i++) eatom[i] = 0.0;
   }
-  if (vflag_atom) {
+  if (vflag_atom && !ev_accumulate) {
     n = atom->nlocal;
     if (force->newton) n += atom->nghost;
     for (i = 0; i < n; i++) {
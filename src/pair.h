@@ -51,6 +51,8 @@ class Pair : protected Pointers {
   int writedata;                 // 1 if writes coeffs to data file
   int ghostneigh;                // 1 if pair style needs neighbors of ghosts
   double **cutghost;             // cutoff for each ghost pair
+  int overlap_enable;            // 1 if compute() can be split into passes
+                                 // over interior and boundary atoms
 
   int ewaldflag;                 // 1 if compatible with Ewald solver
   int pppmflag;                  // 1 if compatible with PPPM solver
@@ -133,6 +135,8 @@ class Pair : protected Pointers {
   // general child-class methods
 
   virtual void compute(int, int) = 0;
+  void compute_interior(int, int);
+  void compute_boundary(int, int);
   virtual void compute_inner() {}
   virtual void compute_middle() {}
   virtual void compute_outer(int, int) {}
@@ -201,6 +205,7 @@ class Pair : protected Pointers {
   double THIRD;
 
   int vflag_fdotr;
+  int ev_accumulate;             // 1 if ev_setup() keeps prior tallies
   int maxeatom,maxvatom;
 
   virtual void ev_setup(int, int);
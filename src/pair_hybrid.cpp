@@ -23,6 +23,7 @@
 #include "neigh_request.h"
 #include "update.h"
 #include "comm.h"
+#include "timer.h"
 #include "memory.h"
 #include "error.h"
 
@@ -36,6 +37,7 @@ PairHybrid::PairHybrid(LAMMPS *lmp) : Pair(lmp)
   styles = NULL;
   keywords = NULL;
   multiple = NULL;
+  subtimer = NULL;
 
   outerflag = 0;
 }
@@ -51,6 +53,7 @@ PairHybrid::~PairHybrid()
   delete [] styles;
   delete [] keywords;
   delete [] multiple;
+  delete [] subtimer;
 
   delete [] svector;
 
@@ -104,9 +107,11 @@ void PairHybrid::compute(int eflag, int vflag)
     // outerflag is set and sub-style has a compute_outer() method
 
     if (styles[m]->compute_flag == 0) continue;
+    timer->sub_start(subtimer[m]);
     if (outerflag && styles[m]->respa_enable) 
       styles[m]->compute_outer(eflag,vflag_substyle);
     else styles[m]->compute(eflag,vflag_substyle);
+    timer->sub_stop(subtimer[m]);
 
     if (eflag_global) {
       eng_vdwl += styles[m]->eng_vdwl;
@@ -214,6 +219,8 @@ void PairHybrid::settings(int narg, char **arg)
   styles = new Pair*[narg];
   keywords = new char*[narg];
   multiple = new int[narg];
+  delete [] subtimer;
+  subtimer = new int[narg];
 
   // allocate each sub-style
   // allocate uses suffix, but don't store suffix version in keywords,
@@ -425,6 +432,18 @@ void PairHybrid::init_style()
 
   for (istyle = 0; istyle < nstyles; istyle++) styles[istyle]->init_style();
 
+  // register a detailed timer for each sub-style
+
+  int root = timer->add("Pair");
+  for (istyle = 0; istyle < nstyles; istyle++) {
+    char *name = new char[strlen(keywords[istyle])+16];
+    if (multiple[istyle])
+      sprintf(name,"%s:%d",keywords[istyle],multiple[istyle]);
+    else strcpy(name,keywords[istyle]);
+    subtimer[istyle] = timer->add(name,root);
+    delete [] name;
+  }
+
   // create skip lists for each pair neigh request
   // any kind of list can have its skip flag set at this stage
 
@@ -628,6 +647,8 @@ void PairHybrid::read_restart(FILE *fp)
   styles = new Pair*[nstyles];
   keywords = new char*[nstyles];
   multiple = new int[nstyles];
+  delete [] subtimer;
+  subtimer = new int[nstyles];
 
   // each sub-style is created via new_pair()
   // each reads its settings, but no coeff info
@@ -41,6 +41,7 @@ using namespace MathConst;
 PairLJCut::PairLJCut(LAMMPS *lmp) : Pair(lmp)
 {
   respa_enable = 1;
+  overlap_enable = 1;
   writedata = 1;
 }
 
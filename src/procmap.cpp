@@ -28,6 +28,7 @@
 using namespace LAMMPS_NS;
 
 #define MAXLINE 128
+#define EPSILON 1.0e-6
 
 enum{MULTIPLE};                   // same as in Comm
 
@@ -343,6 +344,67 @@ void ProcMap::custom_grid(char *cfile, int nprocs,
   if (flag) error->all(FLERR,"Processors custom grid file is inconsistent");
 }
 
+/* ----------------------------------------------------------------------
+   create a two-level 3d grid of procs with nodes and cores auto-detected
+   each node owns an identical compact sub-grid of procs
+   node grid is chosen to minimize ghost volume exchanged between nodes,
+     ties broken by ghost volume exchanged by each proc
+   cut = ghost cutoff, 0.0 if not yet known, then surface area is used
+------------------------------------------------------------------------- */
+
+void ProcMap::node_grid(int nprocs, int *user_procgrid, int *procgrid,
+                        int *coregrid, double cut)
+{
+  int **nfactors,**cfactors,**factors;
+
+  node_info(nprocs);
+
+  // nfactors = list of all possible 3 factors of node count
+  // constrain by 2d
+
+  int nnpossible = factor(nnodes,NULL);
+  memory->create(nfactors,nnpossible,3,"procmap:nfactors");
+  nnpossible = factor(nnodes,nfactors);
+
+  if (domain->dimension == 2) nnpossible = cull_2d(nnpossible,nfactors,3);
+
+  // cfactors = list of all possible 3 factors of procs per node
+  // constrain by 2d
+
+  int ncpossible = factor(procs_per_node,NULL);
+  memory->create(cfactors,ncpossible,3,"procmap:cfactors");
+  ncpossible = factor(procs_per_node,cfactors);
+
+  if (domain->dimension == 2) ncpossible = cull_2d(ncpossible,cfactors,3);
+
+  // factors = all combinations of nfactors and cfactors
+  // constrain by user request
+
+  int npossible = nnpossible * ncpossible;
+  memory->create(factors,npossible,4,"procmap:factors");
+  npossible = combine_factors(nnpossible,nfactors,ncpossible,cfactors,factors);
+
+  npossible = cull_user(npossible,factors,4,user_procgrid);
+
+  if (npossible == 0)
+    error->all(FLERR,"Could not create node grid of processors");
+
+  // select best set of 3 factors based on ghost volume of node sub-domains
+  // index points to corresponding core factorization
+
+  int index = best_node_factors(npossible,factors,cfactors,procgrid,cut);
+
+  coregrid[0] = cfactors[factors[index][3]][0];
+  coregrid[1] = cfactors[factors[index][3]][1];
+  coregrid[2] = cfactors[factors[index][3]][2];
+
+  // clean-up
+
+  memory->destroy(nfactors);
+  memory->destroy(cfactors);
+  memory->destroy(factors);
+}
+
 /* ----------------------------------------------------------------------
    map processors to 3d grid via MPI_Cart routines
    MPI may do layout in machine-optimized fashion
@@ -644,6 +706,68 @@ void ProcMap::custom_map(int *procgrid,
   memory->destroy(cmap);
 }
 
+/* ----------------------------------------------------------------------
+   map processors to 3d grid of nodes and cores within each node
+   nodes are ordered by their lowest proc ID, cores by proc ID within node,
+     each in XYZ order, so placement of procs on nodes does not matter
+   node_id, node_rank were set by node_grid()
+------------------------------------------------------------------------- */
+
+void ProcMap::node_map(int *procgrid, int *coregrid,
+                       int *myloc, int procneigh[3][2], int ***grid2proc)
+{
+  int nprocs;
+  MPI_Comm_size(world,&nprocs);
+
+  nodegrid[0] = procgrid[0] / coregrid[0];
+  nodegrid[1] = procgrid[1] / coregrid[1];
+  nodegrid[2] = procgrid[2] / coregrid[2];
+
+  // my location in grid from location of my node and my core within it
+
+  myloc[0] = (node_id % nodegrid[0]) * coregrid[0] + node_rank % coregrid[0];
+  myloc[1] = (node_id / nodegrid[0] % nodegrid[1]) * coregrid[1] +
+    node_rank / coregrid[0] % coregrid[1];
+  myloc[2] = (node_id / (nodegrid[0]*nodegrid[1])) * coregrid[2] +
+    node_rank / (coregrid[0]*coregrid[1]);
+
+  // allgather of myloc into gridi to fill grid2proc
+
+  int **gridi;
+  memory->create(gridi,nprocs,3,"comm:gridi");
+  MPI_Allgather(myloc,3,MPI_INT,gridi[0],3,MPI_INT,world);
+  for (int i = 0; i < nprocs; i++)
+    grid2proc[gridi[i][0]][gridi[i][1]][gridi[i][2]] = i;
+  memory->destroy(gridi);
+
+  // proc IDs of neighbors
+
+  int minus,plus;
+  grid_shift(myloc[0],procgrid[0],minus,plus);
+  procneigh[0][0] = grid2proc[minus][myloc[1]][myloc[2]];
+  procneigh[0][1] = grid2proc[plus][myloc[1]][myloc[2]];
+
+  grid_shift(myloc[1],procgrid[1],minus,plus);
+  procneigh[1][0] = grid2proc[myloc[0]][minus][myloc[2]];
+  procneigh[1][1] = grid2proc[myloc[0]][plus][myloc[2]];
+
+  grid_shift(myloc[2],procgrid[2],minus,plus);
+  procneigh[2][0] = grid2proc[myloc[0]][myloc[1]][minus];
+  procneigh[2][1] = grid2proc[myloc[0]][myloc[1]][plus];
+}
+
+/* ----------------------------------------------------------------------
+   return # of procs per node if procs of each node have contiguous IDs
+   return 0 if not, or if only one node
+   used to align RCB cuts with node boundaries for comm_style tiled
+------------------------------------------------------------------------- */
+
+int ProcMap::node_block()
+{
+  if (blockflag && nnodes > 1) return procs_per_node;
+  return 0;
+}
+
 /* ----------------------------------------------------------------------
    output mapping of processors to 3d grid to file
 ------------------------------------------------------------------------- */
@@ -882,6 +1006,172 @@ int ProcMap::best_factors(int npossible, int **factors, int *best,
   return index;
 }
 
+/* ----------------------------------------------------------------------
+   select best set of node,core factors for node grid
+   factors[m][0-2] = proc grid, factors[m][3] = index into cfactors
+   best = minimal ghost volume of node sub-domain thru faces shared
+     with other nodes, ties broken by ghost volume of proc sub-domain
+   cut = ghost cutoff, 0.0 to use surface area instead
+   return best = 3 factors
+   return index of best factors in factors
+------------------------------------------------------------------------- */
+
+int ProcMap::best_node_factors(int npossible, int **factors, int **cfactors,
+                               int *best, double cut)
+{
+  // width[3] = distance between opposite box faces
+  // for triclinic, width = volume / area of face via h matrix edge vectors
+
+  double width[3];
+  if (domain->triclinic == 0) {
+    width[0] = domain->xprd;
+    width[1] = domain->yprd;
+    width[2] = domain->zprd;
+  } else {
+    double *h = domain->h;
+    double volume = h[0]*h[1]*h[2];
+    double a[3],b[3],c[3];
+    a[0] = h[5]; a[1] = h[1]; a[2] = 0.0;
+    b[0] = h[4]; b[1] = h[3]; b[2] = h[2];
+    MathExtra::cross3(a,b,c);
+    width[0] = volume / sqrt(c[0]*c[0] + c[1]*c[1] + c[2]*c[2]);
+    a[0] = h[0]; a[1] = 0.0; a[2] = 0.0;
+    MathExtra::cross3(a,b,c);
+    width[1] = volume / sqrt(c[0]*c[0] + c[1]*c[1] + c[2]*c[2]);
+    b[0] = h[5]; b[1] = h[1]; b[2] = 0.0;
+    MathExtra::cross3(a,b,c);
+    width[2] = volume / sqrt(c[0]*c[0] + c[1]*c[1] + c[2]*c[2]);
+  }
+
+  // a dimension with a single node or proc exchanges no ghosts with others
+
+  int index = 0;
+  double len[3];
+  int grid[3];
+  double node,proc;
+  double bestnode = 0.0,bestproc = 0.0;
+
+  for (int m = 0; m < npossible; m++) {
+    for (int i = 0; i < 3; i++) {
+      grid[i] = factors[m][i] / cfactors[factors[m][3]][i];
+      len[i] = width[i] / grid[i];
+    }
+    node = halo_volume(len,grid,cut);
+    for (int i = 0; i < 3; i++) len[i] = width[i] / factors[m][i];
+    proc = halo_volume(len,factors[m],cut);
+
+    if (m == 0 || node < bestnode*(1.0-EPSILON) ||
+        (node <= bestnode*(1.0+EPSILON) && proc < bestproc)) {
+      bestnode = node;
+      bestproc = proc;
+      best[0] = factors[m][0];
+      best[1] = factors[m][1];
+      best[2] = factors[m][2];
+      index = m;
+    }
+  }
+
+  return index;
+}
+
+/* ----------------------------------------------------------------------
+   volume of ghost region of a len[3] sub-domain with ghost cutoff cut
+   only dims with grid > 1 contribute
+   if cut = 0.0, return surface area of those faces instead
+------------------------------------------------------------------------- */
+
+double ProcMap::halo_volume(double *len, int *grid, double cut)
+{
+  if (cut == 0.0) {
+    double area = 0.0;
+    if (grid[0] > 1) area += 2.0*len[1]*len[2];
+    if (grid[1] > 1) area += 2.0*len[0]*len[2];
+    if (grid[2] > 1) area += 2.0*len[0]*len[1];
+    return area;
+  }
+
+  double outer = 1.0;
+  for (int i = 0; i < 3; i++)
+    if (grid[i] > 1) outer *= len[i] + 2.0*cut;
+    else outer *= len[i];
+  return outer - len[0]*len[1]*len[2];
+}
+
+/* ----------------------------------------------------------------------
+   detect which procs share a node
+   uses shared-memory communicator split if MPI library supports it,
+     else processor names as in numa_grid()
+   sets procs_per_node, nnodes, node_id, node_rank, blockflag
+   nodes are numbered by their lowest proc ID
+------------------------------------------------------------------------- */
+
+void ProcMap::node_info(int nprocs)
+{
+  int me;
+  MPI_Comm_rank(world,&me);
+
+#if defined(MPI_VERSION) && (MPI_VERSION >= 3)
+  MPI_Comm node_comm;
+  MPI_Comm_split_type(world,MPI_COMM_TYPE_SHARED,me,MPI_INFO_NULL,&node_comm);
+  MPI_Comm_rank(node_comm,&node_rank);
+  MPI_Comm_size(node_comm,&procs_per_node);
+
+  // rank 0 proc of each node is ordered by proc ID in leader_comm
+
+  MPI_Comm leader_comm;
+  MPI_Comm_split(world,node_rank == 0 ? 0 : MPI_UNDEFINED,me,&leader_comm);
+  if (node_rank == 0) {
+    MPI_Comm_rank(leader_comm,&node_id);
+    MPI_Comm_free(&leader_comm);
+  }
+  MPI_Bcast(&node_id,1,MPI_INT,0,node_comm);
+  MPI_Comm_free(&node_comm);
+#else
+  int name_length;
+  char node_name[MPI_MAX_PROCESSOR_NAME];
+  memset(node_name,0,MPI_MAX_PROCESSOR_NAME);
+  MPI_Get_processor_name(node_name,&name_length);
+  node_name[name_length] = '\0';
+  char *node_names = new char[MPI_MAX_PROCESSOR_NAME*nprocs];
+  MPI_Allgather(node_name,MPI_MAX_PROCESSOR_NAME,MPI_CHAR,node_names,
+                MPI_MAX_PROCESSOR_NAME,MPI_CHAR,world);
+  std::string node_string = std::string(node_name);
+
+  // number nodes in order of first appearance
+
+  std::map<std::string,int> name_map;
+  int n = 0;
+  procs_per_node = node_rank = 0;
+  for (int i = 0; i < nprocs; i++) {
+    std::string i_string = std::string(&node_names[i*MPI_MAX_PROCESSOR_NAME]);
+    if (name_map.find(i_string) == name_map.end()) name_map[i_string] = n++;
+    if (i_string == node_string) {
+      if (i < me) node_rank++;
+      procs_per_node++;
+    }
+  }
+  node_id = name_map[node_string];
+
+  delete [] node_names;
+#endif
+
+  int flag,flagall;
+  MPI_Allreduce(&node_id,&nnodes,1,MPI_INT,MPI_MAX,world);
+  nnodes++;
+
+  flag = procs_per_node;
+  MPI_Allreduce(&flag,&flagall,1,MPI_INT,MPI_MIN,world);
+  if (flagall != procs_per_node) flag = 1;
+  else flag = 0;
+  MPI_Allreduce(&flag,&flagall,1,MPI_INT,MPI_MAX,world);
+  if (flagall)
+    error->all(FLERR,
+               "Processors grid node requires same proc count on every node");
+
+  flag = (me == node_id*procs_per_node + node_rank);
+  MPI_Allreduce(&flag,&blockflag,1,MPI_INT,MPI_MIN,world);
+}
+
 /* ----------------------------------------------------------------------
    minus,plus = indices of neighboring processors in a dimension
 ------------------------------------------------------------------------- */
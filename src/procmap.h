@@ -27,12 +27,15 @@ class ProcMap : protected Pointers {
                      int *, int *);
   void numa_grid(int, int *, int *, int *);
   void custom_grid(char *, int, int *, int *);
+  void node_grid(int, int *, int *, int *, double);
   void cart_map(int, int *, int *, int [3][2], int ***);
   void cart_map(int, int *, int, int *, int *, int [3][2], int ***);
   void xyz_map(char *, int *, int *, int [3][2], int ***);
   void xyz_map(char *, int *, int, int *, int *, int [3][2], int ***);
   void numa_map(int, int *, int *, int [3][2], int ***);
   void custom_map(int *, int *, int [3][2], int ***);
+  void node_map(int *, int *, int *, int [3][2], int ***);
+  int node_block();
   void output(char *, int *, int ***);
 
  private:
@@ -40,6 +43,9 @@ class ProcMap : protected Pointers {
   int procs_per_numa;
   int node_id;                    // which node I am in
   int nodegrid[3];                // 3d grid of nodes
+  int node_rank;                  // my rank within my node
+  int nnodes;                     // # of nodes
+  int blockflag;                  // 1 if procs of each node are contiguous
 
   int **cmap;                     // info in custom grid file
 
@@ -49,6 +55,9 @@ class ProcMap : protected Pointers {
   int cull_user(int, int **, int, int *);
   int cull_other(int, int **, int, int, int *, int *);
   int best_factors(int, int **, int *, int, int, int);
+  int best_node_factors(int, int **, int **, int *, double);
+  double halo_volume(double *, int *, double);
+  void node_info(int);
   void grid_shift(int, int, int &, int &);
 };
 
@@ -72,6 +81,16 @@ E: Could not create twolevel 3d grid of processors
 The specified constraints did not allow this style of grid to be
 created.
 
+E: Processors grid node requires same proc count on every node
+
+The node grid style assigns an identical sub-grid of procs to each
+node, so every node must run the same number of MPI tasks.
+
+E: Could not create node grid of processors
+
+The specified constraints did not allow this style of grid to be
+created.
+
 E: Could not create numa grid of processors
 
 The specified constraints did not allow this style of grid to be
@@ -14,6 +14,7 @@
 #include "mpi.h"
 #include "string.h"
 #include "rcb.h"
+#include "comm.h"
 #include "irregular.h"
 #include "memory.h"
 #include "error.h"
@@ -173,8 +174,10 @@ void RCB::compute(int dimension, int n, double **x, double *wt,
   // recurse until partition is a single proc = me
   // proclower,procupper = lower,upper procs in partition
   // procmid = 1st proc in upper half of partition
+  // nodesize = procs per node if cuts align with node boundaries, else 0
 
   int procpartner,procpartner2;
+  int nodesize = lmp->comm->rcbnode;
 
   int procmid;
   int proclower = 0;
@@ -183,25 +186,36 @@ void RCB::compute(int dimension, int n, double **x, double *wt,
   while (proclower != procupper) {
 
     // if odd # of procs, lower partition gets extra one
+    // if partition spans several nodes, split it between nodes,
+    //   lower partition gets extra node if odd # of nodes
 
     procmid = proclower + (procupper - proclower) / 2 + 1;
+    if (nodesize && procupper - proclower >= nodesize)
+      procmid = proclower +
+        ((procupper - proclower + 1) / nodesize + 1) / 2 * nodesize;
 
     // determine communication partner(s)
     // readnumber = # of proc partners to read from
+    // nlower,nupper = # of procs in lower,upper partition, nlower >= nupper
+    // extra lower procs send to upper procs in reverse order
+    // nlower <= 2*nupper, so an upper proc reads from at most 2 procs
+
+    int nlower = procmid - proclower;
+    int nupper = procupper + 1 - procmid;
 
-    if (me < procmid)
-      procpartner = me + (procmid - proclower);
-    else
-      procpartner = me - (procmid - proclower);
-    
     int readnumber = 1;
-    if (procpartner > procupper) {
-      readnumber = 0;
-      procpartner--;
-    }
-    if (me == procupper && procpartner != procmid - 1) {
-      readnumber = 2;
-      procpartner2 = procpartner + 1;
+    if (me < procmid) {
+      procpartner = me + nlower;
+      if (me - proclower >= nupper) {
+        readnumber = 0;
+        procpartner = procupper - (me - proclower - nupper);
+      }
+    } else {
+      procpartner = me - nlower;
+      if (procupper - me < nlower - nupper) {
+        readnumber = 2;
+        procpartner2 = proclower + nupper + (procupper - me);
+      }
     }
     
     // wttot = summed weight of entire partition
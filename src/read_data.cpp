@@ -41,8 +41,11 @@
 #include "dihedral.h"
 #include "improper.h"
 #include "special.h"
+#include "irregular.h"
+#include "mpiio.h"
 #include "error.h"
 #include "memory.h"
+#include <map>
 
 using namespace LAMMPS_NS;
 
@@ -86,6 +89,10 @@ ReadData::ReadData(LAMMPS *lmp) : Pointers(lmp)
   avec_tri = (AtomVecTri *) atom->style_match("tri");
   nbodies = 0;
   avec_body = (AtomVecBody *) atom->style_match("body");
+
+  mpiio = NULL;
+  pbuf = rbuf = NULL;
+  maxpbuf = maxrbuf = 0;
 }
 
 /* ---------------------------------------------------------------------- */
@@ -98,6 +105,10 @@ ReadData::~ReadData()
   delete [] buffer;
   memory->sfree(arg);
 
+  delete mpiio;
+  memory->sfree(pbuf);
+  memory->sfree(rbuf);
+
   for (int i = 0; i < nfix; i++) {
     delete [] fix_header[i];
     delete [] fix_section[i];
@@ -115,7 +126,7 @@ void ReadData::command(int narg, char **arg)
 
   // optional args
 
-  addflag = mergeflag = 0;
+  addflag = mergeflag = mpiioflag = 0;
   offset[0] = offset[1] = offset[2] = 0.0;
   nfix = 0;
   fix_index = NULL;
@@ -130,6 +141,9 @@ void ReadData::command(int narg, char **arg)
     } else if (strcmp(arg[iarg],"merge") == 0) {
       mergeflag = 1;
       iarg++;
+    } else if (strcmp(arg[iarg],"mpiio") == 0) {
+      mpiioflag = 1;
+      iarg++;
     } else if (strcmp(arg[iarg],"offset") == 0) {
       if (iarg+4 > narg)
         error->all(FLERR,"Illegal read_data command");
@@ -176,6 +190,23 @@ void ReadData::command(int narg, char **arg)
   if (domain->dimension == 2 && domain->zperiodic == 0)
     error->all(FLERR,"Cannot run 2d simulation with nonperiodic Z dimension");
 
+  // parallel reading of large sections via MPI-IO
+  // gzipped files can only be read through a pipe on proc 0
+
+  if (mpiioflag) {
+    char *suffix = arg[0] + strlen(arg[0]) - 3;
+    if (suffix > arg[0] && strcmp(suffix,".gz") == 0) {
+      if (me == 0)
+        error->warning(FLERR,"Read_data mpiio ignored for gzipped file");
+      mpiioflag = 0;
+    } else {
+      mpiio = new ReadDataMPIIO(lmp);
+      if (!mpiio->mpiio_exists)
+        error->all(FLERR,"Read_data mpiio requires the "
+                   "MPIIO package be installed");
+    }
+  }
+
   // perform 1-pass read if no molecular topoogy in file
   // perform 2-pass read if molecular topology,
   //   first pass calculates max topology/atom
@@ -198,6 +229,7 @@ void ReadData::command(int narg, char **arg)
       if (firstpass && screen) fprintf(screen,"Reading data file ...\n");
       open(arg[0]);
     } else fp = NULL;
+    if (mpiioflag) mpiio->openForRead(arg[0]);
     
     // read header info
     
@@ -478,6 +510,7 @@ void ReadData::command(int narg, char **arg)
       if (compressed) pclose(fp);
       else fclose(fp);
     }
+    if (mpiioflag) mpiio->close();
 
     // done if this was 2nd pass
 
@@ -794,12 +827,34 @@ void ReadData::atoms()
   bigint nread = 0;
   bigint natoms = atom->natoms;
 
-  while (nread < natoms) {
-    nchunk = MIN(natoms-nread,CHUNK);
-    eof = comm->read_lines_from_file(fp,nchunk,MAXLINE,buffer);
-    if (eof) error->all(FLERR,"Unexpected end of data file");
-    atom->data_atoms(nchunk,buffer);
-    nread += nchunk;
+  if (mpiioflag) {
+    int n = read_lines_parallel(natoms,1);
+    check_words(n,pbuf,atom->avec->size_data_atom,
+                atom->avec->size_data_atom+3,
+                "Incorrect atom format in data file");
+    if (n) atom->data_atoms(n,pbuf,1);
+
+    // each proc stored atoms from its lines of file
+    // move atoms to procs that own them via irregular()
+    // first do map_init() since irregular->migrate_atoms() will do map_clear()
+
+    if (atom->map_style) {
+      atom->map_init();
+      atom->map_set();
+    }
+    if (domain->triclinic) domain->x2lamda(atom->nlocal);
+    Irregular *irregular = new Irregular(lmp);
+    irregular->migrate_atoms(1);
+    delete irregular;
+    if (domain->triclinic) domain->lamda2x(atom->nlocal);
+  } else {
+    while (nread < natoms) {
+      nchunk = MIN(natoms-nread,CHUNK);
+      eof = comm->read_lines_from_file(fp,nchunk,MAXLINE,buffer);
+      if (eof) error->all(FLERR,"Unexpected end of data file");
+      atom->data_atoms(nchunk,buffer);
+      nread += nchunk;
+    }
   }
 
   // check that all atoms were assigned correctly
@@ -851,12 +906,20 @@ void ReadData::velocities()
   bigint nread = 0;
   bigint natoms = atom->natoms;
 
-  while (nread < natoms) {
-    nchunk = MIN(natoms-nread,CHUNK);
-    eof = comm->read_lines_from_file(fp,nchunk,MAXLINE,buffer);
-    if (eof) error->all(FLERR,"Unexpected end of data file");
-    atom->data_vels(nchunk,buffer);
-    nread += nchunk;
+  if (mpiioflag) {
+    int n = read_lines_parallel(natoms,1);
+    n = route_lines(n,0,1);
+    check_words(n,rbuf,atom->avec->size_data_vel,atom->avec->size_data_vel,
+                "Incorrect velocity format in data file");
+    if (n) atom->data_vels(n,rbuf);
+  } else {
+    while (nread < natoms) {
+      nchunk = MIN(natoms-nread,CHUNK);
+      eof = comm->read_lines_from_file(fp,nchunk,MAXLINE,buffer);
+      if (eof) error->all(FLERR,"Unexpected end of data file");
+      atom->data_vels(nchunk,buffer);
+      nread += nchunk;
+    }
   }
 
   if (mapflag) {
@@ -901,12 +964,18 @@ void ReadData::bonds(int firstpass)
   bigint nread = 0;
   bigint nbonds = atom->nbonds;
 
-  while (nread < nbonds) {
-    nchunk = MIN(nbonds-nread,CHUNK);
-    eof = comm->read_lines_from_file(fp,nchunk,MAXLINE,buffer);
-    if (eof) error->all(FLERR,"Unexpected end of data file");
-    atom->data_bonds(nchunk,buffer,count);
-    nread += nchunk;
+  if (mpiioflag) {
+    int n = read_lines_parallel(nbonds,1);
+    n = route_lines(n,2,2);
+    atom->data_bonds(n,rbuf,count);
+  } else {
+    while (nread < nbonds) {
+      nchunk = MIN(nbonds-nread,CHUNK);
+      eof = comm->read_lines_from_file(fp,nchunk,MAXLINE,buffer);
+      if (eof) error->all(FLERR,"Unexpected end of data file");
+      atom->data_bonds(nchunk,buffer,count);
+      nread += nchunk;
+    }
   }
 
   // if firstpass: tally max bond/atom and return
@@ -976,12 +1045,18 @@ void ReadData::angles(int firstpass)
   bigint nread = 0;
   bigint nangles = atom->nangles;
 
-  while (nread < nangles) {
-    nchunk = MIN(nangles-nread,CHUNK);
-    eof = comm->read_lines_from_file(fp,nchunk,MAXLINE,buffer);
-    if (eof) error->all(FLERR,"Unexpected end of data file");
-    atom->data_angles(nchunk,buffer,count);
-    nread += nchunk;
+  if (mpiioflag) {
+    int n = read_lines_parallel(nangles,1);
+    n = route_lines(n,2,3);
+    atom->data_angles(n,rbuf,count);
+  } else {
+    while (nread < nangles) {
+      nchunk = MIN(nangles-nread,CHUNK);
+      eof = comm->read_lines_from_file(fp,nchunk,MAXLINE,buffer);
+      if (eof) error->all(FLERR,"Unexpected end of data file");
+      atom->data_angles(nchunk,buffer,count);
+      nread += nchunk;
+    }
   }
 
   // if firstpass: tally max angle/atom and return
@@ -1051,12 +1126,18 @@ void ReadData::dihedrals(int firstpass)
   bigint nread = 0;
   bigint ndihedrals = atom->ndihedrals;
 
-  while (nread < ndihedrals) {
-    nchunk = MIN(ndihedrals-nread,CHUNK);
-    eof = comm->read_lines_from_file(fp,nchunk,MAXLINE,buffer);
-    if (eof) error->all(FLERR,"Unexpected end of data file");
-    atom->data_dihedrals(nchunk,buffer,count);
-    nread += nchunk;
+  if (mpiioflag) {
+    int n = read_lines_parallel(ndihedrals,1);
+    n = route_lines(n,2,4);
+    atom->data_dihedrals(n,rbuf,count);
+  } else {
+    while (nread < ndihedrals) {
+      nchunk = MIN(ndihedrals-nread,CHUNK);
+      eof = comm->read_lines_from_file(fp,nchunk,MAXLINE,buffer);
+      if (eof) error->all(FLERR,"Unexpected end of data file");
+      atom->data_dihedrals(nchunk,buffer,count);
+      nread += nchunk;
+    }
   }
 
   // if firstpass: tally max dihedral/atom and return
@@ -1126,12 +1207,18 @@ void ReadData::impropers(int firstpass)
   bigint nread = 0;
   bigint nimpropers = atom->nimpropers;
 
-  while (nread < nimpropers) {
-    nchunk = MIN(nimpropers-nread,CHUNK);
-    eof = comm->read_lines_from_file(fp,nchunk,MAXLINE,buffer);
-    if (eof) error->all(FLERR,"Unexpected end of data file");
-    atom->data_impropers(nchunk,buffer,count);
-    nread += nchunk;
+  if (mpiioflag) {
+    int n = read_lines_parallel(nimpropers,1);
+    n = route_lines(n,2,4);
+    atom->data_impropers(n,rbuf,count);
+  } else {
+    while (nread < nimpropers) {
+      nchunk = MIN(nimpropers-nread,CHUNK);
+      eof = comm->read_lines_from_file(fp,nchunk,MAXLINE,buffer);
+      if (eof) error->all(FLERR,"Unexpected end of data file");
+      atom->data_impropers(nchunk,buffer,count);
+      nread += nchunk;
+    }
   }
 
   // if firstpass: tally max improper/atom and return
@@ -1189,12 +1276,20 @@ void ReadData::bonus(bigint nbonus, AtomVec *ptr, const char *type)
   bigint nread = 0;
   bigint natoms = nbonus;
 
-  while (nread < natoms) {
-    nchunk = MIN(natoms-nread,CHUNK);
-    eof = comm->read_lines_from_file(fp,nchunk,MAXLINE,buffer);
-    if (eof) error->all(FLERR,"Unexpected end of data file");
-    atom->data_bonus(nchunk,buffer,ptr);
-    nread += nchunk;
+  if (mpiioflag) {
+    int n = read_lines_parallel(natoms,1);
+    n = route_lines(n,0,1);
+    check_words(n,rbuf,ptr->size_data_bonus,ptr->size_data_bonus,
+                "Incorrect bonus data format in data file");
+    if (n) atom->data_bonus(n,rbuf,ptr);
+  } else {
+    while (nread < natoms) {
+      nchunk = MIN(natoms-nread,CHUNK);
+      eof = comm->read_lines_from_file(fp,nchunk,MAXLINE,buffer);
+      if (eof) error->all(FLERR,"Unexpected end of data file");
+      atom->data_bonus(nchunk,buffer,ptr);
+      nread += nchunk;
+    }
   }
 
   if (mapflag) {
@@ -1593,12 +1688,258 @@ void ReadData::parse_keyword(int first)
 
 void ReadData::skip_lines(bigint n)
 {
+  if (mpiioflag && n > CHUNK) {
+    read_lines_parallel(n,0);
+    return;
+  }
   if (me) return;
   char *eof;
   for (bigint i = 0; i < n; i++) eof = fgets(line,MAXLINE,fp);
   if (eof == NULL) error->one(FLERR,"Unexpected end of data file");
 }
 
+/* ----------------------------------------------------------------------
+   all procs read next N lines of data file in parallel via MPI-IO
+   each proc gets a contiguous subset of the lines, stored in pbuf if keep
+   proc 0 then repositions its file pointer after the N lines
+   return # of lines read by this proc
+------------------------------------------------------------------------- */
+
+int ReadData::read_lines_parallel(bigint n, int keep)
+{
+  int nmine = 0;
+  bigint start = 0;
+  if (me == 0) start = ftell(fp);
+  MPI_Bcast(&start,1,MPI_LMP_BIGINT,0,world);
+
+  bigint stop = mpiio->read_lines(start,n,MAXLINE,keep,nmine,pbuf,maxpbuf);
+  if (me == 0) fseek(fp,stop,SEEK_SET);
+  return nmine;
+}
+
+/* ----------------------------------------------------------------------
+   send each of my N lines in pbuf to every proc that owns one of its atoms
+   atom IDs are Nid words of each line, starting at word Icol (0-based)
+   owning procs of atom IDs are found via rendezvous comm on ID % nprocs
+   received lines are stored in rbuf, each once per proc
+   return # of received lines
+------------------------------------------------------------------------- */
+
+int ReadData::route_lines(int n, int icol, int nid)
+{
+  int i,k,m,len,nsend;
+  char *ptr,*next,*word,*record;
+  char copy[MAXLINE];
+
+  int nprocs = comm->nprocs;
+
+  // extract atom IDs from each line
+
+  tagint *ids;
+  memory->create(ids,n*nid,"read_data:ids");
+
+  ptr = pbuf;
+  for (i = 0; i < n; i++) {
+    next = strchr(ptr,'\n');
+    len = MIN(next-ptr,MAXLINE-1);
+    strncpy(copy,ptr,len);
+    copy[len] = '\0';
+    word = strtok(copy," \t\n\r\f");
+    for (k = 0; k < icol && word; k++) word = strtok(NULL," \t\n\r\f");
+    for (k = 0; k < nid; k++) {
+      if (word == NULL)
+        error->one(FLERR,"Incorrect format of line in data file section");
+      ids[i*nid+k] = ATOTAGINT(word);
+      word = strtok(NULL," \t\n\r\f");
+    }
+    ptr = next + 1;
+  }
+
+  // rendezvous datums = IDs of my owned atoms + IDs in my lines
+
+  tagint *tag = atom->tag;
+  int nlocal = atom->nlocal;
+
+  nsend = nlocal + n*nid;
+  int *proclist;
+  memory->create(proclist,nsend,"read_data:proclist");
+  IDRvous *inbuf = (IDRvous *)
+    memory->smalloc((bigint) nsend*sizeof(IDRvous),"read_data:inbuf");
+
+  m = 0;
+  for (i = 0; i < nlocal; i++) {
+    proclist[m] = tag[i] % nprocs;
+    inbuf[m].atomID = tag[i];
+    inbuf[m].proc = me;
+    inbuf[m].index = -1;
+    m++;
+  }
+  for (i = 0; i < n*nid; i++) {
+    if (ids[i] > 0) proclist[m] = ids[i] % nprocs;
+    else proclist[m] = 0;
+    inbuf[m].atomID = ids[i];
+    inbuf[m].proc = me;
+    inbuf[m].index = i;
+    m++;
+  }
+
+  char *buf;
+  int nreturn = comm->rendezvous(nsend,proclist,(char *) inbuf,
+                                 sizeof(IDRvous),rendezvous_owners,
+                                 buf,sizeof(OwnerRvous),(void *) this);
+  OwnerRvous *outbuf = (OwnerRvous *) buf;
+
+  memory->destroy(proclist);
+  memory->sfree(inbuf);
+
+  // owner = proc that owns each atom ID in my lines, -1 if no owner
+
+  int *owner;
+  memory->create(owner,n*nid,"read_data:owner");
+  for (i = 0; i < n*nid; i++) owner[i] = -1;
+  for (m = 0; m < nreturn; m++) owner[outbuf[m].index] = outbuf[m].proc;
+  memory->sfree(outbuf);
+  memory->destroy(ids);
+
+  // send each line once to each distinct owner of its atoms
+  // lines are sent as fixed-length MAXLINE strings
+  // a line is truncated if needed so its newline and terminating null
+  //   fit in its own MAXLINE record
+
+  nsend = 0;
+  for (i = 0; i < n; i++)
+    for (k = 0; k < nid; k++) {
+      if (owner[i*nid+k] < 0) continue;
+      for (m = 0; m < k; m++)
+        if (owner[i*nid+m] == owner[i*nid+k]) break;
+      if (m == k) nsend++;
+    }
+
+  memory->create(proclist,nsend,"read_data:proclist");
+  char *sendbuf = (char *)
+    memory->smalloc((bigint) nsend*MAXLINE,"read_data:sendbuf");
+
+  nsend = 0;
+  ptr = pbuf;
+  for (i = 0; i < n; i++) {
+    next = strchr(ptr,'\n');
+    len = MIN(next-ptr,MAXLINE-2);
+    for (k = 0; k < nid; k++) {
+      if (owner[i*nid+k] < 0) continue;
+      for (m = 0; m < k; m++)
+        if (owner[i*nid+m] == owner[i*nid+k]) break;
+      if (m < k) continue;
+      proclist[nsend] = owner[i*nid+k];
+      record = &sendbuf[(bigint) nsend*MAXLINE];
+      memcpy(record,ptr,len);
+      record[len] = '\n';
+      record[len+1] = '\0';
+      nsend++;
+    }
+    ptr = next + 1;
+  }
+
+  memory->destroy(owner);
+
+  Irregular *irregular = new Irregular(lmp);
+  int nrecv = irregular->create_data(nsend,proclist,1);
+  char *recvbuf = (char *)
+    memory->smalloc((bigint) nrecv*MAXLINE,"read_data:recvbuf");
+  irregular->exchange_data(sendbuf,MAXLINE,recvbuf);
+  irregular->destroy_data();
+  delete irregular;
+
+  memory->destroy(proclist);
+  memory->sfree(sendbuf);
+
+  // concatenate received lines into rbuf
+
+  if ((bigint) nrecv*MAXLINE + 1 > maxrbuf) {
+    maxrbuf = (bigint) nrecv*MAXLINE + 1;
+    memory->sfree(rbuf);
+    rbuf = (char *) memory->smalloc(maxrbuf,"read_data:rbuf");
+  }
+
+  bigint nbuf = 0;
+  for (i = 0; i < nrecv; i++) {
+    ptr = &recvbuf[(bigint) i*MAXLINE];
+    len = strlen(ptr);
+    memcpy(&rbuf[nbuf],ptr,len);
+    nbuf += len;
+  }
+  rbuf[nbuf] = '\0';
+
+  memory->sfree(recvbuf);
+  return nrecv;
+}
+
+/* ----------------------------------------------------------------------
+   callback from comm->rendezvous() in route_lines()
+   inbuf = owned atom IDs with their owning proc and queried atom IDs
+   return owning proc of each queried atom ID to proc that queried it
+------------------------------------------------------------------------- */
+
+int ReadData::rendezvous_owners(int n, char *inbuf,
+                                int *&procs, char *&outbuf, void *ptr)
+{
+  int i,m;
+
+  ReadData *rptr = (ReadData *) ptr;
+  Memory *memory = rptr->memory;
+
+  IDRvous *in = (IDRvous *) inbuf;
+
+  std::map<tagint,int> hash;
+  std::map<tagint,int>::iterator pos;
+
+  for (i = 0; i < n; i++)
+    if (in[i].index < 0) hash[in[i].atomID] = in[i].proc;
+
+  int nout = 0;
+  for (i = 0; i < n; i++)
+    if (in[i].index >= 0 && hash.find(in[i].atomID) != hash.end()) nout++;
+
+  memory->create(procs,nout,"read_data:procs");
+  OwnerRvous *out = (OwnerRvous *)
+    memory->smalloc((bigint) nout*sizeof(OwnerRvous),"read_data:outbuf");
+
+  m = 0;
+  for (i = 0; i < n; i++) {
+    if (in[i].index < 0) continue;
+    pos = hash.find(in[i].atomID);
+    if (pos == hash.end()) continue;
+    procs[m] = in[i].proc;
+    out[m].index = in[i].index;
+    out[m].proc = pos->second;
+    m++;
+  }
+
+  outbuf = (char *) out;
+  return nout;
+}
+
+/* ----------------------------------------------------------------------
+   check # of words in 1st of my N lines in Buf against Nw1 or Nw2
+   done collectively, since in parallel reads procs hold different lines
+------------------------------------------------------------------------- */
+
+void ReadData::check_words(int n, char *buf, int nw1, int nw2,
+                           const char *errstr)
+{
+  int flag = 0;
+  if (n) {
+    char *next = strchr(buf,'\n');
+    *next = '\0';
+    int nwords = atom->count_words(buf);
+    *next = '\n';
+    if (nwords != nw1 && nwords != nw2) flag = 1;
+  }
+
+  int flagall;
+  MPI_Allreduce(&flag,&flagall,1,MPI_INT,MPI_MAX,world);
+  if (flagall) error->all(FLERR,errstr);
+}
+
 /* ----------------------------------------------------------------------
    parse a line of coeffs into words, storing them in narg,arg
    trim anything from '#' onward
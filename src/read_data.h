@@ -39,7 +39,7 @@ class ReadData : protected Pointers {
 
   // optional args
 
-  int addflag,mergeflag;
+  int addflag,mergeflag,mpiioflag;
   double offset[3];
   int nfix;         
   int *fix_index;
@@ -55,12 +55,32 @@ class ReadData : protected Pointers {
   bigint nbodies;
   class AtomVecBody *avec_body;
 
+  // parallel reading of sections via MPI-IO
+
+  class ReadDataMPIIO *mpiio;
+  char *pbuf;                  // lines of a section read by this proc
+  char *rbuf;                  // lines routed to this proc
+  bigint maxpbuf,maxrbuf;
+
+  struct IDRvous {             // atom ID sent to rendezvous proc
+    tagint atomID;             // index = -1 if proc owns atom
+    int proc,index;            // else index of ID in proc's lines
+  };
+
+  struct OwnerRvous {          // owning proc returned for an atom ID
+    int index,proc;
+  };
+
   void open(char *);
   void scan(int &, int &, int &, int &);
   int reallocate(int **, int, int);
   void header();
   void parse_keyword(int);
   void skip_lines(bigint);
+  int read_lines_parallel(bigint, int);
+  int route_lines(int, int, int);
+  void check_words(int, char *, int, int, const char *);
+  static int rendezvous_owners(int, char *, int *&, char *&, void *);
   void parse_coeffs(char *, const char *, int);
   int style_match(const char *, const char *);
 
@@ -418,6 +438,35 @@ E: Too many lines in one body in data file - boost MAXBODY
 MAXBODY is a setting at the top of the src/read_data.cpp file.
 Set it larger and re-compile the code.
 
+E: Read_data mpiio requires the MPIIO package be installed
+
+The mpiio option of the read_data command uses the MPIIO package.
+
+W: Read_data mpiio ignored for gzipped file
+
+Compressed data files are read by processor 0 through a gzip pipe, so
+they cannot be read in parallel.
+
+E: Incorrect atom format in data file
+
+Number of values per atom line in the data file is not consistent with
+the atom style.
+
+E: Incorrect velocity format in data file
+
+Each atom style defines a format for the Velocity section
+of the data file.  The read-in lines do not match.
+
+E: Incorrect bonus data format in data file
+
+See the read_data doc page for a description of how various kinds of
+bonus data must be formatted for certain atom styles.
+
+E: Incorrect format of line in data file section
+
+A line of a Velocities, Bonds, Angles, Dihedrals, Impropers,
+Ellipsoids, Lines, or Triangles section has too few values.
+
 E: Cannot open gzipped file
 
 LAMMPS was compiled without support for reading and writing gzipped
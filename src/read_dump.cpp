@@ -231,6 +231,7 @@ bigint ReadDump::seek(bigint nrequest, int exact)
     for (ifile = 0; ifile < nfile; ifile++) {
       ntimestep = -1;
       reader->open_file(files[ifile]);
+      reader->seek_index(nrequest);
       while (1) {
         eofflag = reader->read_time(ntimestep);
         if (eofflag) break;
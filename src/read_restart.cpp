@@ -40,6 +40,8 @@
 
 using namespace LAMMPS_NS;
 
+#define BIG 1.0e20
+
 // same as write_restart.cpp
 
 #define MAGIC_STRING "LammpS RestartT"
@@ -60,7 +62,7 @@ enum{VERSION,SMALLINT,TAGINT,BIGINT,
      SPECIAL_LJ,SPECIAL_COUL,
      MASS,PAIR,BOND,ANGLE,DIHEDRAL,IMPROPER,
      MULTIPROC,MPIIO,PROCSPERFILE,PERPROC,
-     IMAGEINT};
+     IMAGEINT,MPIIOINDEX};
 
 #define LB_FACTOR 1.1
 
@@ -82,7 +84,7 @@ void ReadRestart::command(int narg, char **arg)
 
   // check for remap option
 
-  int remapflag = 0;
+  remapflag = 0;
   if (narg == 2) {
     if (strcmp(arg[1],"remap") == 0) remapflag = 1;
     else error->all(FLERR,"Illegal read_restart command");
@@ -197,14 +199,60 @@ void ReadRestart::command(int narg, char **arg)
 
   // MPI-IO input from single file
 
+  // if file has a chunk index, each proc collectively reads only the
+  //   chunks whose bounding box overlaps its sub-domain and keeps
+  //   the atoms in its sub-domain, extended to infinity at box faces
+  //   so atoms slightly outside the box are not lost
+  // else each proc reads a contiguous set of chunks and keeps all atoms
+
   if (mpiioflag) {
     mpiio->openForRead(file);
-    memory->create(buf,assignedChunkSize,"read_restart:buf");
-    mpiio->read((headerOffset+assignedChunkOffset),assignedChunkSize,buf);
-    mpiio->close();
 
-    m = 0;
-    while (m < assignedChunkSize) m += avec->unpack_restart(&buf[m]);
+    if (indexflag) {
+      bigint nread = 0;
+      for (int i = 0; i < numChunksAssigned; i++) nread += chunkSizes[i];
+      memory->create(buf,nread,"read_restart:buf");
+      mpiio->read_chunks(headerOffset,numChunksAssigned,
+                         chunkOffsets,chunkSizes,buf);
+      mpiio->close();
+
+      int triclinic = domain->triclinic;
+      imageint *iptr;
+      double *x,lamda[3],lo[3],hi[3];
+      double *coord;
+      subdomain_bounds(lo,hi);
+
+      m = 0;
+      while (m < nread) {
+        x = &buf[m+1];
+        if (remapflag) {
+          iptr = (imageint *) &buf[m+7];
+          domain->remap(x,*iptr);
+        }
+
+        if (triclinic) {
+          domain->x2lamda(x,lamda);
+          coord = lamda;
+        } else coord = x;
+
+        if (coord[0] >= lo[0] && coord[0] < hi[0] &&
+            coord[1] >= lo[1] && coord[1] < hi[1] &&
+            coord[2] >= lo[2] && coord[2] < hi[2]) {
+          m += avec->unpack_restart(&buf[m]);
+        } else m += static_cast<int> (buf[m]);
+      }
+
+      memory->destroy(chunkOffsets);
+      memory->destroy(chunkSizes);
+
+    } else {
+      memory->create(buf,assignedChunkSize,"read_restart:buf");
+      mpiio->read((headerOffset+assignedChunkOffset),assignedChunkSize,buf);
+      mpiio->close();
+
+      m = 0;
+      while (m < assignedChunkSize) m += avec->unpack_restart(&buf[m]);
+    }
   }
 
   // input of single native file
@@ -419,10 +467,10 @@ void ReadRestart::command(int narg, char **arg)
   delete [] file;
   memory->destroy(buf);
 
-  // for multiproc or MPI-IO files:
+  // for multiproc or MPI-IO files without a chunk index:
   // perform irregular comm to migrate atoms to correct procs
 
-  if (multiproc || mpiioflag) {
+  if (multiproc || (mpiioflag && !indexflag)) {
 
     // if remapflag set, remap all atoms I read back to box before migrating
 
@@ -931,6 +979,9 @@ void ReadRestart::force_fields()
 
 void ReadRestart::file_layout()
 {
+  indexflag = 0;
+  int *writerSizes = NULL;
+
   int flag = read_int();
   while (flag >= 0) {
 
@@ -961,16 +1012,18 @@ void ReadRestart::file_layout()
         // end of the header info to fit the current partition size
         // if the number of ranks that did the writing is different
 
+        // chunk sizes are kept on all procs in case a chunk index follows
+
+        memory->create(writerSizes,nprocs_file,"read_restart:writerSizes");
+        if (me == 0) fread(writerSizes,sizeof(int),nprocs_file,fp);
+        MPI_Bcast(writerSizes,nprocs_file,MPI_INT,0,world);
+
         if (me == 0) {
-          int *all_written_send_sizes;
-          memory->create(all_written_send_sizes,nprocs_file,
-                         "write_restart:all_written_send_sizes");
+          int *all_written_send_sizes = writerSizes;
           int *nproc_chunk_number;
           memory->create(nproc_chunk_number,nprocs,
                          "write_restart:nproc_chunk_number");
           
-          fread(all_written_send_sizes,sizeof(int),nprocs_file,fp);
-          
           int init_chunk_number = nprocs_file/nprocs;
           int num_extra_chunks = nprocs_file - (nprocs*init_chunk_number);
           
@@ -996,7 +1049,6 @@ void ReadRestart::file_layout()
             }
           
           }
-          memory->destroy(all_written_send_sizes);
           memory->destroy(nproc_chunk_number);
         }
 
@@ -1010,11 +1062,24 @@ void ReadRestart::file_layout()
         memory->destroy(nproc_chunk_sizes);
         memory->destroy(nproc_chunk_offsets);
       }
+
+    } else if (flag == MPIIOINDEX) {
+      int n = read_int();
+      if (writerSizes == NULL || n != 6*nprocs_file)
+        error->all(FLERR,"Invalid chunk index in MPI-IO restart file");
+      double *bounds;
+      memory->create(bounds,n,"read_restart:bounds");
+      read_double_vec(n,bounds);
+      select_chunks(writerSizes,bounds);
+      memory->destroy(bounds);
+      indexflag = 1;
     }
 
     flag = read_int();
   }
 
+  memory->destroy(writerSizes);
+
   // if MPI-IO file, broadcast the end of the header offste
   // this allows all ranks to compute offset to their data
 
@@ -1024,6 +1089,99 @@ void ReadRestart::file_layout()
   }
 }
 
+/* ----------------------------------------------------------------------
+   select chunks of an MPI-IO restart file to read via its chunk index
+   sizes = # of doubles in each writer's chunk
+   bounds = bounding box of atoms in each chunk, lamda coords if triclinic
+   a chunk is selected if its box overlaps my extended sub-domain
+   if remapflag set, a chunk extending outside a periodic box is
+     selected regardless of that dim, since its atoms may remap anywhere
+   chunkOffsets = byte offset of each selected chunk after the header
+------------------------------------------------------------------------- */
+
+void ReadRestart::select_chunks(int *sizes, double *bounds)
+{
+  double lo[3],hi[3],boxlo[3],boxhi[3];
+  int periodic[3];
+
+  subdomain_bounds(lo,hi);
+
+  if (domain->triclinic == 0) {
+    for (int k = 0; k < 3; k++) {
+      boxlo[k] = domain->boxlo[k];
+      boxhi[k] = domain->boxhi[k];
+    }
+  } else {
+    for (int k = 0; k < 3; k++) {
+      boxlo[k] = 0.0;
+      boxhi[k] = 1.0;
+    }
+  }
+  periodic[0] = domain->xperiodic;
+  periodic[1] = domain->yperiodic;
+  periodic[2] = domain->zperiodic;
+
+  numChunksAssigned = 0;
+  for (int i = 0; i < nprocs_file; i++)
+    if (sizes[i]) numChunksAssigned++;
+  memory->create(chunkOffsets,numChunksAssigned,"read_restart:chunkOffsets");
+  memory->create(chunkSizes,numChunksAssigned,"read_restart:chunkSizes");
+
+  double *b;
+  int k,overlap;
+  MPI_Offset offset = 0;
+  int n = 0;
+
+  for (int i = 0; i < nprocs_file; i++) {
+    b = &bounds[6*i];
+    overlap = 1;
+    for (k = 0; k < 3; k++) {
+      if (remapflag && periodic[k] && (b[k] < boxlo[k] || b[k+3] >= boxhi[k]))
+        continue;
+      if (b[k] >= hi[k] || b[k+3] < lo[k]) overlap = 0;
+    }
+    if (sizes[i] && overlap) {
+      chunkOffsets[n] = offset;
+      chunkSizes[n] = sizes[i];
+      n++;
+    }
+    offset += (MPI_Offset) sizes[i] * sizeof(double);
+  }
+
+  numChunksAssigned = n;
+}
+
+/* ----------------------------------------------------------------------
+   bounds of my sub-domain, lamda coords if triclinic
+   extended to +/- infinity on faces that lie on the global box boundary
+------------------------------------------------------------------------- */
+
+void ReadRestart::subdomain_bounds(double *lo, double *hi)
+{
+  double *sublo,*subhi,*boxlo,*boxhi;
+  double lamdalo[3] = {0.0,0.0,0.0};
+  double lamdahi[3] = {1.0,1.0,1.0};
+
+  if (domain->triclinic == 0) {
+    sublo = domain->sublo;
+    subhi = domain->subhi;
+    boxlo = domain->boxlo;
+    boxhi = domain->boxhi;
+  } else {
+    sublo = domain->sublo_lamda;
+    subhi = domain->subhi_lamda;
+    boxlo = lamdalo;
+    boxhi = lamdahi;
+  }
+
+  for (int k = 0; k < 3; k++) {
+    lo[k] = sublo[k];
+    hi[k] = subhi[k];
+    if (sublo[k] == boxlo[k]) lo[k] = -BIG;
+    if (subhi[k] == boxhi[k]) hi[k] = BIG;
+  }
+}
+
 // ----------------------------------------------------------------------
 // ----------------------------------------------------------------------
 // low-level fread methods
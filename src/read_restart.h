@@ -34,6 +34,7 @@ class ReadRestart : protected Pointers {
   int me,nprocs,nprocs_file,multiproc_file;
   FILE *fp;
   int nfix_restart_global,nfix_restart_peratom;
+  int remapflag;             // 1 if remap atoms into periodic box on read
 
   int multiproc;             // 0 = proc 0 writes for all
                              // else # of procs writing files
@@ -45,6 +46,9 @@ class ReadRestart : protected Pointers {
   int numChunksAssigned;
   bigint assignedChunkSize;
   MPI_Offset assignedChunkOffset,headerOffset;
+  int indexflag;               // 1 if file has a per-writer chunk index
+  MPI_Offset *chunkOffsets;    // offsets of chunks I read via the index
+  int *chunkSizes;             // sizes of chunks I read via the index
 
   void file_search(char *, char *);
   void header(int);
@@ -55,6 +59,8 @@ class ReadRestart : protected Pointers {
   void endian();
   int version_numeric();
   void file_layout();
+  void select_chunks(int *, double *);
+  void subdomain_bounds(double *, double *);
 
   int read_int();
   bigint read_bigint();
@@ -200,6 +206,11 @@ E: Restart file is not a MPI-IO file
 
 The file is inconsistent with the filename you specified for it.
 
+E: Invalid chunk index in MPI-IO restart file
+
+The chunk index in the file layout section does not match the number
+of procs that wrote the file.  The file is corrupted.
+
 E: Invalid LAMMPS restart file
 
 The file does not appear to be a LAMMPS restart file since
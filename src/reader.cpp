@@ -23,6 +23,14 @@ using namespace LAMMPS_NS;
 Reader::Reader(LAMMPS *lmp) : Pointers(lmp)
 {
   fp = NULL;
+  filecurrent = NULL;
+}
+
+/* ---------------------------------------------------------------------- */
+
+Reader::~Reader()
+{
+  delete [] filecurrent;
 }
 
 /* ----------------------------------------------------------------------
@@ -34,6 +42,10 @@ void Reader::open_file(const char *file)
 {
   if (fp != NULL) close_file();
 
+  delete [] filecurrent;
+  filecurrent = new char[strlen(file)+1];
+  strcpy(filecurrent,file);
+
   compressed = 0;
   const char *suffix = file + strlen(file) - 3;
   if (suffix > file && strcmp(suffix,".gz") == 0) compressed = 1;
@@ -73,3 +85,106 @@ void Reader::close_file()
   else fclose(fp);
   fp = NULL;
 }
+
+/* ----------------------------------------------------------------------
+   if current file is gzipped with a snapshot index footer written by dump,
+     reopen it at first snapshot with timestep >= Nrequest, so the
+     preceding snapshots are neither decompressed nor parsed
+   if no snapshot qualifies, reopen at the footer which is empty
+   return 1 if file was repositioned, else 0
+   only called by proc 0
+------------------------------------------------------------------------- */
+
+int Reader::seek_index(bigint nrequest)
+{
+  if (!compressed || fp == NULL) return 0;
+
+#ifdef LAMMPS_GZIP
+  FILE *fpraw = fopen(filecurrent,"rb");
+  if (fpraw == NULL) return 0;
+
+  // footer offset is last line of the gzip comment near end of file
+
+  char tail[65];
+  fseek(fpraw,0,SEEK_END);
+  long size = ftell(fpraw);
+  long ntail = MIN(size,64);
+  fseek(fpraw,size-ntail,SEEK_SET);
+  ntail = fread(tail,sizeof(char),ntail,fpraw);
+  for (int i = 0; i < ntail; i++) if (tail[i] == '\0') tail[i] = ' ';
+  tail[ntail] = '\0';
+
+  char *ptr = NULL;
+  char *next = strstr(tail,"index ");
+  while (next) {
+    ptr = next;
+    next = strstr(ptr+1,"index ");
+  }
+  bigint footer;
+  if (ptr == NULL || sscanf(ptr+6,BIGINT_FORMAT,&footer) != 1 ||
+      footer < 0 || footer >= size) {
+    fclose(fpraw);
+    return 0;
+  }
+
+  // footer = gzip header with only the FCOMMENT flag set
+  // comment lines after the 1st are timestep and offset of each snapshot
+
+  unsigned char head[10];
+  fseek(fpraw,footer,SEEK_SET);
+  if (fread(head,sizeof(char),10,fpraw) != 10 ||
+      head[0] != 0x1f || head[1] != 0x8b || head[3] != 0x10) {
+    fclose(fpraw);
+    return 0;
+  }
+
+  bigint offset = footer;
+  bigint ntimestep,noffset;
+  char line[64];
+  int c,n = 0;
+  int iline = 0;
+  while ((c = fgetc(fpraw)) != EOF && c != '\0') {
+    if (c != '\n' && n < 63) {
+      line[n++] = c;
+      continue;
+    }
+    line[n] = '\0';
+    n = 0;
+    if (iline++ == 0) {
+      if (strcmp(line,"LAMMPS dump index") != 0) break;
+      continue;
+    }
+    if (sscanf(line,BIGINT_FORMAT " " BIGINT_FORMAT,
+               &ntimestep,&noffset) != 2) break;
+    if (ntimestep >= nrequest) {
+      offset = noffset;
+      break;
+    }
+  }
+  fclose(fpraw);
+
+  if (iline == 0 || offset == 0) return 0;
+
+  // reopen pipe starting at the gzip member of the selected snapshot
+
+  pclose(fp);
+  char gunzip[1024];
+  sprintf(gunzip,"tail -c +" BIGINT_FORMAT " %s | gzip -c -d",
+          offset+1,filecurrent);
+#ifdef _WIN32
+  fp = _popen(gunzip,"rb");
+#else
+  fp = popen(gunzip,"r");
+#endif
+
+  if (fp == NULL) {
+    char str[128];
+    sprintf(str,"Cannot open file %s",filecurrent);
+    error->one(FLERR,str);
+  }
+
+  return 1;
+#else
+  return 0;
+#endif
+}
@@ -23,7 +23,7 @@ namespace LAMMPS_NS {
 class Reader : protected Pointers {
  public:
   Reader(class LAMMPS *);
-  virtual ~Reader() {}
+  virtual ~Reader();
 
   virtual void settings(int, char**) {};
 
@@ -35,10 +35,12 @@ class Reader : protected Pointers {
 
   virtual void open_file(const char *);
   virtual void close_file();
+  virtual int seek_index(bigint);
 
  protected:
   FILE *fp;                // pointer to opened file or pipe
   int compressed;          // flag for dump file compression
+  char *filecurrent;       // name of opened file
 };
 
 }
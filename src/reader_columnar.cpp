@@ -0,0 +1,387 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#include "stdio.h"
+#include "string.h"
+#include "reader_columnar.h"
+#include "memory.h"
+#include "error.h"
+
+#ifdef LAMMPS_ZLIB
+#include "zlib.h"
+#endif
+
+using namespace LAMMPS_NS;
+
+enum{INT32,INT64,FLOAT32,FLOAT64};         // also in dump_custom_columnar.cpp
+
+/* ---------------------------------------------------------------------- */
+
+ReaderColumnar::ReaderColumnar(LAMMPS *lmp) : ReaderNative(lmp)
+{
+  ncol = 0;
+  coltype = NULL;
+  collabel = NULL;
+  colneed = NULL;
+
+  natoms = nread = 0;
+  maxatoms = 0;
+  colvalues = NULL;
+  maxraw = 0;
+  raw = NULL;
+
+  nindex = 0;
+  indexstep = indexoffset = NULL;
+  indexstart = 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+ReaderColumnar::~ReaderColumnar()
+{
+  close_file();
+  free_columns();
+  memory->sfree(raw);
+}
+
+/* ----------------------------------------------------------------------
+   open binary file, read its column table and its frame index
+   leave file positioned at first frame
+   only called by proc 0
+------------------------------------------------------------------------- */
+
+void ReaderColumnar::open_file(const char *file)
+{
+  if (fp != NULL) close_file();
+
+  delete [] filecurrent;
+  filecurrent = new char[strlen(file)+1];
+  strcpy(filecurrent,file);
+
+  compressed = 0;
+  fp = fopen(file,"rb");
+  if (fp == NULL) {
+    char str[128];
+    sprintf(str,"Cannot open file %s",file);
+    error->one(FLERR,str);
+  }
+
+  // file header = magic string, endian and version flags, column table
+
+  char magic[8];
+  int endian,version;
+  if (fread(magic,sizeof(char),8,fp) != 8 ||
+      strncmp(magic,"LMPCOLMN",8) != 0)
+    error->one(FLERR,"Dump file is not a columnar dump file");
+  read_bytes(&endian,sizeof(int),1);
+  read_bytes(&version,sizeof(int),1);
+  if (endian != 0x0001)
+    error->one(FLERR,"Columnar dump file was written on a machine "
+               "with different byte order");
+
+  read_bytes(&ncol,sizeof(int),1);
+  if (ncol <= 0) error->one(FLERR,"Dump file is incorrectly formatted");
+  coltype = new int[ncol];
+  collabel = new char*[ncol];
+  colneed = new int[ncol];
+  colvalues = new double*[ncol];
+  int n;
+  for (int i = 0; i < ncol; i++) {
+    read_bytes(&coltype[i],sizeof(int),1);
+    read_bytes(&n,sizeof(int),1);
+    if (coltype[i] < INT32 || coltype[i] > FLOAT64 || n <= 0)
+      error->one(FLERR,"Dump file is incorrectly formatted");
+    collabel[i] = new char[n];
+    read_bytes(collabel[i],sizeof(char),n);
+    collabel[i][n-1] = '\0';
+    colneed[i] = 0;
+    colvalues[i] = NULL;
+  }
+  maxatoms = 0;
+  long firstframe = ftell(fp);
+
+  // index location is stored at very end of file
+  // file without a complete index, e.g. from an interrupted run,
+  //   is still read sequentially
+
+  nindex = 0;
+  indexstart = 0;
+  bigint offset;
+  if (fseek(fp,-(long) (sizeof(bigint)+8),SEEK_END) == 0 &&
+      fread(&offset,sizeof(bigint),1,fp) == 1 &&
+      fread(magic,sizeof(char),8,fp) == 8 &&
+      strncmp(magic,"LMPCOLIX",8) == 0 && offset >= firstframe) {
+    fseek(fp,offset,SEEK_SET);
+    if (fread(magic,sizeof(char),4,fp) == 4 &&
+        strncmp(magic,"INDX",4) == 0 &&
+        fread(&nindex,sizeof(int),1,fp) == 1 && nindex >= 0) {
+      memory->create(indexstep,nindex,"read_dump:indexstep");
+      memory->create(indexoffset,nindex,"read_dump:indexoffset");
+      read_bytes(indexstep,sizeof(bigint),nindex);
+      read_bytes(indexoffset,sizeof(bigint),nindex);
+      indexstart = offset;
+    } else nindex = 0;
+  }
+
+  fseek(fp,firstframe,SEEK_SET);
+}
+
+/* ---------------------------------------------------------------------- */
+
+void ReaderColumnar::close_file()
+{
+  if (fp == NULL) return;
+  fclose(fp);
+  fp = NULL;
+  free_columns();
+}
+
+/* ----------------------------------------------------------------------
+   position file at first indexed frame with timestep >= Nrequest
+   if no frame qualifies, position at index which reads as end of file
+   return 1 if file was repositioned, else 0
+   only called by proc 0
+------------------------------------------------------------------------- */
+
+int ReaderColumnar::seek_index(bigint nrequest)
+{
+  if (fp == NULL || indexstart == 0) return 0;
+
+  bigint offset = indexstart;
+  for (int i = 0; i < nindex; i++)
+    if (indexstep[i] >= nrequest) {
+      offset = indexoffset[i];
+      break;
+    }
+
+  fseek(fp,offset,SEEK_SET);
+  return 1;
+}
+
+/* ----------------------------------------------------------------------
+   read and return time stamp from frame header
+   if reach end-of-file or index, return 1 so caller can open next file
+   only called by proc 0
+------------------------------------------------------------------------- */
+
+int ReaderColumnar::read_time(bigint &ntimestep)
+{
+  char marker[4];
+  if (fread(marker,sizeof(char),4,fp) != 4) return 1;
+  if (strncmp(marker,"INDX",4) == 0) return 1;
+  if (strncmp(marker,"FRME",4) != 0)
+    error->one(FLERR,"Dump file is incorrectly formatted");
+  read_bytes(&ntimestep,sizeof(bigint),1);
+  return 0;
+}
+
+/* ----------------------------------------------------------------------
+   skip frame from timestep onward by seeking past each column
+   only called by proc 0
+------------------------------------------------------------------------- */
+
+void ReaderColumnar::skip()
+{
+  int triclinic;
+  char boundstr[8];
+  double box[9];
+  read_bytes(&natoms,sizeof(bigint),1);
+  read_bytes(&triclinic,sizeof(int),1);
+  read_bytes(boundstr,sizeof(char),8);
+  read_bytes(box,sizeof(double),9);
+
+  int flag;
+  bigint nbytes;
+  for (int i = 0; i < ncol; i++) {
+    read_bytes(&flag,sizeof(int),1);
+    read_bytes(&nbytes,sizeof(bigint),1);
+    fseek(fp,nbytes,SEEK_CUR);
+  }
+}
+
+/* ----------------------------------------------------------------------
+   read remaining frame header info:
+     return natoms
+     box bounds, triclinic, fieldflag (1 if any fields not found),
+     xyz flags = UNSET (not a requested field), SCALE/WRAP as in enum
+   if fieldflag set:
+     match Nfield fields to column labels of file
+   load columns mapped to requested fields, seek past all others
+   only called by proc 0
+------------------------------------------------------------------------- */
+
+bigint ReaderColumnar::read_header(double box[3][3], int &triclinic,
+                                   int fieldinfo, int nfield,
+                                   int *fieldtype, char **fieldlabel,
+                                   int scaleflag, int wrapflag, int &fieldflag,
+                                   int &xflag, int &yflag, int &zflag)
+{
+  char boundstr[8];
+  read_bytes(&natoms,sizeof(bigint),1);
+  read_bytes(&triclinic,sizeof(int),1);
+  read_bytes(boundstr,sizeof(char),8);
+  read_bytes(&box[0][0],sizeof(double),9);
+
+  if (fieldinfo) {
+    fieldflag = match_fields(ncol,collabel,nfield,fieldtype,fieldlabel,
+                             scaleflag,wrapflag,xflag,yflag,zflag);
+  }
+
+  for (int i = 0; i < ncol; i++) colneed[i] = 0;
+  if (fieldindex)
+    for (int m = 0; m < nfield; m++)
+      if (fieldindex[m] >= 0 && fieldindex[m] < ncol)
+        colneed[fieldindex[m]] = 1;
+
+  read_columns();
+  return natoms;
+}
+
+/* ----------------------------------------------------------------------
+   return next N atoms of frame from loaded columns
+   stores appropriate values in fields array
+   only called by proc 0
+------------------------------------------------------------------------- */
+
+void ReaderColumnar::read_atoms(int n, int nfield, double **fields)
+{
+  if (nread + n > natoms) error->one(FLERR,"Unexpected end of dump file");
+
+  for (int m = 0; m < nfield; m++) {
+    double *values = &colvalues[fieldindex[m]][nread];
+    for (int i = 0; i < n; i++) fields[i][m] = values[i];
+  }
+  nread += n;
+}
+
+/* ----------------------------------------------------------------------
+   read all columns of current frame
+   only needed columns are read and converted to doubles,
+     others are skipped with a seek
+------------------------------------------------------------------------- */
+
+void ReaderColumnar::read_columns()
+{
+  if (natoms > MAXSMALLINT)
+    error->one(FLERR,"Columnar dump file has too many atoms in one snapshot");
+
+  if (natoms > maxatoms) {
+    maxatoms = natoms;
+    for (int i = 0; i < ncol; i++) {
+      memory->destroy(colvalues[i]);
+      colvalues[i] = NULL;
+    }
+  }
+
+  int flag;
+  bigint nbytes;
+  for (int i = 0; i < ncol; i++) {
+    read_bytes(&flag,sizeof(int),1);
+    read_bytes(&nbytes,sizeof(bigint),1);
+    if (colneed[i]) read_column(i,flag,nbytes);
+    else fseek(fp,nbytes,SEEK_CUR);
+  }
+
+  nread = 0;
+}
+
+/* ----------------------------------------------------------------------
+   read column I of Nbytes and convert its values to doubles
+   uncompress first if flag is set
+------------------------------------------------------------------------- */
+
+void ReaderColumnar::read_column(int i, int flag, bigint nbytes)
+{
+  int width;
+  if (coltype[i] == INT32) width = sizeof(int);
+  else if (coltype[i] == INT64) width = sizeof(bigint);
+  else if (coltype[i] == FLOAT32) width = sizeof(float);
+  else width = sizeof(double);
+  bigint nraw = natoms*width;
+
+  bigint nneed = nraw + (flag ? nbytes : 0);
+  if (nneed > maxraw) {
+    maxraw = nneed;
+    memory->sfree(raw);
+    raw = (char *) memory->smalloc(maxraw,"read_dump:raw");
+  }
+
+  if (flag == 0) {
+    if (nbytes != nraw) error->one(FLERR,"Dump file is incorrectly formatted");
+    read_bytes(raw,sizeof(char),nbytes);
+  } else {
+    char *zraw = &raw[nraw];
+    read_bytes(zraw,sizeof(char),nbytes);
+#ifdef LAMMPS_ZLIB
+    uLongf nout = nraw;
+    if (uncompress((Bytef *) raw,&nout,(Bytef *) zraw,nbytes) != Z_OK ||
+        (bigint) nout != nraw)
+      error->one(FLERR,"Cannot uncompress column of columnar dump file");
+#else
+    error->one(FLERR,"Cannot uncompress column of columnar dump file");
+#endif
+  }
+
+  if (colvalues[i] == NULL)
+    memory->create(colvalues[i],maxatoms,"read_dump:colvalues");
+  double *values = colvalues[i];
+
+  if (coltype[i] == INT32) {
+    int *ivalues = (int *) raw;
+    for (bigint m = 0; m < natoms; m++) values[m] = ivalues[m];
+  } else if (coltype[i] == INT64) {
+    bigint *bvalues = (bigint *) raw;
+    for (bigint m = 0; m < natoms; m++) values[m] = bvalues[m];
+  } else if (coltype[i] == FLOAT32) {
+    float *fvalues = (float *) raw;
+    for (bigint m = 0; m < natoms; m++) values[m] = fvalues[m];
+  } else memcpy(values,raw,natoms*sizeof(double));
+}
+
+/* ----------------------------------------------------------------------
+   free column table and index of current file
+------------------------------------------------------------------------- */
+
+void ReaderColumnar::free_columns()
+{
+  for (int i = 0; i < ncol; i++) {
+    delete [] collabel[i];
+    memory->destroy(colvalues[i]);
+  }
+  delete [] coltype;
+  delete [] collabel;
+  delete [] colneed;
+  delete [] colvalues;
+  coltype = NULL;
+  collabel = NULL;
+  colneed = NULL;
+  colvalues = NULL;
+  ncol = 0;
+  maxatoms = 0;
+
+  memory->destroy(indexstep);
+  memory->destroy(indexoffset);
+  indexstep = indexoffset = NULL;
+  nindex = 0;
+  indexstart = 0;
+}
+
+/* ----------------------------------------------------------------------
+   read N items of Size bytes from file, error if file ends
+------------------------------------------------------------------------- */
+
+void ReaderColumnar::read_bytes(void *ptr, size_t size, size_t n)
+{
+  if (fread(ptr,size,n,fp) != n)
+    error->one(FLERR,"Unexpected end of dump file");
+}
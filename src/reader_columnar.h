@@ -0,0 +1,104 @@
+/* -*- c++ -*- ----------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   http://lammps.sandia.gov, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+#ifdef READER_CLASS
+
+ReaderStyle(columnar,ReaderColumnar)
+
+#else
+
+#ifndef LMP_READER_COLUMNAR_H
+#define LMP_READER_COLUMNAR_H
+
+#include "reader_native.h"
+
+namespace LAMMPS_NS {
+
+class ReaderColumnar : public ReaderNative {
+ public:
+  ReaderColumnar(class LAMMPS *);
+  ~ReaderColumnar();
+
+  int read_time(bigint &);
+  void skip();
+  bigint read_header(double [3][3], int &, int, int, int *, char **,
+                     int, int, int &, int &, int &, int &);
+  void read_atoms(int, int, double **);
+
+  void open_file(const char *);
+  void close_file();
+  int seek_index(bigint);
+
+ private:
+  int ncol;                // # of per-atom columns in file
+  int *coltype;            // binary type of each column (INT32, etc)
+  char **collabel;         // label of each column
+  int *colneed;            // 1 if column is mapped to a requested field
+
+  bigint natoms;           // # of atoms in current frame
+  bigint nread;            // # of atoms of current frame already returned
+  bigint maxatoms;         // size of per-column value arrays
+  double **colvalues;      // values of each needed column in current frame
+  bigint maxraw;           // size of raw
+  char *raw;               // raw bytes of one column as stored in file
+
+  int nindex;              // # of frames in index of current file
+  bigint *indexstep;       // timestep of each indexed frame
+  bigint *indexoffset;     // file offset of each indexed frame
+  bigint indexstart;       // file offset of index, 0 if no index
+
+  void read_columns();
+  void read_column(int, int, bigint);
+  void free_columns();
+  void read_bytes(void *, size_t, size_t);
+};
+
+}
+
+#endif
+#endif
+
+/* ERROR/WARNING messages:
+
+E: Cannot open file %s
+
+The specified file cannot be opened.  Check that the path and name are
+correct.
+
+E: Dump file is not a columnar dump file
+
+The file does not start with the header written by dump custom/columnar.
+
+E: Columnar dump file was written on a machine with different byte order
+
+The binary values in the file cannot be read on this machine.
+
+E: Dump file is incorrectly formatted
+
+Self-explanatory.
+
+E: Unexpected end of dump file
+
+A read operation from the file failed.
+
+E: Columnar dump file has too many atoms in one snapshot
+
+The per-column values of a single snapshot must fit in memory of the
+proc reading the file.
+
+E: Cannot uncompress column of columnar dump file
+
+The column is corrupted or LAMMPS was not compiled with -DLAMMPS_ZLIB,
+which is required to read a file written with dump_modify compress yes.
+
+*/
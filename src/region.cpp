@@ -15,13 +15,16 @@
 #include "stdlib.h"
 #include "string.h"
 #include "region.h"
+#include "atom.h"
 #include "update.h"
 #include "domain.h"
+#include "neighbor.h"
 #include "lattice.h"
 #include "input.h"
 #include "variable.h"
 #include "error.h"
 #include "force.h"
+#include "memory.h"
 
 using namespace LAMMPS_NS;
 
@@ -40,6 +43,12 @@ Region::Region(LAMMPS *lmp, int narg, char **arg) : Pointers(lmp)
   varshape = 0;
   xstr = ystr = zstr = tstr = NULL;
   dx = dy = dz = 0.0;
+
+  nmax_cache = 0;
+  inflag = safeflag = evallist = NULL;
+  tagcache = NULL;
+  xcache = NULL;
+  margin = 0.0;
 }
 
 /* ---------------------------------------------------------------------- */
@@ -53,6 +62,12 @@ Region::~Region()
   delete [] ystr;
   delete [] zstr;
   delete [] tstr;
+
+  memory->destroy(inflag);
+  memory->destroy(safeflag);
+  memory->destroy(tagcache);
+  memory->destroy(xcache);
+  memory->destroy(evallist);
 }
 
 /* ---------------------------------------------------------------------- */
@@ -130,6 +145,133 @@ int Region::match(double x, double y, double z)
   return !(inside(x,y,z) ^ interior);
 }
 
+/* ----------------------------------------------------------------------
+   determine which owned atoms are a match to region volume
+   return per-atom vector of 1 for match, 0 for no match, valid until next call
+   for a static region, the match of each atom is cached together with
+     its coords and whether it was farther than margin from all surfaces
+   margin = 1/2 of neighbor skin, same as trigger in Neighbor::check_distance()
+   a cached match is re-used if atom ID is unchanged, atom was beyond margin
+     and atom has not moved margin or more since, else it is re-evaluated
+   all atoms are evaluated if region is dynamic or has variable shape
+   invokes prematch(), so caller is responsible for wrapping this call with
+     modify->clearstep_compute() and modify->addstep_compute() if needed
+------------------------------------------------------------------------- */
+
+int *Region::match_atoms()
+{
+  int i,k;
+  double delx,dely,delz;
+
+  prematch();
+
+  if (atom->nmax > nmax_cache) {
+    int nold = nmax_cache;
+    nmax_cache = atom->nmax;
+    memory->grow(inflag,nmax_cache,"region:inflag");
+    memory->grow(safeflag,nmax_cache,"region:safeflag");
+    memory->grow(tagcache,nmax_cache,"region:tagcache");
+    memory->grow(xcache,nmax_cache,3,"region:xcache");
+    memory->grow(evallist,nmax_cache,"region:evallist");
+    for (i = nold; i < nmax_cache; i++) safeflag[i] = 0;
+  }
+
+  double **x = atom->x;
+  tagint *tag = atom->tag;
+  int nlocal = atom->nlocal;
+
+  // cached matches are invalid if skin changed since last call
+
+  int cacheflag = 1;
+  if (dynamic_check() || !atom->tag_enable) cacheflag = 0;
+  if (0.5*neighbor->skin != margin) {
+    margin = 0.5*neighbor->skin;
+    for (i = 0; i < nmax_cache; i++) safeflag[i] = 0;
+  }
+  if (margin <= 0.0) cacheflag = 0;
+  double marginsq = margin*margin;
+
+  int n = 0;
+  for (i = 0; i < nlocal; i++) {
+    if (cacheflag && safeflag[i] && tagcache[i] == tag[i]) {
+      delx = x[i][0] - xcache[i][0];
+      dely = x[i][1] - xcache[i][1];
+      delz = x[i][2] - xcache[i][2];
+      if (delx*delx + dely*dely + delz*delz < marginsq) continue;
+    }
+    evallist[n++] = i;
+  }
+
+  match_list(n,evallist,x,inflag);
+
+  if (cacheflag) {
+    for (k = 0; k < n; k++) {
+      i = evallist[k];
+      tagcache[i] = tag[i];
+      xcache[i][0] = x[i][0];
+      xcache[i][1] = x[i][1];
+      xcache[i][2] = x[i][2];
+      safeflag[i] = !near_surface(x[i],margin);
+    }
+  } else {
+    for (k = 0; k < n; k++) safeflag[evallist[k]] = 0;
+  }
+
+  return inflag;
+}
+
+/* ----------------------------------------------------------------------
+   set flag[i] = match() for N atoms with indices i in ilist
+   static regions test all atoms with one call to inside_list()
+------------------------------------------------------------------------- */
+
+void Region::match_list(int n, int *ilist, double **x, int *flag)
+{
+  int i,k;
+
+  if (dynamic) {
+    for (k = 0; k < n; k++) {
+      i = ilist[k];
+      flag[i] = match(x[i][0],x[i][1],x[i][2]);
+    }
+    return;
+  }
+
+  inside_list(n,ilist,x,flag);
+  if (!interior)
+    for (k = 0; k < n; k++) flag[ilist[k]] ^= 1;
+}
+
+/* ----------------------------------------------------------------------
+   set flag[i] = inside() for N atoms with indices i in ilist
+   regions can override this with a loop that avoids a virtual call per atom
+------------------------------------------------------------------------- */
+
+void Region::inside_list(int n, int *ilist, double **x, int *flag)
+{
+  int i;
+  for (int k = 0; k < n; k++) {
+    i = ilist[k];
+    flag[i] = inside(x[i][0],x[i][1],x[i][2]);
+  }
+}
+
+/* ----------------------------------------------------------------------
+   return 1 if point x is within cutoff of a surface of region, else 0
+   used by match_atoms() to decide if inside() of x can change when x moves
+     by less than cutoff, so a region may err on the side of returning 1
+   x is in region space, independent of interior/exterior setting
+   both sides are checked, since for x on a surface inside() and
+     surface_interior()/surface_exterior() can differ by round-off
+------------------------------------------------------------------------- */
+
+int Region::near_surface(double *x, double cutoff)
+{
+  if (surface_interior(x,cutoff)) return 1;
+  if (surface_exterior(x,cutoff)) return 1;
+  return 0;
+}
+
 /* ----------------------------------------------------------------------
    generate list of contact points for interior or exterior regions
    if region has variable shape, invoke shape_update() once per timestep
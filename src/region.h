@@ -50,12 +50,19 @@ class Region : protected Pointers {
   int match(double, double, double);
   int surface(double, double, double, double);
 
+  // called by other classes to check all owned atoms versus region
+
+  int *match_atoms();
+  void match_list(int, int *, double **, int *);
+
   // implemented by each region, not called by other classes
 
   virtual int inside(double, double, double) = 0;
   virtual int surface_interior(double *, double) = 0;
   virtual int surface_exterior(double *, double) = 0;
   virtual void shape_update() {}
+  virtual void inside_list(int, int *, double **, int *);
+  virtual int near_surface(double *, double);
 
  protected:
   void add_contact(int, double *, double, double, double);
@@ -70,6 +77,16 @@ class Region : protected Pointers {
   int xvar,yvar,zvar,tvar;
   double dx,dy,dz,theta;
 
+  // cache of match() for owned atoms, see match_atoms()
+
+  int nmax_cache;             // size of per-atom cache arrays
+  int *inflag;                // 1 if atom matches region
+  int *safeflag;              // 1 if atom is beyond margin from any surface
+  tagint *tagcache;           // ID of atom whose match is cached
+  double **xcache;            // coords at which match was computed
+  int *evallist;              // atoms whose match is re-evaluated
+  double margin;              // distance used for safeflag
+
   void pretransform();
   void forward_transform(double &, double &, double &);
   void inverse_transform(double &, double &, double &);
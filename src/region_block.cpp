@@ -118,6 +118,23 @@ int RegBlock::inside(double x, double y, double z)
   return 0;
 }
 
+/* ----------------------------------------------------------------------
+   set flag[i] = inside() for N atoms with indices i in ilist
+------------------------------------------------------------------------- */
+
+void RegBlock::inside_list(int n, int *ilist, double **x, int *flag)
+{
+  int i;
+  double *xi;
+
+  for (int k = 0; k < n; k++) {
+    i = ilist[k];
+    xi = x[i];
+    flag[i] = (xi[0] >= xlo && xi[0] <= xhi && xi[1] >= ylo && xi[1] <= yhi &&
+               xi[2] >= zlo && xi[2] <= zhi);
+  }
+}
+
 /* ----------------------------------------------------------------------
    contact if 0 <= x < cutoff from one or more inner surfaces of block
    can be one contact for each of 6 faces
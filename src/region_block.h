@@ -31,6 +31,7 @@ class RegBlock : public Region {
   RegBlock(class LAMMPS *, int, char **);
   ~RegBlock();
   int inside(double, double, double);
+  void inside_list(int, int *, double **, int *);
   int surface_interior(double *, double);
   int surface_exterior(double *, double);
 
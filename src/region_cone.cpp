@@ -514,6 +514,63 @@ int RegCone::surface_exterior(double *x, double cutoff)
   }
 }
 
+/* ----------------------------------------------------------------------
+   return 1 if x is within cutoff of surface of cone
+   distance is computed in plane of x and cone axis, where the cone surface
+     is 3 line segments: side and the two end planes
+------------------------------------------------------------------------- */
+
+int RegCone::near_surface(double *x, double cutoff)
+{
+  double del1,del2,z;
+  double c[3],corner1[3],corner2[3],corner3[3],corner4[3],xp[3];
+
+  if (axis == 'x') {
+    del1 = x[1] - c1;
+    del2 = x[2] - c2;
+    z = x[0];
+  } else if (axis == 'y') {
+    del1 = x[0] - c1;
+    del2 = x[2] - c2;
+    z = x[1];
+  } else {
+    del1 = x[0] - c1;
+    del2 = x[1] - c2;
+    z = x[2];
+  }
+
+  c[0] = sqrt(del1*del1 + del2*del2);
+  c[1] = z;
+  c[2] = 0.0;
+
+  corner1[0] = radiuslo;
+  corner1[1] = lo;
+  corner2[0] = radiushi;
+  corner2[1] = hi;
+  corner3[0] = 0.0;
+  corner3[1] = lo;
+  corner4[0] = 0.0;
+  corner4[1] = hi;
+  corner1[2] = corner2[2] = corner3[2] = corner4[2] = 0.0;
+
+  // an end plane of 0 radius is the apex, which is on the side segment
+
+  double distsq = BIG;
+  point_on_line_segment(corner1,corner2,c,xp);
+  distsq = closest(c,xp,xp,distsq);
+  if (radiuslo > 0.0) {
+    point_on_line_segment(corner1,corner3,c,xp);
+    distsq = closest(c,xp,xp,distsq);
+  }
+  if (radiushi > 0.0) {
+    point_on_line_segment(corner2,corner4,c,xp);
+    distsq = closest(c,xp,xp,distsq);
+  }
+
+  if (distsq < cutoff*cutoff) return 1;
+  return 0;
+}
+
 /* ----------------------------------------------------------------------
    find nearest point to C on line segment A,B and return it as D
    project (C-A) onto (B-A)
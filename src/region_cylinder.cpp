@@ -430,6 +430,31 @@ int RegCylinder::surface_exterior(double *x, double cutoff)
   }
 }
 
+/* ----------------------------------------------------------------------
+   return 1 if x is within cutoff of surface of cylinder
+   x on the axis is always near, since surface_interior() and
+     surface_exterior() cannot compute a contact for it
+------------------------------------------------------------------------- */
+
+int RegCylinder::near_surface(double *x, double cutoff)
+{
+  double del1,del2;
+
+  if (axis == 'x') {
+    del1 = x[1] - c1;
+    del2 = x[2] - c2;
+  } else if (axis == 'y') {
+    del1 = x[0] - c1;
+    del2 = x[2] - c2;
+  } else {
+    del1 = x[0] - c1;
+    del2 = x[1] - c2;
+  }
+
+  if (del1 == 0.0 && del2 == 0.0) return 1;
+  return Region::near_surface(x,cutoff);
+}
+
 /* ----------------------------------------------------------------------
    change region shape via variable evaluation
 ------------------------------------------------------------------------- */
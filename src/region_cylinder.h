@@ -34,6 +34,7 @@ class RegCylinder : public Region {
   int inside(double, double, double);
   int surface_interior(double *, double);
   int surface_exterior(double *, double);
+  int near_surface(double *, double);
   void shape_update();
 
  private:
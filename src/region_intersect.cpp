@@ -14,9 +14,11 @@
 #include "stdlib.h"
 #include "string.h"
 #include "region_intersect.h"
+#include "atom.h"
 #include "domain.h"
 #include "error.h"
 #include "force.h"
+#include "memory.h"
 
 using namespace LAMMPS_NS;
 
@@ -91,6 +93,9 @@ RegIntersect::RegIntersect(LAMMPS *lmp, int narg, char **arg) :
   for (int ilist = 0; ilist < nregion; ilist++)
     cmax += regions[list[ilist]]->cmax;
   contact = new Contact[cmax];
+
+  maxwork = 0;
+  work = NULL;
 }
 
 /* ---------------------------------------------------------------------- */
@@ -101,6 +106,7 @@ RegIntersect::~RegIntersect()
   delete [] idsub;
   delete [] list;
   delete [] contact;
+  memory->destroy(work);
 }
 
 /* ---------------------------------------------------------------------- */
@@ -253,3 +259,45 @@ void RegIntersect::shape_update()
   for (int ilist = 0; ilist < nregion; ilist++)
     regions[list[ilist]]->shape_update();
 }
+
+/* ----------------------------------------------------------------------
+   set flag[i] = inside() for N atoms with indices i in ilist
+   each sub-region tests all atoms with one call to match_list(),
+     skipping atoms that matched all previous sub-regions
+------------------------------------------------------------------------- */
+
+void RegIntersect::inside_list(int n, int *ilist, double **x, int *flag)
+{
+  int k,m;
+
+  if (n > maxwork) {
+    maxwork = MAX(n,atom->nmax);
+    memory->destroy(work);
+    memory->create(work,maxwork,"region:work");
+  }
+
+  for (k = 0; k < n; k++) work[k] = ilist[k];
+  int nwork = n;
+
+  Region **regions = domain->regions;
+  for (int iregion = 0; iregion < nregion && nwork; iregion++) {
+    regions[list[iregion]]->match_list(nwork,work,x,flag);
+    m = 0;
+    for (k = 0; k < nwork; k++)
+      if (flag[work[k]]) work[m++] = work[k];
+    nwork = m;
+  }
+}
+
+/* ----------------------------------------------------------------------
+   return 1 if x is within cutoff of surface of any sub-region
+   inside() can only change if match() of a sub-region changes
+------------------------------------------------------------------------- */
+
+int RegIntersect::near_surface(double *x, double cutoff)
+{
+  Region **regions = domain->regions;
+  for (int ilist = 0; ilist < nregion; ilist++)
+    if (regions[list[ilist]]->near_surface(x,cutoff)) return 1;
+  return 0;
+}
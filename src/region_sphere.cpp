@@ -104,6 +104,24 @@ int RegSphere::inside(double x, double y, double z)
   return 0;
 }
 
+/* ----------------------------------------------------------------------
+   set flag[i] = inside() for N atoms with indices i in ilist
+------------------------------------------------------------------------- */
+
+void RegSphere::inside_list(int n, int *ilist, double **x, int *flag)
+{
+  int i;
+  double delx,dely,delz;
+
+  for (int k = 0; k < n; k++) {
+    i = ilist[k];
+    delx = x[i][0] - xc;
+    dely = x[i][1] - yc;
+    delz = x[i][2] - zc;
+    flag[i] = (sqrt(delx*delx + dely*dely + delz*delz) <= radius);
+  }
+}
+
 /* ----------------------------------------------------------------------
    one contact if 0 <= x < cutoff from inner surface of sphere
    no contact if outside (possible if called from union/intersect)
@@ -155,6 +173,20 @@ int RegSphere::surface_exterior(double *x, double cutoff)
   return 0;
 }
 
+/* ----------------------------------------------------------------------
+   return 1 if x is within cutoff of surface of sphere, including center
+------------------------------------------------------------------------- */
+
+int RegSphere::near_surface(double *x, double cutoff)
+{
+  double delx = x[0] - xc;
+  double dely = x[1] - yc;
+  double delz = x[2] - zc;
+  double r = sqrt(delx*delx + dely*dely + delz*delz);
+  if (fabs(r - radius) < cutoff) return 1;
+  return 0;
+}
+
 /* ----------------------------------------------------------------------
    change region shape via variable evaluation
 ------------------------------------------------------------------------- */
@@ -30,8 +30,10 @@ class RegSphere : public Region {
   ~RegSphere();
   void init();
   int inside(double, double, double);
+  void inside_list(int, int *, double **, int *);
   int surface_interior(double *, double);
   int surface_exterior(double *, double);
+  int near_surface(double *, double);
   void shape_update();
 
  private:
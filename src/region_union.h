@@ -34,11 +34,15 @@ class RegUnion : public Region {
   int surface_interior(double *, double);
   int surface_exterior(double *, double);
   void shape_update();
+  void inside_list(int, int *, double **, int *);
+  int near_surface(double *, double);
 
  private:
   int nregion;
   int *list;
   char **idsub;
+  int maxwork;              // size of work
+  int *work;                // atoms still to be tested by inside_list()
 };
 
 }
@@ -478,6 +478,14 @@ void Respa::run(int n)
       output->write(update->ntimestep);
       timer->stamp(TIME_OUTPUT);
     }
+
+    // periodic timer output in JSON format
+
+    if (timer->jsonevery && ntimestep % timer->jsonevery == 0) {
+      timer->stamp();
+      timer->write_json(timer->elapsed(TIME_LOOP));
+      timer->stamp(TIME_OUTPUT);
+    }
   }
 }
 
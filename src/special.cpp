@@ -13,6 +13,7 @@
 
 #include "mpi.h"
 #include "stdio.h"
+#include "string.h"
 #include "special.h"
 #include "atom.h"
 #include "atom_vec.h"
@@ -21,11 +22,9 @@
 #include "memory.h"
 #include "error.h"
 
-using namespace LAMMPS_NS;
-
-// allocate space for static class variable
+#include <map>
 
-Special *Special::sptr;
+using namespace LAMMPS_NS;
 
 /* ---------------------------------------------------------------------- */
 
@@ -35,6 +34,9 @@ Special::Special(LAMMPS *lmp) : Pointers(lmp)
   MPI_Comm_size(world,&nprocs);
 
   onetwo = onethree = onefour = NULL;
+  nrvous = 0;
+  atomIDs = NULL;
+  procowner = NULL;
 }
 
 /* ---------------------------------------------------------------------- */
@@ -44,372 +46,419 @@ Special::~Special()
   memory->destroy(onetwo);
   memory->destroy(onethree);
   memory->destroy(onefour);
+  memory->destroy(atomIDs);
+  memory->destroy(procowner);
 }
 
 /* ----------------------------------------------------------------------
    create 1-2, 1-3, 1-4 lists of topology neighbors
    store in onetwo, onethree, onefour for each atom
    store 3 counters in nspecial[i]
+   info for atoms owned by other procs is exchanged via rendezvous comm
+     with each atom ID assigned to a rendezvous proc = ID % nprocs
 ------------------------------------------------------------------------- */
 
 void Special::build()
 {
-  int i,j,k,size;
-  int max,maxall,nbuf;
-  tagint *buf;
-
   MPI_Barrier(world);
 
   int nlocal = atom->nlocal;
-
-  tagint *tag = atom->tag;
-  int *num_bond = atom->num_bond;
-  tagint **bond_atom = atom->bond_atom;
   int **nspecial = atom->nspecial;
 
   if (me == 0 && screen) fprintf(screen,"Finding 1-2 1-3 1-4 neighbors ...\n");
 
   // initialize nspecial counters to 0
 
-  for (i = 0; i < nlocal; i++) {
+  for (int i = 0; i < nlocal; i++) {
     nspecial[i][0] = 0;
     nspecial[i][1] = 0;
     nspecial[i][2] = 0;
   }
 
-  // -----------------------------------------------------
-  // compute nspecial[i][0] = # of 1-2 neighbors of atom i
-  // -----------------------------------------------------
-
-  // bond partners stored by atom itself
+  // setup atomIDs and procowner vectors in rendezvous decomposition
 
-  for (i = 0; i < nlocal; i++) nspecial[i][0] = num_bond[i];
+  atom_owners();
 
-  // if newton_bond off, then done
-  // else only counted 1/2 of all bonds, so count other half
+  // tally 1-2 neighbors, create onetwo[i] = list of 1-2 neighbors of atom i
+  // if newton_bond off, each atom already stores all of its bond partners
 
-  if (force->newton_bond) {
+  if (force->newton_bond) onetwo_build_newton();
+  else onetwo_build_newton_off();
 
-    // nbufmax = largest buffer needed to hold info from any proc
-    // info for each atom = global tag of 2nd atom in each bond
+  // done if special_bonds for 1-3, 1-4 are set to 1.0
+  // else create onethree[i], and onefour[i] if 1-4 is not set to 1.0
 
-    nbuf = 0;
-    for (i = 0; i < nlocal; i++) nbuf += num_bond[i];
-    memory->create(buf,nbuf,"special:buf");
+  if (force->special_lj[2] == 1.0 && force->special_coul[2] == 1.0 &&
+      force->special_lj[3] == 1.0 && force->special_coul[3] == 1.0) {
+    dedup();
+    combine();
 
-    // fill buffer with global tags of bond partners of my atoms
+  } else if (force->special_lj[3] == 1.0 && force->special_coul[3] == 1.0) {
+    onethree_build();
+    dedup();
+    if (force->special_angle) angle_trim();
+    combine();
 
-    size = 0;
-    for (i = 0; i < nlocal; i++)
-      for (j = 0; j < num_bond[i]; j++)
-        buf[size++] = bond_atom[i][j];
+  } else {
+    onethree_build();
+    onefour_build();
+    dedup();
+    if (force->special_angle) angle_trim();
+    if (force->special_dihedral) dihedral_trim();
+    combine();
+  }
 
-    // cycle buffer around ring of procs back to self
-    // when receive buffer, scan tags for atoms I own
-    // when find one, increment nspecial count for that atom
+  memory->destroy(atomIDs);
+  memory->destroy(procowner);
+  atomIDs = NULL;
+  procowner = NULL;
+  nrvous = 0;
+}
 
-    sptr = this;
-    comm->ring(size,sizeof(tagint),buf,1,ring_one,NULL);
+/* ----------------------------------------------------------------------
+   setup atomIDs and procowner vectors on rendezvous procs
+   each owned atom sends its ID and my proc ID to proc = ID % nprocs
+------------------------------------------------------------------------- */
 
-    memory->destroy(buf);
-  }
+void Special::atom_owners()
+{
+  tagint *tag = atom->tag;
+  int nlocal = atom->nlocal;
 
-  // ----------------------------------------------------
-  // create onetwo[i] = list of 1-2 neighbors for atom i
-  // ----------------------------------------------------
+  int *proclist;
+  memory->create(proclist,nlocal,"special:proclist");
+  IDRvous *idbuf = (IDRvous *)
+    memory->smalloc((bigint) nlocal*sizeof(IDRvous),"special:idbuf");
 
-  max = 0;
-  for (i = 0; i < nlocal; i++) max = MAX(max,nspecial[i][0]);
+  for (int i = 0; i < nlocal; i++) {
+    proclist[i] = tag[i] % nprocs;
+    idbuf[i].me = me;
+    idbuf[i].atomID = tag[i];
+  }
 
-  MPI_Allreduce(&max,&maxall,1,MPI_INT,MPI_MAX,world);
+  // rendezvous_ids() stores the datums and returns nothing
 
-  if (me == 0) {
-    if (screen) fprintf(screen,"  %d = max # of 1-2 neighbors\n",maxall);
-    if (logfile) fprintf(logfile,"  %d = max # of 1-2 neighbors\n",maxall);
-  }
+  char *buf;
+  comm->rendezvous(nlocal,proclist,(char *) idbuf,sizeof(IDRvous),
+                   rendezvous_ids,buf,0,(void *) this);
 
-  memory->create(onetwo,nlocal,maxall,"special:onetwo");
+  memory->destroy(proclist);
+  memory->sfree(idbuf);
+  memory->sfree(buf);
+}
 
-  // count = accumulating counter
+/* ----------------------------------------------------------------------
+   send N pairs of atom IDs to procs owning the 1st atom in each pair
+   pairs are routed via the rendezvous proc of the 1st atom
+   proclist is filled here, outbuf is allocated here, caller frees it
+   return # of pairs received for my owned atoms
+------------------------------------------------------------------------- */
 
-  memory->create(count,nlocal,"special:count");
-  for (i = 0; i < nlocal; i++) count[i] = 0;
+int Special::pair_rendezvous(int n, int *proclist, PairRvous *inbuf,
+                             PairRvous *&outbuf)
+{
+  for (int i = 0; i < n; i++) proclist[i] = inbuf[i].atomID % nprocs;
+
+  char *buf;
+  int nreturn = comm->rendezvous(n,proclist,(char *) inbuf,sizeof(PairRvous),
+                                 rendezvous_pairs,buf,sizeof(PairRvous),
+                                 (void *) this);
+  outbuf = (PairRvous *) buf;
+  return nreturn;
+}
 
-  // add bond partners stored by atom to onetwo list
+/* ----------------------------------------------------------------------
+   return max of nspecial[i][which] across all procs and print it
+------------------------------------------------------------------------- */
 
-  for (i = 0; i < nlocal; i++)
-    for (j = 0; j < num_bond[i]; j++)
-      onetwo[i][count[i]++] = bond_atom[i][j];
+int Special::max_count(int which, const char *name)
+{
+  int **nspecial = atom->nspecial;
+  int nlocal = atom->nlocal;
 
-  // if newton_bond off, then done
-  // else only stored 1/2 of all bonds, so store other half
+  int max = 0;
+  for (int i = 0; i < nlocal; i++) max = MAX(max,nspecial[i][which]);
 
-  if (force->newton_bond) {
+  int maxall;
+  MPI_Allreduce(&max,&maxall,1,MPI_INT,MPI_MAX,world);
 
-    // nbufmax = largest buffer needed to hold info from any proc
-    // info for each atom = 2 global tags in each bond
+  if (me == 0) {
+    if (screen) fprintf(screen,"  %d = max # of %s neighbors\n",maxall,name);
+    if (logfile) fprintf(logfile,"  %d = max # of %s neighbors\n",maxall,name);
+  }
 
-    nbuf = 0;
-    for (i = 0; i < nlocal; i++) nbuf += 2*num_bond[i];
-    memory->create(buf,nbuf,"special:buf");
+  return maxall;
+}
 
-    // fill buffer with global tags of both atoms in bond
+/* ----------------------------------------------------------------------
+   onetwo build when newton_bond flag on
+   only 1/2 of bonds are stored, by one of the 2 atoms
+   partner of each bond must also add the bond to its onetwo list
+------------------------------------------------------------------------- */
 
-    size = 0;
-    for (i = 0; i < nlocal; i++)
-      for (j = 0; j < num_bond[i]; j++) {
-        buf[size++] = tag[i];
-        buf[size++] = bond_atom[i][j];
-      }
+void Special::onetwo_build_newton()
+{
+  int i,j,m;
 
-    // cycle buffer around ring of procs back to self
-    // when receive buffer, scan 2nd-atom tags for atoms I own
-    // when find one, add 1st-atom tag to onetwo list for 2nd atom
+  tagint *tag = atom->tag;
+  int *num_bond = atom->num_bond;
+  tagint **bond_atom = atom->bond_atom;
+  int **nspecial = atom->nspecial;
+  int nlocal = atom->nlocal;
 
-    sptr = this;
-    comm->ring(size,sizeof(tagint),buf,2,ring_two,NULL);
+  // nsend = # of bonds whose partner atom is not owned by me
 
-    memory->destroy(buf);
-  }
+  int nsend = 0;
+  for (i = 0; i < nlocal; i++)
+    for (j = 0; j < num_bond[i]; j++) {
+      m = atom->map(bond_atom[i][j]);
+      if (m < 0 || m >= nlocal) nsend++;
+    }
 
-  memory->destroy(count);
+  int *proclist;
+  memory->create(proclist,nsend,"special:proclist");
+  PairRvous *inbuf = (PairRvous *)
+    memory->smalloc((bigint) nsend*sizeof(PairRvous),"special:inbuf");
 
-  // -----------------------------------------------------
-  // done if special_bonds for 1-3, 1-4 are set to 1.0
-  // -----------------------------------------------------
+  // one datum for each unowned bond partner = partner ID, my atom ID
 
-  if (force->special_lj[2] == 1.0 && force->special_coul[2] == 1.0 &&
-      force->special_lj[3] == 1.0 && force->special_coul[3] == 1.0) {
-    dedup();
-    combine();
-    return;
-  }
+  nsend = 0;
+  for (i = 0; i < nlocal; i++)
+    for (j = 0; j < num_bond[i]; j++) {
+      m = atom->map(bond_atom[i][j]);
+      if (m >= 0 && m < nlocal) continue;
+      inbuf[nsend].atomID = bond_atom[i][j];
+      inbuf[nsend].partnerID = tag[i];
+      nsend++;
+    }
 
-  // -----------------------------------------------------
-  // compute nspecial[i][1] = # of 1-3 neighbors of atom i
-  // -----------------------------------------------------
+  PairRvous *outbuf;
+  int nreturn = pair_rendezvous(nsend,proclist,inbuf,outbuf);
 
-  // nbufmax = largest buffer needed to hold info from any proc
-  // info for each atom = 2 scalars + list of 1-2 neighbors
+  memory->destroy(proclist);
+  memory->sfree(inbuf);
 
-  nbuf = 0;
-  for (i = 0; i < nlocal; i++) nbuf += 2 + nspecial[i][0];
-  memory->create(buf,nbuf,"special:buf");
+  // set nspecial[0] and onetwo for all owned atoms
+  // from owned bonds, bonds with owned partners, and rendezvous output
 
-  // fill buffer with:
-  // (1) = counter for 1-3 neighbors, initialized to 0
-  // (2) = # of 1-2 neighbors
-  // (3:N) = list of 1-2 neighbors
+  for (i = 0; i < nlocal; i++)
+    for (j = 0; j < num_bond[i]; j++) {
+      nspecial[i][0]++;
+      m = atom->map(bond_atom[i][j]);
+      if (m >= 0 && m < nlocal) nspecial[m][0]++;
+    }
 
-  size = 0;
-  for (i = 0; i < nlocal; i++) {
-    buf[size++] = 0;
-    buf[size++] = nspecial[i][0];
-    for (j = 0; j < nspecial[i][0]; j++) buf[size++] = onetwo[i][j];
+  for (m = 0; m < nreturn; m++) {
+    i = atom->map(outbuf[m].atomID);
+    nspecial[i][0]++;
   }
 
-  // cycle buffer around ring of procs back to self
-  // when receive buffer, scan list of 1-2 neighbors for atoms I own
-  // when find one, increment 1-3 count by # of 1-2 neighbors of my atom,
-  //   subtracting one since my list will contain original atom
+  int max = max_count(0,"1-2");
+  memory->create(onetwo,nlocal,max,"special:onetwo");
 
-  sptr = this;
-  comm->ring(size,sizeof(tagint),buf,3,ring_three,buf);
+  for (i = 0; i < nlocal; i++) nspecial[i][0] = 0;
 
-  // extract count from buffer that has cycled back to me
-  // nspecial[i][1] = # of 1-3 neighbors of atom i
+  for (i = 0; i < nlocal; i++)
+    for (j = 0; j < num_bond[i]; j++) {
+      onetwo[i][nspecial[i][0]++] = bond_atom[i][j];
+      m = atom->map(bond_atom[i][j]);
+      if (m >= 0 && m < nlocal) onetwo[m][nspecial[m][0]++] = tag[i];
+    }
 
-  j = 0;
-  for (i = 0; i < nlocal; i++) {
-    nspecial[i][1] = buf[j];
-    j += 2 + nspecial[i][0];
+  for (m = 0; m < nreturn; m++) {
+    i = atom->map(outbuf[m].atomID);
+    onetwo[i][nspecial[i][0]++] = outbuf[m].partnerID;
   }
 
-  memory->destroy(buf);
-
-  // ----------------------------------------------------
-  // create onethree[i] = list of 1-3 neighbors for atom i
-  // ----------------------------------------------------
-
-  max = 0;
-  for (i = 0; i < nlocal; i++) max = MAX(max,nspecial[i][1]);
-  MPI_Allreduce(&max,&maxall,1,MPI_INT,MPI_MAX,world);
+  memory->sfree(outbuf);
+}
 
-  if (me == 0) {
-    if (screen) fprintf(screen,"  %d = max # of 1-3 neighbors\n",maxall);
-    if (logfile) fprintf(logfile,"  %d = max # of 1-3 neighbors\n",maxall);
-  }
+/* ----------------------------------------------------------------------
+   onetwo build when newton_bond flag off
+   all bonds are stored by both atoms, so no communication is needed
+------------------------------------------------------------------------- */
 
-  memory->create(onethree,nlocal,maxall,"special:onethree");
+void Special::onetwo_build_newton_off()
+{
+  int i,j;
 
-  // nbufmax = largest buffer needed to hold info from any proc
-  // info for each atom = 4 scalars + list of 1-2 neighs + list of 1-3 neighs
+  int *num_bond = atom->num_bond;
+  tagint **bond_atom = atom->bond_atom;
+  int **nspecial = atom->nspecial;
+  int nlocal = atom->nlocal;
 
-  nbuf = 0;
-  for (i = 0; i < nlocal; i++) nbuf += 4 + nspecial[i][0] + nspecial[i][1];
-  memory->create(buf,nbuf,"special:buf");
+  for (i = 0; i < nlocal; i++) nspecial[i][0] = num_bond[i];
 
-  // fill buffer with:
-  // (1) = global tag of original atom
-  // (2) = # of 1-2 neighbors
-  // (3) = # of 1-3 neighbors
-  // (4) = counter for 1-3 neighbors, initialized to 0
-  // (5:N) = list of 1-2 neighbors
-  // (N+1:2N) space for list of 1-3 neighbors
+  int max = max_count(0,"1-2");
+  memory->create(onetwo,nlocal,max,"special:onetwo");
 
-  size = 0;
-  for (i = 0; i < nlocal; i++) {
-    buf[size++] = tag[i];
-    buf[size++] = nspecial[i][0];
-    buf[size++] = nspecial[i][1];
-    buf[size++] = 0;
-    for (j = 0; j < nspecial[i][0]; j++) buf[size++] = onetwo[i][j];
-    size += nspecial[i][1];
-  }
+  for (i = 0; i < nlocal; i++)
+    for (j = 0; j < num_bond[i]; j++)
+      onetwo[i][j] = bond_atom[i][j];
+}
 
-  // cycle buffer around ring of procs back to self
-  // when receive buffer, scan list of 1-2 neighbors for atoms I own
-  // when find one, add its neighbors to 1-3 list
-  //   increment the count in buf(i+4)
-  //   exclude the atom whose tag = original
-  //   this process may include duplicates but they will be culled later
+/* ----------------------------------------------------------------------
+   onethree build
+   for each atom I, each pair of its 1-2 neighbors J,K are 1-3 neighbors
+   may include duplicates, they will be culled later
+------------------------------------------------------------------------- */
 
-  sptr = this;
-  comm->ring(size,sizeof(tagint),buf,4,ring_four,buf);
+void Special::onethree_build()
+{
+  int i,j,k,m;
 
-  // fill onethree with buffer values that have been returned to me
-  // sanity check: accumulated buf[i+3] count should equal
-  //   nspecial[i][1] for each atom
+  int **nspecial = atom->nspecial;
+  int nlocal = atom->nlocal;
 
-  j = 0;
-  for (i = 0; i < nlocal; i++) {
-    if (buf[j+3] != nspecial[i][1])
-      error->one(FLERR,"1-3 bond count is inconsistent");
-    j += 4 + nspecial[i][0];
-    for (k = 0; k < nspecial[i][1]; k++)
-      onethree[i][k] = buf[j++];
-  }
+  // nsend = # of 1-3 pairs whose 1st atom is not owned by me
 
-  memory->destroy(buf);
+  int nsend = 0;
+  for (i = 0; i < nlocal; i++)
+    for (j = 0; j < nspecial[i][0]; j++) {
+      m = atom->map(onetwo[i][j]);
+      if (m < 0 || m >= nlocal) nsend += nspecial[i][0]-1;
+    }
 
-  // done if special_bonds for 1-4 are set to 1.0
+  int *proclist;
+  memory->create(proclist,nsend,"special:proclist");
+  PairRvous *inbuf = (PairRvous *)
+    memory->smalloc((bigint) nsend*sizeof(PairRvous),"special:inbuf");
 
-  if (force->special_lj[3] == 1.0 && force->special_coul[3] == 1.0) {
-    dedup();
-    if (force->special_angle) angle_trim();
-    combine();
-    return;
-  }
+  nsend = 0;
+  for (i = 0; i < nlocal; i++)
+    for (j = 0; j < nspecial[i][0]; j++) {
+      m = atom->map(onetwo[i][j]);
+      if (m >= 0 && m < nlocal) continue;
+      for (k = 0; k < nspecial[i][0]; k++) {
+        if (j == k) continue;
+        inbuf[nsend].atomID = onetwo[i][j];
+        inbuf[nsend].partnerID = onetwo[i][k];
+        nsend++;
+      }
+    }
 
-  // -----------------------------------------------------
-  // compute nspecial[i][2] = # of 1-4 neighbors of atom i
-  // -----------------------------------------------------
+  PairRvous *outbuf;
+  int nreturn = pair_rendezvous(nsend,proclist,inbuf,outbuf);
 
-  // nbufmax = largest buffer needed to hold info from any proc
-  // info for each atom = 2 scalars + list of 1-3 neighbors
+  memory->destroy(proclist);
+  memory->sfree(inbuf);
 
-  nbuf = 0;
-  for (i = 0; i < nlocal; i++) nbuf += 2 + nspecial[i][1];
-  memory->create(buf,nbuf,"special:buf");
+  // set nspecial[1] and onethree for all owned atoms
+  // from owned 1-2 neighbors and rendezvous output
 
-  // fill buffer with:
-  // (1) = counter for 1-4 neighbors, initialized to 0
-  // (2) = # of 1-3 neighbors
-  // (3:N) = list of 1-3 neighbors
+  for (i = 0; i < nlocal; i++)
+    for (j = 0; j < nspecial[i][0]; j++) {
+      m = atom->map(onetwo[i][j]);
+      if (m >= 0 && m < nlocal) nspecial[m][1] += nspecial[i][0]-1;
+    }
 
-  size = 0;
-  for (i = 0; i < nlocal; i++) {
-    buf[size++] = 0;
-    buf[size++] = nspecial[i][1];
-    for (j = 0; j < nspecial[i][1]; j++) buf[size++] = onethree[i][j];
+  for (m = 0; m < nreturn; m++) {
+    i = atom->map(outbuf[m].atomID);
+    nspecial[i][1]++;
   }
 
-  // cycle buffer around ring of procs back to self
-  // when receive buffer, scan list of 1-3 neighbors for atoms I own
-  // when find one, increment 1-4 count by # of 1-2 neighbors of my atom
-  //   may include duplicates and original atom but they will be culled later
+  int max = max_count(1,"1-3");
+  memory->create(onethree,nlocal,max,"special:onethree");
 
-  sptr = this;
-  comm->ring(size,sizeof(tagint),buf,5,ring_five,buf);
+  for (i = 0; i < nlocal; i++) nspecial[i][1] = 0;
 
-  // extract count from buffer that has cycled back to me
-  // nspecial[i][2] = # of 1-4 neighbors of atom i
+  for (i = 0; i < nlocal; i++)
+    for (j = 0; j < nspecial[i][0]; j++) {
+      m = atom->map(onetwo[i][j]);
+      if (m < 0 || m >= nlocal) continue;
+      for (k = 0; k < nspecial[i][0]; k++) {
+        if (j == k) continue;
+        onethree[m][nspecial[m][1]++] = onetwo[i][k];
+      }
+    }
 
-  j = 0;
-  for (i = 0; i < nlocal; i++) {
-    nspecial[i][2] = buf[j];
-    j += 2 + nspecial[i][1];
+  for (m = 0; m < nreturn; m++) {
+    i = atom->map(outbuf[m].atomID);
+    onethree[i][nspecial[i][1]++] = outbuf[m].partnerID;
   }
 
-  memory->destroy(buf);
+  memory->sfree(outbuf);
+}
 
-  // ----------------------------------------------------
-  // create onefour[i] = list of 1-4 neighbors for atom i
-  // ----------------------------------------------------
+/* ----------------------------------------------------------------------
+   onefour build
+   for each atom I, each of its 1-2 neighbors K is a 1-4 neighbor
+     of each of its 1-3 neighbors J
+   may include duplicates and atoms closer than 1-4, culled later
+------------------------------------------------------------------------- */
 
-  max = 0;
-  for (i = 0; i < nlocal; i++) max = MAX(max,nspecial[i][2]);
-  MPI_Allreduce(&max,&maxall,1,MPI_INT,MPI_MAX,world);
+void Special::onefour_build()
+{
+  int i,j,k,m;
 
-  if (me == 0) {
-    if (screen) fprintf(screen,"  %d = max # of 1-4 neighbors\n",maxall);
-    if (logfile) fprintf(logfile,"  %d = max # of 1-4 neighbors\n",maxall);
-  }
+  int **nspecial = atom->nspecial;
+  int nlocal = atom->nlocal;
 
-  memory->create(onefour,nlocal,maxall,"special:onefour");
+  // nsend = # of 1-4 pairs whose 1st atom is not owned by me
 
-  // nbufmax = largest buffer needed to hold info from any proc
-  // info for each atom = 3 scalars + list of 1-3 neighs + list of 1-4 neighs
+  int nsend = 0;
+  for (i = 0; i < nlocal; i++)
+    for (j = 0; j < nspecial[i][1]; j++) {
+      m = atom->map(onethree[i][j]);
+      if (m < 0 || m >= nlocal) nsend += nspecial[i][0];
+    }
+
+  int *proclist;
+  memory->create(proclist,nsend,"special:proclist");
+  PairRvous *inbuf = (PairRvous *)
+    memory->smalloc((bigint) nsend*sizeof(PairRvous),"special:inbuf");
 
-  nbuf = 0;
+  nsend = 0;
   for (i = 0; i < nlocal; i++)
-    nbuf += 3 + nspecial[i][1] + nspecial[i][2];
-  memory->create(buf,nbuf,"special:buf");
+    for (j = 0; j < nspecial[i][1]; j++) {
+      m = atom->map(onethree[i][j]);
+      if (m >= 0 && m < nlocal) continue;
+      for (k = 0; k < nspecial[i][0]; k++) {
+        inbuf[nsend].atomID = onethree[i][j];
+        inbuf[nsend].partnerID = onetwo[i][k];
+        nsend++;
+      }
+    }
 
-  // fill buffer with:
-  // (1) = # of 1-3 neighbors
-  // (2) = # of 1-4 neighbors
-  // (3) = counter for 1-4 neighbors, initialized to 0
-  // (4:N) = list of 1-3 neighbors
-  // (N+1:2N) space for list of 1-4 neighbors
+  PairRvous *outbuf;
+  int nreturn = pair_rendezvous(nsend,proclist,inbuf,outbuf);
 
-  size = 0;
-  for (i = 0; i < nlocal; i++) {
-    buf[size++] = nspecial[i][1];
-    buf[size++] = nspecial[i][2];
-    buf[size++] = 0;
-    for (j = 0; j < nspecial[i][1]; j++) buf[size++] = onethree[i][j];
-    size += nspecial[i][2];
+  memory->destroy(proclist);
+  memory->sfree(inbuf);
+
+  // set nspecial[2] and onefour for all owned atoms
+  // from owned 1-3 neighbors and rendezvous output
+
+  for (i = 0; i < nlocal; i++)
+    for (j = 0; j < nspecial[i][1]; j++) {
+      m = atom->map(onethree[i][j]);
+      if (m >= 0 && m < nlocal) nspecial[m][2] += nspecial[i][0];
+    }
+
+  for (m = 0; m < nreturn; m++) {
+    i = atom->map(outbuf[m].atomID);
+    nspecial[i][2]++;
   }
 
-  // cycle buffer around ring of procs back to self
-  // when receive buffer, scan list of 1-3 neighbors for atoms I own
-  // when find one, add its neighbors to 1-4 list
-  //   incrementing the count in buf(i+4)
-  //   this process may include duplicates but they will be culled later
+  int max = max_count(2,"1-4");
+  memory->create(onefour,nlocal,max,"special:onefour");
 
-  sptr = this;
-  comm->ring(size,sizeof(tagint),buf,6,ring_six,buf);
+  for (i = 0; i < nlocal; i++) nspecial[i][2] = 0;
 
-  // fill onefour with buffer values that have been returned to me
-  // sanity check: accumulated buf[i+2] count should equal
-  //  nspecial[i][2] for each atom
+  for (i = 0; i < nlocal; i++)
+    for (j = 0; j < nspecial[i][1]; j++) {
+      m = atom->map(onethree[i][j]);
+      if (m < 0 || m >= nlocal) continue;
+      for (k = 0; k < nspecial[i][0]; k++)
+        onefour[m][nspecial[m][2]++] = onetwo[i][k];
+    }
 
-  j = 0;
-  for (i = 0; i < nlocal; i++) {
-    if (buf[j+2] != nspecial[i][2])
-      error->one(FLERR,"1-4 bond count is inconsistent");
-    j += 3 + nspecial[i][1];
-    for (k = 0; k < nspecial[i][2]; k++)
-      onefour[i][k] = buf[j++];
+  for (m = 0; m < nreturn; m++) {
+    i = atom->map(outbuf[m].atomID);
+    onefour[i][nspecial[i][2]++] = outbuf[m].partnerID;
   }
 
-  memory->destroy(buf);
-
-  dedup();
-  if (force->special_angle) angle_trim();
-  if (force->special_dihedral) dihedral_trim();
-  combine();
+  memory->sfree(outbuf);
 }
 
 /* ----------------------------------------------------------------------
@@ -670,6 +719,11 @@ void Special::angle_trim()
 
   if ((num_angle && atom->nangles) || (num_dihedral && atom->ndihedrals)) {
 
+    int anyangle = 0;
+    if (num_angle && atom->nangles) anyangle = 1;
+    int anydihedral = 0;
+    if (num_dihedral && atom->ndihedrals) anydihedral = 1;
+
     // dflag = flag for 1-3 neighs of all owned atoms
 
     int maxcount = 0;
@@ -681,44 +735,84 @@ void Special::angle_trim()
       for (j = 0; j < n; j++) dflag[i][j] = 0;
     }
 
-    // nbufmax = largest buffer needed to hold info from any proc
-    // info for each atom = list of 1,3 atoms in each angle stored by atom
-    //   and list of 1,3 and 2,4 atoms in each dihedral stored by atom
+    // pairs of 1,3 atoms in each angle stored by atom
+    //   and 1,3 and 2,4 atoms in each dihedral stored by atom
+    // flag pairs in both directions, if atom is owned flag it directly
+    //   else send pair to proc owning it, via rendezvous comm
 
-    int nbuf = 0;
+    int nsend = 0;
     for (i = 0; i < nlocal; i++) {
-      if (num_angle && atom->nangles) nbuf += 2*num_angle[i];
-      if (num_dihedral && atom->ndihedrals) nbuf += 2*2*num_dihedral[i];
+      if (anyangle)
+        for (j = 0; j < num_angle[i]; j++) {
+          m = atom->map(angle_atom1[i][j]);
+          if (m < 0 || m >= nlocal) nsend++;
+          m = atom->map(angle_atom3[i][j]);
+          if (m < 0 || m >= nlocal) nsend++;
+        }
+      if (anydihedral)
+        for (j = 0; j < num_dihedral[i]; j++) {
+          m = atom->map(dihedral_atom1[i][j]);
+          if (m < 0 || m >= nlocal) nsend++;
+          m = atom->map(dihedral_atom2[i][j]);
+          if (m < 0 || m >= nlocal) nsend++;
+          m = atom->map(dihedral_atom3[i][j]);
+          if (m < 0 || m >= nlocal) nsend++;
+          m = atom->map(dihedral_atom4[i][j]);
+          if (m < 0 || m >= nlocal) nsend++;
+        }
     }
-    int *buf;
-    memory->create(buf,nbuf,"special:buf");
 
-    // fill buffer with list of 1,3 atoms in each angle
-    // and with list of 1,3 and 2,4 atoms in each dihedral
+    int *proclist;
+    memory->create(proclist,nsend,"special:proclist");
+    PairRvous *inbuf = (PairRvous *)
+      memory->smalloc((bigint) nsend*sizeof(PairRvous),"special:inbuf");
 
-    int size = 0;
-    if (num_angle && atom->nangles)
-      for (i = 0; i < nlocal; i++)
+    tagint id[4];
+    nsend = 0;
+
+    for (i = 0; i < nlocal; i++) {
+      if (anyangle)
         for (j = 0; j < num_angle[i]; j++) {
-          buf[size++] = angle_atom1[i][j];
-          buf[size++] = angle_atom3[i][j];
+          id[0] = angle_atom1[i][j];
+          id[1] = angle_atom3[i][j];
+          for (n = 0; n < 2; n++) {
+            m = atom->map(id[n]);
+            if (m >= 0 && m < nlocal) trim_flag(id[n],id[1-n],1,onethree);
+            else {
+              inbuf[nsend].atomID = id[n];
+              inbuf[nsend].partnerID = id[1-n];
+              nsend++;
+            }
+          }
         }
-
-    if (num_dihedral && atom->ndihedrals)
-      for (i = 0; i < nlocal; i++)
+      if (anydihedral)
         for (j = 0; j < num_dihedral[i]; j++) {
-          buf[size++] = dihedral_atom1[i][j];
-          buf[size++] = dihedral_atom3[i][j];
-          buf[size++] = dihedral_atom2[i][j];
-          buf[size++] = dihedral_atom4[i][j];
+          id[0] = dihedral_atom1[i][j];
+          id[1] = dihedral_atom3[i][j];
+          id[2] = dihedral_atom2[i][j];
+          id[3] = dihedral_atom4[i][j];
+          for (n = 0; n < 4; n++) {
+            m = atom->map(id[n]);
+            if (m >= 0 && m < nlocal) trim_flag(id[n],id[n^1],1,onethree);
+            else {
+              inbuf[nsend].atomID = id[n];
+              inbuf[nsend].partnerID = id[n^1];
+              nsend++;
+            }
+          }
         }
+    }
 
-    // cycle buffer around ring of procs back to self
-    // when receive buffer, scan list of 1,3 atoms looking for atoms I own
-    // when find one, scan its 1-3 neigh list and mark I,J as in an angle
+    PairRvous *outbuf;
+    int nreturn = pair_rendezvous(nsend,proclist,inbuf,outbuf);
 
-    sptr = this;
-    comm->ring(size,sizeof(tagint),buf,7,ring_seven,NULL);
+    memory->destroy(proclist);
+    memory->sfree(inbuf);
+
+    for (m = 0; m < nreturn; m++)
+      trim_flag(outbuf[m].atomID,outbuf[m].partnerID,1,onethree);
+
+    memory->sfree(outbuf);
 
     // delete 1-3 neighbors if they are not flagged in dflag
 
@@ -732,7 +826,6 @@ void Special::angle_trim()
     // clean up
 
     memory->destroy(dflag);
-    memory->destroy(buf);
 
   // if no angles or dihedrals are defined, delete all 1-3 neighs
 
@@ -802,29 +895,52 @@ void Special::dihedral_trim()
       for (j = 0; j < n; j++) dflag[i][j] = 0;
     }
 
-    // nbufmax = largest buffer needed to hold info from any proc
-    // info for each atom = list of 1,4 atoms in each dihedral stored by atom
+    // pairs of 1,4 atoms in each dihedral stored by atom
+    // flag pairs in both directions, if atom is owned flag it directly
+    //   else send pair to proc owning it, via rendezvous comm
 
-    int nbuf = 0;
-    for (i = 0; i < nlocal; i++) nbuf += 2*num_dihedral[i];
-    int *buf;
-    memory->create(buf,nbuf,"special:buf");
+    int nsend = 0;
+    for (i = 0; i < nlocal; i++)
+      for (j = 0; j < num_dihedral[i]; j++) {
+        m = atom->map(dihedral_atom1[i][j]);
+        if (m < 0 || m >= nlocal) nsend++;
+        m = atom->map(dihedral_atom4[i][j]);
+        if (m < 0 || m >= nlocal) nsend++;
+      }
+
+    int *proclist;
+    memory->create(proclist,nsend,"special:proclist");
+    PairRvous *inbuf = (PairRvous *)
+      memory->smalloc((bigint) nsend*sizeof(PairRvous),"special:inbuf");
 
-    // fill buffer with list of 1,4 atoms in each dihedral
+    tagint id[2];
+    nsend = 0;
 
-    int size = 0;
     for (i = 0; i < nlocal; i++)
       for (j = 0; j < num_dihedral[i]; j++) {
-        buf[size++] = dihedral_atom1[i][j];
-        buf[size++] = dihedral_atom4[i][j];
+        id[0] = dihedral_atom1[i][j];
+        id[1] = dihedral_atom4[i][j];
+        for (n = 0; n < 2; n++) {
+          m = atom->map(id[n]);
+          if (m >= 0 && m < nlocal) trim_flag(id[n],id[1-n],2,onefour);
+          else {
+            inbuf[nsend].atomID = id[n];
+            inbuf[nsend].partnerID = id[1-n];
+            nsend++;
+          }
+        }
       }
 
-    // cycle buffer around ring of procs back to self
-    // when receive buffer, scan list of 1,4 atoms looking for atoms I own
-    // when find one, scan its 1-4 neigh list and mark I,J as in a dihedral
+    PairRvous *outbuf;
+    int nreturn = pair_rendezvous(nsend,proclist,inbuf,outbuf);
+
+    memory->destroy(proclist);
+    memory->sfree(inbuf);
 
-    sptr = this;
-    comm->ring(size,sizeof(tagint),buf,8,ring_eight,NULL);
+    for (m = 0; m < nreturn; m++)
+      trim_flag(outbuf[m].atomID,outbuf[m].partnerID,2,onefour);
+
+    memory->sfree(outbuf);
 
     // delete 1-4 neighbors if they are not flagged in dflag
 
@@ -838,7 +954,6 @@ void Special::dihedral_trim()
     // clean up
 
     memory->destroy(dflag);
-    memory->destroy(buf);
 
   // if no dihedrals are defined, delete all 1-4 neighs
 
@@ -863,252 +978,83 @@ void Special::dihedral_trim()
 }
 
 /* ----------------------------------------------------------------------
-   when receive buffer, scan tags for atoms I own
-   when find one, increment nspecial count for that atom
+   set dflag for partnerID in list of 1-3 or 1-4 neighs of owned atomID
+   which = 1 for 1-3 neighs in onethree, 2 for 1-4 neighs in onefour
 ------------------------------------------------------------------------- */
 
-void Special::ring_one(int ndatum, char *cbuf)
+void Special::trim_flag(tagint atomID, tagint partnerID, int which,
+                        tagint **list)
 {
-  Atom *atom = sptr->atom;
-  int **nspecial = atom->nspecial;
-  int nlocal = atom->nlocal;
+  int i = atom->map(atomID);
+  int n = atom->nspecial[i][which];
 
-  tagint *buf = (tagint *) cbuf;
-  int m;
-
-  for (int i = 0; i < ndatum; i++) {
-    m = atom->map(buf[i]);
-    if (m >= 0 && m < nlocal) nspecial[m][0]++;
-  }
-}
-
-/* ----------------------------------------------------------------------
-   when receive buffer, scan 2nd-atom tags for atoms I own
-   when find one, add 1st-atom tag to onetwo list for 2nd atom
-------------------------------------------------------------------------- */
-
-void Special::ring_two(int ndatum, char *cbuf)
-{
-  Atom *atom = sptr->atom;
-  int nlocal = atom->nlocal;
-
-  tagint **onetwo = sptr->onetwo;
-  int *count = sptr->count;
-
-  tagint *buf = (tagint *) cbuf;
-  int m;
-
-  for (int i = 1; i < ndatum; i += 2) {
-    m = atom->map(buf[i]);
-    if (m >= 0 && m < nlocal) onetwo[m][count[m]++] = buf[i-1];
-  }
-}
-
-/* ----------------------------------------------------------------------
-   when receive buffer, scan list of 1-2 neighbors for atoms I own
-   when find one, increment 1-3 count by # of 1-2 neighbors of my atom,
-     subtracting one since my list will contain original atom
-------------------------------------------------------------------------- */
-
-void Special::ring_three(int ndatum, char *cbuf)
-{
-  Atom *atom = sptr->atom;
-  int **nspecial = atom->nspecial;
-  int nlocal = atom->nlocal;
-
-  tagint *buf = (tagint *) cbuf;
-  int i,j,m,n,num12;
-
-  i = 0;
-  while (i < ndatum) {
-    n = buf[i];
-    num12 = buf[i+1];
-    for (j = 0; j < num12; j++) {
-      m = atom->map(buf[i+2+j]);
-      if (m >= 0 && m < nlocal)
-        n += nspecial[m][0] - 1;
+  for (int m = 0; m < n; m++)
+    if (list[i][m] == partnerID) {
+      dflag[i][m] = 1;
+      break;
     }
-    buf[i] = n;
-    i += 2 + num12;
-  }
 }
 
 /* ----------------------------------------------------------------------
-  when receive buffer, scan list of 1-2 neighbors for atoms I own
-  when find one, add its neighbors to 1-3 list
-    increment the count in buf(i+4)
-    exclude the atom whose tag = original
-    this process may include duplicates but they will be culled later
+   callback from comm->rendezvous() in atom_owners()
+   inbuf = list of N atom IDs and their owning procs
+   store them for use by later rendezvous_pairs() callbacks
+   no output datums
 ------------------------------------------------------------------------- */
 
-void Special::ring_four(int ndatum, char *cbuf)
+int Special::rendezvous_ids(int n, char *inbuf,
+                            int *&procs, char *&outbuf, void *ptr)
 {
-  Atom *atom = sptr->atom;
-  int **nspecial = atom->nspecial;
-  int nlocal = atom->nlocal;
+  Special *sptr = (Special *) ptr;
+  Memory *memory = sptr->memory;
 
-  tagint **onetwo = sptr->onetwo;
-
-  tagint *buf = (tagint *) cbuf;
-  tagint original;
-  int i,j,k,m,n,num12,num13;
-
-  i = 0;
-  while (i < ndatum) {
-    original = buf[i];
-    num12 = buf[i+1];
-    num13 = buf[i+2];
-    n = buf[i+3];
-    for (j = 0; j < num12; j++) {
-      m = atom->map(buf[i+4+j]);
-      if (m >= 0 && m < nlocal)
-        for (k = 0; k < nspecial[m][0]; k++)
-          if (onetwo[m][k] != original)
-            buf[i+4+num12+(n++)] = onetwo[m][k];
-    }
-    buf[i+3] = n;
-    i += 4 + num12 + num13;
-  }
-}
+  IDRvous *in = (IDRvous *) inbuf;
 
-/* ----------------------------------------------------------------------
-   when receive buffer, scan list of 1-3 neighbors for atoms I own
-   when find one, increment 1-4 count by # of 1-2 neighbors of my atom
-     may include duplicates and original atom but they will be culled later
-------------------------------------------------------------------------- */
+  memory->create(sptr->atomIDs,n,"special:atomIDs");
+  memory->create(sptr->procowner,n,"special:procowner");
 
-void Special::ring_five(int ndatum, char *cbuf)
-{
-  Atom *atom = sptr->atom;
-  int **nspecial = atom->nspecial;
-  int nlocal = atom->nlocal;
-
-  tagint *buf = (tagint *) cbuf;
-  int i,j,m,n,num13;
-
-  i = 0;
-  while (i < ndatum) {
-    n = buf[i];
-    num13 = buf[i+1];
-    for (j = 0; j < num13; j++) {
-      m = atom->map(buf[i+2+j]);
-      if (m >= 0 && m < nlocal) n += nspecial[m][0];
-    }
-      buf[i] = n;
-      i += 2 + num13;
+  for (int i = 0; i < n; i++) {
+    sptr->atomIDs[i] = in[i].atomID;
+    sptr->procowner[i] = in[i].me;
   }
+  sptr->nrvous = n;
+
+  procs = NULL;
+  outbuf = NULL;
+  return 0;
 }
 
 /* ----------------------------------------------------------------------
-   when receive buffer, scan list of 1-3 neighbors for atoms I own
-   when find one, add its neighbors to 1-4 list
-     incrementing the count in buf(i+4)
-     this process may include duplicates but they will be culled later
+   callback from comm->rendezvous() in pair_rendezvous()
+   inbuf = list of N pairs of atom IDs, 1st atom is one of mine
+     in rendezvous decomposition, i.e. stored by rendezvous_ids()
+   send each pair unchanged to proc that owns the 1st atom
 ------------------------------------------------------------------------- */
 
-void Special::ring_six(int ndatum, char *cbuf)
+int Special::rendezvous_pairs(int n, char *inbuf,
+                              int *&procs, char *&outbuf, void *ptr)
 {
-  Atom *atom = sptr->atom;
-  int **nspecial = atom->nspecial;
-  int nlocal = atom->nlocal;
+  Special *sptr = (Special *) ptr;
+  Memory *memory = sptr->memory;
 
-  tagint **onetwo = sptr->onetwo;
-
-  tagint *buf = (tagint *) cbuf;
-  int i,j,k,m,n,num13,num14;
-
-  i = 0;
-  while (i < ndatum) {
-    num13 = buf[i];
-    num14 = buf[i+1];
-    n = buf[i+2];
-    for (j = 0; j < num13; j++) {
-      m = atom->map(buf[i+3+j]);
-      if (m >= 0 && m < nlocal)
-        for (k = 0; k < nspecial[m][0]; k++)
-          buf[i+3+num13+(n++)] = onetwo[m][k];
-    }
-    buf[i+2] = n;
-    i += 3 + num13 + num14;
-  }
-}
+  int nrvous = sptr->nrvous;
+  tagint *atomIDs = sptr->atomIDs;
+  int *procowner = sptr->procowner;
 
-/* ----------------------------------------------------------------------
-   when receive buffer, scan list of 1,3 atoms looking for atoms I own
-   when find one, scan its 1-3 neigh list and mark I,J as in an angle
-------------------------------------------------------------------------- */
+  // hash = map of rendezvous atom IDs to their index
 
-void Special::ring_seven(int ndatum, char *cbuf)
-{
-  Atom *atom = sptr->atom;
-  int **nspecial = atom->nspecial;
-  int nlocal = atom->nlocal;
+  std::map<tagint,int> hash;
+  for (int i = 0; i < nrvous; i++) hash[atomIDs[i]] = i;
 
-  tagint **onethree = sptr->onethree;
-  int **dflag = sptr->dflag;
-
-  tagint *buf = (tagint *) cbuf;
-  tagint iglobal,jglobal;
-  int i,m,ilocal,jlocal;
-
-  i = 0;
-  while (i < ndatum) {
-    iglobal = buf[i];
-    jglobal = buf[i+1];
-    ilocal = atom->map(iglobal);
-    jlocal = atom->map(jglobal);
-    if (ilocal >= 0 && ilocal < nlocal)
-      for (m = 0; m < nspecial[ilocal][1]; m++)
-        if (jglobal == onethree[ilocal][m]) {
-          dflag[ilocal][m] = 1;
-          break;
-        }
-    if (jlocal >= 0 && jlocal < nlocal)
-      for (m = 0; m < nspecial[jlocal][1]; m++)
-        if (iglobal == onethree[jlocal][m]) {
-          dflag[jlocal][m] = 1;
-          break;
-        }
-    i += 2;
-  }
-}
+  PairRvous *in = (PairRvous *) inbuf;
 
-/* ----------------------------------------------------------------------
-   when receive buffer, scan list of 1,4 atoms looking for atoms I own
-   when find one, scan its 1-4 neigh list and mark I,J as in a dihedral
-------------------------------------------------------------------------- */
+  memory->create(procs,n,"special:procs");
+  outbuf = (char *)
+    memory->smalloc((bigint) n*sizeof(PairRvous),"special:outbuf");
+  memcpy(outbuf,inbuf,n*sizeof(PairRvous));
 
-void Special::ring_eight(int ndatum, char *cbuf)
-{
-  Atom *atom = sptr->atom;
-  int **nspecial = atom->nspecial;
-  int nlocal = atom->nlocal;
+  for (int i = 0; i < n; i++)
+    procs[i] = procowner[hash.find(in[i].atomID)->second];
 
-  tagint **onefour = sptr->onefour;
-  int **dflag = sptr->dflag;
-
-  tagint *buf = (tagint *) cbuf;
-  tagint iglobal,jglobal;
-  int i,m,ilocal,jlocal;
-
-  i = 0;
-  while (i < ndatum) {
-    iglobal = buf[i];
-    jglobal = buf[i+1];
-    ilocal = atom->map(iglobal);
-    jlocal = atom->map(jglobal);
-    if (ilocal >= 0 && ilocal < nlocal)
-      for (m = 0; m < nspecial[ilocal][2]; m++)
-        if (jglobal == onefour[ilocal][m]) {
-          dflag[ilocal][m] = 1;
-          break;
-        }
-    if (jlocal >= 0 && jlocal < nlocal)
-      for (m = 0; m < nspecial[jlocal][2]; m++)
-        if (iglobal == onefour[jlocal][m]) {
-          dflag[jlocal][m] = 1;
-          break;
-        }
-    i += 2;
-  }
+  return n;
 }
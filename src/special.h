@@ -28,28 +28,43 @@ class Special : protected Pointers {
   int me,nprocs;
   tagint **onetwo,**onethree,**onefour;
 
-  // data used by ring callback methods
+  // data used by rendezvous callback methods
 
-  int *count;
+  int nrvous;
+  tagint *atomIDs;
+  int *procowner;
   int **dflag;
 
+  // datums sent to rendezvous procs: atom ID + its owning proc,
+  //   or a pair of atom IDs which are special neighbors of each other
+
+  struct IDRvous {
+    int me;
+    tagint atomID;
+  };
+
+  struct PairRvous {
+    tagint atomID,partnerID;
+  };
+
+  void atom_owners();
+  void onetwo_build_newton();
+  void onetwo_build_newton_off();
+  void onethree_build();
+  void onefour_build();
+  int pair_rendezvous(int, int *, PairRvous *, PairRvous *&);
+  int max_count(int, const char *);
+
   void dedup();
   void angle_trim();
   void dihedral_trim();
+  void trim_flag(tagint, tagint, int, tagint **);
   void combine();
 
-  // static variable for ring communication callback to access class data
-  // callback functions for ring communication
-
-  static Special *sptr;
-  static void ring_one(int, char *);
-  static void ring_two(int, char *);
-  static void ring_three(int, char *);
-  static void ring_four(int, char *);
-  static void ring_five(int, char *);
-  static void ring_six(int, char *);
-  static void ring_seven(int, char *);
-  static void ring_eight(int, char *);
+  // callback functions for rendezvous communication
+
+  static int rendezvous_ids(int, char *, int *&, char *&, void *);
+  static int rendezvous_pairs(int, char *, int *&, char *&, void *);
 };
 
 }
@@ -58,16 +73,4 @@ class Special : protected Pointers {
 
 /* ERROR/WARNING messages:
 
-E: 1-3 bond count is inconsistent
-
-An inconsistency was detected when computing the number of 1-3
-neighbors for each atom.  This likely means something is wrong with
-the bond topologies you have defined.
-
-E: 1-4 bond count is inconsistent
-
-An inconsistency was detected when computing the number of 1-4
-neighbors for each atom.  This likely means something is wrong with
-the bond topologies you have defined.
-
 */
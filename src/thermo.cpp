@@ -236,16 +236,27 @@ void Thermo::init()
 
   // find current ptr for each Compute ID
   // cudable = 0 if any compute used by Thermo is non-CUDA
+  // register a detailed timer for each Compute array and
+  //   one for all Compute scalars and vectors summed together
 
   cudable = 1;
 
   int icompute;
+  int root = timer->add("Output");
   for (i = 0; i < ncompute; i++) {
     icompute = modify->find_compute(id_compute[i]);
     if (icompute < 0) error->all(FLERR,"Could not find thermo compute ID");
     computes[i] = modify->compute[icompute];
     cudable = cudable && computes[i]->cudable;
+    computetimer[i] = -1;
+    if (compute_which[i] != ARRAY) continue;
+    char *name = new char[strlen(computes[i]->id) +
+                          strlen(computes[i]->style) + 16];
+    sprintf(name,"compute %s %s",computes[i]->id,computes[i]->style);
+    computetimer[i] = timer->add(name,root);
+    delete [] name;
   }
+  reducetimer = timer->add("compute reduction",root);
 
   // find current ptr for each Fix ID
   // check that fix frequency is acceptable with thermo output frequency
@@ -311,24 +322,42 @@ void Thermo::compute(int flag)
   else normflag = normvalue;
 
   // invoke Compute methods needed for thermo keywords
+  // global scalars and vectors of all Computes are summed across procs
+  //   in one reduction by Modify, arrays are invoked one by one
 
-  for (i = 0; i < ncompute; i++)
+  nreduce = 0;
+  for (i = 0; i < ncompute; i++) {
     if (compute_which[i] == SCALAR) {
       if (!(computes[i]->invoked_flag & INVOKED_SCALAR)) {
-        computes[i]->compute_scalar();
         computes[i]->invoked_flag |= INVOKED_SCALAR;
+        reduce[nreduce] = computes[i];
+        reduce_which[nreduce++] = 0;
       }
     } else if (compute_which[i] == VECTOR) {
       if (!(computes[i]->invoked_flag & INVOKED_VECTOR)) {
-        computes[i]->compute_vector();
         computes[i]->invoked_flag |= INVOKED_VECTOR;
+        reduce[nreduce] = computes[i];
+        reduce_which[nreduce++] = 1;
       }
-    } else if (compute_which[i] == ARRAY) {
+    }
+  }
+
+  if (nreduce) {
+    timer->sub_start(reducetimer);
+    modify->reduce_compute(nreduce,reduce,reduce_which);
+    timer->sub_stop(reducetimer);
+  }
+
+  for (i = 0; i < ncompute; i++) {
+    if (compute_which[i] == ARRAY) {
       if (!(computes[i]->invoked_flag & INVOKED_ARRAY)) {
+        timer->sub_start(computetimer[i]);
         computes[i]->compute_array();
         computes[i]->invoked_flag |= INVOKED_ARRAY;
+        timer->sub_stop(computetimer[i]);
       }
     }
+  }
 
   // if lineflag = MULTILINE, prepend step/cpu header line
 
@@ -596,6 +625,9 @@ void Thermo::allocate()
   id_compute = new char*[3*n];
   compute_which = new int[3*n];
   computes = new Compute*[3*n];
+  computetimer = new int[3*n];
+  reduce = new Compute*[3*n];
+  reduce_which = new int[3*n];
 
   nfix = 0;
   id_fix = new char*[n];
@@ -632,6 +664,9 @@ void Thermo::deallocate()
   delete [] id_compute;
   delete [] compute_which;
   delete [] computes;
+  delete [] computetimer;
+  delete [] reduce;
+  delete [] reduce_which;
 
   for (int i = 0; i < nfix; i++) delete [] id_fix[i];
   delete [] id_fix;
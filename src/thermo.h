@@ -88,6 +88,11 @@ class Thermo : protected Pointers {
   char **id_compute;           // their IDs
   int *compute_which;          // 0/1/2 if should call scalar,vector,array
   class Compute **computes;    // list of ptrs to the Compute objects
+  int *computetimer;           // detailed timer index of each Compute
+  int reducetimer;             // detailed timer index of summed Computes
+  int nreduce;                 // # of Computes summed in one reduction
+  class Compute **reduce;      // list of ptrs to those Computes
+  int *reduce_which;           // 0/1 if scalar or vector is summed
 
   int nfix;                    // # of Fix objects called by thermo
   char **id_fix;               // their IDs
@@ -12,16 +12,58 @@
 ------------------------------------------------------------------------- */
 
 #include "mpi.h"
+#include "stdlib.h"
+#include "string.h"
 #include "timer.h"
+#include "comm.h"
+#include "force.h"
+#include "update.h"
 #include "memory.h"
+#include "error.h"
+#include <map>
+#include <string>
 
 using namespace LAMMPS_NS;
 
+#define DELTA 16
+
+static const char *sectionnames[] =
+  {"Loop","Pair","Bond","Kspace","Neigh","Comm","Output"};
+
+/* ----------------------------------------------------------------------
+   write str as a quoted JSON string
+   fix and compute IDs may contain quotes, backslashes, or control chars
+------------------------------------------------------------------------- */
+
+static void json_string(FILE *fp, const char *str)
+{
+  fputc('"',fp);
+  for (const char *p = str; *p; p++) {
+    if (*p == '"' || *p == '\\') fprintf(fp,"\\%c",*p);
+    else if ((unsigned char) *p < 0x20) fprintf(fp,"\\u%04x",*p);
+    else fputc(*p,fp);
+  }
+  fputc('"',fp);
+}
+
 /* ---------------------------------------------------------------------- */
 
 Timer::Timer(LAMMPS *lmp) : Pointers(lmp)
 {
   memory->create(array,TIME_N,"array");
+
+  fullflag = 0;
+  nsub = maxsub = 0;
+  subname = NULL;
+  subparent = subcount = NULL;
+  subtime = substart = NULL;
+
+  nnodes = 0;
+  nodeprocs = NULL;
+  nodenames = NULL;
+
+  jsonflag = jsonevery = 0;
+  jsonfp = NULL;
 }
 
 /* ---------------------------------------------------------------------- */
@@ -29,6 +71,19 @@ Timer::Timer(LAMMPS *lmp) : Pointers(lmp)
 Timer::~Timer()
 {
   memory->destroy(array);
+
+  for (int i = 0; i < nsub; i++) delete [] subname[i];
+  memory->sfree(subname);
+  memory->destroy(subparent);
+  memory->destroy(subcount);
+  memory->destroy(subtime);
+  memory->destroy(substart);
+
+  for (int i = 0; i < nnodes; i++) delete [] nodenames[i];
+  delete [] nodenames;
+  delete [] nodeprocs;
+
+  if (jsonfp) fclose(jsonfp);
 }
 
 /* ---------------------------------------------------------------------- */
@@ -36,6 +91,10 @@ Timer::~Timer()
 void Timer::init()
 {
   for (int i = 0; i < TIME_N; i++) array[i] = 0.0;
+  for (int i = 0; i < nsub; i++) {
+    subtime[i] = 0.0;
+    subcount[i] = 0;
+  }
 }
 
 /* ---------------------------------------------------------------------- */
@@ -82,3 +141,223 @@ double Timer::elapsed(int which)
   double current_time = MPI_Wtime();
   return (current_time - array[which]);
 }
+
+/* ----------------------------------------------------------------------
+   process timer command
+------------------------------------------------------------------------- */
+
+void Timer::modify_params(int narg, char **arg)
+{
+  if (narg == 0) error->all(FLERR,"Illegal timer command");
+
+  int iarg = 0;
+  while (iarg < narg) {
+    if (strcmp(arg[iarg],"normal") == 0) {
+      fullflag = 0;
+      iarg += 1;
+    } else if (strcmp(arg[iarg],"full") == 0) {
+      fullflag = 1;
+      iarg += 1;
+    } else if (strcmp(arg[iarg],"json") == 0) {
+      if (iarg+2 > narg) error->all(FLERR,"Illegal timer command");
+      if (jsonfp) fclose(jsonfp);
+      jsonfp = NULL;
+      jsonflag = jsonevery = 0;
+      if (strcmp(arg[iarg+1],"none") == 0) {
+        iarg += 2;
+        continue;
+      }
+      if (iarg+3 > narg) error->all(FLERR,"Illegal timer command");
+      jsonevery = force->inumeric(FLERR,arg[iarg+2]);
+      if (jsonevery < 0) error->all(FLERR,"Illegal timer command");
+      jsonflag = 1;
+      if (comm->me == 0) {
+        jsonfp = fopen(arg[iarg+1],"w");
+        if (jsonfp == NULL) {
+          char str[128];
+          sprintf(str,"Cannot open timer JSON file %s",arg[iarg+1]);
+          error->one(FLERR,str);
+        }
+      }
+      iarg += 3;
+    } else error->all(FLERR,"Illegal timer command");
+  }
+}
+
+/* ----------------------------------------------------------------------
+   register a detailed timer with name below parent timer
+   return index of existing timer if already registered
+   return -1 if detailed timing is off
+   must be called by all procs in the same order, e.g. from an init()
+------------------------------------------------------------------------- */
+
+int Timer::add(const char *name, int parent)
+{
+  if (!fullflag) return -1;
+
+  for (int i = 0; i < nsub; i++)
+    if (subparent[i] == parent && strcmp(subname[i],name) == 0) return i;
+
+  if (nsub == maxsub) {
+    maxsub += DELTA;
+    subname = (char **)
+      memory->srealloc(subname,maxsub*sizeof(char *),"timer:subname");
+    memory->grow(subparent,maxsub,"timer:subparent");
+    memory->grow(subcount,maxsub,"timer:subcount");
+    memory->grow(subtime,maxsub,"timer:subtime");
+    memory->grow(substart,maxsub,"timer:substart");
+  }
+
+  int n = strlen(name) + 1;
+  subname[nsub] = new char[n];
+  strcpy(subname[nsub],name);
+  subparent[nsub] = parent;
+  subcount[nsub] = 0;
+  subtime[nsub] = 0.0;
+  return nsub++;
+}
+
+/* ----------------------------------------------------------------------
+   inclusive time of each detailed timer on this proc
+   a timer never started is a grouping scope, its time = sum of children
+   children always have a larger index than their parent
+------------------------------------------------------------------------- */
+
+void Timer::sub_totals(double *total)
+{
+  for (int i = 0; i < nsub; i++) total[i] = subtime[i];
+  for (int i = nsub-1; i >= 0; i--)
+    if (subparent[i] >= 0 && subcount[subparent[i]] == 0)
+      total[subparent[i]] += total[i];
+}
+
+/* ----------------------------------------------------------------------
+   identify which node each proc runs on, by MPI processor name
+   same approach as ProcMap uses for NUMA-aware mapping
+------------------------------------------------------------------------- */
+
+void Timer::node_setup()
+{
+  if (nnodes) return;
+
+  int me,nprocs;
+  MPI_Comm_rank(world,&me);
+  MPI_Comm_size(world,&nprocs);
+
+  int name_length;
+  char node_name[MPI_MAX_PROCESSOR_NAME];
+  memset(node_name,0,MPI_MAX_PROCESSOR_NAME);
+  MPI_Get_processor_name(node_name,&name_length);
+  node_name[name_length] = '\0';
+  char *node_names = new char[MPI_MAX_PROCESSOR_NAME*nprocs];
+  MPI_Allgather(node_name,MPI_MAX_PROCESSOR_NAME,MPI_CHAR,node_names,
+                MPI_MAX_PROCESSOR_NAME,MPI_CHAR,world);
+
+  std::map<std::string,int> name_map;
+  std::map<std::string,int>::iterator it;
+  for (int i = 0; i < nprocs; i++) {
+    std::string i_string = std::string(&node_names[i*MPI_MAX_PROCESSOR_NAME]);
+    it = name_map.find(i_string);
+    if (it == name_map.end()) name_map[i_string] = 1;
+    else it->second++;
+  }
+  delete [] node_names;
+
+  nnodes = name_map.size();
+  nodeprocs = new int[nnodes];
+  nodenames = new char*[nnodes];
+  int i = 0;
+  for (it = name_map.begin(); it != name_map.end(); ++it, i++) {
+    nodeprocs[i] = it->second;
+    nodenames[i] = new char[it->first.length()+1];
+    strcpy(nodenames[i],it->first.c_str());
+    if (it->first == std::string(node_name)) inode = i;
+  }
+}
+
+/* ----------------------------------------------------------------------
+   average N values of each proc over the procs on each node
+   return nodeave = Nnodes x N values, same on all procs
+------------------------------------------------------------------------- */
+
+void Timer::node_average(int n, double *local, double *nodeave)
+{
+  node_setup();
+
+  double *buf = new double[nnodes*n];
+  for (int i = 0; i < nnodes*n; i++) buf[i] = 0.0;
+  for (int i = 0; i < n; i++) buf[inode*n+i] = local[i]/nodeprocs[inode];
+  MPI_Allreduce(buf,nodeave,nnodes*n,MPI_DOUBLE,MPI_SUM,world);
+  delete [] buf;
+}
+
+/* ----------------------------------------------------------------------
+   write one JSON object on a single line with current timing data
+   time_loop = elapsed loop time so far on this proc
+   sections and detailed timers report min/avg/max over procs
+   nodes report the average over their procs
+   collective, only proc 0 writes
+------------------------------------------------------------------------- */
+
+void Timer::write_json(double time_loop)
+{
+  int i,j;
+
+  int me,nprocs;
+  MPI_Comm_rank(world,&me);
+  MPI_Comm_size(world,&nprocs);
+
+  // values = loop time, section times, inclusive detailed times
+
+  int n = TIME_N + nsub;
+  double *values = new double[n];
+  double *vmin = new double[n];
+  double *vmax = new double[n];
+  double *vsum = new double[n];
+
+  values[TIME_LOOP] = time_loop;
+  for (i = 1; i < TIME_N; i++) values[i] = array[i];
+  sub_totals(&values[TIME_N]);
+
+  MPI_Allreduce(values,vmin,n,MPI_DOUBLE,MPI_MIN,world);
+  MPI_Allreduce(values,vmax,n,MPI_DOUBLE,MPI_MAX,world);
+  MPI_Allreduce(values,vsum,n,MPI_DOUBLE,MPI_SUM,world);
+
+  node_setup();
+  double *nodeave = new double[nnodes*TIME_N];
+  node_average(TIME_N,values,nodeave);
+
+  if (me == 0 && jsonfp) {
+    fprintf(jsonfp,"{\"step\": " BIGINT_FORMAT ", \"nprocs\": %d, "
+            "\"sections\": {",update->ntimestep,nprocs);
+    for (i = 0; i < TIME_N; i++)
+      fprintf(jsonfp,"%s\"%s\": {\"min\": %g, \"avg\": %g, \"max\": %g}",
+              i ? ", " : "",sectionnames[i],vmin[i],vsum[i]/nprocs,vmax[i]);
+    fprintf(jsonfp,"}, \"timers\": [");
+    for (i = 0; i < nsub; i++) {
+      j = TIME_N + i;
+      fprintf(jsonfp,"%s{\"name\": ",i ? ", " : "");
+      json_string(jsonfp,subname[i]);
+      fprintf(jsonfp,", \"parent\": %d, "
+              "\"min\": %g, \"avg\": %g, \"max\": %g}",
+              subparent[i],vmin[j],vsum[j]/nprocs,vmax[j]);
+    }
+    fprintf(jsonfp,"], \"nodes\": [");
+    for (i = 0; i < nnodes; i++) {
+      fprintf(jsonfp,"%s{\"name\": ",i ? ", " : "");
+      json_string(jsonfp,nodenames[i]);
+      fprintf(jsonfp,", \"nprocs\": %d",nodeprocs[i]);
+      for (j = 0; j < TIME_N; j++)
+        fprintf(jsonfp,", \"%s\": %g",sectionnames[j],nodeave[i*TIME_N+j]);
+      fprintf(jsonfp,"}");
+    }
+    fprintf(jsonfp,"]}\n");
+    fflush(jsonfp);
+  }
+
+  delete [] values;
+  delete [] vmin;
+  delete [] vmax;
+  delete [] vsum;
+  delete [] nodeave;
+}
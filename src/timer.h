@@ -25,6 +25,24 @@ class Timer : protected Pointers {
  public:
   double *array;
 
+  // detailed timers, a tree of named scopes below the TIME_* categories
+  // only registered and accumulated when fullflag is set
+
+  int fullflag;                 // 1 if timer full is set
+  int nsub;                     // # of detailed timers
+  char **subname;               // name of each detailed timer
+  int *subparent;               // index of parent timer, -1 for a root
+  int *subcount;                // # of times each timer was started
+  double *subtime;              // accumulated time for each timer
+
+  int nnodes;                   // # of nodes the procs run on
+  int inode;                    // index of node this proc runs on
+  int *nodeprocs;               // # of procs on each node
+  char **nodenames;             // name of each node
+
+  int jsonflag;                 // 1 if JSON output is enabled
+  int jsonevery;                // also write JSON every this many steps
+
   Timer(class LAMMPS *);
   ~Timer();
   void init();
@@ -34,10 +52,48 @@ class Timer : protected Pointers {
   void barrier_stop(int);
   double elapsed(int);
 
+  void modify_params(int, char **);
+  int add(const char *, int parent = -1);
+  void sub_totals(double *);
+  void node_setup();
+  void node_average(int, double *, double *);
+  void write_json(double);
+
+  // start and stop a detailed timer
+  // index < 0 means timer was not registered since fullflag was off
+
+  void sub_start(int i) {
+    if (i >= 0) substart[i] = MPI_Wtime();
+  }
+  void sub_stop(int i) {
+    if (i >= 0) {
+      subtime[i] += MPI_Wtime() - substart[i];
+      subcount[i]++;
+    }
+  }
+
  private:
   double previous_time;
+  int maxsub;
+  double *substart;             // start time of each running timer
+  FILE *jsonfp;                 // file for periodic JSON output
 };
 
 }
 
 #endif
+
+/* ERROR/WARNING messages:
+
+E: Illegal ... command
+
+Self-explanatory.  Check the input script syntax and compare to the
+documentation for the command.  You can use -echo screen as a
+command-line option when running LAMMPS to see the offending line.
+
+E: Cannot open timer JSON file %s
+
+The specified file cannot be opened.  Check that the path and name are
+correct.
+
+*/
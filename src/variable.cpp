@@ -46,6 +46,8 @@ using namespace MathConst;
 #define CHUNK 1024
 #define VALUELENGTH 64
 #define MAXFUNCARG 6
+#define MAXSTACK 64
+#define DELTACODE 16
 
 #define MYROUND(a) (( a-floor(a) ) >= .5) ? ceil(a) : floor(a)
 
@@ -62,7 +64,12 @@ enum{DONE,ADD,SUBTRACT,MULTIPLY,DIVIDE,CARAT,MODULO,UNARY,
      SQRT,EXP,LN,LOG,ABS,SIN,COS,TAN,ASIN,ACOS,ATAN,ATAN2,
      RANDOM,NORMAL,CEIL,FLOOR,ROUND,RAMP,STAGGER,LOGFREQ,STRIDE,STRIDE2,
      VDISPLACE,SWIGGLE,CWIGGLE,GMASK,RMASK,GRMASK,
-     VALUE,ATOMARRAY,TYPEARRAY,INTARRAY,BIGINTARRAY};
+     VALUE,ATOMARRAY,TYPEARRAY,INTARRAY,BIGINTARRAY,
+     KEYWORD,VARREF,ATOMFILEREF,COMPUTEREF,FIXREF,ATOMVECTOR};
+
+// kinds of compute and fix quantities a compiled formula can reference
+
+enum{GLOBALSCALAR,GLOBALVECTOR,GLOBALARRAY,PERATOMVECTOR,PERATOMARRAY};
 
 // customize by adding a special function
 
@@ -92,6 +99,9 @@ Variable::Variable(LAMMPS *lmp) : Pointers(lmp)
 
   eval_in_progress = NULL;
 
+  program = NULL;
+  compiled = NULL;
+
   randomequal = NULL;
   randomatom = NULL;
 
@@ -118,6 +128,7 @@ Variable::~Variable()
     if (style[i] == LOOP || style[i] == ULOOP) delete [] data[i][0];
     else for (int j = 0; j < num[i]; j++) delete [] data[i][j];
     delete [] data[i];
+    free_program(program[i]);
   }
   memory->sfree(names);
   memory->destroy(style);
@@ -128,6 +139,8 @@ Variable::~Variable()
   memory->sfree(data);
 
   memory->destroy(eval_in_progress);
+  memory->sfree(program);
+  memory->destroy(compiled);
 
   delete randomequal;
   delete randomatom;
@@ -415,6 +428,10 @@ void Variable::set(int narg, char **arg)
 
   } else error->all(FLERR,"Illegal variable command");
 
+  // any compiled formula may have inlined or failed on this variable
+
+  invalidate(-1);
+
   // set name of variable, if not replacing (STRING/EQUAL/ATOM)
   // name must be all alphanumeric chars or underscores
 
@@ -625,14 +642,14 @@ char *Variable::retrieve(char *name)
     strcpy(data[ivar][0],result);
     str = data[ivar][0];
   } else if (style[ivar] == EQUAL) {
-    double answer = evaluate(data[ivar][0],NULL);
+    double answer = evaluate_equal(ivar);
     sprintf(data[ivar][1],"%.15g",answer);
     str = data[ivar][1];
   } else if (style[ivar] == FORMAT) {
     int jvar = find(data[ivar][0]);
     if (jvar == -1) return NULL;
     if (!equalstyle(jvar)) return NULL;
-    double answer = evaluate(data[jvar][0],NULL);
+    double answer = evaluate_equal(jvar);
     sprintf(data[ivar][2],data[ivar][1],answer);
     str = data[ivar][2];
   } else if (style[ivar] == GETENV) {
@@ -660,7 +677,7 @@ double Variable::compute_equal(int ivar)
     error->all(FLERR,"Variable has circular dependency");
   eval_in_progress[ivar] = 1;
 
-  double value = evaluate(data[ivar][0],NULL);
+  double value = evaluate_equal(ivar);
 
   eval_in_progress[ivar] = 0;
   return value;
@@ -686,23 +703,32 @@ double Variable::compute_equal(char *str)
 void Variable::compute_atom(int ivar, int igroup,
                             double *result, int stride, int sumflag)
 {
-  Tree *tree;
-  double *vstore;
-  
+  Tree *tree = NULL;
+  double *vstore = NULL;
+  double value = 0.0;
+
   if (eval_in_progress[ivar]) 
     error->all(FLERR,"Variable has circular dependency");
   eval_in_progress[ivar] = 1;
 
-  if (style[ivar] == ATOM) {
-    evaluate(data[ivar][0],&tree);
-    collapse_tree(tree);
-  } else vstore = reader[ivar]->fix->vstore;
-
   int groupbit = group->bitmask[igroup];
   int *mask = atom->mask;
   int nlocal = atom->nlocal;
 
+  // use compiled program if formula can be compiled, else parse tree
+  // program result is either per-atom vstore or a single value
+
   if (style[ivar] == ATOM) {
+    Program *prog = get_program(ivar,1);
+    if (prog) {
+      if (run_program(prog,groupbit,value)) vstore = prog->vstack[0];
+    } else {
+      evaluate(data[ivar][0],&tree);
+      collapse_tree(tree);
+    }
+  } else vstore = reader[ivar]->fix->vstore;
+
+  if (tree) {
     if (sumflag == 0) {
       int m = 0;
       for (int i = 0; i < nlocal; i++) {
@@ -719,7 +745,7 @@ void Variable::compute_atom(int ivar, int igroup,
       }
     }
 
-  } else {
+  } else if (vstore) {
     if (sumflag == 0) {
       int m = 0;
       for (int i = 0; i < nlocal; i++) {
@@ -735,9 +761,26 @@ void Variable::compute_atom(int ivar, int igroup,
         m += stride;
       }
     }
+
+  } else {
+    if (sumflag == 0) {
+      int m = 0;
+      for (int i = 0; i < nlocal; i++) {
+        if (mask[i] & groupbit) result[m] = value;
+        else result[m] = 0.0;
+        m += stride;
+      }
+
+    } else {
+      int m = 0;
+      for (int i = 0; i < nlocal; i++) {
+        if (mask[i] & groupbit) result[m] += value;
+        m += stride;
+      }
+    }
   }
 
-  if (style[ivar] == ATOM) free_tree(tree);
+  if (tree) free_tree(tree);
 
   eval_in_progress[ivar] = 0;
 }
@@ -801,6 +844,7 @@ void Variable::equal_restore(int ivar, char *copy)
   data[ivar][0] = new char[n];
   strcpy(data[ivar][0],copy);
   delete [] copy;
+  invalidate(ivar);
 }
 
 /* ----------------------------------------------------------------------
@@ -811,6 +855,7 @@ void Variable::equal_restore(int ivar, char *copy)
 void Variable::equal_override(int ivar, double value)
 {
   sprintf(data[ivar][0],"%.15g",value);
+  invalidate(ivar);
 }
 
 /* ----------------------------------------------------------------------
@@ -825,6 +870,7 @@ void Variable::remove(int n)
   else for (int i = 0; i < num[n]; i++) delete [] data[n][i];
   delete [] data[n];
   delete reader[n];
+  free_program(program[n]);
 
   for (int i = n+1; i < nvar; i++) {
     names[i-1] = names[i];
@@ -834,8 +880,14 @@ void Variable::remove(int n)
     pad[i-1] = pad[i];
     reader[i-1] = reader[i];
     data[i-1] = data[i];
+    program[i-1] = program[i];
+    compiled[i-1] = compiled[i];
   }
   nvar--;
+  program[nvar] = NULL;
+  compiled[nvar] = 0;
+
+  invalidate(-1);
 }
 
 /* ----------------------------------------------------------------------
@@ -860,6 +912,14 @@ void Variable::grow()
 
   memory->grow(eval_in_progress,maxvar,"var:eval_in_progress");
   for (int i = 0; i < maxvar; i++) eval_in_progress[i] = 0;
+
+  program = (Program **) 
+    memory->srealloc(program,maxvar*sizeof(Program *),"var:program");
+  memory->grow(compiled,maxvar,"var:compiled");
+  for (int i = old; i < maxvar; i++) {
+    program[i] = NULL;
+    compiled[i] = 0;
+  }
 }
 
 /* ----------------------------------------------------------------------
@@ -2996,7 +3056,7 @@ int Variable::math_function(char *word, char *contents, Tree **tree,
       error->all(FLERR,"Invalid math function in variable formula");
     if (update->whichflag == 0)
       error->all(FLERR,"Cannot use swiggle in variable formula between runs");
-    if (tree) newtree->type = CWIGGLE;
+    if (tree) newtree->type = SWIGGLE;
     else {
       if (values[0] == 0.0)
         error->all(FLERR,"Invalid math function in variable formula");
@@ -3844,6 +3904,1143 @@ void Variable::print_tree(Tree *tree, int level)
   return;
 }
 
+/* ----------------------------------------------------------------------
+   evaluate equal-style variable ivar
+   use its compiled program if formula can be compiled, else parse string
+------------------------------------------------------------------------- */
+
+double Variable::evaluate_equal(int ivar)
+{
+  double value;
+
+  Program *prog = get_program(ivar,0);
+  if (prog) run_program(prog,0,value);
+  else value = evaluate(data[ivar][0],NULL);
+  return value;
+}
+
+/* ----------------------------------------------------------------------
+   return compiled program for formula of variable ivar
+   atomflag = 1 if formula is atom-style, 0 if equal-style
+   program is compiled once and reused until the formula or a variable
+     it inlines changes, or a compute/fix it references is replaced
+   return NULL if formula uses features not supported by programs,
+     caller then falls back to evaluate()
+------------------------------------------------------------------------- */
+
+Variable::Program *Variable::get_program(int ivar, int atomflag)
+{
+  if (compiled[ivar] == 1 && !check_program(program[ivar]))
+    compiled[ivar] = 0;
+
+  if (compiled[ivar] == 0) {
+    free_program(program[ivar]);
+
+    Program *prog = new Program;
+    prog->ncode = prog->maxcode = 0;
+    prog->nstack = prog->maxstack = 0;
+    prog->atomflag = atomflag;
+    prog->code = NULL;
+    prog->vstack = NULL;
+    prog->maxvstack = prog->maxvatom = 0;
+
+    int flag = compile(data[ivar][0],prog);
+    if (flag && prog->nstack == 1 && prog->maxstack <= MAXSTACK) {
+      program[ivar] = prog;
+      compiled[ivar] = 1;
+    } else {
+      free_program(prog);
+      program[ivar] = NULL;
+      compiled[ivar] = -1;
+    }
+  }
+
+  if (compiled[ivar] == 1) return program[ivar];
+  return NULL;
+}
+
+/* ----------------------------------------------------------------------
+   force recompile of program for variable ivar, or all if ivar < 0
+   program is not freed here since it may be in use by caller
+------------------------------------------------------------------------- */
+
+void Variable::invalidate(int ivar)
+{
+  if (ivar >= 0) compiled[ivar] = 0;
+  else for (int i = 0; i < nvar; i++) compiled[i] = 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void Variable::free_program(Program *prog)
+{
+  if (prog == NULL) return;
+  for (int i = 0; i < prog->ncode; i++) {
+    delete [] prog->code[i].id;
+    delete [] prog->code[i].id2;
+  }
+  memory->sfree(prog->code);
+  memory->destroy(prog->vstack);
+  delete prog;
+}
+
+/* ----------------------------------------------------------------------
+   compile formula str into postfix instructions appended to prog
+   follows the grammar and operator precedence of evaluate()
+   leaves one more value on the program stack
+   values that can change (thermo keywords, computes, fixes, other
+     variables, atom vectors) are looked up each time program is run
+   return 1 if successful
+   return 0 if str has a syntax error or uses a feature without an
+     instruction, e.g. group/special functions, random numbers,
+     atom values or indexed per-atom quantities
+------------------------------------------------------------------------- */
+
+int Variable::compile(char *str, Program *prog)
+{
+  int op,opprevious,flag;
+  char onechar;
+  Instr *instr;
+
+  int opstack[MAXSTACK];
+  int nopstack = 0;
+  int nstart = prog->nstack;
+
+  int i = 0;
+  int expect = ARG;
+
+  while (1) {
+    onechar = str[i];
+
+    // whitespace: just skip
+
+    if (isspace(onechar)) i++;
+
+    // parentheses: compile contents
+
+    else if (onechar == '(') {
+      if (expect == OP) return 0;
+      expect = OP;
+
+      char *contents;
+      i = find_matching_paren(str,i,contents);
+      i++;
+      flag = compile(contents,prog);
+      delete [] contents;
+      if (!flag) return 0;
+
+    // number: push value
+
+    } else if (isdigit(onechar) || onechar == '.') {
+      if (expect == OP) return 0;
+      expect = OP;
+
+      int istart = i;
+      while (isdigit(str[i]) || str[i] == '.') i++;
+      if (str[i] == 'e' || str[i] == 'E') {
+        i++;
+        if (str[i] == '+' || str[i] == '-') i++;
+        while (isdigit(str[i])) i++;
+      }
+      int istop = i - 1;
+
+      int n = istop - istart + 1;
+      char *number = new char[n+1];
+      strncpy(number,&str[istart],n);
+      number[n] = '\0';
+      emit(prog,VALUE,0,atof(number),NULL,NULL);
+      delete [] number;
+
+    // letter: compute, fix, variable, function, atom vector,
+    //         constant, thermo keyword
+
+    } else if (isalpha(onechar)) {
+      if (expect == OP) return 0;
+      expect = OP;
+
+      int istart = i;
+      while (isalnum(str[i]) || str[i] == '_') i++;
+      int istop = i-1;
+
+      int n = istop - istart + 1;
+      char *word = new char[n+1];
+      strncpy(word,&str[istart],n);
+      word[n] = '\0';
+
+      flag = 0;
+      int index1,index2,kind;
+
+      if (strncmp(word,"c_",2) == 0) {
+        int icompute = modify->find_compute(&word[2]);
+        if (domain->box_exist && icompute >= 0 &&
+            compile_brackets(str,i,index1,index2) >= 0) {
+          kind = compute_kind(modify->compute[icompute],
+                              (index1 > 0) + (index2 > 0),prog->atomflag);
+          if (kind >= 0) {
+            instr = emit(prog,COMPUTEREF,0,0.0,&word[2],NULL);
+            instr->kind = kind;
+            instr->index1 = index1;
+            instr->index2 = index2;
+            instr->icache = icompute;
+            flag = 1;
+          }
+        }
+
+      } else if (strncmp(word,"f_",2) == 0) {
+        int ifix = modify->find_fix(&word[2]);
+        if (domain->box_exist && ifix >= 0 &&
+            compile_brackets(str,i,index1,index2) >= 0) {
+          kind = fix_kind(modify->fix[ifix],
+                          (index1 > 0) + (index2 > 0),prog->atomflag);
+          if (kind >= 0) {
+            instr = emit(prog,FIXREF,0,0.0,&word[2],NULL);
+            instr->kind = kind;
+            instr->index1 = index1;
+            instr->index2 = index2;
+            instr->icache = ifix;
+            flag = 1;
+          }
+        }
+
+      // atom-style variable is inlined, as evaluate() does with its tree
+      // eval_in_progress detects circular inlining
+
+      } else if (strncmp(word,"v_",2) == 0) {
+        int jvar = find(&word[2]);
+        if (jvar >= 0 && !eval_in_progress[jvar] && str[i] != '[') {
+          if (style[jvar] == ATOM) {
+            if (prog->atomflag) {
+              eval_in_progress[jvar] = 1;
+              flag = compile(data[jvar][0],prog);
+              eval_in_progress[jvar] = 0;
+            }
+          } else if (style[jvar] == ATOMFILE) {
+            if (prog->atomflag) {
+              instr = emit(prog,ATOMFILEREF,0,0.0,&word[2],NULL);
+              instr->icache = jvar;
+              flag = 1;
+            }
+          } else {
+            instr = emit(prog,VARREF,0,0.0,&word[2],NULL);
+            instr->icache = jvar;
+            flag = 1;
+          }
+        }
+
+      } else if (str[i] == '(') {
+        char *contents;
+        i = find_matching_paren(str,i,contents);
+        i++;
+        flag = compile_function(word,contents,prog);
+        delete [] contents;
+
+      } else if (str[i] == '[') {
+        flag = 0;
+
+      } else if (is_atom_vector(word)) {
+        if (prog->atomflag && domain->box_exist) {
+          emit(prog,ATOMVECTOR,0,0.0,word,NULL);
+          flag = 1;
+        }
+
+      } else if (is_constant(word)) {
+        emit(prog,VALUE,0,constant(word),NULL,NULL);
+        flag = 1;
+
+      } else if (domain->box_exist) {
+        emit(prog,KEYWORD,0,0.0,word,NULL);
+        flag = 1;
+      }
+
+      delete [] word;
+      if (!flag) return 0;
+
+    // math operator, including end-of-string
+
+    } else if (strchr("+-*/^<>=!&|%\0",onechar)) {
+      if (onechar == '+') op = ADD;
+      else if (onechar == '-') op = SUBTRACT;
+      else if (onechar == '*') op = MULTIPLY;
+      else if (onechar == '/') op = DIVIDE;
+      else if (onechar == '%') op = MODULO;
+      else if (onechar == '^') op = CARAT;
+      else if (onechar == '=') {
+        if (str[i+1] != '=') return 0;
+        op = EQ;
+        i++;
+      } else if (onechar == '!') {
+        if (str[i+1] == '=') {
+          op = NE;
+          i++;
+        } else op = NOT;
+      } else if (onechar == '<') {
+        if (str[i+1] != '=') op = LT;
+        else {
+          op = LE;
+          i++;
+        }
+      } else if (onechar == '>') {
+        if (str[i+1] != '=') op = GT;
+        else {
+          op = GE;
+          i++;
+        }
+      } else if (onechar == '&') {
+        if (str[i+1] != '&') return 0;
+        op = AND;
+        i++;
+      } else if (onechar == '|') {
+        if (str[i+1] != '|') return 0;
+        op = OR;
+        i++;
+      } else op = DONE;
+
+      i++;
+
+      if (nopstack == MAXSTACK) return 0;
+      if (op == SUBTRACT && expect == ARG) {
+        opstack[nopstack++] = UNARY;
+        continue;
+      }
+      if (op == NOT && expect == ARG) {
+        opstack[nopstack++] = op;
+        continue;
+      }
+
+      if (expect == ARG) return 0;
+      expect = ARG;
+
+      // emit stacked operations as deep as possible
+      // while respecting precedence
+
+      while (nopstack && precedence[opstack[nopstack-1]] >= precedence[op]) {
+        opprevious = opstack[--nopstack];
+        if (opprevious == UNARY || opprevious == NOT)
+          emit(prog,opprevious,1,0.0,NULL,NULL);
+        else emit(prog,opprevious,2,0.0,NULL,NULL);
+      }
+
+      if (op == DONE) break;
+      opstack[nopstack++] = op;
+
+    } else return 0;
+  }
+
+  if (nopstack) return 0;
+  if (prog->nstack != nstart+1) return 0;
+  return 1;
+}
+
+/* ----------------------------------------------------------------------
+   compile a math function or a gmask/rmask/grmask special function
+   word = function name, contents = str between parentheses
+   return 1 if successful, 0 if function has no instruction or wrong # args
+------------------------------------------------------------------------- */
+
+int Variable::compile_function(char *word, char *contents, Program *prog)
+{
+  int op,nreq;
+
+  if (strcmp(word,"sqrt") == 0) op = SQRT, nreq = 1;
+  else if (strcmp(word,"exp") == 0) op = EXP, nreq = 1;
+  else if (strcmp(word,"ln") == 0) op = LN, nreq = 1;
+  else if (strcmp(word,"log") == 0) op = LOG, nreq = 1;
+  else if (strcmp(word,"abs") == 0) op = ABS, nreq = 1;
+  else if (strcmp(word,"sin") == 0) op = SIN, nreq = 1;
+  else if (strcmp(word,"cos") == 0) op = COS, nreq = 1;
+  else if (strcmp(word,"tan") == 0) op = TAN, nreq = 1;
+  else if (strcmp(word,"asin") == 0) op = ASIN, nreq = 1;
+  else if (strcmp(word,"acos") == 0) op = ACOS, nreq = 1;
+  else if (strcmp(word,"atan") == 0) op = ATAN, nreq = 1;
+  else if (strcmp(word,"atan2") == 0) op = ATAN2, nreq = 2;
+  else if (strcmp(word,"ceil") == 0) op = CEIL, nreq = 1;
+  else if (strcmp(word,"floor") == 0) op = FLOOR, nreq = 1;
+  else if (strcmp(word,"round") == 0) op = ROUND, nreq = 1;
+  else if (strcmp(word,"ramp") == 0) op = RAMP, nreq = 2;
+  else if (strcmp(word,"stagger") == 0) op = STAGGER, nreq = 2;
+  else if (strcmp(word,"logfreq") == 0) op = LOGFREQ, nreq = 3;
+  else if (strcmp(word,"stride") == 0) op = STRIDE, nreq = 3;
+  else if (strcmp(word,"stride2") == 0) op = STRIDE2, nreq = 6;
+  else if (strcmp(word,"vdisplace") == 0) op = VDISPLACE, nreq = 2;
+  else if (strcmp(word,"swiggle") == 0) op = SWIGGLE, nreq = 3;
+  else if (strcmp(word,"cwiggle") == 0) op = CWIGGLE, nreq = 3;
+  else if (strcmp(word,"gmask") == 0) op = GMASK, nreq = 1;
+  else if (strcmp(word,"rmask") == 0) op = RMASK, nreq = 1;
+  else if (strcmp(word,"grmask") == 0) op = GRMASK, nreq = 2;
+  else return 0;
+
+  char *args[MAXFUNCARG];
+  int narg = parse_args(contents,args);
+
+  int flag = 1;
+  if (narg != nreq) flag = 0;
+  else if (op == GMASK || op == RMASK || op == GRMASK) {
+    if (!prog->atomflag) flag = 0;
+    else if (op == GRMASK) emit(prog,op,0,0.0,args[0],args[1]);
+    else emit(prog,op,0,0.0,args[0],NULL);
+  } else {
+    for (int i = 0; i < narg; i++)
+      if (flag) flag = compile(args[i],prog);
+    if (flag) emit(prog,op,narg,0.0,NULL,NULL);
+  }
+
+  for (int i = 0; i < narg; i++) delete [] args[i];
+  return flag;
+}
+
+/* ----------------------------------------------------------------------
+   parse zero, one or two trailing brackets of a compute/fix reference
+   i = location in str after reference name, returned after last bracket
+   index1,index2 = int inside each bracket, 0 if no bracket
+   return # of bracket pairs, -1 if brackets are not plain positive ints
+------------------------------------------------------------------------- */
+
+int Variable::compile_brackets(char *str, int &i, int &index1, int &index2)
+{
+  int *index[2];
+  index[0] = &index1;
+  index[1] = &index2;
+  index1 = index2 = 0;
+
+  int nbracket = 0;
+  while (nbracket < 2 && str[i] == '[') {
+    int j = i+1;
+    while (isdigit(str[j])) j++;
+    if (str[j] != ']' || j == i+1) return -1;
+    *index[nbracket] = atoi(&str[i+1]);
+    if (*index[nbracket] == 0) return -1;
+    nbracket++;
+    i = j+1;
+  }
+  return nbracket;
+}
+
+/* ----------------------------------------------------------------------
+   append one instruction to prog and track depth of its value stack
+   narg = # of values the instruction pops, it always pushes one value
+------------------------------------------------------------------------- */
+
+Variable::Instr *Variable::emit(Program *prog, int op, int narg,
+                                double value, char *id, char *id2)
+{
+  if (prog->ncode == prog->maxcode) {
+    prog->maxcode += DELTACODE;
+    prog->code = (Instr *)
+      memory->srealloc(prog->code,prog->maxcode*sizeof(Instr),
+                       "variable:code");
+  }
+
+  Instr *instr = &prog->code[prog->ncode++];
+  instr->op = op;
+  instr->narg = narg;
+  instr->kind = -1;
+  instr->index1 = instr->index2 = 0;
+  instr->icache = -1;
+  instr->value = value;
+  instr->id = instr->id2 = NULL;
+  if (id) {
+    instr->id = new char[strlen(id)+1];
+    strcpy(instr->id,id);
+  }
+  if (id2) {
+    instr->id2 = new char[strlen(id2)+1];
+    strcpy(instr->id2,id2);
+  }
+
+  prog->nstack += 1 - narg;
+  prog->maxstack = MAX(prog->maxstack,prog->nstack);
+  return instr;
+}
+
+/* ----------------------------------------------------------------------
+   kind of quantity a compute reference with nbracket brackets produces
+   same order of tests as in evaluate()
+   return -1 for an indexed per-atom value or a per-atom quantity
+     in an equal-style formula, these are left to evaluate()
+------------------------------------------------------------------------- */
+
+int Variable::compute_kind(Compute *compute, int nbracket, int atomflag)
+{
+  if (nbracket == 0 && compute->scalar_flag) return GLOBALSCALAR;
+  if (nbracket == 1 && compute->vector_flag) return GLOBALVECTOR;
+  if (nbracket == 2 && compute->array_flag) return GLOBALARRAY;
+  if (!atomflag || !compute->peratom_flag) return -1;
+  if (nbracket == 0 && compute->size_peratom_cols == 0) return PERATOMVECTOR;
+  if (nbracket == 1 && compute->size_peratom_cols > 0) return PERATOMARRAY;
+  return -1;
+}
+
+/* ---------------------------------------------------------------------- */
+
+int Variable::fix_kind(Fix *fix, int nbracket, int atomflag)
+{
+  if (nbracket == 0 && fix->scalar_flag) return GLOBALSCALAR;
+  if (nbracket == 1 && fix->vector_flag) return GLOBALVECTOR;
+  if (nbracket == 2 && fix->array_flag) return GLOBALARRAY;
+  if (!atomflag || !fix->peratom_flag) return -1;
+  if (nbracket == 0 && fix->size_peratom_cols == 0) return PERATOMVECTOR;
+  if (nbracket == 1 && fix->size_peratom_cols > 0) return PERATOMARRAY;
+  return -1;
+}
+
+/* ----------------------------------------------------------------------
+   check that computes, fixes and atomfile variables referenced by prog
+     still exist and produce the same kind of quantity
+   refresh cached indices used by run_program()
+   return 1 if prog can be run, 0 if it must be recompiled
+------------------------------------------------------------------------- */
+
+int Variable::check_program(Program *prog)
+{
+  int n;
+
+  for (int m = 0; m < prog->ncode; m++) {
+    Instr *instr = &prog->code[m];
+    int nbracket = (instr->index1 > 0) + (instr->index2 > 0);
+
+    if (instr->op == COMPUTEREF) {
+      n = instr->icache;
+      if (n < 0 || n >= modify->ncompute ||
+          strcmp(modify->compute[n]->id,instr->id) != 0)
+        n = instr->icache = modify->find_compute(instr->id);
+      if (n < 0) return 0;
+      if (compute_kind(modify->compute[n],nbracket,prog->atomflag) !=
+          instr->kind) return 0;
+
+    } else if (instr->op == FIXREF) {
+      n = instr->icache;
+      if (n < 0 || n >= modify->nfix ||
+          strcmp(modify->fix[n]->id,instr->id) != 0)
+        n = instr->icache = modify->find_fix(instr->id);
+      if (n < 0) return 0;
+      if (fix_kind(modify->fix[n],nbracket,prog->atomflag) != instr->kind)
+        return 0;
+
+    } else if (instr->op == ATOMFILEREF) {
+      n = instr->icache;
+      if (n < 0 || n >= nvar || strcmp(names[n],instr->id) != 0)
+        n = instr->icache = find(instr->id);
+      if (n < 0 || style[n] != ATOMFILE) return 0;
+    }
+  }
+
+  return 1;
+}
+
+/* ----------------------------------------------------------------------
+   run compiled program on a stack of values
+   each stack entry is a single value or a per-atom vector in vstack
+   per-atom entries are processed by loops over contiguous vectors,
+     scalar entries are broadcast when combined with per-atom entries
+   per-atom error checks are only applied to atoms in groupbit,
+     like eval_tree() which is only called for those atoms
+   return 1 if result is per-atom in prog->vstack[0]
+   return 0 if result is a single value in answer
+------------------------------------------------------------------------- */
+
+int Variable::run_program(Program *prog, int groupbit, double &answer)
+{
+  int i,k,n,op,narg,nlocal,vecflag;
+  double *a,*b;
+  double sval[MAXSTACK],arg[MAXFUNCARG];
+  int vflag[MAXSTACK];
+
+  int *mask = NULL;
+  nlocal = 0;
+  if (prog->atomflag) {
+    nlocal = atom->nlocal;
+    mask = atom->mask;
+    if (prog->maxstack > prog->maxvstack || nlocal > prog->maxvatom) {
+      memory->destroy(prog->vstack);
+      prog->maxvstack = MAX(prog->maxstack,prog->maxvstack);
+      prog->maxvatom = MAX(atom->nmax,prog->maxvatom);
+      memory->create(prog->vstack,prog->maxvstack,prog->maxvatom,
+                     "variable:vstack");
+    }
+  }
+  double **vstack = prog->vstack;
+
+  n = 0;
+  for (int m = 0; m < prog->ncode; m++) {
+    Instr *instr = &prog->code[m];
+    op = instr->op;
+
+    // ----------------
+    // values and references push one entry
+    // ----------------
+
+    if (op == VALUE) {
+      sval[n] = instr->value;
+      vflag[n++] = 0;
+      continue;
+    }
+
+    if (op == KEYWORD) {
+      if (domain->box_exist == 0)
+        error->all(FLERR,
+                   "Variable evaluation before simulation box is defined");
+      int flag = output->thermo->evaluate_keyword(instr->id,&sval[n]);
+      if (flag) error->all(FLERR,"Invalid thermo keyword in variable formula");
+      vflag[n++] = 0;
+      continue;
+    }
+
+    if (op == VARREF) {
+      int jvar = instr->icache;
+      if (jvar < 0 || jvar >= nvar || strcmp(names[jvar],instr->id) != 0)
+        jvar = instr->icache = find(instr->id);
+      if (jvar < 0)
+        error->all(FLERR,"Invalid variable name in variable formula");
+      if (eval_in_progress[jvar])
+        error->all(FLERR,"Variable has circular dependency");
+      char *var = retrieve(instr->id);
+      if (var == NULL)
+        error->all(FLERR,"Invalid variable evaluation in variable formula");
+      sval[n] = atof(var);
+      vflag[n++] = 0;
+      continue;
+    }
+
+    if (op == ATOMFILEREF) {
+      load_peratom(vstack[n],reader[instr->icache]->fix->vstore,1);
+      vflag[n++] = 1;
+      continue;
+    }
+
+    if (op == COMPUTEREF) {
+      Compute *compute = modify->compute[instr->icache];
+      int index1 = instr->index1;
+      int index2 = instr->index2;
+
+      if (instr->kind == GLOBALSCALAR) {
+        if (update->whichflag == 0) {
+          if (compute->invoked_scalar != update->ntimestep)
+            error->all(FLERR,"Compute used in variable between runs "
+                       "is not current");
+        } else if (!(compute->invoked_flag & INVOKED_SCALAR)) {
+          compute->compute_scalar();
+          compute->invoked_flag |= INVOKED_SCALAR;
+        }
+        sval[n] = compute->scalar;
+        vflag[n++] = 0;
+
+      } else if (instr->kind == GLOBALVECTOR) {
+        if (index1 > compute->size_vector)
+          error->all(FLERR,"Variable formula compute vector "
+                     "is accessed out-of-range");
+        if (update->whichflag == 0) {
+          if (compute->invoked_vector != update->ntimestep)
+            error->all(FLERR,"Compute used in variable between runs "
+                       "is not current");
+        } else if (!(compute->invoked_flag & INVOKED_VECTOR)) {
+          compute->compute_vector();
+          compute->invoked_flag |= INVOKED_VECTOR;
+        }
+        sval[n] = compute->vector[index1-1];
+        vflag[n++] = 0;
+
+      } else if (instr->kind == GLOBALARRAY) {
+        if (index1 > compute->size_array_rows)
+          error->all(FLERR,"Variable formula compute array "
+                     "is accessed out-of-range");
+        if (index2 > compute->size_array_cols)
+          error->all(FLERR,"Variable formula compute array "
+                     "is accessed out-of-range");
+        if (update->whichflag == 0) {
+          if (compute->invoked_array != update->ntimestep)
+            error->all(FLERR,"Compute used in variable between runs "
+                       "is not current");
+        } else if (!(compute->invoked_flag & INVOKED_ARRAY)) {
+          compute->compute_array();
+          compute->invoked_flag |= INVOKED_ARRAY;
+        }
+        sval[n] = compute->array[index1-1][index2-1];
+        vflag[n++] = 0;
+
+      } else {
+        if (instr->kind == PERATOMARRAY &&
+            index1 > compute->size_peratom_cols)
+          error->all(FLERR,"Variable formula compute array "
+                     "is accessed out-of-range");
+        if (update->whichflag == 0) {
+          if (compute->invoked_peratom != update->ntimestep)
+            error->all(FLERR,"Compute used in variable between runs "
+                       "is not current");
+        } else if (!(compute->invoked_flag & INVOKED_PERATOM)) {
+          compute->compute_peratom();
+          compute->invoked_flag |= INVOKED_PERATOM;
+        }
+        if (instr->kind == PERATOMVECTOR)
+          load_peratom(vstack[n],compute->vector_atom,1);
+        else if (compute->array_atom)
+          load_peratom(vstack[n],&compute->array_atom[0][index1-1],
+                       compute->size_peratom_cols);
+        else load_peratom(vstack[n],NULL,0);
+        vflag[n++] = 1;
+      }
+      continue;
+    }
+
+    if (op == FIXREF) {
+      Fix *fix = modify->fix[instr->icache];
+      int index1 = instr->index1;
+      int index2 = instr->index2;
+
+      if (instr->kind == GLOBALSCALAR) {
+        if (update->whichflag > 0 && update->ntimestep % fix->global_freq)
+          error->all(FLERR,"Fix in variable not computed at compatible time");
+        sval[n] = fix->compute_scalar();
+        vflag[n++] = 0;
+
+      } else if (instr->kind == GLOBALVECTOR) {
+        if (index1 > fix->size_vector)
+          error->all(FLERR,
+                     "Variable formula fix vector is accessed out-of-range");
+        if (update->whichflag > 0 && update->ntimestep % fix->global_freq)
+          error->all(FLERR,"Fix in variable not computed at compatible time");
+        sval[n] = fix->compute_vector(index1-1);
+        vflag[n++] = 0;
+
+      } else if (instr->kind == GLOBALARRAY) {
+        if (index1 > fix->size_array_rows)
+          error->all(FLERR,
+                     "Variable formula fix array is accessed out-of-range");
+        if (index2 > fix->size_array_cols)
+          error->all(FLERR,
+                     "Variable formula fix array is accessed out-of-range");
+        if (update->whichflag > 0 && update->ntimestep % fix->global_freq)
+          error->all(FLERR,"Fix in variable not computed at compatible time");
+        sval[n] = fix->compute_array(index1-1,index2-1);
+        vflag[n++] = 0;
+
+      } else {
+        if (instr->kind == PERATOMARRAY && index1 > fix->size_peratom_cols)
+          error->all(FLERR,
+                     "Variable formula fix array is accessed out-of-range");
+        if (update->whichflag > 0 &&
+            update->ntimestep % fix->peratom_freq)
+          error->all(FLERR,"Fix in variable not computed at compatible time");
+        if (instr->kind == PERATOMVECTOR)
+          load_peratom(vstack[n],fix->vector_atom,1);
+        else if (fix->array_atom)
+          load_peratom(vstack[n],&fix->array_atom[0][index1-1],
+                       fix->size_peratom_cols);
+        else load_peratom(vstack[n],NULL,0);
+        vflag[n++] = 1;
+      }
+      continue;
+    }
+
+    if (op == ATOMVECTOR) {
+      if (domain->box_exist == 0)
+        error->all(FLERR,
+                   "Variable evaluation before simulation box is defined");
+      char *word = instr->id;
+      a = vstack[n];
+
+      if (strcmp(word,"id") == 0) {
+        tagint *tag = atom->tag;
+        for (i = 0; i < nlocal; i++) a[i] = tag[i];
+      } else if (strcmp(word,"mass") == 0) {
+        if (atom->rmass) load_peratom(a,atom->rmass,1);
+        else {
+          double *mass = atom->mass;
+          int *type = atom->type;
+          for (i = 0; i < nlocal; i++) a[i] = mass[type[i]];
+        }
+      } else if (strcmp(word,"type") == 0) {
+        int *type = atom->type;
+        for (i = 0; i < nlocal; i++) a[i] = type[i];
+      } else if (strcmp(word,"mol") == 0) {
+        if (!atom->molecule_flag) 
+          error->one(FLERR,"Variable uses atom property that isn't allocated");
+        tagint *molecule = atom->molecule;
+        for (i = 0; i < nlocal; i++) a[i] = molecule[i];
+      } 
+      else if (strcmp(word,"x") == 0) load_peratom(a,&atom->x[0][0],3);
+      else if (strcmp(word,"y") == 0) load_peratom(a,&atom->x[0][1],3);
+      else if (strcmp(word,"z") == 0) load_peratom(a,&atom->x[0][2],3);
+      else if (strcmp(word,"vx") == 0) load_peratom(a,&atom->v[0][0],3);
+      else if (strcmp(word,"vy") == 0) load_peratom(a,&atom->v[0][1],3);
+      else if (strcmp(word,"vz") == 0) load_peratom(a,&atom->v[0][2],3);
+      else if (strcmp(word,"fx") == 0) load_peratom(a,&atom->f[0][0],3);
+      else if (strcmp(word,"fy") == 0) load_peratom(a,&atom->f[0][1],3);
+      else if (strcmp(word,"fz") == 0) load_peratom(a,&atom->f[0][2],3);
+      else if (strcmp(word,"q") == 0) load_peratom(a,atom->q,1);
+
+      vflag[n++] = 1;
+      continue;
+    }
+
+    if (op == GMASK || op == RMASK || op == GRMASK) {
+      int bitmask = 0;
+      Region *region = NULL;
+      if (op != RMASK) {
+        int igroup = group->find(instr->id);
+        if (igroup == -1)
+          error->all(FLERR,"Group ID in variable formula does not exist");
+        bitmask = group->bitmask[igroup];
+      }
+      if (op != GMASK) {
+        if (op == RMASK) region = domain->regions[region_function(instr->id)];
+        else region = domain->regions[region_function(instr->id2)];
+        region->prematch();
+      }
+
+      a = vstack[n];
+      double **x = atom->x;
+      if (op == GMASK) {
+        for (i = 0; i < nlocal; i++) a[i] = (mask[i] & bitmask) ? 1.0 : 0.0;
+      } else if (op == RMASK) {
+        for (i = 0; i < nlocal; i++)
+          a[i] = region->match(x[i][0],x[i][1],x[i][2]) ? 1.0 : 0.0;
+      } else {
+        for (i = 0; i < nlocal; i++)
+          a[i] = ((mask[i] & bitmask) &&
+                  region->match(x[i][0],x[i][1],x[i][2])) ? 1.0 : 0.0;
+      }
+      vflag[n++] = 1;
+      continue;
+    }
+
+    // ----------------
+    // operators and math functions pop narg entries, push one
+    // ----------------
+
+    narg = instr->narg;
+    n -= narg;
+
+    if (update->whichflag == 0) {
+      if (op == RAMP)
+        error->all(FLERR,"Cannot use ramp in variable formula between runs");
+      if (op == VDISPLACE)
+        error->all(FLERR,
+                   "Cannot use vdisplace in variable formula between runs");
+      if (op == SWIGGLE)
+        error->all(FLERR,"Cannot use swiggle in variable formula between runs");
+      if (op == CWIGGLE)
+        error->all(FLERR,"Cannot use cwiggle in variable formula between runs");
+    }
+
+    vecflag = 0;
+    for (k = n; k < n+narg; k++)
+      if (vflag[k]) vecflag = 1;
+
+    if (!vecflag) {
+      for (k = 0; k < narg; k++) arg[k] = sval[n+k];
+      sval[n] = math_scalar(op,arg,prog->atomflag);
+      vflag[n++] = 0;
+      continue;
+    }
+
+    for (k = n; k < n+narg; k++) {
+      if (vflag[k]) continue;
+      a = vstack[k];
+      for (i = 0; i < nlocal; i++) a[i] = sval[k];
+    }
+
+    a = vstack[n];
+    b = (narg > 1) ? vstack[n+1] : NULL;
+
+    switch (op) {
+    case ADD:
+      for (i = 0; i < nlocal; i++) a[i] = a[i] + b[i];
+      break;
+    case SUBTRACT:
+      for (i = 0; i < nlocal; i++) a[i] = a[i] - b[i];
+      break;
+    case MULTIPLY:
+      for (i = 0; i < nlocal; i++) a[i] = a[i] * b[i];
+      break;
+    case DIVIDE:
+      for (i = 0; i < nlocal; i++)
+        if ((mask[i] & groupbit) && b[i] == 0.0)
+          error->one(FLERR,"Divide by 0 in variable formula");
+      for (i = 0; i < nlocal; i++) a[i] = a[i] / b[i];
+      break;
+    case UNARY:
+      for (i = 0; i < nlocal; i++) a[i] = -a[i];
+      break;
+    case NOT:
+      for (i = 0; i < nlocal; i++) a[i] = (a[i] == 0.0) ? 1.0 : 0.0;
+      break;
+    case EQ:
+      for (i = 0; i < nlocal; i++) a[i] = (a[i] == b[i]) ? 1.0 : 0.0;
+      break;
+    case NE:
+      for (i = 0; i < nlocal; i++) a[i] = (a[i] != b[i]) ? 1.0 : 0.0;
+      break;
+    case LT:
+      for (i = 0; i < nlocal; i++) a[i] = (a[i] < b[i]) ? 1.0 : 0.0;
+      break;
+    case LE:
+      for (i = 0; i < nlocal; i++) a[i] = (a[i] <= b[i]) ? 1.0 : 0.0;
+      break;
+    case GT:
+      for (i = 0; i < nlocal; i++) a[i] = (a[i] > b[i]) ? 1.0 : 0.0;
+      break;
+    case GE:
+      for (i = 0; i < nlocal; i++) a[i] = (a[i] >= b[i]) ? 1.0 : 0.0;
+      break;
+    case AND:
+      for (i = 0; i < nlocal; i++)
+        a[i] = (a[i] != 0.0 && b[i] != 0.0) ? 1.0 : 0.0;
+      break;
+    case OR:
+      for (i = 0; i < nlocal; i++)
+        a[i] = (a[i] != 0.0 || b[i] != 0.0) ? 1.0 : 0.0;
+      break;
+    case SQRT:
+      for (i = 0; i < nlocal; i++)
+        if ((mask[i] & groupbit) && a[i] < 0.0)
+          error->one(FLERR,"Sqrt of negative value in variable formula");
+      for (i = 0; i < nlocal; i++) a[i] = sqrt(a[i]);
+      break;
+    case EXP:
+      for (i = 0; i < nlocal; i++) a[i] = exp(a[i]);
+      break;
+    case ABS:
+      for (i = 0; i < nlocal; i++) a[i] = fabs(a[i]);
+      break;
+    case SIN:
+      for (i = 0; i < nlocal; i++) a[i] = sin(a[i]);
+      break;
+    case COS:
+      for (i = 0; i < nlocal; i++) a[i] = cos(a[i]);
+      break;
+    case ATAN2:
+      for (i = 0; i < nlocal; i++) a[i] = atan2(a[i],b[i]);
+      break;
+    case CEIL:
+      for (i = 0; i < nlocal; i++) a[i] = ceil(a[i]);
+      break;
+    case FLOOR:
+      for (i = 0; i < nlocal; i++) a[i] = floor(a[i]);
+      break;
+
+    // remaining operations need per-atom error checks or branches
+
+    default:
+      for (i = 0; i < nlocal; i++) {
+        if (mask[i] & groupbit) {
+          for (k = 0; k < narg; k++) arg[k] = vstack[n+k][i];
+          a[i] = math_scalar(op,arg,1);
+        } else a[i] = 0.0;
+      }
+    }
+
+    vflag[n++] = 1;
+  }
+
+  answer = sval[0];
+  return vflag[0];
+}
+
+/* ----------------------------------------------------------------------
+   apply operator or math function op to scalar args
+   same math and error checks as evaluate() and eval_tree()
+   atomflag = 1 for per-atom values, so errors are from a single proc
+------------------------------------------------------------------------- */
+
+double Variable::math_scalar(int op, double *arg, int atomflag)
+{
+  double value1 = arg[0];
+  double value2 = arg[1];
+  double value;
+
+  switch (op) {
+  case ADD: return value1 + value2;
+  case SUBTRACT: return value1 - value2;
+  case MULTIPLY: return value1 * value2;
+  case DIVIDE:
+    if (value2 == 0.0) math_error(atomflag,"Divide by 0 in variable formula");
+    return value1 / value2;
+  case MODULO:
+    if (value2 == 0.0) math_error(atomflag,"Modulo 0 in variable formula");
+    return fmod(value1,value2);
+  case CARAT:
+    if (value2 == 0.0) math_error(atomflag,"Power by 0 in variable formula");
+    return pow(value1,value2);
+  case UNARY: return -value1;
+  case NOT: return (value1 == 0.0) ? 1.0 : 0.0;
+  case EQ: return (value1 == value2) ? 1.0 : 0.0;
+  case NE: return (value1 != value2) ? 1.0 : 0.0;
+  case LT: return (value1 < value2) ? 1.0 : 0.0;
+  case LE: return (value1 <= value2) ? 1.0 : 0.0;
+  case GT: return (value1 > value2) ? 1.0 : 0.0;
+  case GE: return (value1 >= value2) ? 1.0 : 0.0;
+  case AND: return (value1 != 0.0 && value2 != 0.0) ? 1.0 : 0.0;
+  case OR: return (value1 != 0.0 || value2 != 0.0) ? 1.0 : 0.0;
+
+  case SQRT:
+    if (value1 < 0.0)
+      math_error(atomflag,"Sqrt of negative value in variable formula");
+    return sqrt(value1);
+  case EXP: return exp(value1);
+  case LN:
+    if (value1 <= 0.0)
+      math_error(atomflag,"Log of zero/negative value in variable formula");
+    return log(value1);
+  case LOG:
+    if (value1 <= 0.0)
+      math_error(atomflag,"Log of zero/negative value in variable formula");
+    return log10(value1);
+  case ABS: return fabs(value1);
+  case SIN: return sin(value1);
+  case COS: return cos(value1);
+  case TAN: return tan(value1);
+  case ASIN:
+    if (value1 < -1.0 || value1 > 1.0)
+      math_error(atomflag,"Arcsin of invalid value in variable formula");
+    return asin(value1);
+  case ACOS:
+    if (value1 < -1.0 || value1 > 1.0)
+      math_error(atomflag,"Arccos of invalid value in variable formula");
+    return acos(value1);
+  case ATAN: return atan(value1);
+  case ATAN2: return atan2(value1,value2);
+  case CEIL: return ceil(value1);
+  case FLOOR: return floor(value1);
+  case ROUND: return MYROUND(value1);
+
+  case RAMP: {
+    double delta = update->ntimestep - update->beginstep;
+    if (delta != 0.0) delta /= update->endstep - update->beginstep;
+    return value1 + delta*(value2-value1);
+  }
+
+  case STAGGER: {
+    int ivalue1 = static_cast<int> (value1);
+    int ivalue2 = static_cast<int> (value2);
+    if (ivalue1 <= 0 || ivalue2 <= 0 || ivalue1 <= ivalue2)
+      math_error(atomflag,"Invalid math function in variable formula");
+    int lower = update->ntimestep/ivalue1 * ivalue1;
+    int delta = update->ntimestep - lower;
+    if (delta < ivalue2) value = lower+ivalue2;
+    else value = lower+ivalue1;
+    return value;
+  }
+
+  case LOGFREQ: {
+    int ivalue1 = static_cast<int> (value1);
+    int ivalue2 = static_cast<int> (value2);
+    int ivalue3 = static_cast<int> (arg[2]);
+    if (ivalue1 <= 0 || ivalue2 <= 0 || ivalue3 <= 0 || ivalue2 >= ivalue3)
+      math_error(atomflag,"Invalid math function in variable formula");
+    if (update->ntimestep < ivalue1) value = ivalue1;
+    else {
+      int lower = ivalue1;
+      while (update->ntimestep >= ivalue3*lower) lower *= ivalue3;
+      int multiple = update->ntimestep/lower;
+      if (multiple < ivalue2) value = (multiple+1)*lower;
+      else value = lower*ivalue3;
+    }
+    return value;
+  }
+
+  case STRIDE: {
+    int ivalue1 = static_cast<int> (value1);
+    int ivalue2 = static_cast<int> (value2);
+    int ivalue3 = static_cast<int> (arg[2]);
+    if (ivalue1 < 0 || ivalue2 < 0 || ivalue3 <= 0 || ivalue1 > ivalue2)
+      error->one(FLERR,"Invalid math function in variable formula");
+    if (update->ntimestep < ivalue1) value = ivalue1;
+    else if (update->ntimestep < ivalue2) {
+      int offset = update->ntimestep - ivalue1;
+      value = ivalue1 + (offset/ivalue3)*ivalue3 + ivalue3;
+      if (value > ivalue2) value = 9.0e18;
+    } else value = 9.0e18;
+    return value;
+  }
+
+  case STRIDE2: {
+    int ivalue1 = static_cast<int> (value1);
+    int ivalue2 = static_cast<int> (value2);
+    int ivalue3 = static_cast<int> (arg[2]);
+    int ivalue4 = static_cast<int> (arg[3]);
+    int ivalue5 = static_cast<int> (arg[4]);
+    int ivalue6 = static_cast<int> (arg[5]);
+    if (ivalue1 < 0 || ivalue2 < 0 || ivalue3 <= 0 || ivalue1 > ivalue2)
+      error->one(FLERR,"Invalid math function in variable formula");
+    if (ivalue4 < 0 || ivalue5 < 0 || ivalue6 <= 0 || ivalue4 > ivalue5)
+      error->one(FLERR,"Invalid math function in variable formula");
+    if (ivalue4 < ivalue1 || ivalue5 > ivalue2)
+      error->one(FLERR,"Invalid math function in variable formula");
+    bigint istep;
+    if (update->ntimestep < ivalue1) istep = ivalue1;
+    else if (update->ntimestep < ivalue2) {
+      if (update->ntimestep < ivalue4 || update->ntimestep > ivalue5) {
+        int offset = update->ntimestep - ivalue1;
+        istep = ivalue1 + (offset/ivalue3)*ivalue3 + ivalue3;
+        if (update->ntimestep < ivalue4 && istep > ivalue4) istep = ivalue4;
+      } else {
+        int offset = update->ntimestep - ivalue4;
+        istep = ivalue4 + (offset/ivalue6)*ivalue6 + ivalue6;
+        if (istep > ivalue5) {
+          int offset = ivalue5 - ivalue1;
+          istep = ivalue1 + (offset/ivalue3)*ivalue3 + ivalue3;
+          if (istep > ivalue2) istep = 9.0e18;
+        }
+      }
+    } else istep = 9.0e18;
+    value = istep;
+    return value;
+  }
+
+  case VDISPLACE: {
+    double delta = update->ntimestep - update->beginstep;
+    return value1 + value2*delta*update->dt;
+  }
+
+  case SWIGGLE: {
+    if (arg[2] == 0.0)
+      math_error(atomflag,"Invalid math function in variable formula");
+    double delta = update->ntimestep - update->beginstep;
+    double omega = 2.0*MY_PI/arg[2];
+    return value1 + value2*sin(omega*delta*update->dt);
+  }
+
+  case CWIGGLE: {
+    if (arg[2] == 0.0)
+      math_error(atomflag,"Invalid math function in variable formula");
+    double delta = update->ntimestep - update->beginstep;
+    double omega = 2.0*MY_PI/arg[2];
+    return value1 + value2*(1.0-cos(omega*delta*update->dt));
+  }
+  }
+
+  return 0.0;
+}
+
+/* ----------------------------------------------------------------------
+   error in a compiled math operation
+   per-atom values may only be bad on some procs
+------------------------------------------------------------------------- */
+
+void Variable::math_error(int atomflag, const char *str)
+{
+  if (atomflag) error->one(FLERR,str);
+  else error->all(FLERR,str);
+}
+
+/* ----------------------------------------------------------------------
+   copy per-atom values with stride nstride into contiguous vector
+   src = NULL means no values are stored, e.g. no atoms, store 0.0
+------------------------------------------------------------------------- */
+
+void Variable::load_peratom(double *vec, double *src, int nstride)
+{
+  int nlocal = atom->nlocal;
+
+  if (src == NULL) {
+    for (int i = 0; i < nlocal; i++) vec[i] = 0.0;
+    return;
+  }
+
+  if (nstride == 1) memcpy(vec,src,nlocal*sizeof(double));
+  else for (int i = 0; i < nlocal; i++) vec[i] = src[i*nstride];
+}
+
 /* ----------------------------------------------------------------------
    recursive evaluation of string str
    called from "if" command in input script
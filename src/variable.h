@@ -77,6 +77,30 @@ class Variable : protected Pointers {
     Tree **extra;          // ptrs further down tree for nextra args
   };
 
+  struct Instr {            // one step of a compiled formula
+    int op;                // operation, see enum{} in variable.cpp
+    int narg;              // # of args consumed from stack
+    int kind;              // kind of compute/fix quantity referenced
+    int index1,index2;     // bracket indices of compute/fix reference
+    int icache;            // last known index of compute/fix/variable
+    double value;          // constant value
+    char *id,*id2;         // ID of compute/fix/variable/group/region
+                           //   or thermo keyword or atom vector name
+  };
+
+  struct Program {         // postfix program for equal/atom-style variables
+    int ncode,maxcode;     // # of instructions, allocated length
+    int nstack,maxstack;   // current and max stack depth while compiling
+    int atomflag;          // 1 if per-atom values are allowed
+    Instr *code;
+    double **vstack;       // per-atom stack for evaluation
+    int maxvstack,maxvatom;
+  };
+
+  Program **program;       // compiled program for each variable
+  int *compiled;           // 1 = program is valid, 0 = needs compile,
+                           // -1 = formula cannot be compiled
+
   void remove(int);
   void grow();
   void copy(int, char **, char **);
@@ -99,6 +123,22 @@ class Variable : protected Pointers {
   int parse_args(char *, char **);
   char *find_next_comma(char *);
   void print_tree(Tree *, int);
+
+  double evaluate_equal(int);
+  Program *get_program(int, int);
+  void invalidate(int);
+  void free_program(Program *);
+  int compile(char *, Program *);
+  int compile_function(char *, char *, Program *);
+  int compile_brackets(char *, int &, int &, int &);
+  Instr *emit(Program *, int, int, double, char *, char *);
+  int compute_kind(class Compute *, int, int);
+  int fix_kind(class Fix *, int, int);
+  int check_program(Program *);
+  int run_program(Program *, int, double &);
+  double math_scalar(int, double *, int);
+  void math_error(int, const char *);
+  void load_peratom(double *, double *, int);
 };
 
 class VarReader : protected Pointers {
@@ -31,6 +31,7 @@
 #include "compute.h"
 #include "fix.h"
 #include "timer.h"
+#include "neigh_list.h"
 #include "memory.h"
 #include "error.h"
 
@@ -39,7 +40,11 @@ using namespace LAMMPS_NS;
 /* ---------------------------------------------------------------------- */
 
 Verlet::Verlet(LAMMPS *lmp, int narg, char **arg) :
-  Integrate(lmp, narg, arg) {}
+  Integrate(lmp, narg, arg)
+{
+  overlap_flag = 0;
+  overlap_warn = 0;
+}
 
 /* ----------------------------------------------------------------------
    initialization before run
@@ -111,6 +116,7 @@ void Verlet::setup()
   modify->setup_pre_neighbor();
   neighbor->build();
   neighbor->ncalls = 0;
+  overlap_setup();
 
   // compute all forces
 
@@ -171,6 +177,7 @@ void Verlet::setup_minimal(int flag)
     neighbor->build();
     neighbor->ncalls = 0;
   }
+  overlap_setup();
 
   // compute all forces
 
@@ -235,7 +242,8 @@ void Verlet::run(int n)
 
     if (nflag == 0) {
       timer->stamp();
-      comm->forward_comm();
+      if (overlap_flag) comm->forward_comm_start();
+      else comm->forward_comm();
       timer->stamp(TIME_COMM);
     } else {
       if (n_pre_exchange) modify->pre_exchange();
@@ -254,6 +262,7 @@ void Verlet::run(int n)
       timer->stamp(TIME_COMM);
       if (n_pre_neighbor) modify->pre_neighbor();
       neighbor->build();
+      if (overlap_flag) force->pair->list->split_interior();
       timer->stamp(TIME_NEIGHBOR);
     }
 
@@ -261,13 +270,21 @@ void Verlet::run(int n)
     // important for pair to come before bonded contributions
     // since some bonded potentials tally pairwise energy/virial
     // and Pair:ev_tally() needs to be called before any tallying
+    // if overlapping, compute interior atoms while forward comm completes
 
     force_clear();
     if (n_pre_force) modify->pre_force(vflag);
 
     timer->stamp();
 
-    if (pair_compute_flag) {
+    if (overlap_flag && nflag == 0) {
+      force->pair->compute_interior(eflag,vflag);
+      timer->stamp(TIME_PAIR);
+      comm->forward_comm_finish();
+      timer->stamp(TIME_COMM);
+      force->pair->compute_boundary(eflag,vflag);
+      timer->stamp(TIME_PAIR);
+    } else if (pair_compute_flag) {
       force->pair->compute(eflag,vflag);
       timer->stamp(TIME_PAIR);
     }
@@ -305,6 +322,14 @@ void Verlet::run(int n)
       output->write(ntimestep);
       timer->stamp(TIME_OUTPUT);
     }
+
+    // periodic timer output in JSON format
+
+    if (timer->jsonevery && ntimestep % timer->jsonevery == 0) {
+      timer->stamp();
+      timer->write_json(timer->elapsed(TIME_LOOP));
+      timer->stamp(TIME_OUTPUT);
+    }
   }
 }
 
@@ -317,6 +342,37 @@ void Verlet::cleanup()
   update->update_time();
 }
 
+/* ----------------------------------------------------------------------
+   decide if forward comm can overlap with pair computation
+   requires a pair style that supports compute_interior/boundary()
+     and no pre_force fixes, which may access ghost atoms
+   accelerated pair styles disable overlap_enable or are excluded here
+   if so, order interior atoms first in the pair neighbor list
+   warn only once if overlap was requested but cannot be used
+------------------------------------------------------------------------- */
+
+void Verlet::overlap_setup()
+{
+  overlap_flag = 0;
+  if (!comm->overlap) return;
+
+  Pair *pair = force->pair;
+  if (pair && pair_compute_flag && pair->overlap_enable && pair->list &&
+      !external_force_clear &&
+      modify->n_pre_force == 0 && !lmp->cuda && !lmp->kokkos)
+    overlap_flag = 1;
+
+  if (!overlap_flag) {
+    if (comm->me == 0 && !overlap_warn)
+      error->warning(FLERR,"Comm overlap disabled for this pair style "
+                     "or fix setup");
+    overlap_warn = 1;
+    return;
+  }
+
+  pair->list->split_interior();
+}
+
 /* ----------------------------------------------------------------------
    clear force on own & ghost atoms
    clear other arrays as needed
@@ -37,8 +37,11 @@ class Verlet : public Integrate {
  protected:
   int triclinic;                    // 0 if domain is orthog, 1 if triclinic
   int torqueflag,extraflag;
+  int overlap_flag;                 // 1 if forward comm overlaps pair compute
+  int overlap_warn;                 // 1 if disabled overlap was warned about
 
   virtual void force_clear();
+  void overlap_setup();
 };
 
 }
@@ -53,4 +56,12 @@ W: No fixes defined, atoms won't move
 If you are not using a fix like nve, nvt, npt then atom velocities and
 coordinates will not be updated during timestepping.
 
+W: Comm overlap disabled for this pair style or fix setup
+
+The comm_modify overlap option requires a pair style that supports
+splitting its computation between interior and boundary atoms, and no
+fixes that operate on atoms before forces are computed.  It is not
+supported by accelerated styles.  Regular forward communication is
+used instead.
+
 */
@@ -79,7 +79,9 @@ void WriteDump::command(int narg, char **arg)
   dump->write();
 
   // delete the Dump instance and local storage
+  // wait for background I/O thread before derived dump data is freed
 
+  dump->async_wait();
   delete dump;
   delete [] dumpargs;
 }
@@ -39,6 +39,8 @@
 
 using namespace LAMMPS_NS;
 
+#define BIG 1.0e20
+
 // same as read_restart.cpp
 
 #define MAGIC_STRING "LammpS RestartT"
@@ -59,7 +61,7 @@ enum{VERSION,SMALLINT,TAGINT,BIGINT,
      SPECIAL_LJ,SPECIAL_COUL,
      MASS,PAIR,BOND,ANGLE,DIHEDRAL,IMPROPER,
      MULTIPROC,MPIIO,PROCSPERFILE,PERPROC,
-     IMAGEINT};
+     IMAGEINT,MPIIOINDEX};
 
 enum{IGNORE,WARN,ERROR};                    // same as thermo.cpp
 
@@ -291,37 +293,6 @@ void WriteRestart::write(char *file)
   double *buf;
   memory->create(buf,max_size,"write_restart:buf");
 
-  // all procs write file layout info which may include per-proc sizes
-
-  file_layout(send_size);
-
-  // header info is complete
-  // if multiproc output:
-  //   close header file, open multiname file on each writing proc,
-  //   write PROCSPERFILE into new file
-
-  if (multiproc) {
-    if (me == 0) fclose(fp);
-
-    char *multiname = new char[strlen(file) + 16];
-    char *ptr = strchr(file,'%');
-    *ptr = '\0';
-    sprintf(multiname,"%s%d%s",file,icluster,ptr+1);
-    *ptr = '%';
-
-    if (filewriter) {
-      fp = fopen(multiname,"wb");
-      if (fp == NULL) {
-        char str[128];
-        sprintf(str,"Cannot open restart file %s",multiname);
-        error->one(FLERR,str);
-      }
-      write_int(PROCSPERFILE,nclusterprocs);
-    }
-
-    delete [] multiname;
-  }
-
   // pack my atom data into buf
 
   AtomVec *avec = atom->avec;
@@ -377,6 +348,38 @@ void WriteRestart::write(char *file)
     }
   }
 
+  // all procs write file layout info which may include per-proc sizes
+  // and, for MPI-IO, the bounding box of each proc's chunk of atoms
+
+  file_layout(send_size,buf);
+
+  // header info is complete
+  // if multiproc output:
+  //   close header file, open multiname file on each writing proc,
+  //   write PROCSPERFILE into new file
+
+  if (multiproc) {
+    if (me == 0) fclose(fp);
+
+    char *multiname = new char[strlen(file) + 16];
+    char *ptr = strchr(file,'%');
+    *ptr = '\0';
+    sprintf(multiname,"%s%d%s",file,icluster,ptr+1);
+    *ptr = '%';
+
+    if (filewriter) {
+      fp = fopen(multiname,"wb");
+      if (fp == NULL) {
+        char str[128];
+        sprintf(str,"Cannot open restart file %s",multiname);
+        error->one(FLERR,str);
+      }
+      write_int(PROCSPERFILE,nclusterprocs);
+    }
+
+    delete [] multiname;
+  }
+
   // MPI-IO output to single file
 
   if (mpiioflag) {
@@ -542,7 +545,7 @@ void WriteRestart::force_fields()
    all procs call this method, only proc 0 writes to file
 ------------------------------------------------------------------------- */
 
-void WriteRestart::file_layout(int send_size)
+void WriteRestart::file_layout(int send_size, double *buf)
 {
   if (me == 0) {
     write_int(MULTIPROC,multiproc);
@@ -555,6 +558,36 @@ void WriteRestart::file_layout(int send_size)
     MPI_Gather(&send_size, 1, MPI_INT, all_send_sizes, 1, MPI_INT, 0,world);
     if (me == 0) fwrite(all_send_sizes,sizeof(int),nprocs,fp);
     memory->destroy(all_send_sizes);
+
+    // chunk index = bounding box of the atoms in each proc's chunk
+    // in lamda coords for triclinic, after any restart PBC remap of buf
+    // chunk offsets follow from the sizes, so a reader on any # of procs
+    //   can fetch only the chunks that overlap its sub-domain
+
+    double bounds[6],lamda[3];
+    double *x,*coord;
+    bounds[0] = bounds[1] = bounds[2] = BIG;
+    bounds[3] = bounds[4] = bounds[5] = -BIG;
+
+    int m = 0;
+    while (m < send_size) {
+      x = &buf[m+1];
+      if (domain->triclinic) {
+        domain->x2lamda(x,lamda);
+        coord = lamda;
+      } else coord = x;
+      for (int k = 0; k < 3; k++) {
+        bounds[k] = MIN(bounds[k],coord[k]);
+        bounds[k+3] = MAX(bounds[k+3],coord[k]);
+      }
+      m += static_cast<int> (buf[m]);
+    }
+
+    double *all_bounds;
+    memory->create(all_bounds,6*nprocs,"write_restart:all_bounds");
+    MPI_Gather(bounds,6,MPI_DOUBLE,all_bounds,6,MPI_DOUBLE,0,world);
+    if (me == 0) write_double_vec(MPIIOINDEX,6*nprocs,all_bounds);
+    memory->destroy(all_bounds);
   }
 
   // -1 flag signals end of file layout info
@@ -53,7 +53,7 @@ class WriteRestart : protected Pointers {
   void header();
   void type_arrays();
   void force_fields();
-  void file_layout(int);
+  void file_layout(int, double *);
 
   void magic_string();
   void endian();